@@ -28,50 +28,165 @@
 #include "GpuMemoryHeap.h"
 #include "GpuFence.h"
 #include "Core/Assert.h"
+#include "Core/Errors.h"
 #include "Utils/Math/Common.h"
+#include <algorithm>
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Flags of the thread allocators owned by the current thread, set when the thread exits.
+            This lets the heaps recycle the active pages of exited threads, e.g., short-lived texture loader threads.
+        */
+        struct ThreadExitFlags
+        {
+            std::vector<std::shared_ptr<std::atomic<bool>>> flags;
+
+            ~ThreadExitFlags()
+            {
+                for (auto& pFlag : flags) *pFlag = true;
+            }
+        };
+
+        thread_local ThreadExitFlags tThreadExitFlags;
+    }
+
     GpuMemoryHeap::~GpuMemoryHeap()
     {
         mDeferredReleases = decltype(mDeferredReleases)();
     }
 
-    GpuMemoryHeap::GpuMemoryHeap(Type type, size_t pageSize, const GpuFence::SharedPtr& pFence)
+    GpuMemoryHeap::GpuMemoryHeap(Type type, size_t pageSize, const Backend& backend)
         : mType(type)
+        , mBackend(backend)
         , mPageSize(pageSize)
-        , mpFence(pFence)
     {
-        allocateNewPage();
+        checkArgument(mBackend.getCpuFenceValue && mBackend.getGpuFenceValue, "'backend' must provide fence values");
+        if (!mBackend.createPage) mBackend.createPage = [this](BaseData& data, size_t size) { initBasePageData(data, size); };
     }
 
     GpuMemoryHeap::SharedPtr GpuMemoryHeap::create(Type type, size_t pageSize, const GpuFence::SharedPtr& pFence)
     {
-        return SharedPtr(new GpuMemoryHeap(type, pageSize, pFence));
+        checkArgument(pFence != nullptr, "'pFence' must not be null");
+
+        Backend backend;
+        backend.getCpuFenceValue = [pFence]() { return pFence->getCpuValue(); };
+        backend.getGpuFenceValue = [pFence]() { return pFence->getGpuValue(); };
+        return SharedPtr(new GpuMemoryHeap(type, pageSize, backend));
+    }
+
+    GpuMemoryHeap::SharedPtr GpuMemoryHeap::create(Type type, size_t pageSize, const Backend& backend)
+    {
+        return SharedPtr(new GpuMemoryHeap(type, pageSize, backend));
+    }
+
+    size_t GpuMemoryHeap::getLargePageSizeClass(size_t size)
+    {
+        if (size <= 4) return size;
+
+        uint32_t msb = 0;
+        for (size_t v = size - 1; v > 1; v >>= 1) msb++;
+        size_t step = size_t(1) << (msb - 2);
+        return align_to(step, size);
     }
 
-    void GpuMemoryHeap::allocateNewPage()
+    GpuMemoryHeap::ThreadAllocator& GpuMemoryHeap::getThreadAllocator()
     {
-        if (mpActivePage)
+        std::thread::id threadId = std::this_thread::get_id();
         {
-            mUsedPages[mCurrentPageId] = std::move(mpActivePage);
+            std::shared_lock<std::shared_mutex> lock(mThreadAllocatorsMutex);
+            auto it = mThreadAllocators.find(threadId);
+            if (it != mThreadAllocators.end() && !*it->second->pThreadExited) return *it->second;
         }
 
-        if (mAvailablePages.size())
+        std::unique_lock<std::shared_mutex> lock(mThreadAllocatorsMutex);
+        auto& pThreadAllocator = mThreadAllocators[threadId];
+
+        // Thread IDs may be reused, retire the page of an exited thread that has not been released yet.
+        if (pThreadAllocator && *pThreadAllocator->pThreadExited)
         {
-            mpActivePage = std::move(mAvailablePages.front());
-            mAvailablePages.pop();
-            mpActivePage->allocationsCount = 0;
-            mpActivePage->currentOffset = 0;
+            std::lock_guard<std::mutex> pagesLock(mMutex);
+            retireActivePage(*pThreadAllocator);
+            pThreadAllocator = nullptr;
         }
-        else
+
+        if (!pThreadAllocator)
         {
-            mpActivePage = std::make_unique<PageData>();
-            initBasePageData((*mpActivePage), mPageSize);
+            pThreadAllocator = std::make_unique<ThreadAllocator>();
+            pThreadAllocator->pThreadExited = std::make_shared<std::atomic<bool>>(false);
+            tThreadExitFlags.flags.push_back(pThreadAllocator->pThreadExited);
         }
+        return *pThreadAllocator;
+    }
 
-        mpActivePage->currentOffset = 0;
-        mCurrentPageId++;
+    void GpuMemoryHeap::retireActivePage(ThreadAllocator& threadAllocator)
+    {
+        // From now on releases recycle the page once it is empty.
+        if (!threadAllocator.pActivePage) return;
+
+        PageData* pOldPage = threadAllocator.pActivePage;
+        threadAllocator.pActivePage = nullptr;
+        pOldPage->retired = true;
+        if (pOldPage->allocationsCount == 0)
+        {
+            mAvailablePages.push(std::move(mUsedPages[threadAllocator.activePageID]));
+            mUsedPages.erase(threadAllocator.activePageID);
+        }
+    }
+
+    void GpuMemoryHeap::releaseExitedThreadAllocators()
+    {
+        auto hasExited = [](const auto& it) { return (bool)*it.second->pThreadExited; };
+        {
+            std::shared_lock<std::shared_mutex> lock(mThreadAllocatorsMutex);
+            if (std::none_of(mThreadAllocators.begin(), mThreadAllocators.end(), hasExited)) return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mThreadAllocatorsMutex);
+        std::lock_guard<std::mutex> pagesLock(mMutex);
+        for (auto it = mThreadAllocators.begin(); it != mThreadAllocators.end();)
+        {
+            if (hasExited(*it))
+            {
+                retireActivePage(*it->second);
+                it = mThreadAllocators.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void GpuMemoryHeap::allocateNewPage(ThreadAllocator& threadAllocator)
+    {
+        PageData::UniquePtr pPage;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            retireActivePage(threadAllocator);
+
+            if (mAvailablePages.size())
+            {
+                pPage = std::move(mAvailablePages.front());
+                mAvailablePages.pop();
+            }
+        }
+
+        if (!pPage)
+        {
+            pPage = std::make_unique<PageData>();
+            mBackend.createPage(*pPage, mPageSize);
+        }
+
+        pPage->allocationsCount = 0;
+        pPage->currentOffset = 0;
+        pPage->retired = false;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        threadAllocator.pActivePage = pPage.get();
+        threadAllocator.activePageID = mNextPageId++;
+        mUsedPages[threadAllocator.activePageID] = std::move(pPage);
     }
 
     GpuMemoryHeap::Allocation GpuMemoryHeap::allocate(size_t size, size_t alignment)
@@ -80,65 +195,138 @@ namespace Falcor
         if (size > mPageSize)
         {
             data.pageID = GpuMemoryHeap::Allocation::kMegaPageId;
-            initBasePageData(data, size);
+            data.pageSize = getLargePageSizeClass(size);
+
+            // Reuse a pooled page of the same size class if possible.
+            bool reused = false;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mLargePageCount++;
+                auto it = mLargePagePool.find(data.pageSize);
+                if (it != mLargePagePool.end())
+                {
+                    static_cast<BaseData&>(data) = it->second.back();
+                    it->second.pop_back();
+                    if (it->second.empty()) mLargePagePool.erase(it);
+                    mPooledLargePageBytes -= data.pageSize;
+                    mLargePagesReused++;
+                    reused = true;
+                }
+                else
+                {
+                    mLargePagesCreated++;
+                }
+            }
+
+            if (!reused) mBackend.createPage(data, data.pageSize);
         }
         else
         {
+            ThreadAllocator& threadAllocator = getThreadAllocator();
+
             // Calculate the start
-            size_t currentOffset = align_to(alignment, mpActivePage->currentOffset);
-            if (currentOffset + size > mPageSize)
+            size_t currentOffset = threadAllocator.pActivePage ? align_to(alignment, threadAllocator.pActivePage->currentOffset) : 0;
+            if (!threadAllocator.pActivePage || currentOffset + size > mPageSize)
             {
                 currentOffset = 0;
-                allocateNewPage();
+                allocateNewPage(threadAllocator);
             }
 
-            data.pageID = mCurrentPageId;
+            PageData* pPage = threadAllocator.pActivePage;
+            data.pageID = threadAllocator.activePageID;
             data.offset = currentOffset;
-            data.pData = mpActivePage->pData + currentOffset;
-            data.pResourceHandle = mpActivePage->pResourceHandle;
-            mpActivePage->currentOffset = currentOffset + size;
-            mpActivePage->allocationsCount++;
+            data.pData = pPage->pData + currentOffset;
+            data.pResourceHandle = pPage->pResourceHandle;
+            pPage->currentOffset = currentOffset + size;
+            pPage->allocationsCount++;
         }
 
-        data.fenceValue = mpFence->getCpuValue();
+        data.fenceValue = mBackend.getCpuFenceValue();
         return data;
     }
 
     void GpuMemoryHeap::release(Allocation& data)
     {
-        FALCOR_ASSERT(data.pResourceHandle);
+        FALCOR_ASSERT(data.pageID != 0);
+        std::lock_guard<std::mutex> lock(mMutex);
         mDeferredReleases.push(data);
     }
 
     void GpuMemoryHeap::executeDeferredReleases()
     {
-        uint64_t gpuVal = mpFence->getGpuValue();
+        releaseExitedThreadAllocators();
+
+        uint64_t gpuVal = mBackend.getGpuFenceValue();
+
+        std::lock_guard<std::mutex> lock(mMutex);
         while (mDeferredReleases.size() && mDeferredReleases.top().fenceValue <= gpuVal)
         {
             const Allocation& data = mDeferredReleases.top();
-            if (data.pageID == mCurrentPageId)
+            if (data.pageID != Allocation::kMegaPageId)
             {
-                mpActivePage->allocationsCount--;
-                if (mpActivePage->allocationsCount == 0)
+                auto it = mUsedPages.find(data.pageID);
+                FALCOR_ASSERT(it != mUsedPages.end());
+                PageData* pPage = it->second.get();
+
+                // Active pages are recycled when their thread retires them.
+                if (--pPage->allocationsCount == 0 && pPage->retired)
                 {
-                    mpActivePage->currentOffset = 0;
+                    mAvailablePages.push(std::move(it->second));
+                    mUsedPages.erase(it);
                 }
             }
             else
             {
-                if (data.pageID != Allocation::kMegaPageId)
+                // Keep the large page for reuse if it fits in the budget, otherwise popping it releases the resource.
+                mLargePageCount--;
+                if (mPooledLargePageBytes + data.pageSize <= mLargePagePoolBudget)
                 {
-                    auto& pData = mUsedPages[data.pageID];
-                    pData->allocationsCount--;
-                    if (pData->allocationsCount == 0)
-                    {
-                        mAvailablePages.push(std::move(pData));
-                        mUsedPages.erase(data.pageID);
-                    }
+                    mLargePagePool[data.pageSize].push_back(data);
+                    mPooledLargePageBytes += data.pageSize;
                 }
-                // else it's a mega-page. Popping it will release the resource
             }
             mDeferredReleases.pop();
         }
     }
+
+    void GpuMemoryHeap::setLargePagePoolBudget(size_t budget)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLargePagePoolBudget = budget;
+
+        // Free the largest pages until the pool fits in the budget.
+        while (mPooledLargePageBytes > mLargePagePoolBudget)
+        {
+            auto it = std::prev(mLargePagePool.end());
+            it->second.pop_back();
+            mPooledLargePageBytes -= it->first;
+            if (it->second.empty()) mLargePagePool.erase(it);
+        }
+    }
+
+    void GpuMemoryHeap::trimLargePagePool()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLargePagePool.clear();
+        mPooledLargePageBytes = 0;
+    }
+
+    GpuMemoryHeap::Stats GpuMemoryHeap::getStats() const
+    {
+        Stats stats;
+        {
+            std::shared_lock<std::shared_mutex> allocatorsLock(mThreadAllocatorsMutex);
+            stats.threadAllocatorCount = mThreadAllocators.size();
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats.pageCount = mUsedPages.size() + mAvailablePages.size();
+        stats.availablePageCount = mAvailablePages.size();
+        stats.largePageCount = mLargePageCount;
+        for (const auto& [size, pages] : mLargePagePool) stats.pooledLargePageCount += pages.size();
+        stats.pooledLargePageBytes = mPooledLargePageBytes;
+        stats.largePagesCreated = mLargePagesCreated;
+        stats.largePagesReused = mLargePagesReused;
+        return stats;
+    }
 }
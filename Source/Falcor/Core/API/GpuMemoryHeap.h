@@ -29,12 +29,29 @@
 #include "Handles.h"
 #include "GpuFence.h"
 #include "Core/Macros.h"
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
+    /** Linear allocator of transient GPU memory.
+
+        Small allocations are sub-allocated from pages of a fixed size. Every thread allocates from its own active page,
+        so allocations from different threads never contend on the same page. Allocations larger than the page size get a
+        dedicated large page. Large pages are rounded up to a size class and returned to a pool when released, so repeated
+        large uploads reuse resources instead of creating new ones.
+
+        Memory is released once the GPU has passed the fence value that was current when the allocation was made.
+        All functions are thread-safe.
+    */
     class FALCOR_API GpuMemoryHeap
     {
     public:
@@ -59,11 +76,36 @@ namespace Falcor
         {
             uint64_t pageID = 0;
             uint64_t fenceValue = 0;
+            size_t pageSize = 0;    ///< Size of the page for large allocations.
 
             static const uint64_t kMegaPageId = -1;
             bool operator<(const Allocation& other)  const { return fenceValue > other.fenceValue; }
         };
 
+        /** Fence values and page creation used by the heap.
+            The default backend uses a GpuFence and GPU buffers, a custom backend allows testing the allocator without a device.
+        */
+        struct Backend
+        {
+            std::function<uint64_t()> getCpuFenceValue;                 ///< Returns the fence value that will be signaled by the next GPU work.
+            std::function<uint64_t()> getGpuFenceValue;                 ///< Returns the last fence value signaled by the GPU.
+            std::function<void(BaseData& data, size_t size)> createPage; ///< Creates and maps a page of the given size.
+        };
+
+        struct Stats
+        {
+            size_t pageCount = 0;               ///< Number of regular pages, including available pages.
+            size_t availablePageCount = 0;      ///< Number of regular pages without allocations that are ready for reuse.
+            size_t largePageCount = 0;          ///< Number of large pages in use or waiting for release.
+            size_t pooledLargePageCount = 0;    ///< Number of large pages ready for reuse.
+            size_t pooledLargePageBytes = 0;    ///< Total size of large pages ready for reuse.
+            uint64_t largePagesCreated = 0;     ///< Total number of large pages created.
+            uint64_t largePagesReused = 0;      ///< Total number of large allocations served from the pool.
+            size_t threadAllocatorCount = 0;    ///< Number of threads with their own active page.
+        };
+
+        static constexpr size_t kDefaultLargePagePoolBudget = 256 * 1024 * 1024;
+
         ~GpuMemoryHeap();
 
         /** Create a new GPU memory heap.
@@ -74,33 +116,78 @@ namespace Falcor
         */
         static SharedPtr create(Type type, size_t pageSize, const GpuFence::SharedPtr& pFence);
 
+        /** Create a new GPU memory heap with a custom backend.
+            \param[in] type The type of heap.
+            \param[in] pageSize Page size in bytes.
+            \param[in] backend Fence and page creation functions.
+            \return A new object, or throws an exception if creation failed.
+        */
+        static SharedPtr create(Type type, size_t pageSize, const Backend& backend);
+
         Allocation allocate(size_t size, size_t alignment = 1);
         void release(Allocation& data);
         size_t getPageSize() const { return mPageSize; }
         void executeDeferredReleases();
 
+        /** Set the maximum total size of released large pages kept for reuse. Pages exceeding the budget are freed.
+        */
+        void setLargePagePoolBudget(size_t budget);
+        size_t getLargePagePoolBudget() const { return mLargePagePoolBudget; }
+
+        /** Free all pooled large pages.
+        */
+        void trimLargePagePool();
+
+        Stats getStats() const;
+
+        /** Returns the size class of a large allocation. Sizes are rounded up to a quarter of their power of two, wasting at most 25%.
+        */
+        static size_t getLargePageSizeClass(size_t size);
+
     private:
-        GpuMemoryHeap(Type type, size_t pageSize, const GpuFence::SharedPtr& pFence);
+        GpuMemoryHeap(Type type, size_t pageSize, const Backend& backend);
 
         struct PageData : public BaseData
         {
-            uint32_t allocationsCount = 0;
+            std::atomic<uint32_t> allocationsCount = 0;
             size_t currentOffset = 0;
+            bool retired = false;   ///< True once the page is no longer the active page of a thread.
 
             using UniquePtr = std::unique_ptr<PageData>;
         };
 
+        /** Active page of a single thread. Only accessed by the owning thread, or once the owning thread has exited.
+        */
+        struct ThreadAllocator
+        {
+            PageData* pActivePage = nullptr;
+            uint64_t activePageID = 0;
+            std::shared_ptr<std::atomic<bool>> pThreadExited;   ///< Set when the owning thread exits.
+        };
+
         Type mType;
-        GpuFence::SharedPtr mpFence;
+        Backend mBackend;
         size_t mPageSize = 0;
-        size_t mCurrentPageId = 0;
-        PageData::UniquePtr mpActivePage;
+        size_t mLargePagePoolBudget = kDefaultLargePagePoolBudget;
 
+        mutable std::mutex mMutex;  ///< Protects all state except the thread allocators.
+        uint64_t mNextPageId = 1;
         std::priority_queue<Allocation> mDeferredReleases;
-        std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
+        std::unordered_map<uint64_t, PageData::UniquePtr> mUsedPages;   ///< Active and retired pages that still have allocations.
         std::queue<PageData::UniquePtr> mAvailablePages;
+        std::map<size_t, std::vector<BaseData>> mLargePagePool;         ///< Released large pages by size class.
+        size_t mPooledLargePageBytes = 0;
+        size_t mLargePageCount = 0;
+        uint64_t mLargePagesCreated = 0;
+        uint64_t mLargePagesReused = 0;
+
+        mutable std::shared_mutex mThreadAllocatorsMutex;
+        std::unordered_map<std::thread::id, std::unique_ptr<ThreadAllocator>> mThreadAllocators;
 
-        void allocateNewPage();
+        ThreadAllocator& getThreadAllocator();
+        void allocateNewPage(ThreadAllocator& threadAllocator);
+        void retireActivePage(ThreadAllocator& threadAllocator);
+        void releaseExitedThreadAllocators();
         void initBasePageData(BaseData& data, size_t size);
     };
 }
@@ -33,10 +33,12 @@
 #include "Utils/Logger.h"
 #include "Utils/Threading.h"
 #include "Utils/Image/ImageIO.h"
+#include "Utils/Image/PixelConversion.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "RenderGraph/BasePasses/FullScreenPass.h"
 
 #include <mutex>
+#include <vector>
 
 namespace Falcor
 {
@@ -162,12 +164,31 @@ namespace Falcor
             if (pBitmap)
             {
                 ResourceFormat texFormat = pBitmap->getFormat();
+                const void* pData = pBitmap->getData();
+                const uint32_t width = pBitmap->getWidth();
+                const uint32_t height = pBitmap->getHeight();
+
+                // There is no 3-channel half float texture format, expand to RGBA before uploading.
+                std::vector<uint16_t> expandedData;
+                if (texFormat == ResourceFormat::RGB16Float)
+                {
+                    const uint16_t kHalfOne = 0x3c00;
+                    expandedData.resize(size_t(width) * height * 4);
+                    PixelConversion::forEachRow(height, width * 4 * sizeof(uint16_t), [&](uint32_t y)
+                    {
+                        const uint16_t* pSrcRow = reinterpret_cast<const uint16_t*>(pBitmap->getData() + size_t(y) * pBitmap->getRowPitch());
+                        PixelConversion::expandToRGBA(pSrcRow, 3, expandedData.data() + size_t(y) * width * 4, width, kHalfOne);
+                    });
+                    texFormat = ResourceFormat::RGBA16Float;
+                    pData = expandedData.data();
+                }
+
                 if (loadAsSrgb)
                 {
                     texFormat = linearToSrgbFormat(texFormat);
                 }
 
-                pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+                pTex = Texture::create2D(width, height, texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pData, bindFlags);
             }
         }
 
@@ -250,6 +250,14 @@ namespace Falcor
         */
         const std::filesystem::path& getSourcePath() const { return mSourcePath; }
 
+        /** In case the texture content was derived from the source file (e.g. block compressed by a texture cache), use this to set a key identifying the processing.
+        */
+        void setSourceKey(const std::string& key) { mSourceKey = key; }
+
+        /** Get the key identifying how the texture content was derived from the source file, or an empty string if the file was loaded as is.
+        */
+        const std::string& getSourceKey() const { return mSourceKey; }
+
         /** Returns the total number of texels across all mip levels and array slices.
         */
         uint64_t getTexelCount() const;
@@ -270,6 +278,7 @@ namespace Falcor
 
         bool mReleaseRtvsAfterGenMips = true;
         std::filesystem::path mSourcePath;
+        std::string mSourceKey;
 
         uint32_t mWidth = 0;
         uint32_t mHeight = 0;
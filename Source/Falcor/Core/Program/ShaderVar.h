@@ -366,6 +366,7 @@ namespace Falcor
 
     private:
         friend class VariablesBufferUI;
+        friend class ShaderVarPath;
         /** The parameter block that is being pointed into.
 
             Note: this is an unowned pointer, so it is *not* safe to hold onto a `ShaderVar` for long periods
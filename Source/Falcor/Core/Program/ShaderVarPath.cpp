@@ -0,0 +1,175 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ShaderVarPath.h"
+#include "Core/Errors.h"
+#include "Core/ErrorHandling.h"
+#include "Core/API/ParameterBlock.h"
+#include <cctype>
+
+namespace Falcor
+{
+    namespace
+    {
+        bool isConstantBuffer(const ShaderVar& var)
+        {
+            auto pResourceType = var.getType()->asResourceType();
+            return pResourceType && pResourceType->getType() == ReflectionResourceType::Type::ConstantBuffer;
+        }
+    }
+
+    ShaderVarPath::ShaderVarPath(const std::string& path)
+        : mPath(path)
+    {
+        size_t pos = 0;
+        while (pos < path.size())
+        {
+            // Parse member name, which may only be omitted for a leading array index.
+            size_t end = path.find_first_of(".[", pos);
+            if (end == std::string::npos) end = path.size();
+            if (end > pos) mElements.push_back({ path.substr(pos, end - pos), 0 });
+            else if (pos != 0) throw ArgumentError("Invalid shader variable path '{}'. Expected member name at position {}.", path, pos);
+            pos = end;
+
+            // Parse array indices.
+            while (pos < path.size() && path[pos] == '[')
+            {
+                size_t close = path.find(']', pos);
+                if (close == std::string::npos || close == pos + 1) throw ArgumentError("Invalid shader variable path '{}'. Expected array index at position {}.", path, pos);
+                size_t index = 0;
+                for (size_t i = pos + 1; i < close; i++)
+                {
+                    if (!std::isdigit((unsigned char)path[i])) throw ArgumentError("Invalid shader variable path '{}'. Array index at position {} is not a number.", path, pos);
+                    index = index * 10 + (path[i] - '0');
+                }
+                mElements.push_back({ "", index });
+                pos = close + 1;
+            }
+
+            if (pos < path.size())
+            {
+                if (path[pos] != '.' || pos + 1 == path.size()) throw ArgumentError("Invalid shader variable path '{}'. Unexpected character at position {}.", path, pos);
+                pos++;
+            }
+        }
+    }
+
+    ShaderVar ShaderVarPath::get(const ShaderVar& var) const
+    {
+        auto result = find(var);
+        if (!result.isValid() && var.isValid())
+        {
+            reportError("No shader variable found at path '" + mPath + "'.\n");
+        }
+        return result;
+    }
+
+    ShaderVar ShaderVarPath::find(const ShaderVar& var) const
+    {
+        if (!var.isValid()) return var;
+
+        ShaderVar result;
+        if (mResolved && apply(var, result)) return result;
+
+        // The path has not been resolved yet, or the reflection data changed (e.g., the program was relinked).
+        resolve(var, result);
+        return result;
+    }
+
+    bool ShaderVarPath::resolve(const ShaderVar& var, ShaderVar& result) const
+    {
+        mSegments.clear();
+        mResolved = false;
+
+        ShaderVar current = var;
+        Segment segment;
+        segment.start = current.mOffset;
+        bool segmentEmpty = true;
+
+        for (const auto& element : mElements)
+        {
+            // Implicitly dereference constant buffers and parameter blocks, the same as ShaderVar::findMember() does.
+            // This starts a new segment, as the offsets are relative to the referenced parameter block.
+            if (isConstantBuffer(current))
+            {
+                if (!segmentEmpty)
+                {
+                    segment.offset = current.mOffset;
+                    mSegments.push_back(segment);
+                }
+                auto pBlock = current.getParameterBlock();
+                if (!pBlock) return false;
+                current = pBlock->getRootVar();
+                segment = Segment{ true, current.mOffset, {} };
+            }
+
+            if (!element.name.empty())
+            {
+                current = current.findMember(element.name);
+            }
+            else
+            {
+                auto pArrayType = current.getType()->asArrayType();
+                if (!pArrayType || (pArrayType->getElementCount() && element.index >= pArrayType->getElementCount())) return false;
+                current = current[element.index];
+            }
+            if (!current.isValid()) return false;
+            segmentEmpty = false;
+        }
+
+        if (!segmentEmpty)
+        {
+            segment.offset = current.mOffset;
+            mSegments.push_back(segment);
+        }
+
+        mResolved = true;
+        result = current;
+        return true;
+    }
+
+    bool ShaderVarPath::apply(const ShaderVar& var, ShaderVar& result) const
+    {
+        ShaderVar current = var;
+        for (const auto& segment : mSegments)
+        {
+            if (segment.dereference)
+            {
+                auto pBlock = current.getParameterBlock();
+                if (!pBlock) return false;
+                current = pBlock->getRootVar();
+            }
+
+            // The cached offset is only valid if the segment starts at the same type and offset as when it was resolved.
+            if (current.mOffset.getType() != segment.start.getType() || current.mOffset != segment.start) return false;
+            current = ShaderVar(current.mpBlock, segment.offset);
+        }
+
+        result = current;
+        return true;
+    }
+}
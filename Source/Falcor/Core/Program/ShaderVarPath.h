@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ShaderVar.h"
+#include "ProgramReflection.h"
+#include "Core/Macros.h"
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** A precompiled path to a shader variable.
+
+        Looking up a shader variable by name, e.g., `var["CB"]["gTaskCount"]`, does a string lookup in the reflection
+        data for every member access. A `ShaderVarPath` resolves the member path once into typed offsets, one per
+        constant buffer or parameter block crossed along the path, and applies the offsets directly afterwards.
+
+        The resolved offsets are tied to the reflection types they were resolved against. When the program is relinked
+        and a shader variable with different reflection data is passed in, the path is transparently resolved again.
+
+        Paths consist of member names separated by '.' with optional array indices:
+
+            ShaderVarPath mTaskCountPath = ShaderVarPath("CB.gTaskCount");
+            ShaderVarPath mLightPath = ShaderVarPath("gScene.lights[2].intensity");
+            ...
+            mTaskCountPath.get(var) = taskCount;
+
+        Arrays with dynamic indices are best handled by resolving the path to the array and indexing the result,
+        as `operator[](size_t)` on a shader variable does not involve any string lookups.
+
+        Note: A `ShaderVarPath` caches resolved state and must not be used from multiple threads concurrently.
+    */
+    class FALCOR_API ShaderVarPath
+    {
+    public:
+        /** Create an empty path, which refers to the shader variable it is applied to.
+        */
+        ShaderVarPath() = default;
+
+        /** Create a path from a string.
+            Throws an ArgumentError if the path is malformed.
+            \param[in] path Member names separated by '.', with optional array indices, e.g., "CB.items[2].value".
+        */
+        ShaderVarPath(const std::string& path);
+        ShaderVarPath(const char* path) : ShaderVarPath(std::string(path)) {}
+
+        /** Get the shader variable at the end of the path.
+            Logs an error and returns an invalid shader variable if the path does not exist.
+            \param[in] var The shader variable the path starts at.
+        */
+        ShaderVar get(const ShaderVar& var) const;
+
+        /** Try to get the shader variable at the end of the path.
+            Unlike `get`, no error is logged if the path does not exist.
+            \param[in] var The shader variable the path starts at.
+        */
+        ShaderVar find(const ShaderVar& var) const;
+
+        /** Get the path string.
+        */
+        const std::string& getPath() const { return mPath; }
+
+    private:
+        struct Element
+        {
+            std::string name;               ///< Member name, empty for array elements.
+            size_t index = 0;               ///< Array element index.
+        };
+
+        /** Part of the resolved path within a single parameter block.
+        */
+        struct Segment
+        {
+            bool dereference = false;       ///< True if the segment starts by dereferencing a constant buffer or parameter block.
+            TypedShaderVarOffset start;     ///< Offset the segment starts at, used to validate the cached offset.
+            TypedShaderVarOffset offset;    ///< Resolved offset at the end of the segment.
+        };
+
+        bool resolve(const ShaderVar& var, ShaderVar& result) const;
+        bool apply(const ShaderVar& var, ShaderVar& result) const;
+
+        std::string mPath;
+        std::vector<Element> mElements;
+        mutable std::vector<Segment> mSegments;
+        mutable bool mResolved = false;
+    };
+}
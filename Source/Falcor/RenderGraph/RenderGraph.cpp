@@ -76,6 +76,8 @@ namespace Falcor
         {
             it.second.pPass->setScene(gpDevice->getRenderContext(), pScene);
         }
+        // Passes commonly change their I/O based on the scene.
+        mCompilationState.invalidatePasses();
         mRecompile = true;
     }
 
@@ -94,7 +96,7 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, pPass = pPass.get()]() { mRecompile = true; mCompilationState.dirtyPasses.insert(pPass); };
         pPass->mName = passName;
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -161,7 +163,7 @@ namespace Falcor
         std::string passTypeName = pOldPass->getType();
         auto pPass = RenderPassLibrary::instance().createPass(pRenderContext, passTypeName.c_str(), dict);
         pPassIt->second.pPass = pPass;
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, pPass = pPass.get()]() { mRecompile = true; mCompilationState.dirtyPasses.insert(pPass); };
         pPass->mName = pOldPass->getName();
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -406,7 +408,7 @@ namespace Falcor
 
         try
         {
-            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
+            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps, &mCompilationState);
             mRecompile = false;
             return true;
         }
@@ -286,6 +286,7 @@ namespace Falcor
         InternalDictionary::SharedPtr mpPassDictionary;             ///< Dictionary used to communicate between passes.
         RenderGraphExe::SharedPtr mpExe;                            ///< Helper for allocating resources and executing the graph.
         RenderGraphCompiler::Dependencies mCompilerDeps;            ///< Data needed by the graph compiler.
+        RenderGraphCompiler::CompilationState mCompilationState;    ///< State of the last compilation, used to recompile incrementally.
         bool mRecompile = false;                                    ///< Set to true to trigger a recompilation after any graph changes (topology/scene/size/passes/etc.)
 
         std::filesystem::path mScriptPath;
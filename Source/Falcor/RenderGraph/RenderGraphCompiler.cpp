@@ -29,7 +29,9 @@
 #include "RenderGraph.h"
 #include "RenderPasses/ResolvePass.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
+#include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -39,13 +41,32 @@ namespace Falcor
         {
             return src.getSampleCount() > 1 && dst.getSampleCount() == 1;
         }
+
+        bool isSameDefaultProperties(const ResourceCache::DefaultProperties& lhs, const ResourceCache::DefaultProperties& rhs)
+        {
+            return lhs.dims == rhs.dims && lhs.format == rhs.format;
+        }
+
+        bool isSameCompileData(const RenderPass::CompileData& lhs, const RenderPass::CompileData& rhs)
+        {
+            return lhs.defaultTexDims == rhs.defaultTexDims && lhs.defaultTexFormat == rhs.defaultTexFormat && lhs.connectedResources == rhs.connectedResources;
+        }
     }
 
-    RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies) : mGraph(graph), mDependencies(dependencies) {}
+    RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies, CompilationState* pState) : mGraph(graph), mDependencies(dependencies), mpState(pState) {}
 
-    RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies)
+    RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, CompilationState* pState)
     {
-        RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
+        RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies, pState);
+
+        if (pState)
+        {
+            // Pass reflections may depend on the default resource properties, and passes that requested a recompile need to be reflected again.
+            if (!isSameDefaultProperties(pState->defaultResourceProps, dependencies.defaultResourceProps)) pState->invalidatePasses();
+            pState->defaultResourceProps = dependencies.defaultResourceProps;
+            for (const RenderPass* pPass : pState->dirtyPasses) pState->passes.erase(pPass);
+            pState->dirtyPasses.clear();
+        }
 
         // Register the external resources
         auto pResourcesCache = ResourceCache::create();
@@ -57,6 +78,18 @@ namespace Falcor
         c.validateGraph();
         c.allocateResources(pResourcesCache.get());
 
+        if (pState)
+        {
+            // Drop the state of passes that are no longer executed.
+            for (auto it = pState->passes.begin(); it != pState->passes.end();)
+            {
+                bool executed = std::any_of(c.mExecutionList.begin(), c.mExecutionList.end(), [&](const PassData& p) { return p.pPass.get() == it->first; });
+                it = executed ? std::next(it) : pState->passes.erase(it);
+            }
+            pState->pResourceCache = pResourcesCache;
+            logDebug("RenderGraphCompiler: reflected {} and compiled {} of {} passes.", c.mReflectedPassCount, c.mCompiledPassCount, c.mExecutionList.size());
+        }
+
         auto pExe = RenderGraphExe::create();
         pExe->mExecutionList.reserve(c.mExecutionList.size());
 
@@ -148,11 +181,31 @@ namespace Falcor
             if (participatingPasses.find(node) != participatingPasses.end())
             {
                 const auto pData = mGraph.mNodeData[node];
-                mExecutionList.push_back({ node, pData.pPass, pData.name, pData.pPass->reflect(compileData) });
+                mExecutionList.push_back({ node, pData.pPass, pData.name, reflectPass(pData.pPass, compileData) });
             }
         }
     }
 
+    RenderPassReflection RenderGraphCompiler::reflectPass(const RenderPass::SharedPtr& pPass, const RenderPass::CompileData& compileData)
+    {
+        // Without connected resources the reflection only depends on the pass and the default properties, which are tracked by the state.
+        FALCOR_ASSERT(compileData.connectedResources.getFieldCount() == 0);
+        if (mpState)
+        {
+            auto& passState = mpState->passes[pPass.get()];
+            if (passState.pPass == nullptr)
+            {
+                passState.pPass = pPass;
+                passState.reflector = pPass->reflect(compileData);
+                mReflectedPassCount++;
+            }
+            return passState.reflector;
+        }
+
+        mReflectedPassCount++;
+        return pPass->reflect(compileData);
+    }
+
     bool RenderGraphCompiler::insertAutoPasses()
     {
         bool addedPasses = false;
@@ -314,7 +367,7 @@ namespace Falcor
             }
         }
 
-        pResourceCache->allocateResources(mDependencies.defaultResourceProps);
+        pResourceCache->allocateResources(mDependencies.defaultResourceProps, mpState ? mpState->pResourceCache.get() : nullptr);
     }
 
 
@@ -409,12 +462,26 @@ namespace Falcor
             bool success = true;
             for (auto& p : mExecutionList)
             {
+                RenderPass::CompileData compileData = prepPassCompilationData(p);
+
+                // Skip passes that were already compiled with the same reflection and data.
+                CompilationState::PassState* pPassState = mpState ? &mpState->passes[p.pPass.get()] : nullptr;
+                if (pPassState && pPassState->compiled && pPassState->compiledReflector == p.reflector && isSameCompileData(pPassState->compileData, compileData)) continue;
+
                 try
                 {
-                    p.pPass->compile(pRenderContext, prepPassCompilationData(p));
+                    p.pPass->compile(pRenderContext, compileData);
+                    mCompiledPassCount++;
+                    if (pPassState)
+                    {
+                        pPassState->compiled = true;
+                        pPassState->compiledReflector = p.reflector;
+                        pPassState->compileData = std::move(compileData);
+                    }
                 }
                 catch (const std::exception& e)
                 {
+                    if (pPassState) pPassState->compiled = false;
                     log += std::string(e.what()) + "\n";
                     success = false;
                 }
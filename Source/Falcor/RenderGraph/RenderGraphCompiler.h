@@ -32,6 +32,8 @@
 #include "RenderGraphExe.h"
 #include "Core/Macros.h"
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -47,12 +49,49 @@ namespace Falcor
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
         };
-        static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
+
+        /** State kept between compilations of the same graph, used to only redo the work affected by graph changes.
+            Passes are reflected once and only compiled again if their reflection or compile data changed, or if they
+            requested a recompile. Resources whose description didn't change are taken over from the previous compilation.
+        */
+        struct CompilationState
+        {
+            struct PassState
+            {
+                RenderPass::SharedPtr pPass;            ///< Keeps the pass alive, so that its address isn't reused by another pass.
+                RenderPassReflection reflector;         ///< Reflection used to resolve the execution order.
+                RenderPassReflection compiledReflector; ///< Reflection the pass was last compiled with.
+                RenderPass::CompileData compileData;    ///< Data the pass was last compiled with.
+                bool compiled = false;
+            };
+
+            std::unordered_map<const RenderPass*, PassState> passes;
+            std::unordered_set<const RenderPass*> dirtyPasses;      ///< Passes that requested a recompile since the last compilation.
+            ResourceCache::DefaultProperties defaultResourceProps;  ///< Default properties the pass reflections were created with.
+            ResourceCache::SharedPtr pResourceCache;                ///< Resources of the last successful compilation.
+
+            /** Drop the state of all passes, they will be reflected and compiled again by the next compilation.
+                Resources are still taken over from the previous compilation.
+            */
+            void invalidatePasses() { passes.clear(); }
+        };
+
+        /** Compile a render graph.
+            \param[in] graph The graph.
+            \param[in] pRenderContext Render context used to compile the passes.
+            \param[in] dependencies Default resource properties and external resources.
+            \param[in,out] pState Optional. State of the previous compilation of the graph, updated on success. If null, everything is compiled from scratch.
+            \return The graph executor.
+        */
+        static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, CompilationState* pState = nullptr);
 
     private:
-        RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies);
+        RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies, CompilationState* pState);
         RenderGraph& mGraph;
         const Dependencies& mDependencies;
+        CompilationState* mpState;
+        uint32_t mReflectedPassCount = 0;
+        uint32_t mCompiledPassCount = 0;
 
         struct PassData
         {
@@ -70,6 +109,7 @@ namespace Falcor
             std::vector<std::pair<std::string, std::string>> removedEdges;
         } mCompilationChanges;
 
+        RenderPassReflection reflectPass(const RenderPass::SharedPtr& pPass, const RenderPass::CompileData& compileData);
         void resolveExecutionOrder();
         void compilePasses(RenderContext* pRenderContext);
         bool insertAutoPasses();
@@ -180,13 +180,32 @@ namespace Falcor
         return pResource;
     }
 
-    void ResourceCache::allocateResources(const DefaultProperties& params)
+    Resource::SharedPtr ResourceCache::findReusableResource(const ResourceData& data) const
     {
+        auto it = mNameToIndex.find(data.name);
+        if (it == mNameToIndex.end()) return nullptr;
+
+        // The name may be an alias of another resource, in which case the resource is not reused.
+        const auto& prevData = mResourceData[it->second];
+        if (prevData.name != data.name || prevData.field != data.field || prevData.resolveBindFlags != data.resolveBindFlags) return nullptr;
+        return prevData.pResource;
+    }
+
+    void ResourceCache::allocateResources(const DefaultProperties& params, const ResourceCache* pPreviousCache)
+    {
+        // Resources can only be taken over if they were created with the same default properties.
+        if (pPreviousCache && (pPreviousCache->mDefaultProperties.dims != params.dims || pPreviousCache->mDefaultProperties.format != params.format))
+        {
+            pPreviousCache = nullptr;
+        }
+        mDefaultProperties = params;
+
         for (auto& data : mResourceData)
         {
             if ((data.pResource == nullptr) && (data.field.isValid()))
             {
-                data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
+                if (pPreviousCache) data.pResource = pPreviousCache->findReusableResource(data);
+                if (data.pResource == nullptr) data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
             }
         }
     }
@@ -80,8 +80,11 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            \param[in] params Default properties for fields that don't fully specify their resource.
+            \param[in] pPreviousCache Optional. Cache of a previous compilation of the graph. Resources with the same name and
+                properties are taken over from it instead of being reallocated, which preserves their contents.
         */
-        void allocateResources(const DefaultProperties& params);
+        void allocateResources(const DefaultProperties& params, const ResourceCache* pPreviousCache = nullptr);
 
         /** Clears all registered field/resource properties and allocated resources.
         */
@@ -99,12 +102,17 @@ namespace Falcor
             std::string name;                       // Full name of the resource, including the pass name
         };
 
+        Resource::SharedPtr findReusableResource(const ResourceData& data) const;
+
         // Resources and properties for fields within (and therefore owned by) a render graph
         std::unordered_map<std::string, uint32_t> mNameToIndex;
         std::vector<ResourceData> mResourceData;
 
         // References to output resources not to be allocated by the render graph
         ResourcesMap mExternalResources;
+
+        // Default properties used by the last allocation
+        DefaultProperties mDefaultProperties;
     };
 
 }
@@ -26,8 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "EmissivePowerSampler.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Timing/Profiler.h"
 #include <algorithm>
+#include <execution>
 
 namespace Falcor
 {
@@ -59,10 +61,21 @@ namespace Falcor
             std::vector<float> weights(numTris);
             for (size_t i = 0; i < numTris; i++) weights[i] = triangles[i].flux;
 
-            mTriangleTable = generateAliasTable(std::move(weights));
+            // Light collection updates are often transform changes that leave the flux unchanged.
+            // The builder only rebuilds the table if any weight actually changed.
+            if (mTriangleTable.fullTable == nullptr)
+            {
+                mTriangleTableBuilder.build(std::move(weights));
+                samplerChanged = true;
+            }
+            else
+            {
+                samplerChanged = mTriangleTableBuilder.updateWeights(weights);
+            }
+
+            if (samplerChanged) uploadAliasTable();
 
             mNeedsRebuild = false;
-            samplerChanged = true;
         }
 
         return samplerChanged;
@@ -83,95 +96,27 @@ namespace Falcor
         mpLightCollection = pScene->getLightCollection(pRenderContext);
     }
 
-    EmissivePowerSampler::AliasTable EmissivePowerSampler::generateAliasTable(std::vector<float> weights)
+    void EmissivePowerSampler::uploadAliasTable()
     {
-        uint32_t N = uint32_t(weights.size());
-        std::uniform_int_distribution<uint32_t> rngDist;
-
-        double sum = 0.0f;
-        for (float f : weights)
-        {
-            sum += f;
-        }
-        for (float& f : weights)
-        {
-            f *= N / float(sum);
-        }
+        const uint32_t N = mTriangleTableBuilder.getCount();
+        const auto& entries = mTriangleTableBuilder.getEntries();
 
-        std::vector<uint32_t> permutation(N);
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            permutation[i] = i;
-        }
-        std::sort(permutation.begin(), permutation.end(), [&](uint32_t a, uint32_t b) { return weights[a] < weights[b]; });
-
-        std::vector<float> thresholds(N);
-        std::vector<uint32_t> redirect(N);
-        std::vector<uint2> merged(N);
         std::vector<uint2> fullTable(N);
-
-        uint32_t head = 0;
-        uint32_t tail = N - 1;
-
-        while (head != tail)
+        auto range = NumericRange<uint32_t>(0, N);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
         {
-            int i = permutation[head];
-            int j = permutation[tail];
-
-            thresholds[i] = weights[i];
-            redirect[i] = j;
-            weights[j] -= 1.0f - weights[i];
-
-            if (head == tail - 1)
-            {
-                thresholds[j] = 1.0f;
-                redirect[j] = j;
-                break;
-            }
-            else if (weights[j] < 1.0f)
-            {
-                std::swap(permutation[head], permutation[tail]);
-                tail--;
-            }
-            else
-            {
-                head++;
-            }
-        }
-
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            permutation[i] = i;
-        }
-
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            uint32_t dst = i + (rngDist(mAliasTableRng) % (N - i));
-            std::swap(thresholds[i], thresholds[dst]);
-            std::swap(redirect[i], redirect[dst]);
-            std::swap(permutation[i], permutation[dst]);
-        }
-
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            merged[i] = uint2(redirect[i], permutation[i]);
-
             // Pack 16-bit threshold (i.e., a half float) plus 2x 24-bit table entries
-            uint32_t prob = (uint32_t(f32tof16(thresholds[i])) << 16u);
-            uint2 lowPrec = uint2(redirect[i] & 0xFFFFFFu, permutation[i] & 0xFFFFFFu);
-            uint2 mergedEntry = uint2(prob | ((lowPrec.x >> 8u) & 0xFFFFu), ((lowPrec.x & 0xFFu) << 24u) | lowPrec.y);
-            fullTable[i] = mergedEntry;
-        }
+            uint32_t prob = (uint32_t(f32tof16(entries[i].threshold)) << 16u);
+            uint2 lowPrec = uint2(entries[i].alias & 0xFFFFFFu, i & 0xFFFFFFu);
+            fullTable[i] = uint2(prob | ((lowPrec.x >> 8u) & 0xFFFFu), ((lowPrec.x & 0xFFu) << 24u) | lowPrec.y);
+        });
 
-        AliasTable result
+        if (!mTriangleTable.fullTable || mTriangleTable.N != N)
         {
-            float(sum),
-            N,
-            Buffer::createTyped<uint2>(N),
-        };
-
-        result.fullTable->setBlob(&fullTable[0], 0, N * sizeof(uint2));
-
-        return result;
+            mTriangleTable.fullTable = Buffer::createTyped<uint2>(N);
+        }
+        mTriangleTable.weightSum = float(mTriangleTableBuilder.getWeightSum());
+        mTriangleTable.N = N;
+        mTriangleTable.fullTable->setBlob(fullTable.data(), 0, N * sizeof(uint2));
     }
 }
@@ -29,8 +29,8 @@
 #include "EmissiveLightSampler.h"
 #include "Core/Macros.h"
 #include "Scene/Lights/LightCollection.h"
+#include "Utils/Sampling/AliasTableBuilder.h"
 #include <memory>
-#include <random>
 #include <vector>
 
 namespace Falcor
@@ -76,18 +76,17 @@ namespace Falcor
     protected:
         EmissivePowerSampler(RenderContext* pRenderContext, Scene::SharedPtr pScene);
 
-        /** Generate an alias table
-            \param[in] weights  The weights we'd like to sample each entry proportional to
-            \returns The alias table
+        /** Pack the entries of the alias table builder and upload them to the GPU.
+            The existing buffer is reused if the number of entries is unchanged.
         */
-        AliasTable generateAliasTable(std::vector<float> weights);
+        void uploadAliasTable();
 
         // Internal state
         bool                            mNeedsRebuild = true;   ///< Trigger rebuild on the next call to update(). We should always build on the first call, so the initial value is true.
 
         LightCollection::SharedConstPtr mpLightCollection;
 
-        std::mt19937                    mAliasTableRng;
+        AliasTableBuilder               mTriangleTableBuilder;  ///< CPU alias table over the emissive triangle flux.
         AliasTable                      mTriangleTable;
     };
 }
@@ -0,0 +1,335 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "EnvMapImportanceMap.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kDirectory = "NVIDIA/Falcor/EnvMapImportanceCache";
+        const uint32_t kCacheMagic = 0x434d4945; ///< "EIMC".
+        const uint32_t kCacheVersion = 1; ///< Increment when the importance map construction changes to invalidate existing cache entries.
+
+        float sign(float x) { return x > 0.f ? 1.f : (x < 0.f ? -1.f : 0.f); }
+
+        /** Converts point in the octahedral map to normalized direction (equal area, unsigned normalized).
+            This matches oct_to_ndir_equal_area_unorm() in MathHelpers.slang.
+        */
+        float3 octToNdirEqualAreaUnorm(float2 p)
+        {
+            p = p * 2.f - 1.f;
+
+            float d = 1.f - (std::abs(p.x) + std::abs(p.y));
+            float r = 1.f - std::abs(d);
+
+            float phi = (r > 0.f) ? ((std::abs(p.y) - std::abs(p.x)) / r + 1.f) * (float)(M_PI / 4.0) : 0.f;
+
+            float f = r * std::sqrt(2.f - r * r);
+            float x = f * sign(p.x) * std::cos(phi);
+            float y = f * sign(p.y) * std::sin(phi);
+            float z = sign(d) * (1.f - r * r);
+
+            return float3(x, y, z);
+        }
+
+        /** Converts a direction to a coordinate in the latitude-longitude map.
+            This matches world_to_latlong_map() in MathHelpers.slang.
+        */
+        float2 worldToLatlongMap(const float3& dir)
+        {
+            float3 p = normalize(dir);
+            float2 uv;
+            uv.x = std::atan2(p.x, -p.z) * (float)(0.5 / M_PI) + 0.5f;
+            uv.y = std::acos(std::clamp(p.y, -1.f, 1.f)) * (float)(1.0 / M_PI);
+            return uv;
+        }
+    }
+
+    float3 EnvMapImportanceMap::EnvMapData::sample(const float2& uv) const
+    {
+        FALCOR_ASSERT(width > 0 && height > 0 && texels.size() == (size_t)width * height);
+
+        // Texel centers are at half-integer coordinates.
+        const float tx = uv.x * width - 0.5f;
+        const float ty = uv.y * height - 0.5f;
+        const float fx0 = std::floor(tx);
+        const float fy0 = std::floor(ty);
+        const float wx = tx - fx0;
+        const float wy = ty - fy0;
+
+        const int64_t w = width;
+        const int64_t h = height;
+        auto wrapX = [w](int64_t x) { return (size_t)(((x % w) + w) % w); };
+        auto clampY = [h](int64_t y) { return (size_t)std::clamp(y, (int64_t)0, h - 1); };
+
+        const size_t x0 = wrapX((int64_t)fx0), x1 = wrapX((int64_t)fx0 + 1);
+        const size_t y0 = clampY((int64_t)fy0), y1 = clampY((int64_t)fy0 + 1);
+
+        float3 top = lerp(texels[y0 * width + x0], texels[y0 * width + x1], wx);
+        float3 bottom = lerp(texels[y1 * width + x0], texels[y1 * width + x1], wx);
+        return lerp(top, bottom, wy);
+    }
+
+    EnvMapImportanceMap EnvMapImportanceMap::build(const EnvMapData& envMap, uint32_t dimension, uint32_t samples)
+    {
+        checkArgument(isPowerOf2(dimension), "'dimension' must be a power of two");
+        checkArgument(isPowerOf2(samples), "'samples' must be a power of two");
+
+        // Use the same sample pattern as EnvMapSamplerSetup.cs.slang.
+        const uint32_t samplesX = std::max(1u, (uint32_t)std::sqrt(samples));
+        const uint32_t samplesY = samples / samplesX;
+        FALCOR_ASSERT(samples == samplesX * samplesY);
+
+        const float2 invDimInSamples = 1.f / float2(dimension * samplesX, dimension * samplesY);
+        const float invSamples = 1.f / (samplesX * samplesY);
+
+        std::vector<float> baseLevel((size_t)dimension * dimension);
+        NumericRange<uint32_t> rows(0, dimension);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < dimension; x++)
+            {
+                float L = 0.f;
+                for (uint32_t sy = 0; sy < samplesY; sy++)
+                {
+                    for (uint32_t sx = 0; sx < samplesX; sx++)
+                    {
+                        float2 samplePos = float2(x * samplesX + sx, y * samplesY + sy);
+                        float2 p = (samplePos + 0.5f) * invDimInSamples;
+                        float2 uv = worldToLatlongMap(octToNdirEqualAreaUnorm(p));
+                        L += luminance(envMap.sample(uv));
+                    }
+                }
+                baseLevel[(size_t)y * dimension + x] = L * invSamples;
+            }
+        });
+
+        return createFromBaseLevel(dimension, std::move(baseLevel));
+    }
+
+    EnvMapImportanceMap EnvMapImportanceMap::createFromBaseLevel(uint32_t dimension, std::vector<float> baseLevel)
+    {
+        checkArgument(isPowerOf2(dimension), "'dimension' must be a power of two");
+        checkArgument(baseLevel.size() == (size_t)dimension * dimension, "'baseLevel' must hold dimension x dimension values");
+
+        EnvMapImportanceMap importanceMap;
+        importanceMap.mDimension = dimension;
+        importanceMap.mMips.push_back(std::move(baseLevel));
+
+        // Compute the mip hierarchy. This matches the default mip generation as each texel is the average of exactly 2x2 texels.
+        for (uint32_t dim = dimension / 2; dim > 0; dim /= 2)
+        {
+            const std::vector<float>& src = importanceMap.mMips.back();
+            std::vector<float> dst((size_t)dim * dim);
+            for (uint32_t y = 0; y < dim; y++)
+            {
+                for (uint32_t x = 0; x < dim; x++)
+                {
+                    size_t i = (size_t)(2 * y) * (2 * dim) + 2 * x;
+                    dst[(size_t)y * dim + x] = 0.25f * (src[i] + src[i + 1] + src[i + 2 * dim] + src[i + 2 * dim + 1]);
+                }
+            }
+            importanceMap.mMips.push_back(std::move(dst));
+        }
+
+        return importanceMap;
+    }
+
+    std::vector<float> EnvMapImportanceMap::getPackedMips() const
+    {
+        std::vector<float> packed;
+        for (const auto& mip : mMips) packed.insert(packed.end(), mip.begin(), mip.end());
+        return packed;
+    }
+
+    float2 EnvMapImportanceMap::sample(float2 rnd, float& pdf) const
+    {
+        FALCOR_ASSERT(isValid());
+
+        float2 p = rnd;
+        uint2 pos = uint2(0);
+
+        // Iterate over mips of 2x2...NxN resolution.
+        for (int mip = (int)getMipCount() - 2; mip >= 0; mip--)
+        {
+            pos *= 2u;
+
+            float w[4];
+            w[0] = getValue((uint32_t)mip, pos.x, pos.y);
+            w[1] = getValue((uint32_t)mip, pos.x + 1, pos.y);
+            w[2] = getValue((uint32_t)mip, pos.x, pos.y + 1);
+            w[3] = getValue((uint32_t)mip, pos.x + 1, pos.y + 1);
+
+            float q[2];
+            q[0] = w[0] + w[2];
+            q[1] = w[1] + w[3];
+
+            uint2 off;
+
+            // Horizontal warp.
+            float d = q[0] / (q[0] + q[1]);
+            if (p.x < d)
+            {
+                off.x = 0;
+                p.x = p.x / d;
+            }
+            else
+            {
+                off.x = 1;
+                p.x = (p.x - d) / (1.f - d);
+            }
+
+            // Vertical warp.
+            float e = w[off.x] / q[off.x];
+            if (p.y < e)
+            {
+                off.y = 0;
+                p.y = p.y / e;
+            }
+            else
+            {
+                off.y = 1;
+                p.y = (p.y - e) / (1.f - e);
+            }
+
+            pos += off;
+        }
+
+        pdf = getValue(0, pos.x, pos.y) / getAverage();
+        return (float2(pos) + p) / (float)mDimension;
+    }
+
+    float EnvMapImportanceMap::evalPdf(const float2& uv) const
+    {
+        FALCOR_ASSERT(isValid());
+
+        // Point sampling with clamp to edge, as the importance sampler in EnvMapSampler.
+        uint32_t x = (uint32_t)std::clamp((int64_t)std::floor(uv.x * mDimension), (int64_t)0, (int64_t)mDimension - 1);
+        uint32_t y = (uint32_t)std::clamp((int64_t)std::floor(uv.y * mDimension), (int64_t)0, (int64_t)mDimension - 1);
+        return getValue(0, x, y) / getAverage();
+    }
+
+    EnvMapImportanceMap::CDFTables EnvMapImportanceMap::computeCDFTables() const
+    {
+        FALCOR_ASSERT(isValid());
+
+        // Build a normalized CDF from a list of non-negative weights. Falls back to a uniform distribution if all weights are zero.
+        auto buildCDF = [](const float* pWeights, uint32_t count, float* pCDF)
+        {
+            double sum = 0.0;
+            pCDF[0] = 0.f;
+            for (uint32_t i = 0; i < count; i++) sum += pWeights[i];
+            double acc = 0.0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                acc += sum > 0.0 ? pWeights[i] : 1.0;
+                pCDF[i + 1] = (float)(acc / (sum > 0.0 ? sum : count));
+            }
+            pCDF[count] = 1.f;
+        };
+
+        const uint32_t dim = mDimension;
+        const std::vector<float>& baseLevel = mMips[0];
+
+        CDFTables tables;
+        tables.conditional.resize((size_t)dim * (dim + 1));
+        std::vector<float> rowSums(dim);
+
+        NumericRange<uint32_t> rows(0, dim);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+        {
+            const float* pRow = &baseLevel[(size_t)y * dim];
+            double sum = 0.0;
+            for (uint32_t x = 0; x < dim; x++) sum += pRow[x];
+            rowSums[y] = (float)sum;
+            buildCDF(pRow, dim, &tables.conditional[(size_t)y * (dim + 1)]);
+        });
+
+        tables.marginal.resize(dim + 1);
+        buildCDF(rowSums.data(), dim, tables.marginal.data());
+
+        return tables;
+    }
+
+    SHA1::MD EnvMapImportanceMap::computeKey(const SHA1::MD& envMapHash, uint32_t dimension, uint32_t samples)
+    {
+        SHA1 sha1;
+        sha1.update(&kCacheVersion, sizeof(kCacheVersion));
+        sha1.update(envMapHash.data(), envMapHash.size());
+        sha1.update(&dimension, sizeof(dimension));
+        sha1.update(&samples, sizeof(samples));
+        return sha1.finalize();
+    }
+
+    EnvMapImportanceMap::Cache::Cache(const std::filesystem::path& directory)
+        : mFiles(directory.empty() ? getAppDataDirectory() / kDirectory : directory, ".bin")
+    {
+    }
+
+    bool EnvMapImportanceMap::Cache::load(const SHA1::MD& key, uint32_t dimension, EnvMapImportanceMap& importanceMap) const
+    {
+        std::ifstream fs(mFiles.getPath(key), std::ios_base::binary);
+        if (!fs) return false;
+
+        uint32_t header[3] = {};
+        fs.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!fs || header[0] != kCacheMagic || header[1] != kCacheVersion || header[2] != dimension || !isPowerOf2(dimension)) return false;
+
+        std::vector<float> baseLevel((size_t)dimension * dimension);
+        fs.read(reinterpret_cast<char*>(baseLevel.data()), baseLevel.size() * sizeof(float));
+        if (!fs) return false;
+
+        importanceMap = createFromBaseLevel(dimension, std::move(baseLevel));
+        return true;
+    }
+
+    void EnvMapImportanceMap::Cache::store(const SHA1::MD& key, const EnvMapImportanceMap& importanceMap) const
+    {
+        FALCOR_ASSERT(importanceMap.isValid());
+
+        mFiles.store(key, [&](const std::filesystem::path& path)
+        {
+            std::ofstream fs(path, std::ios_base::binary);
+            const uint32_t header[3] = { kCacheMagic, kCacheVersion, importanceMap.getDimension() };
+            const std::vector<float>& baseLevel = importanceMap.getMip(0);
+            fs.write(reinterpret_cast<const char*>(header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(baseLevel.data()), baseLevel.size() * sizeof(float));
+            return (bool)fs;
+        });
+    }
+}
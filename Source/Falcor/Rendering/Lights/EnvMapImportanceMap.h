@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/PersistentCache.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU representation of the hierarchical importance map used by EnvMapSampler.
+
+        The base level is a square power-of-two map in the equal-area octahedral parameterization, where each texel
+        holds the average luminance of the environment map over its footprint. Each coarser mip holds the average
+        of 2x2 texels of the previous mip, down to a single texel holding the average over the whole sphere.
+
+        The map is built in parallel with the same sample pattern as EnvMapSamplerSetup.cs.slang, and provides
+        the same hierarchical sampling as EnvMapSampler.slang as well as equivalent marginal/conditional CDF tables
+        for offline tools and validation. Built maps can be stored in a persistent cache.
+    */
+    class FALCOR_API EnvMapImportanceMap
+    {
+    public:
+        /** Environment map data, finest mip level of the lat-long map in linear RGB.
+        */
+        struct EnvMapData
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float3> texels;     ///< Texels in row-major order.
+
+            /** Sample the environment map with bilinear filtering, wrapping in U and clamping in V as the EnvMap sampler does.
+            */
+            float3 sample(const float2& uv) const;
+        };
+
+        /** Marginal/conditional CDF tables of the base level. Sampling these is equivalent to sampling the hierarchy.
+        */
+        struct CDFTables
+        {
+            std::vector<float> marginal;    ///< CDF over rows, dimension + 1 entries.
+            std::vector<float> conditional; ///< CDF over texels within each row, dimension x (dimension + 1) entries.
+        };
+
+        EnvMapImportanceMap() = default;
+
+        /** Build an importance map from an environment map.
+            \param[in] envMap Environment map data.
+            \param[in] dimension Width and height of the base level. Must be a power of two.
+            \param[in] samples Number of samples per base level texel. Must be a power of two.
+            \return The importance map.
+        */
+        static EnvMapImportanceMap build(const EnvMapData& envMap, uint32_t dimension, uint32_t samples);
+
+        /** Create an importance map from its base level, coarser mips are computed by 2x2 averaging.
+            \param[in] dimension Width and height of the base level. Must be a power of two.
+            \param[in] baseLevel Base level values in row-major order.
+            \return The importance map.
+        */
+        static EnvMapImportanceMap createFromBaseLevel(uint32_t dimension, std::vector<float> baseLevel);
+
+        bool isValid() const { return !mMips.empty(); }
+        uint32_t getDimension() const { return mDimension; }
+        uint32_t getMipCount() const { return (uint32_t)mMips.size(); }
+        const std::vector<float>& getMip(uint32_t mip) const { return mMips[mip]; }
+        float getValue(uint32_t mip, uint32_t x, uint32_t y) const { return mMips[mip][(size_t)y * (mDimension >> mip) + x]; }
+
+        /** Returns the average importance over the map, i.e., the value of the 1x1 mip.
+        */
+        float getAverage() const { return mMips.back()[0]; }
+
+        /** Returns all mips packed from finest to coarsest, in the layout expected by Texture::create2D().
+        */
+        std::vector<float> getPackedMips() const;
+
+        /** Warp a uniform sample to a position in the octahedral map by traversing the hierarchy.
+            This matches EnvMapSampler::sample() in EnvMapSampler.slang.
+            \param[in] rnd Uniform random sample in [0,1)^2.
+            \param[out] pdf Probability density with respect to area in the octahedral map.
+            \return Position in the octahedral map in [0,1)^2.
+        */
+        float2 sample(float2 rnd, float& pdf) const;
+
+        /** Evaluate the probability density with respect to area in the octahedral map.
+            \param[in] uv Position in the octahedral map in [0,1]^2.
+        */
+        float evalPdf(const float2& uv) const;
+
+        /** Compute the marginal/conditional CDF tables of the base level.
+        */
+        CDFTables computeCDFTables() const;
+
+        /** Compute the cache key of an importance map.
+            \param[in] envMapHash Hash of the environment map content.
+            \param[in] dimension Width and height of the base level.
+            \param[in] samples Number of samples per base level texel.
+            \return Cache key.
+        */
+        static SHA1::MD computeKey(const SHA1::MD& envMapHash, uint32_t dimension, uint32_t samples);
+
+        /** Persistent on-disk cache of importance maps. Only the base level is stored.
+            Entries are never evicted.
+        */
+        class FALCOR_API Cache
+        {
+        public:
+            /** Create a cache.
+                \param[in] directory Cache directory. If empty, a directory in the application data directory is used.
+            */
+            Cache(const std::filesystem::path& directory = {});
+
+            /** Load a cache entry.
+                \param[in] key Cache key.
+                \param[in] dimension Expected width and height of the base level.
+                \param[out] importanceMap Importance map.
+                \return True if a valid entry was found.
+            */
+            bool load(const SHA1::MD& key, uint32_t dimension, EnvMapImportanceMap& importanceMap) const;
+
+            /** Store a cache entry. Failures are ignored as the cache is an optimization only.
+                \param[in] key Cache key.
+                \param[in] importanceMap Importance map.
+            */
+            void store(const SHA1::MD& key, const EnvMapImportanceMap& importanceMap) const;
+
+            const std::filesystem::path& getDirectory() const { return mFiles.getDirectory(); }
+
+        private:
+            PersistentCache mFiles;
+        };
+
+    private:
+        uint32_t mDimension = 0;
+        std::vector<std::vector<float>> mMips;  ///< Mips from NxN to 1x1 texels, in row-major order.
+    };
+}
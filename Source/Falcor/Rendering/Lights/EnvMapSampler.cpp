@@ -29,7 +29,11 @@
 #include "Core/Assert.h"
 #include "Core/API/RenderContext.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/Image/TextureCache.h"
 #include <glm/gtc/integer.hpp>
+#include <cstring>
 
 namespace Falcor
 {
@@ -40,6 +44,26 @@ namespace Falcor
         // The defaults are 512x512 @ 64spp in the resampling step.
         const uint32_t kDefaultDimension = 512;
         const uint32_t kDefaultSpp = 64;
+
+        /** Read back the finest mip of an environment map. The format must be supported by PixelConversion::convertToRGBA32Float().
+        */
+        EnvMapImportanceMap::EnvMapData readEnvMapData(RenderContext* pRenderContext, const Texture& texture)
+        {
+            const ResourceFormat format = texture.getFormat();
+            FALCOR_ASSERT(PixelConversion::isConvertibleToRGBA32Float(format));
+
+            EnvMapImportanceMap::EnvMapData data;
+            data.width = texture.getWidth(0);
+            data.height = texture.getHeight(0);
+
+            std::vector<uint8_t> texels = pRenderContext->readTextureSubresource(&texture, 0);
+            std::vector<float> rgba((size_t)data.width * data.height * 4);
+            PixelConversion::convertToRGBA32Float(format, data.width, data.height, texels.data(), getFormatRowPitch(format, data.width), rgba.data());
+
+            data.texels.resize((size_t)data.width * data.height);
+            for (size_t i = 0; i < data.texels.size(); i++) data.texels[i] = float3(rgba[4 * i + 0], rgba[4 * i + 1], rgba[4 * i + 2]);
+            return data;
+        }
     }
 
     EnvMapSampler::SharedPtr EnvMapSampler::create(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap)
@@ -82,22 +106,16 @@ namespace Falcor
         }
     }
 
-    bool EnvMapSampler::createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples)
+    EnvMapImportanceMap EnvMapSampler::computeImportanceMapOnGPU(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples) const
     {
         FALCOR_ASSERT(isPowerOf2(dimension));
         FALCOR_ASSERT(isPowerOf2(samples));
 
-        // We create log2(N)+1 mips from NxN...1x1 texels resolution.
-        uint32_t mips = glm::log2(dimension) + 1;
-        FALCOR_ASSERT((1u << (mips - 1)) == dimension);
-        FALCOR_ASSERT(mips > 1 && mips <= 12);     // Shader constant limits max resolution, increase if needed.
-
-        // Create importance map. We have to set the RTV flag to be able to use generateMips().
-        mpImportanceMap = Texture::create2D(dimension, dimension, ResourceFormat::R32Float, 1, mips, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget | Resource::BindFlags::UnorderedAccess);
-        FALCOR_ASSERT(mpImportanceMap);
+        auto pBaseLevel = Texture::create2D(dimension, dimension, ResourceFormat::R32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
 
         mpSetupPass["gEnvMap"] = mpEnvMap->getEnvMap();
-        mpSetupPass["gImportanceMap"] = mpImportanceMap;
+        mpSetupPass["gEnvSampler"] = mpEnvMap->getEnvSampler();
+        mpSetupPass["gImportanceMap"] = pBaseLevel;
 
         uint32_t samplesX = std::max(1u, (uint32_t)std::sqrt(samples));
         uint32_t samplesY = samples / samplesX;
@@ -111,10 +129,54 @@ namespace Falcor
         // Execute setup pass to compute the square importance map (base mip).
         mpSetupPass->execute(pRenderContext, dimension, dimension);
 
-        // Populate mip hierarchy. We rely on the default mip generation for this.
-        mpImportanceMap->generateMips(pRenderContext);
+        std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pBaseLevel.get(), 0);
+        FALCOR_ASSERT(data.size() == (size_t)dimension * dimension * sizeof(float));
+        std::vector<float> baseLevel((size_t)dimension * dimension);
+        std::memcpy(baseLevel.data(), data.data(), baseLevel.size() * sizeof(float));
 
-        return true;
+        // The mip hierarchy is computed on the CPU, which matches the default mip generation.
+        return EnvMapImportanceMap::createFromBaseLevel(dimension, std::move(baseLevel));
     }
 
+    bool EnvMapSampler::createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples)
+    {
+        FALCOR_ASSERT(isPowerOf2(dimension));
+        FALCOR_ASSERT(isPowerOf2(samples));
+
+        // We create log2(N)+1 mips from NxN...1x1 texels resolution.
+        uint32_t mips = glm::log2(dimension) + 1;
+        FALCOR_ASSERT((1u << (mips - 1)) == dimension);
+        FALCOR_ASSERT(mips > 1 && mips <= 12);     // Shader constant limits max resolution, increase if needed.
+
+        const auto& pEnvMap = mpEnvMap->getEnvMap();
+
+        // Look up the importance map in the persistent cache. Only environment maps loaded from file are cached.
+        EnvMapImportanceMap::Cache cache;
+        SHA1::MD envMapHash;
+        const bool useCache = TextureCache::computeSourceHash(*pEnvMap, envMapHash);
+        const SHA1::MD key = useCache ? EnvMapImportanceMap::computeKey(envMapHash, dimension, samples) : SHA1::MD();
+
+        if (!useCache || !cache.load(key, dimension, mImportanceMapData))
+        {
+            // Build the importance map on the CPU if the env map can be read back, otherwise use the setup pass.
+            if (PixelConversion::isConvertibleToRGBA32Float(pEnvMap->getFormat()))
+            {
+                mImportanceMapData = EnvMapImportanceMap::build(readEnvMapData(pRenderContext, *pEnvMap), dimension, samples);
+            }
+            else
+            {
+                mImportanceMapData = computeImportanceMapOnGPU(pRenderContext, dimension, samples);
+            }
+
+            if (useCache) cache.store(key, mImportanceMapData);
+        }
+
+        // Create importance map with the full mip hierarchy.
+        FALCOR_ASSERT(mImportanceMapData.getMipCount() == mips);
+        std::vector<float> packedMips = mImportanceMapData.getPackedMips();
+        mpImportanceMap = Texture::create2D(dimension, dimension, ResourceFormat::R32Float, 1, mips, packedMips.data(), Resource::BindFlags::ShaderResource);
+        FALCOR_ASSERT(mpImportanceMap);
+
+        return true;
+    }
 }
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "EnvMapImportanceMap.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
@@ -39,6 +40,11 @@ namespace Falcor
 
     /** Environment map sampler.
         Utily class for sampling and evaluating radiance stored in an omnidirectional environment map.
+
+        The hierarchical importance map is built on the CPU (see EnvMapImportanceMap) and stored in a persistent
+        cache keyed by the environment map source file, so that loading a previously seen environment map
+        requires no preprocessing. Environment maps in formats that can't be read back on the CPU
+        (e.g., block compressed) use the setup compute pass instead.
     */
     class FALCOR_API EnvMapSampler
     {
@@ -62,6 +68,19 @@ namespace Falcor
 
         const Texture::SharedPtr& getImportanceMap() const { return mpImportanceMap; }
 
+        /** Get the CPU representation of the importance map, which holds the same data as getImportanceMap().
+        */
+        const EnvMapImportanceMap& getImportanceMapData() const { return mImportanceMapData; }
+
+        /** Compute an importance map with the setup compute pass and read it back.
+            This is used for environment maps that can't be read back on the CPU, and for validation of the CPU builder.
+            \param[in] pRenderContext A render-context that will be used for processing.
+            \param[in] dimension Width and height of the base level. Must be a power of two.
+            \param[in] samples Number of samples per base level texel. Must be a power of two.
+            \return The importance map.
+        */
+        EnvMapImportanceMap computeImportanceMapOnGPU(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples) const;
+
     protected:
         EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap);
 
@@ -72,6 +91,7 @@ namespace Falcor
         ComputePass::SharedPtr  mpSetupPass;        ///< Compute pass for creating the importance map.
 
         Texture::SharedPtr      mpImportanceMap;    ///< Hierarchical importance map (luminance).
+        EnvMapImportanceMap     mImportanceMapData; ///< CPU copy of the importance map.
         Sampler::SharedPtr      mpImportanceSampler;
     };
 }
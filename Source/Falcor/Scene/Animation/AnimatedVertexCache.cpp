@@ -30,6 +30,10 @@
 #include "Core/API/RenderContext.h"
 #include "Scene/Scene.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Threading.h"
+#include <functional>
+#include <limits>
 
 namespace Falcor
 {
@@ -39,6 +43,36 @@ namespace Falcor
         const std::string kUpdateCurveAABBsFilename = "Scene/Animation/UpdateCurveAABBs.slang";
         const std::string kUpdateCurvePolyTubeVerticesFilename = "Scene/Animation/UpdateCurvePolyTubeVertices.slang";
 
+        /// Number of keyframes resident on the GPU per vertex cache, i.e., the two keyframes being interpolated.
+        const uint32_t kKeyframeSlotCount = 2;
+        const uint32_t kInvalidKeyframe = std::numeric_limits<uint32_t>::max();
+
+        /** Map the keyframes to be interpolated to GPU slots, uploading keyframes that are not resident.
+            \param[in,out] slotKeyframes Keyframe held by each slot.
+            \param[in] keyframes Keyframes to be interpolated.
+            \param[in] upload Function uploading a keyframe to a slot.
+            \return Slots holding the keyframes.
+        */
+        uint2 assignKeyframeSlots(uint2& slotKeyframes, uint2 keyframes, const std::function<void(uint32_t slot, uint32_t keyframe)>& upload)
+        {
+            uint2 slots;
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                uint32_t keyframe = keyframes[i];
+                if (slotKeyframes.x == keyframe) slots[i] = 0;
+                else if (slotKeyframes.y == keyframe) slots[i] = 1;
+                else
+                {
+                    // Don't evict the slot holding the other keyframe.
+                    uint32_t slot = i == 0 ? (slotKeyframes.x == keyframes.y ? 1 : 0) : 1 - slots[0];
+                    upload(slot, keyframe);
+                    slotKeyframes[slot] = keyframe;
+                    slots[i] = slot;
+                }
+            }
+            return slots;
+        }
+
         InterpolationInfo calculateInterpolation(double time, const std::vector<double>& timeSamples, Animation::Behavior preInfinityBehavior, Animation::Behavior postInfinityBehavior)
         {
             if (!std::isfinite(time))
@@ -96,14 +130,18 @@ namespace Falcor
         }
     }
 
-    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const Options& options)
         : mpScene(pScene)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
         , mpPrevVertexData(pPrevVertexData)
+        , mOptions(options)
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
 
+        // Keyframes are compressed by the importers, they are only decoded in a window around the current time.
+        mpDecodeQueue = std::make_unique<KeyframeDecodeQueue>(std::clamp(mOptions.decodeThreadCount, 1u, std::max(1u, Threading::getLogicalThreadCount())));
+
         if (!mCachedCurves.empty())
         {
             for (auto& cache : mCachedCurves)
@@ -139,9 +177,9 @@ namespace Falcor
         }
     }
 
-    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const Options& options)
     {
-        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes)));
+        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), options));
     }
 
     bool AnimatedVertexCache::animate(RenderContext* pRenderContext, double time)
@@ -197,6 +235,17 @@ namespace Falcor
         for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) m += mpMeshVertexBuffers[i] ? mpMeshVertexBuffers[i]->getSize() : 0;
         m += mpMeshInterpolationBuffer ? mpMeshInterpolationBuffer->getSize() : 0;
         m += mpMeshMetadataBuffer ? mpMeshMetadataBuffer->getSize() : 0;
+        for (size_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) m += mpCurvePolyTubeVertexBuffers[i] ? mpCurvePolyTubeVertexBuffers[i]->getSize() : 0;
+        m += mpCurvePolyTubeStrandIndexBuffer ? mpCurvePolyTubeStrandIndexBuffer->getSize() : 0;
+        m += mpCurvePolyTubeCurveMetadataBuffer ? mpCurvePolyTubeCurveMetadataBuffer->getSize() : 0;
+        m += mpCurvePolyTubeMeshMetadataBuffer ? mpCurvePolyTubeMeshMetadataBuffer->getSize() : 0;
+
+        // Compressed keyframes and decoded keyframe windows on the CPU.
+        for (const auto& cache : mCachedCurves) m += cache.keyframes.getMemoryUsageInBytes();
+        for (const auto& cache : mCachedMeshes) m += cache.keyframes.getMemoryUsageInBytes();
+        for (const auto& window : mMeshKeyframeWindows) m += window.getMemoryUsageInBytes();
+        m += mCurveKeyframeWindow.getMemoryUsageInBytes();
+        m += mCurvePolyTubeKeyframeWindow.getMemoryUsageInBytes();
         return m;
     }
 
@@ -207,9 +256,10 @@ namespace Falcor
     {
         // Align the time samples across vertex caches.
         mCurveKeyframeTimes.clear();
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        for (const auto& cache : mCachedCurves)
         {
-            mCurveKeyframeTimes.insert(mCurveKeyframeTimes.end(), mCachedCurves[i].timeSamples.begin(), mCachedCurves[i].timeSamples.end());
+            const auto& timeSamples = cache.keyframes.getTimeSamples();
+            mCurveKeyframeTimes.insert(mCurveKeyframeTimes.end(), timeSamples.begin(), timeSamples.end());
         }
         std::sort(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end());
         mCurveKeyframeTimes.erase(std::unique(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end()), mCurveKeyframeTimes.end());
@@ -217,6 +267,50 @@ namespace Falcor
         mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
     }
 
+    void AnimatedVertexCache::decodeCurveKeyframe(CurveTessellationMode mode, uint32_t keyframe, std::vector<DynamicCurveVertexData>& vertices) const
+    {
+        const double time = mCurveKeyframeTimes[keyframe];
+        vertices.resize(mode == CurveTessellationMode::LinearSweptSphere ? mCurveVertexCount : mCurvePolyTubeVertexCount);
+
+        size_t offset = 0;
+        std::vector<DynamicCurveVertexData> prevVertices;
+        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        {
+            if (mCachedCurves[i].tessellationMode != mode) continue;
+
+            const auto& keyframes = mCachedCurves[i].keyframes;
+            const auto& timeSamples = keyframes.getTimeSamples();
+            const uint32_t vertexCount = keyframes.getVertexCount();
+            DynamicCurveVertexData* pDst = vertices.data() + offset;
+
+            // Find the first keyframe of this curve at or after the time, clamping outside of the sampled range.
+            uint32_t k = uint32_t(std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin());
+            if (k == timeSamples.size())
+            {
+                keyframes.decode(k - 1, pDst);
+            }
+            else if (k == 0 || timeSamples[k] == time)
+            {
+                keyframes.decode(k, pDst);
+            }
+            else
+            {
+                // Linearly interpolate at the missing keyframe.
+                float t = float((time - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
+                prevVertices.resize(vertexCount);
+                keyframes.decode(k - 1, prevVertices.data());
+                keyframes.decode(k, pDst);
+                for (size_t p = 0; p < vertexCount; p++)
+                {
+                    pDst[p].position = lerp(prevVertices[p].position, pDst[p].position, t);
+                }
+            }
+
+            offset += vertexCount;
+        }
+        FALCOR_ASSERT(offset == vertices.size());
+    }
+
     void AnimatedVertexCache::bindCurveLSSBuffers()
     {
         // Compute curve vertex and index (segment) count.
@@ -226,68 +320,36 @@ namespace Falcor
         {
             if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
 
-            mCurveVertexCount += (uint32_t)mCachedCurves[i].vertexData[0].size();
+            mCurveVertexCount += mCachedCurves[i].keyframes.getVertexCount();
             mCurveIndexCount += (uint32_t)mCachedCurves[i].indexData.size();
         }
 
+        // Keyframes are decoded on demand, only the keyframes being interpolated are uploaded to the GPU slots.
+        mCurveKeyframeWindow = VertexKeyframeWindow<DynamicCurveVertexData>((uint32_t)mCurveKeyframeTimes.size(), mOptions.prefetchKeyframeCount,
+            [this](uint32_t keyframe, std::vector<DynamicCurveVertexData>& vertices) { decodeCurveKeyframe(CurveTessellationMode::LinearSweptSphere, keyframe, vertices); }, mpDecodeQueue.get());
+        const auto& firstKeyframe = mCurveKeyframeWindow.get(0);
+
         // Create buffers for vertex positions in curve vertex caches.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurveVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurveVertexBuffers.resize(kKeyframeSlotCount);
+        for (uint32_t i = 0; i < kKeyframeSlotCount; i++)
         {
-            mpCurveVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+            mpCurveVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, i == 0 ? firstKeyframe.data() : nullptr, false);
             mpCurveVertexBuffers[i]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(i) + "]");
         }
+        mCurveSlotKeyframes = uint2(0, kInvalidKeyframe);
 
-        // Create buffers for previous vertex positions.
-        mpPrevCurveVertexBuffer = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+        // Create buffers for previous vertex positions, initialized with positions at the first keyframe.
+        mpPrevCurveVertexBuffer = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, firstKeyframe.data(), false);
         mpPrevCurveVertexBuffer->setName("AnimatedVertexCache::mpPrevCurveVertexBuffer");
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurveVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurveVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            // Initialize it with positions at the first keyframe.
-            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
-
-            offset += bufSize;
-        }
-
         // Create curve index buffer.
         vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurveIndexBuffer = Buffer::create(sizeof(uint32_t) * mCurveIndexCount, vbBindFlags);
         mpCurveIndexBuffer->setName("AnimatedVertexCache::mpCurveIndexBuffer");
 
         // Initialize index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         std::vector<uint32_t> indexData(mCurveIndexCount);
         for (CurveID curveID{ 0 }; curveID.get() < (uint32_t)mCachedCurves.size(); ++curveID)
         {
@@ -321,7 +383,7 @@ namespace Falcor
             PerCurveMetadata curveMeta;
             curveMeta.indexCount = (uint32_t)cache.indexData.size();
             curveMeta.indexOffset = mCurvePolyTubeIndexCount;
-            curveMeta.vertexCount = (uint32_t)cache.vertexData[0].size();
+            curveMeta.vertexCount = mCachedCurves[i].keyframes.getVertexCount();
             curveMeta.vertexOffset = mCurvePolyTubeVertexCount;
             curveMetadata.push_back(curveMeta);
 
@@ -343,49 +405,20 @@ namespace Falcor
         mpCurvePolyTubeMeshMetadataBuffer = Buffer::createStructured(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
         mpCurvePolyTubeMeshMetadataBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeMeshMetadataBuffer");
 
+        // Keyframes are decoded on demand, only the keyframes being interpolated are uploaded to the GPU slots.
+        mCurvePolyTubeKeyframeWindow = VertexKeyframeWindow<DynamicCurveVertexData>((uint32_t)mCurveKeyframeTimes.size(), mOptions.prefetchKeyframeCount,
+            [this](uint32_t keyframe, std::vector<DynamicCurveVertexData>& vertices) { decodeCurveKeyframe(CurveTessellationMode::PolyTube, keyframe, vertices); }, mpDecodeQueue.get());
+        const auto& firstKeyframe = mCurvePolyTubeKeyframeWindow.get(0);
+
         // Create buffers for vertex positions in curve vertex caches.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurvePolyTubeVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurvePolyTubeVertexBuffers.resize(kKeyframeSlotCount);
+        for (uint32_t i = 0; i < kKeyframeSlotCount; i++)
         {
-            mpCurvePolyTubeVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+            mpCurvePolyTubeVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, Buffer::CpuAccess::None, i == 0 ? firstKeyframe.data() : nullptr, false);
             mpCurvePolyTubeVertexBuffers[i]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(i) + "]");
         }
-
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::PolyTube) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            offset += bufSize;
-        }
+        mCurvePolyTubeSlotKeyframes = uint2(0, kInvalidKeyframe);
 
         // Create curve strand index buffer.
         vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
@@ -393,7 +426,7 @@ namespace Falcor
         mpCurvePolyTubeStrandIndexBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeStrandIndexBuffer");
 
         // Initialize strand index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         const uint32_t strandLastVertexIndex = 0xffffffff;
         std::vector<uint32_t> strandIndexData(mCurvePolyTubeVertexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
@@ -433,40 +466,49 @@ namespace Falcor
     {
         for (const auto& cache : mCachedMeshes)
         {
-            mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
-            mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
-            mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
+            const auto& keyframes = cache.keyframes;
+            mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, keyframes.getTimeSamples().back());
+            mMaxMeshVertexCount = std::max(keyframes.getVertexCount(), mMaxMeshVertexCount);
         }
     }
 
     void AnimatedVertexCache::initMeshBuffers()
     {
-        mpMeshVertexBuffers.resize(mMeshKeyframeCount);
+        mpMeshVertexBuffers.resize(mCachedMeshes.size() * kKeyframeSlotCount);
+        mMeshSlotKeyframes.resize(mCachedMeshes.size(), uint2(0, kInvalidKeyframe));
         std::vector<PerMeshMetadata> meshMetadata;
         meshMetadata.reserve(mCachedMeshes.size());
 
-        uint32_t keyframeOffset = 0;
-        for (auto& cache : mCachedMeshes)
+        for (uint32_t meshIndex = 0; meshIndex < (uint32_t)mCachedMeshes.size(); meshIndex++)
         {
-            FALCOR_ASSERT(cache.vertexData.front().size() == mpScene->getMesh(cache.meshID).vertexCount);
+            const auto& cache = mCachedMeshes[meshIndex];
+            const auto& keyframes = mCachedMeshes[meshIndex].keyframes;
+            FALCOR_ASSERT(keyframes.getVertexCount() == mpScene->getMesh(cache.meshID).vertexCount);
 
             PerMeshMetadata meta;
-            meta.keyframeBufferOffset = keyframeOffset;
-            meta.vertexCount = (uint32_t)cache.vertexData.front().size();
+            meta.keyframeBufferOffset = meshIndex * kKeyframeSlotCount;
+            meta.vertexCount = keyframes.getVertexCount();
             meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
 
-            // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
+            // Keyframes are decoded on demand, only the keyframes being interpolated are uploaded to the GPU slots.
+            mMeshKeyframeWindows.emplace_back(keyframes.getKeyframeCount(), mOptions.prefetchKeyframeCount,
+                [this, meshIndex](uint32_t keyframe, std::vector<PackedStaticVertexData>& vertices)
+                {
+                    const auto& keyframes = mCachedMeshes[meshIndex].keyframes;
+                    vertices.resize(keyframes.getVertexCount());
+                    keyframes.decode(keyframe, vertices.data());
+                }, mpDecodeQueue.get());
+            const auto& firstKeyframe = mMeshKeyframeWindows.back().get(0);
+
+            // Create a vertex buffer for each GPU slot of this mesh.
+            for (uint32_t slot = 0; slot < kKeyframeSlotCount; slot++)
             {
-                auto& data = cache.vertexData[i];
-                size_t index = keyframeOffset + i;
-                mpMeshVertexBuffers[index] = Buffer::createStructured(sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data(), false);
+                size_t index = meta.keyframeBufferOffset + slot;
+                mpMeshVertexBuffers[index] = Buffer::createStructured(sizeof(PackedStaticVertexData), meta.vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, slot == 0 ? firstKeyframe.data() : nullptr, false);
                 mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
             }
-
-            keyframeOffset += (uint32_t)cache.timeSamples.size();
         }
 
         mpMeshMetadataBuffer = Buffer::createStructured(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
@@ -482,7 +524,7 @@ namespace Falcor
         FALCOR_ASSERT(!mCachedMeshes.empty());
 
         Program::DefineList defines;
-        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mMeshKeyframeCount));
+        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mpMeshVertexBuffers.size()));
         mpMeshVertexUpdatePass = ComputePass::create("Scene/Animation/UpdateMeshVertices.slang", "main", defines);
 
         // Bind data
@@ -500,14 +542,14 @@ namespace Falcor
         FALCOR_ASSERT(mCurveLSSCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(kKeyframeSlotCount));
         mpCurveVertexUpdatePass = ComputePass::create(kUpdateCurveVerticesFilename, "main", defines);
 
         auto block = mpCurveVertexUpdatePass->getVars()["gCurveVertexUpdater"];
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
+        for (uint32_t i = 0; i < kKeyframeSlotCount; i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
     }
 
     void AnimatedVertexCache::createCurveLSSAABBUpdatePass()
@@ -525,7 +567,7 @@ namespace Falcor
         FALCOR_ASSERT(mCurvePolyTubeCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(kKeyframeSlotCount));
         mpCurvePolyTubeVertexUpdatePass = ComputePass::create(kUpdateCurvePolyTubeVerticesFilename, "main", defines);
 
         auto block = mpCurvePolyTubeVertexUpdatePass->getVars()["gCurvePolyTubeVertexUpdater"];
@@ -535,7 +577,7 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+        for (uint32_t i = 0; i < kKeyframeSlotCount; i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
     }
 
 
@@ -545,14 +587,29 @@ namespace Falcor
 
         FALCOR_PROFILE("update mesh vertices");
 
-        // Update interpolation
-        for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+        // Update interpolation and make sure the interpolated keyframes are resident on the GPU.
+        if (!copyPrev)
         {
-            auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
-            mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
-        }
+            for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+            {
+                auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
+                InterpolationInfo info = calculateInterpolation(t, mCachedMeshes[i].keyframes.getTimeSamples(), mPreInfinityBehavior, postInfinityBehavior);
+
+                auto& window = mMeshKeyframeWindows[i];
+                uint32_t slotOffset = (uint32_t)i * kKeyframeSlotCount;
+                uint2 keyframes = info.keyframeIndices;
+                info.keyframeIndices = assignKeyframeSlots(mMeshSlotKeyframes[i], keyframes, [&](uint32_t slot, uint32_t keyframe)
+                {
+                    const auto& vertices = window.get(keyframe);
+                    mpMeshVertexBuffers[slotOffset + slot]->setBlob(vertices.data(), 0, vertices.size() * sizeof(PackedStaticVertexData));
+                });
+                window.update(keyframes.x, keyframes.y);
 
-        mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+                mMeshInterpolationInfo[i] = info;
+            }
+
+            mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+        }
 
         auto block = mpMeshVertexUpdatePass->getVars()["gMeshVertexUpdater"];
         block["sceneVertexData"] = mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex);
@@ -567,8 +624,20 @@ namespace Falcor
 
         FALCOR_PROFILE("update curve vertices");
 
+        // Make sure the interpolated keyframes are resident on the GPU.
+        uint2 slots = uint2(0);
+        if (!copyPrev)
+        {
+            slots = assignKeyframeSlots(mCurveSlotKeyframes, info.keyframeIndices, [&](uint32_t slot, uint32_t keyframe)
+            {
+                const auto& vertices = mCurveKeyframeWindow.get(keyframe);
+                mpCurveVertexBuffers[slot]->setBlob(vertices.data(), 0, vertices.size() * sizeof(DynamicCurveVertexData));
+            });
+            mCurveKeyframeWindow.update(info.keyframeIndices.x, info.keyframeIndices.y);
+        }
+
         auto block = mpCurveVertexUpdatePass->getVars()["gCurveVertexUpdater"];
-        block["keyframeIndices"] = info.keyframeIndices;
+        block["keyframeIndices"] = slots;
         block["t"] = info.t;
         block["copyPrev"] = copyPrev;
         block["curveVertices"] = mpScene->mpCurveVao->getVertexBuffer(0);
@@ -606,8 +675,20 @@ namespace Falcor
 
         FALCOR_PROFILE("Update curve poly-tube vertices");
 
+        // Make sure the interpolated keyframes are resident on the GPU.
+        uint2 slots = uint2(0);
+        if (!copyPrev)
+        {
+            slots = assignKeyframeSlots(mCurvePolyTubeSlotKeyframes, info.keyframeIndices, [&](uint32_t slot, uint32_t keyframe)
+            {
+                const auto& vertices = mCurvePolyTubeKeyframeWindow.get(keyframe);
+                mpCurvePolyTubeVertexBuffers[slot]->setBlob(vertices.data(), 0, vertices.size() * sizeof(DynamicCurveVertexData));
+            });
+            mCurvePolyTubeKeyframeWindow.update(info.keyframeIndices.x, info.keyframeIndices.y);
+        }
+
         auto block = mpCurvePolyTubeVertexUpdatePass->getVars()["gCurvePolyTubeVertexUpdater"];
-        block["keyframeIndices"] = info.keyframeIndices;
+        block["keyframeIndices"] = slots;
         block["t"] = info.t;
         block["copyPrev"] = copyPrev;
 
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Animation.h"
+#include "CompressedVertexKeyframes.h"
 #include "SharedTypes.slang"
 #include "Core/API/Buffer.h"
 #include "Scene/Curves/CurveConfig.h"
@@ -51,24 +52,20 @@ namespace Falcor
         CurveTessellationMode tessellationMode = CurveTessellationMode::LinearSweptSphere;  ///< Curve tessellation mode.
         CurveOrMeshID geometryID{ CurveOrMeshID::kInvalidID };                              ///< ID of the curve or mesh this data is animating.
 
-        std::vector<double> timeSamples;
-
         // Shared among all frames.
         // We assume the topology doesn't change during animation.
         std::vector<uint32_t> indexData;
 
-        // vertexData[i][j] represents at the i-th keyframe, the cache data of the j-th vertex.
-        std::vector<std::vector<DynamicCurveVertexData>> vertexData;
+        // Compressed vertex positions of each keyframe.
+        CompressedVertexKeyframes keyframes;
     };
 
     struct CachedMesh
     {
         MeshID meshID{ MeshID::kInvalidID }; ///< ID of the mesh this data is animating.
 
-        std::vector<double> timeSamples;
-
-        // vertexData[i][j] represents at the i-th keyframe, the cache data of the j-th vertex.
-        std::vector<std::vector<PackedStaticVertexData>> vertexData;
+        // Compressed vertex data of each keyframe.
+        CompressedVertexKeyframes keyframes;
     };
 
     class FALCOR_API AnimatedVertexCache
@@ -78,7 +75,17 @@ namespace Falcor
         using UniqueConstPtr = std::unique_ptr<const AnimatedVertexCache>;
         ~AnimatedVertexCache() = default;
 
-        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        struct Options
+        {
+            uint32_t prefetchKeyframeCount = 2;                 ///< Number of keyframes decoded ahead of the current time.
+            uint32_t decodeThreadCount = 2;                     ///< Number of worker threads prefetching keyframes.
+        };
+
+        /** Create a vertex cache.
+            The keyframes of the cached curves and meshes are kept compressed on the CPU.
+            Only the two keyframes needed for interpolation are resident on the GPU, a small window of decoded keyframes is kept on the CPU.
+        */
+        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const Options& options = Options());
 
         void setIsLooped(bool looped) { mLoopAnimations = looped; }
 
@@ -103,9 +110,10 @@ namespace Falcor
         uint64_t getMemoryUsageInBytes() const;
 
     private:
-        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const Options& options);
 
         void initCurveKeyframes();
+        void decodeCurveKeyframe(CurveTessellationMode mode, uint32_t keyframe, std::vector<DynamicCurveVertexData>& vertices) const;
         void bindCurveLSSBuffers();
         void bindCurvePolyTubeBuffers();
 
@@ -137,6 +145,8 @@ namespace Falcor
         Buffer::SharedPtr mpPrevVertexData; ///< Owned by AnimationController
         Animation::Behavior mPreInfinityBehavior = Animation::Behavior::Constant; // How the animation behaves before the first keyframe.
 
+        Options mOptions;
+
         std::vector<CachedCurve> mCachedCurves;
         uint32_t mCurveLSSCount = 0;
         uint32_t mCurvePolyTubeCount = 0;
@@ -150,7 +160,9 @@ namespace Falcor
         uint32_t mCurveIndexCount = 0;
         uint32_t mCurveAABBOffset = 0;
 
-        std::vector<Buffer::SharedPtr> mpCurveVertexBuffers;
+        std::vector<Buffer::SharedPtr> mpCurveVertexBuffers;    ///< Vertex data of the keyframes in each GPU slot.
+        uint2 mCurveSlotKeyframes;                              ///< Keyframe held by each GPU slot.
+        VertexKeyframeWindow<DynamicCurveVertexData> mCurveKeyframeWindow;
         Buffer::SharedPtr mpPrevCurveVertexBuffer;
         Buffer::SharedPtr mpCurveIndexBuffer;
 
@@ -161,7 +173,9 @@ namespace Falcor
         uint32_t mCurvePolyTubeIndexCount = 0;
         uint32_t mMaxCurvePolyTubeVertexCount = 0; ///< Greatest vertex count a curve has
 
-        std::vector<Buffer::SharedPtr> mpCurvePolyTubeVertexBuffers;
+        std::vector<Buffer::SharedPtr> mpCurvePolyTubeVertexBuffers;    ///< Vertex data of the keyframes in each GPU slot.
+        uint2 mCurvePolyTubeSlotKeyframes;                              ///< Keyframe held by each GPU slot.
+        VertexKeyframeWindow<DynamicCurveVertexData> mCurvePolyTubeKeyframeWindow;
         Buffer::SharedPtr mpCurvePolyTubeStrandIndexBuffer;
         Buffer::SharedPtr mpCurvePolyTubeCurveMetadataBuffer;
         Buffer::SharedPtr mpCurvePolyTubeMeshMetadataBuffer;
@@ -171,12 +185,16 @@ namespace Falcor
         ComputePass::SharedPtr mpMeshVertexUpdatePass;
 
         std::vector<CachedMesh> mCachedMeshes;
+        std::vector<VertexKeyframeWindow<PackedStaticVertexData>> mMeshKeyframeWindows;
+        std::vector<uint2> mMeshSlotKeyframes; ///< Keyframe held by each GPU slot per mesh.
         std::vector<InterpolationInfo> mMeshInterpolationInfo;
-        uint32_t mMeshKeyframeCount = 0; ///< Total count of all keyframes for all meshes
         uint32_t mMaxMeshVertexCount = 0; ///< Greatest vertex count a mesh has
 
-        std::vector<Buffer::SharedPtr> mpMeshVertexBuffers;
+        std::vector<Buffer::SharedPtr> mpMeshVertexBuffers; ///< Vertex data of the keyframes in the GPU slots of all meshes.
         Buffer::SharedPtr mpMeshInterpolationBuffer;
         Buffer::SharedPtr mpMeshMetadataBuffer;
+
+        /// Workers prefetching keyframes for the windows above. Declared last so that it is destroyed first, its tasks reference this object.
+        std::unique_ptr<KeyframeDecodeQueue> mpDecodeQueue;
     };
 }
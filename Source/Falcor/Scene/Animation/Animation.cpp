@@ -30,8 +30,11 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Scene/Transform.h"
+#include "Utils/NumericRange.h"
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <execution>
 
 namespace Falcor
 {
@@ -39,6 +42,9 @@ namespace Falcor
     {
         const double kEpsilonTime = 1e-5f;
 
+        /// Minimum number of animations in a batch for it to be evaluated in parallel.
+        const size_t kMinParallelBatchSize = 256;
+
         const Gui::DropdownList kChannelLoopModeDropdown =
         {
             { (uint32_t)Animation::Behavior::Constant, "Constant" },
@@ -93,17 +99,6 @@ namespace Falcor
             result.time = glm::lerp(k0.time, k1.time, (double)t);
             return result;
         }
-
-        Animation::Keyframe interpolateHermite(const Animation::Keyframe& k0, const Animation::Keyframe& k1, const Animation::Keyframe& k2, const Animation::Keyframe& k3, float t)
-        {
-            FALCOR_ASSERT(t >= 0.f && t <= 1.f);
-            Animation::Keyframe result;
-            result.translation = interpolateHermite(k0.translation, k1.translation, k2.translation, k3.translation, t);
-            result.scaling = lerp(k1.scaling, k2.scaling, t);
-            result.rotation = interpolateHermite(k0.rotation, k1.rotation, k2.rotation, k3.rotation, t);
-            result.time = glm::lerp(k1.time, k2.time, (double)t);
-            return result;
-        }
     }
 
     Animation::SharedPtr Animation::create(const std::string& name, NodeID nodeID, double duration)
@@ -121,28 +116,28 @@ namespace Falcor
     {
         // Calculate the sample time.
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < mTimes.front() || time > mTimes.back())
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
         Keyframe interpolated;
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
+            const Keyframe k0{ mTimes.front(), mTranslations.front(), mScalings.front(), mRotations.front() };
             auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
+            const Keyframe k1{ mTimes.back(), mTranslations.back(), mScalings.back(), mRotations.back() };
             auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
@@ -161,44 +156,51 @@ namespace Falcor
         return transform;
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    void Animation::animateBatch(const std::vector<SharedPtr>& animations, double currentTime, std::vector<rmcv::mat4>& matrices)
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
-
-        // Validate cached frame index.
-        size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+        matrices.resize(animations.size());
 
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        if (animations.size() < kMinParallelBatchSize)
         {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
+            for (size_t i = 0; i < animations.size(); i++) matrices[i] = animations[i]->animate(currentTime);
+            return;
         }
 
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
+        auto range = NumericRange<size_t>(0, animations.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            matrices[i] = animations[i]->animate(currentTime);
+        });
+    }
+
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
+
+        size_t frameIndex = findFrameIndex(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = mTimes.size();
             return mEnableWarping ? (frame + count + offset) % count : clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        Keyframe result;
+
+        if (mode == InterpolationMode::Linear || mTimes.size() < 4)
         {
             size_t i0 = frameIndex;
             size_t i1 = adjacentFrame(i0);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-
-            double segmentDuration = k1.time - k0.time;
+            double segmentDuration = mTimes[i1] - mTimes[i0];
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
-            float t = (float)clamp((segmentDuration > 0.0 ? (time - k0.time) / segmentDuration : 1.0), 0.0, 1.0);
+            float t = (float)clamp((segmentDuration > 0.0 ? (time - mTimes[i0]) / segmentDuration : 1.0), 0.0, 1.0);
 
-            return interpolateLinear(k0, k1, t);
+            result.translation = lerp(mTranslations[i0], mTranslations[i1], t);
+            result.scaling = lerp(mScalings[i0], mScalings[i1], t);
+            result.rotation = slerp(mRotations[i0], mRotations[i1], t);
+            result.time = glm::lerp(mTimes[i0], mTimes[i1], (double)t);
         }
         else if (mode == InterpolationMode::Hermite)
         {
@@ -207,21 +209,50 @@ namespace Falcor
             size_t i2 = adjacentFrame(i1, 1);
             size_t i3 = adjacentFrame(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
-
-            double segmentDuration = k2.time - k1.time;
+            double segmentDuration = mTimes[i2] - mTimes[i1];
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
-            float t = (float)clamp(segmentDuration > 0.0 ? (time - k1.time) / segmentDuration : 1.0, 0.0, 1.0);
+            float t = (float)clamp(segmentDuration > 0.0 ? (time - mTimes[i1]) / segmentDuration : 1.0, 0.0, 1.0);
 
-            return interpolateHermite(k0, k1, k2, k3, t);
+            result.translation = interpolateHermite(mTranslations[i0], mTranslations[i1], mTranslations[i2], mTranslations[i3], t);
+            result.scaling = lerp(mScalings[i1], mScalings[i2], t);
+            result.rotation = interpolateHermite(mRotations[i0], mRotations[i1], mRotations[i2], mRotations[i3], t);
+            result.time = glm::lerp(mTimes[i1], mTimes[i2], (double)t);
         }
         else
         {
             throw ArgumentError("'mode' is unknown interpolation mode");
         }
+
+        return result;
+    }
+
+    // Finds the last keyframe at or before the given time, or the first keyframe if there is none.
+    // Time usually advances coherently between calls, so the cached frame and its successor are
+    // checked before falling back to a binary search.
+    size_t Animation::findFrameIndex(double time) const
+    {
+        const size_t count = mTimes.size();
+        auto containsTime = [&](size_t frame)
+        {
+            return mTimes[frame] <= time && (frame + 1 == count || time < mTimes[frame + 1]);
+        };
+
+        size_t frameIndex = std::min(mCachedFrameIndex, count - 1);
+        if (!containsTime(frameIndex))
+        {
+            if (frameIndex + 1 < count && containsTime(frameIndex + 1))
+            {
+                frameIndex++;
+            }
+            else
+            {
+                auto it = std::upper_bound(mTimes.begin(), mTimes.end(), time);
+                frameIndex = it == mTimes.begin() ? 0 : (size_t)(it - mTimes.begin()) - 1;
+            }
+        }
+
+        mCachedFrameIndex = frameIndex;
+        return frameIndex;
     }
 
     // Calculates the sample time within the keyframe range if the current time lies outside and
@@ -231,8 +262,8 @@ namespace Falcor
     double Animation::calcSampleTime(double currentTime)
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mTimes.front();
+        double lastKeyframeTime = mTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -263,59 +294,36 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), keyframe.time);
+        size_t index = it - mTimes.begin();
+
+        // If we already have a key-frame at the same time, replace it
+        if (it != mTimes.end() && *it == keyframe.time)
         {
-            mKeyframes.push_back(keyframe);
+            mTranslations[index] = keyframe.translation;
+            mScalings[index] = keyframe.scaling;
+            mRotations[index] = keyframe.rotation;
+            return;
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
-        }
+        mTimes.insert(it, keyframe.time);
+        mTranslations.insert(mTranslations.begin() + index, keyframe.translation);
+        mScalings.insert(mScalings.begin() + index, keyframe.scaling);
+        mRotations.insert(mRotations.begin() + index, keyframe.rotation);
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        if (it == mTimes.end() || *it != time) throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+
+        size_t index = it - mTimes.begin();
+        return Keyframe{ mTimes[index], mTranslations[index], mScalings[index], mRotations[index] };
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mTimes.begin(), mTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
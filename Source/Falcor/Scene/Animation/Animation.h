@@ -86,6 +86,15 @@ namespace Falcor
         */
         void setNodeID(NodeID id) { mNodeID = id; }
 
+        /** Get the additional nodes driven by this animation.
+        */
+        const std::vector<NodeID>& getInstanceNodeIDs() const { return mInstanceNodeIDs; }
+
+        /** Add a node driven by this animation in addition to the animated node.
+            This is used to share a single animation between all instances of a prototype.
+        */
+        void addInstanceNodeID(NodeID id) { mInstanceNodeIDs.push_back(id); }
+
         /** Get the animation duration in seconds.
         */
         double getDuration() const { return mDuration; }
@@ -131,9 +140,13 @@ namespace Falcor
         /** Get the keyframe at the specified time.
             If the keyframe doesn't exists, the function will throw an exception. If you don't want to handle exceptions, call doesKeyframeExist() first.
             \param[in] time Time of the keyframe.
-            \return Returns the keyframe.
+            \return Returns a copy of the keyframe. Keyframes are stored as separate channels, so there is no keyframe object to reference.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
+
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mTimes.size(); }
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -147,6 +160,13 @@ namespace Falcor
         */
         rmcv::mat4 animate(double currentTime);
 
+        /** Compute a batch of animations. Animations are evaluated in parallel for large batches.
+            \param[in] animations Animations to evaluate.
+            \param[in] currentTime The current time in seconds.
+            \param[out] matrices Transform matrix of each animation, resized to the number of animations.
+        */
+        static void animateBatch(const std::vector<SharedPtr>& animations, double currentTime, std::vector<rmcv::mat4>& matrices);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -155,10 +175,12 @@ namespace Falcor
         Animation(const std::string& name, NodeID nodeID, double duration);
 
         Keyframe interpolate(InterpolationMode mode, double time) const;
+        size_t findFrameIndex(double time) const;
         double calcSampleTime(double currentTime);
 
         std::string mName;
         NodeID mNodeID;
+        std::vector<NodeID> mInstanceNodeIDs;
         double mDuration; // Includes any time before the first keyframe. May be Assimp or FBX specific.
 
         Behavior mPreInfinityBehavior = Behavior::Constant; // How the animation behaves before the first keyframe
@@ -167,7 +189,11 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
+        // Keyframe channels, sorted by time.
+        std::vector<double> mTimes;
+        std::vector<float3> mTranslations;
+        std::vector<float3> mScalings;
+        std::vector<glm::quat> mRotations;
         mutable size_t mCachedFrameIndex = 0;
 
         friend class SceneCache;
@@ -121,7 +121,7 @@ namespace Falcor
             for (auto& cache : cachedMeshes)
             {
                 uint32_t offset = mpScene->getMesh(cache.meshID).vbOffset;
-                for (size_t i = 0; i < cache.vertexData.front().size(); i++)
+                for (size_t i = 0; i < cache.keyframes.getVertexCount(); i++)
                 {
                     prevVertexData.push_back({ staticVertexData[offset + i].position });
                 }
@@ -199,6 +199,7 @@ namespace Falcor
         FALCOR_PROFILE("animate");
 
         std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        mChangedNodes.clear();
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -287,17 +288,34 @@ namespace Falcor
             mTime = time;
         }
 
+        // Gather the compact list of changed nodes so that clients don't have to scan all matrices.
+        if (changed)
+        {
+            for (size_t i = 0; i < mMatricesChanged.size(); i++)
+            {
+                if (mMatricesChanged[i]) mChangedNodes.push_back(NodeID{ i });
+            }
+        }
+
         return changed;
     }
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        Animation::animateBatch(mAnimations, time, mAnimationMatrices);
+
+        // Scatter in order so that the last animation of a node takes precedence.
+        auto setLocalMatrix = [&](NodeID nodeID, const float4x4& matrix)
         {
-            NodeID nodeID = pAnimation->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
+            mLocalMatrices[nodeID.get()] = matrix;
             mMatricesChanged[nodeID.get()] = true;
+        };
+
+        for (size_t i = 0; i < mAnimations.size(); i++)
+        {
+            setLocalMatrix(mAnimations[i]->getNodeID(), mAnimationMatrices[i]);
+            for (NodeID nodeID : mAnimations[i]->getInstanceNodeIDs()) setLocalMatrix(nodeID, mAnimationMatrices[i]);
         }
     }
 
@@ -114,6 +114,11 @@ namespace Falcor
         */
         bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
 
+        /** Get the list of nodes whose global matrix changed since last frame.
+            The list is sorted by node ID and only valid after calling animate().
+        */
+        const std::vector<NodeID>& getChangedNodes() const { return mChangedNodes; }
+
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
         */
@@ -162,11 +167,13 @@ namespace Falcor
 
         // Animation
         std::vector<Animation::SharedPtr> mAnimations;
+        std::vector<float4x4> mAnimationMatrices;   ///< Matrix per animation, scratch space for batched evaluation.
         std::vector<bool> mNodesEdited;
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<NodeID> mChangedNodes;          ///< List of nodes whose matrix changed since last frame.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -0,0 +1,303 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CompressedVertexKeyframes.h"
+#include "Core/Assert.h"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Maximum number of consecutive keyframes that may be dropped. Bounds the cost of the error checks and the number of pending keyframes.
+        const uint32_t kMaxDroppedKeyframes = 8;
+
+        const float kMaxQuantizedValue = float(std::numeric_limits<int16_t>::max());
+    }
+
+    CompressedVertexKeyframes::CompressedVertexKeyframes(const std::vector<double>& timeSamples, const std::vector<std::vector<PackedStaticVertexData>>& vertexData, const Options& options)
+        : mOptions(options)
+    {
+        FALCOR_ASSERT(!vertexData.empty() && vertexData.size() == timeSamples.size());
+
+        for (size_t i = 0; i < vertexData.size(); i++) addKeyframe(timeSamples[i], vertexData[i]);
+        finalize();
+    }
+
+    CompressedVertexKeyframes::CompressedVertexKeyframes(const std::vector<double>& timeSamples, const std::vector<std::vector<DynamicCurveVertexData>>& vertexData, const Options& options)
+        : mOptions(options)
+    {
+        FALCOR_ASSERT(!vertexData.empty() && vertexData.size() == timeSamples.size());
+
+        for (size_t i = 0; i < vertexData.size(); i++) addKeyframe(timeSamples[i], vertexData[i]);
+        finalize();
+    }
+
+    void CompressedVertexKeyframes::addKeyframe(double time, const std::vector<PackedStaticVertexData>& vertices)
+    {
+        if (mTimeSamples.empty()) mReferenceVertices = vertices;
+        FALCOR_ASSERT(hasNormals());
+
+        PendingKeyframe keyframe;
+        keyframe.time = time;
+        keyframe.positions.reserve(vertices.size());
+        keyframe.normals.reserve(vertices.size());
+        keyframe.tangents.reserve(vertices.size());
+        for (const auto& v : vertices)
+        {
+            uint32_t x = asuint(v.packedNormalTangentCurveRadius.x);
+            uint32_t y = asuint(v.packedNormalTangentCurveRadius.y);
+            float3 normal = float3(f16tof32(x & 0xffff), f16tof32(x >> 16), f16tof32(y & 0xffff));
+            float len = glm::length(normal);
+            keyframe.positions.push_back(v.position);
+            keyframe.normals.push_back(encodeNormal2x16(len > 0.f ? normal / len : float3(0.f, 0.f, 1.f)));
+            keyframe.tangents.push_back(asuint(v.packedNormalTangentCurveRadius.z));
+        }
+        addPendingKeyframe(std::move(keyframe));
+    }
+
+    void CompressedVertexKeyframes::addKeyframe(double time, const std::vector<DynamicCurveVertexData>& vertices)
+    {
+        FALCOR_ASSERT(!hasNormals());
+
+        PendingKeyframe keyframe;
+        keyframe.time = time;
+        keyframe.positions.reserve(vertices.size());
+        for (const auto& v : vertices) keyframe.positions.push_back(v.position);
+        addPendingKeyframe(std::move(keyframe));
+    }
+
+    void CompressedVertexKeyframes::addPendingKeyframe(PendingKeyframe&& keyframe)
+    {
+        // The first keyframe is the reference pose and is always retained.
+        if (mTimeSamples.empty())
+        {
+            mVertexCount = (uint32_t)keyframe.positions.size();
+            mReferencePositions = keyframe.positions;
+            compressKeyframe(keyframe);
+            mPending.push_back(std::move(keyframe));
+            return;
+        }
+
+        FALCOR_ASSERT(!mPending.empty() && keyframe.positions.size() == mVertexCount);
+        FALCOR_ASSERT(keyframe.time > mPending.back().time);
+
+        // The newest pending keyframe is dropped if all keyframes since the last retained one can be reconstructed
+        // within the error bound by interpolating the last retained keyframe and the added keyframe.
+        if (mPending.size() > 1)
+        {
+            const PendingKeyframe& lastKept = mPending.front();
+            bool keep = mOptions.maxDecimationError < 0.f || mPending.size() - 1 > kMaxDroppedKeyframes;
+            auto vertices = NumericRange<uint32_t>(0, mVertexCount);
+            for (size_t j = 1; j < mPending.size() && !keep; j++)
+            {
+                const PendingKeyframe& dropped = mPending[j];
+                float t = float((dropped.time - lastKept.time) / (keyframe.time - lastKept.time));
+                keep = !std::all_of(std::execution::par, vertices.begin(), vertices.end(), [&](uint32_t v)
+                {
+                    float3 p = lerp(lastKept.positions[v], keyframe.positions[v], t);
+                    return glm::length(p - dropped.positions[v]) <= mOptions.maxDecimationError;
+                });
+            }
+
+            if (keep)
+            {
+                compressKeyframe(mPending.back());
+                mPending.front() = std::move(mPending.back());
+                mPending.resize(1);
+            }
+        }
+
+        mPending.push_back(std::move(keyframe));
+    }
+
+    void CompressedVertexKeyframes::finalize()
+    {
+        // The last keyframe is always retained.
+        if (mPending.size() > 1) compressKeyframe(mPending.back());
+        mPending = {};
+    }
+
+    void CompressedVertexKeyframes::compressKeyframe(const PendingKeyframe& keyframe)
+    {
+        mTimeSamples.push_back(keyframe.time);
+
+        // Quantize the deltas to the reference pose with a per-keyframe range.
+        float3 minDelta(std::numeric_limits<float>::max());
+        float3 maxDelta(-std::numeric_limits<float>::max());
+        for (uint32_t v = 0; v < mVertexCount; v++)
+        {
+            float3 delta = keyframe.positions[v] - mReferencePositions[v];
+            minDelta = glm::min(minDelta, delta);
+            maxDelta = glm::max(maxDelta, delta);
+        }
+
+        KeyframeQuantization quantization;
+        quantization.offset = mVertexCount > 0 ? 0.5f * (minDelta + maxDelta) : float3(0.f);
+        quantization.scale = mVertexCount > 0 ? 0.5f * (maxDelta - minDelta) / kMaxQuantizedValue : float3(0.f);
+        float3 invScale = glm::mix(float3(0.f), 1.f / quantization.scale, glm::greaterThan(quantization.scale, float3(0.f)));
+        mQuantization.push_back(quantization);
+
+        mPositionDeltas.reserve(mPositionDeltas.size() + size_t(mVertexCount) * 3);
+        for (uint32_t v = 0; v < mVertexCount; v++)
+        {
+            float3 q = glm::round((keyframe.positions[v] - mReferencePositions[v] - quantization.offset) * invScale);
+            q = glm::clamp(q, float3(-kMaxQuantizedValue), float3(kMaxQuantizedValue));
+            mPositionDeltas.push_back((int16_t)q.x);
+            mPositionDeltas.push_back((int16_t)q.y);
+            mPositionDeltas.push_back((int16_t)q.z);
+        }
+
+        mNormals.insert(mNormals.end(), keyframe.normals.begin(), keyframe.normals.end());
+        mTangents.insert(mTangents.end(), keyframe.tangents.begin(), keyframe.tangents.end());
+    }
+
+    float3 CompressedVertexKeyframes::decodePosition(uint32_t keyframe, uint32_t vertex) const
+    {
+        const auto& quantization = mQuantization[keyframe];
+        const int16_t* pDelta = mPositionDeltas.data() + (size_t(keyframe) * mVertexCount + vertex) * 3;
+        return mReferencePositions[vertex] + quantization.offset + float3(pDelta[0], pDelta[1], pDelta[2]) * quantization.scale;
+    }
+
+    void CompressedVertexKeyframes::decode(uint32_t keyframe, PackedStaticVertexData* pDst) const
+    {
+        FALCOR_ASSERT(keyframe < getKeyframeCount() && hasNormals());
+
+        const size_t base = size_t(keyframe) * mVertexCount;
+        for (uint32_t v = 0; v < mVertexCount; v++)
+        {
+            const auto& ref = mReferenceVertices[v];
+            auto& dst = pDst[v];
+            dst.position = decodePosition(keyframe, v);
+            dst.texCrd = ref.texCrd;
+
+            // Tangent sign and curve radius are taken from the reference pose.
+            float3 normal = decodeNormal2x16(mNormals[base + v]);
+            uint32_t tangentW = asuint(ref.packedNormalTangentCurveRadius.y) & 0xffff0000;
+            dst.packedNormalTangentCurveRadius.x = asfloat(f32tof16(normal.x) | (f32tof16(normal.y) << 16));
+            dst.packedNormalTangentCurveRadius.y = asfloat(f32tof16(normal.z) | tangentW);
+            dst.packedNormalTangentCurveRadius.z = asfloat(mTangents[base + v]);
+        }
+    }
+
+    void CompressedVertexKeyframes::decode(uint32_t keyframe, DynamicCurveVertexData* pDst) const
+    {
+        FALCOR_ASSERT(keyframe < getKeyframeCount());
+
+        for (uint32_t v = 0; v < mVertexCount; v++) pDst[v].position = decodePosition(keyframe, v);
+    }
+
+    uint64_t CompressedVertexKeyframes::getMemoryUsageInBytes() const
+    {
+        uint64_t m = 0;
+        m += mTimeSamples.size() * sizeof(double);
+        m += mReferencePositions.size() * sizeof(float3);
+        m += mReferenceVertices.size() * sizeof(PackedStaticVertexData);
+        m += mQuantization.size() * sizeof(KeyframeQuantization);
+        m += mPositionDeltas.size() * sizeof(int16_t);
+        m += mNormals.size() * sizeof(uint32_t);
+        m += mTangents.size() * sizeof(uint32_t);
+        return m;
+    }
+
+    void KeyframeDecodeQueue::Task::cancel()
+    {
+        State expected = State::Queued;
+        mState.compare_exchange_strong(expected, State::Cancelled);
+    }
+
+    void KeyframeDecodeQueue::Task::wait()
+    {
+        // Run the task here rather than waiting for a worker to pick it up. A cancelled task is revived.
+        if (run(State::Queued) || run(State::Cancelled)) return;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]() { return mState == State::Done; });
+    }
+
+    bool KeyframeDecodeQueue::Task::run(State expected)
+    {
+        if (!mState.compare_exchange_strong(expected, State::Running)) return false;
+
+        execute();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mState = State::Done;
+        }
+        mDone.notify_all();
+        return true;
+    }
+
+    KeyframeDecodeQueue::KeyframeDecodeQueue(uint32_t threadCount)
+    {
+        FALCOR_ASSERT(threadCount > 0);
+        for (uint32_t i = 0; i < threadCount; i++) mThreads.emplace_back([this]() { workerMain(); });
+    }
+
+    KeyframeDecodeQueue::~KeyframeDecodeQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+            mTasks.clear();
+        }
+        mTaskAdded.notify_all();
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    void KeyframeDecodeQueue::push(std::shared_ptr<Task> pTask)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.push_back(std::move(pTask));
+        }
+        mTaskAdded.notify_one();
+    }
+
+    void KeyframeDecodeQueue::workerMain()
+    {
+        while (true)
+        {
+            std::shared_ptr<Task> pTask;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mTaskAdded.wait(lock, [this]() { return mStop || !mTasks.empty(); });
+                if (mStop) return;
+                pTask = std::move(mTasks.front());
+                mTasks.pop_front();
+            }
+
+            // Skips tasks that were cancelled or are already being executed by a waiting thread.
+            pTask->run(Task::State::Queued);
+        }
+    }
+}
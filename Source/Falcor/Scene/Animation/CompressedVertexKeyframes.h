@@ -0,0 +1,330 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Scene/SceneTypes.slang"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+    /** Compact CPU storage of vertex cache keyframes.
+
+        Positions are stored as 16-bit quantized deltas against a reference pose (the first keyframe), with a
+        per-keyframe offset and scale. For meshes, normals are stored octahedral encoded and tangents are kept in
+        their packed form; texture coordinates and tangent signs are taken from the reference pose.
+
+        Keyframes that can be reconstructed by linearly interpolating the neighboring retained keyframes within an
+        error bound are dropped. The first and last keyframes are always retained.
+
+        Keyframes are compressed as they are added, so that importers never hold more than a few uncompressed
+        keyframes per vertex cache.
+    */
+    class FALCOR_API CompressedVertexKeyframes
+    {
+    public:
+        struct Options
+        {
+            float maxDecimationError = 0.f;     ///< Maximum position error allowed when dropping keyframes. Exactly interpolable keyframes are dropped at zero, negative values disable decimation.
+        };
+
+        CompressedVertexKeyframes() = default;
+
+        /** Create an empty set of keyframes. Keyframes are added with addKeyframe() followed by a call to finalize().
+            \param[in] options Compression options.
+        */
+        explicit CompressedVertexKeyframes(const Options& options) : mOptions(options) {}
+
+        /** Compress mesh keyframes.
+            \param[in] timeSamples Time of each keyframe.
+            \param[in] vertexData Vertex data of each keyframe, all keyframes must have the same vertex count.
+            \param[in] options Compression options.
+        */
+        CompressedVertexKeyframes(const std::vector<double>& timeSamples, const std::vector<std::vector<PackedStaticVertexData>>& vertexData, const Options& options);
+
+        /** Compress curve keyframes.
+            \param[in] timeSamples Time of each keyframe.
+            \param[in] vertexData Vertex data of each keyframe, all keyframes must have the same vertex count.
+            \param[in] options Compression options.
+        */
+        CompressedVertexKeyframes(const std::vector<double>& timeSamples, const std::vector<std::vector<DynamicCurveVertexData>>& vertexData, const Options& options);
+
+        /** Add a mesh keyframe.
+            The keyframe is kept uncompressed until it is known whether it is retained, i.e., at most a few keyframes are pending.
+            \param[in] time Time of the keyframe, must be greater than the time of the previous keyframe.
+            \param[in] vertices Vertex data, must have the same vertex count as the first keyframe.
+        */
+        void addKeyframe(double time, const std::vector<PackedStaticVertexData>& vertices);
+
+        /** Add a curve keyframe.
+            \param[in] time Time of the keyframe, must be greater than the time of the previous keyframe.
+            \param[in] vertices Vertex data, must have the same vertex count as the first keyframe.
+        */
+        void addKeyframe(double time, const std::vector<DynamicCurveVertexData>& vertices);
+
+        /** Retain the last added keyframe and release the pending keyframes. Must be called after the last keyframe is added.
+        */
+        void finalize();
+
+        /** Returns the time samples of the retained keyframes.
+        */
+        const std::vector<double>& getTimeSamples() const { return mTimeSamples; }
+
+        uint32_t getKeyframeCount() const { return (uint32_t)mTimeSamples.size(); }
+        uint32_t getVertexCount() const { return mVertexCount; }
+        bool hasNormals() const { return !mReferenceVertices.empty(); }
+
+        /** Decode the vertices of a retained mesh keyframe.
+            \param[in] keyframe Index of the retained keyframe.
+            \param[out] pDst Output array with getVertexCount() elements.
+        */
+        void decode(uint32_t keyframe, PackedStaticVertexData* pDst) const;
+
+        /** Decode the vertex positions of a retained keyframe.
+            \param[in] keyframe Index of the retained keyframe.
+            \param[out] pDst Output array with getVertexCount() elements.
+        */
+        void decode(uint32_t keyframe, DynamicCurveVertexData* pDst) const;
+
+        uint64_t getMemoryUsageInBytes() const;
+
+    private:
+        struct KeyframeQuantization
+        {
+            float3 offset;      ///< Offset added to the dequantized delta.
+            float3 scale;       ///< Scale of the quantized delta.
+        };
+
+        /** Keyframe that is not compressed yet.
+        */
+        struct PendingKeyframe
+        {
+            double time = 0.0;
+            std::vector<float3> positions;
+            std::vector<uint32_t> normals;      ///< Octahedral encoded normals, empty for curves.
+            std::vector<uint32_t> tangents;     ///< Packed tangents, empty for curves.
+        };
+
+        void addPendingKeyframe(PendingKeyframe&& keyframe);
+        void compressKeyframe(const PendingKeyframe& keyframe);
+        float3 decodePosition(uint32_t keyframe, uint32_t vertex) const;
+
+        Options mOptions;
+        uint32_t mVertexCount = 0;
+        std::vector<double> mTimeSamples;
+        std::vector<float3> mReferencePositions;
+        std::vector<PackedStaticVertexData> mReferenceVertices;  ///< Reference pose of meshes, empty for curves.
+        std::vector<KeyframeQuantization> mQuantization;
+        std::vector<int16_t> mPositionDeltas;           ///< Three components per vertex per retained keyframe.
+        std::vector<uint32_t> mNormals;                 ///< Octahedral encoded normal per vertex per retained keyframe.
+        std::vector<uint32_t> mTangents;                ///< Packed tangent per vertex per retained keyframe.
+
+        /// Last retained keyframe followed by the keyframes that may still be dropped. Empty once finalized.
+        std::vector<PendingKeyframe> mPending;
+
+        friend class SceneCache;
+    };
+
+    /** Bounded pool of worker threads decoding keyframes.
+        Tasks are executed in submission order. Cancelled tasks that have not started are skipped,
+        tasks that are running when they are cancelled complete without anyone waiting for them.
+    */
+    class FALCOR_API KeyframeDecodeQueue
+    {
+    public:
+        class FALCOR_API Task
+        {
+        public:
+            virtual ~Task() = default;
+
+            /** Cancel the task. Does not block.
+            */
+            void cancel();
+
+            /** Wait for the task to complete. A task that has not started is executed on the calling thread.
+            */
+            void wait();
+
+            bool isDone() const { return mState == State::Done; }
+
+        protected:
+            virtual void execute() = 0;
+
+        private:
+            enum class State
+            {
+                Queued,
+                Cancelled,
+                Running,
+                Done,
+            };
+
+            /** Execute the task if it is in the given state.
+                \return True if the task was executed.
+            */
+            bool run(State expected);
+
+            std::atomic<State> mState = State::Queued;
+            std::mutex mMutex;
+            std::condition_variable mDone;
+
+            friend class KeyframeDecodeQueue;
+        };
+
+        /** Create a queue.
+            \param[in] threadCount Number of worker threads, at least one.
+        */
+        explicit KeyframeDecodeQueue(uint32_t threadCount);
+
+        /** Discard queued tasks and wait for the running tasks to complete.
+        */
+        ~KeyframeDecodeQueue();
+
+        KeyframeDecodeQueue(const KeyframeDecodeQueue&) = delete;
+        KeyframeDecodeQueue& operator=(const KeyframeDecodeQueue&) = delete;
+
+        void push(std::shared_ptr<Task> pTask);
+
+    private:
+        void workerMain();
+
+        std::vector<std::thread> mThreads;
+        std::deque<std::shared_ptr<Task>> mTasks;
+        std::mutex mMutex;
+        std::condition_variable mTaskAdded;
+        bool mStop = false;
+    };
+
+    /** Window of decoded keyframes around the current animation time.
+        Keyframes are decoded on demand and the following keyframes are prefetched on the decode queue.
+        Keyframes outside of the window are released, prefetches that are still in flight are cancelled without waiting.
+    */
+    template<typename T>
+    class VertexKeyframeWindow
+    {
+    public:
+        using DecodeFunc = std::function<void(uint32_t keyframe, std::vector<T>& vertices)>;
+
+        VertexKeyframeWindow() = default;
+
+        /** Create a window.
+            \param[in] keyframeCount Total number of keyframes.
+            \param[in] prefetchCount Number of keyframes decoded ahead of the requested ones.
+            \param[in] decode Function decoding a keyframe. Called concurrently from the worker threads of the queue.
+            \param[in] pQueue Queue used for prefetching. Must outlive the window. If null, keyframes are decoded when they are needed.
+        */
+        VertexKeyframeWindow(uint32_t keyframeCount, uint32_t prefetchCount, DecodeFunc decode, KeyframeDecodeQueue* pQueue)
+            : mKeyframeCount(keyframeCount)
+            , mPrefetchCount(prefetchCount)
+            , mDecode(std::move(decode))
+            , mpQueue(pQueue)
+        {}
+
+        /** Get the decoded vertices of a keyframe, waiting for them to be decoded if needed.
+        */
+        const std::vector<T>& get(uint32_t keyframe)
+        {
+            const auto& pTask = request(keyframe);
+            pTask->wait();
+            return pTask->vertices;
+        }
+
+        /** Release keyframes outside of the window starting at the given keyframe and start prefetching the next keyframes.
+            \param[in] first First keyframe in the window.
+            \param[in] last Last keyframe that is needed.
+        */
+        void update(uint32_t first, uint32_t last)
+        {
+            if (mKeyframeCount == 0) return;
+
+            // Keyframes [first, last + prefetchCount], wrapping around for looped animations.
+            uint32_t span = std::min(mKeyframeCount, (last + mKeyframeCount - first) % mKeyframeCount + 1 + mPrefetchCount);
+            auto inWindow = [&](uint32_t keyframe) { return (keyframe + mKeyframeCount - first) % mKeyframeCount < span; };
+
+            for (auto it = mDecoded.begin(); it != mDecoded.end();)
+            {
+                if (inWindow(it->first)) ++it;
+                else
+                {
+                    it->second->cancel();
+                    it = mDecoded.erase(it);
+                }
+            }
+
+            for (uint32_t i = 0; i < span; i++) request((first + i) % mKeyframeCount);
+        }
+
+        uint64_t getMemoryUsageInBytes() const
+        {
+            uint64_t m = 0;
+            for (const auto& it : mDecoded)
+            {
+                if (it.second->isDone()) m += it.second->vertices.size() * sizeof(T);
+            }
+            return m;
+        }
+
+    private:
+        struct DecodeTask : public KeyframeDecodeQueue::Task
+        {
+            DecodeFunc decode;
+            uint32_t keyframe = 0;
+            std::vector<T> vertices;
+
+            void execute() override { decode(keyframe, vertices); }
+        };
+
+        const std::shared_ptr<DecodeTask>& request(uint32_t keyframe)
+        {
+            auto it = mDecoded.find(keyframe);
+            if (it != mDecoded.end()) return it->second;
+
+            auto pTask = std::make_shared<DecodeTask>();
+            pTask->decode = mDecode;
+            pTask->keyframe = keyframe;
+            if (mpQueue) mpQueue->push(pTask);
+            return mDecoded.emplace(keyframe, std::move(pTask)).first->second;
+        }
+
+        uint32_t mKeyframeCount = 0;
+        uint32_t mPrefetchCount = 0;
+        DecodeFunc mDecode;
+        KeyframeDecodeQueue* mpQueue = nullptr;
+        std::map<uint32_t, std::shared_ptr<DecodeTask>> mDecoded;
+    };
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasBuildScheduler.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        uint64_t getFinalByteSize(const BlasBuildScheduler::BlasSizes& sizes)
+        {
+            return sizes.finalByteSize > 0 ? sizes.finalByteSize : sizes.resultByteSize;
+        }
+
+        /** Group under construction.
+        */
+        struct GroupBuilder
+        {
+            std::vector<std::vector<uint32_t>> batches;
+            std::vector<uint64_t> batchScratchByteSizes;
+            uint64_t resultByteSize = 0;
+            uint64_t scratchByteSize = 0;
+            uint64_t finalByteSize = 0;
+
+            /** Returns the batch to add a build to, i.e., the first one with enough scratch left, or the index of a new batch.
+            */
+            uint32_t findBatch(uint64_t scratchByteSize, uint64_t batchScratchBudget) const
+            {
+                for (uint32_t i = 0; i < (uint32_t)batches.size(); i++)
+                {
+                    if (batchScratchByteSizes[i] + scratchByteSize <= batchScratchBudget) return i;
+                }
+                return (uint32_t)batches.size();
+            }
+
+            uint64_t getBatchScratchByteSize(uint32_t batchIndex) const
+            {
+                return batchIndex < batchScratchByteSizes.size() ? batchScratchByteSizes[batchIndex] : 0;
+            }
+
+            void add(uint32_t blasIndex, const BlasBuildScheduler::BlasSizes& sizes, uint32_t batchIndex)
+            {
+                if (batchIndex == batches.size())
+                {
+                    batches.emplace_back();
+                    batchScratchByteSizes.push_back(0);
+                }
+                batches[batchIndex].push_back(blasIndex);
+                batchScratchByteSizes[batchIndex] += sizes.scratchByteSize;
+                resultByteSize += sizes.resultByteSize;
+                scratchByteSize = std::max(scratchByteSize, batchScratchByteSizes[batchIndex]);
+                finalByteSize += getFinalByteSize(sizes);
+            }
+        };
+    }
+
+    BlasBuildScheduler::Schedule BlasBuildScheduler::createSchedule(const std::vector<BlasSizes>& blasSizes, const Options& options)
+    {
+        for (const auto& sizes : blasSizes)
+        {
+            if (sizes.resultByteSize == 0 || sizes.scratchByteSize == 0) throw ArgumentError("BLAS result and scratch sizes must be non-zero");
+        }
+
+        // Sort the BLASes by decreasing memory footprint for first-fit decreasing packing.
+        // Ties are broken by index to make the schedule deterministic.
+        std::vector<uint32_t> order(blasSizes.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto getFootprint = [&](uint32_t i) { return blasSizes[i].resultByteSize + blasSizes[i].scratchByteSize + getFinalByteSize(blasSizes[i]); };
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return getFootprint(a) > getFootprint(b); });
+
+        // Place each BLAS in the first group where it fits within the budget.
+        std::vector<GroupBuilder> groups;
+        for (uint32_t blasIndex : order)
+        {
+            const auto& sizes = blasSizes[blasIndex];
+            const uint64_t resultAndFinal = sizes.resultByteSize + getFinalByteSize(sizes);
+
+            bool placed = false;
+            for (auto& group : groups)
+            {
+                // Early out if the group is full even without counting additional scratch.
+                if (group.resultByteSize + group.finalByteSize + group.scratchByteSize + resultAndFinal > options.memoryBudget) continue;
+
+                uint32_t batchIndex = group.findBatch(sizes.scratchByteSize, options.batchScratchBudget);
+                uint64_t scratchByteSize = std::max(group.scratchByteSize, group.getBatchScratchByteSize(batchIndex) + sizes.scratchByteSize);
+                if (group.resultByteSize + group.finalByteSize + scratchByteSize + resultAndFinal > options.memoryBudget) continue;
+
+                group.add(blasIndex, sizes, batchIndex);
+                placed = true;
+                break;
+            }
+
+            if (!placed)
+            {
+                groups.emplace_back();
+                groups.back().add(blasIndex, sizes, 0);
+            }
+        }
+
+        // Assign buffer regions. Builds are issued in batch order, and by BLAS index within a batch.
+        Schedule schedule;
+        schedule.groups.resize(groups.size());
+        schedule.placements.resize(blasSizes.size());
+
+        for (uint32_t groupIndex = 0; groupIndex < (uint32_t)groups.size(); groupIndex++)
+        {
+            auto& builder = groups[groupIndex];
+            auto& group = schedule.groups[groupIndex];
+            group.batchCount = (uint32_t)builder.batches.size();
+
+            for (uint32_t batchIndex = 0; batchIndex < group.batchCount; batchIndex++)
+            {
+                auto& batch = builder.batches[batchIndex];
+                std::sort(batch.begin(), batch.end());
+
+                uint64_t scratchByteOffset = 0;
+                for (uint32_t blasIndex : batch)
+                {
+                    const auto& sizes = blasSizes[blasIndex];
+                    auto& placement = schedule.placements[blasIndex];
+                    placement.groupIndex = groupIndex;
+                    placement.batchIndex = batchIndex;
+                    placement.resultByteOffset = group.resultByteSize;
+                    placement.scratchByteOffset = scratchByteOffset;
+
+                    group.blasIndices.push_back(blasIndex);
+                    group.resultByteSize += sizes.resultByteSize;
+                    group.finalByteSize += getFinalByteSize(sizes);
+                    scratchByteOffset += sizes.scratchByteSize;
+                }
+                group.scratchByteSize = std::max(group.scratchByteSize, scratchByteOffset);
+            }
+            FALCOR_ASSERT(group.scratchByteSize == builder.scratchByteSize);
+
+            schedule.resultByteSize = std::max(schedule.resultByteSize, group.resultByteSize);
+            schedule.scratchByteSize = std::max(schedule.scratchByteSize, group.scratchByteSize);
+            schedule.peakBuildMemory = std::max(schedule.peakBuildMemory, group.getBuildMemory());
+        }
+
+        return schedule;
+    }
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Plans the build of a set of BLASes under a memory budget.
+
+        BLASes are built in groups. All groups share one intermediate result buffer and one scratch buffer,
+        so the regions of these buffers are aliased between groups. After each group is built, its BLASes are
+        compacted or cloned into a final buffer owned by the group, after which the intermediate buffers can be reused.
+
+        Within a group, builds are issued in batches. Builds in the same batch may execute concurrently and use
+        disjoint scratch regions, while builds in different batches are separated by a barrier and alias their scratch.
+        This keeps the scratch buffer small without serializing every build.
+
+        The planner packs BLASes into as few groups as possible using first-fit decreasing bin packing. The memory
+        used while building a group is the sum of its intermediate results, its peak batch scratch and its final BLASes.
+        The budget is not a strict limit, a BLAS that exceeds it on its own is placed in a group by itself.
+    */
+    class FALCOR_API BlasBuildScheduler
+    {
+    public:
+        /** Sizes of a single BLAS build. All sizes should include alignment padding.
+        */
+        struct BlasSizes
+        {
+            uint64_t resultByteSize = 0;    ///< Size of the build result.
+            uint64_t scratchByteSize = 0;   ///< Size of the scratch data needed for the build and later updates.
+            uint64_t finalByteSize = 0;     ///< Estimated size of the final BLAS, e.g., after compaction. Zero uses the result size.
+        };
+
+        struct Options
+        {
+            uint64_t memoryBudget = 1ull << 29;         ///< Target memory used while building one group.
+            uint64_t batchScratchBudget = 1ull << 27;   ///< Target scratch memory used by one batch of builds.
+        };
+
+        /** Location of a BLAS in the build schedule.
+        */
+        struct Placement
+        {
+            uint32_t groupIndex = 0;        ///< Index of the group building the BLAS.
+            uint32_t batchIndex = 0;        ///< Index of the batch within the group.
+            uint64_t resultByteOffset = 0;  ///< Offset into the intermediate result buffer.
+            uint64_t scratchByteOffset = 0; ///< Offset into the scratch buffer.
+        };
+
+        struct Group
+        {
+            std::vector<uint32_t> blasIndices;  ///< Indices of the BLASes in build order, sorted by batch.
+            uint32_t batchCount = 0;            ///< Number of build batches.
+            uint64_t resultByteSize = 0;        ///< Size of the intermediate results of all BLASes in the group.
+            uint64_t scratchByteSize = 0;       ///< Peak scratch size over all batches.
+            uint64_t finalByteSize = 0;         ///< Estimated size of the final BLASes.
+
+            /** Returns the estimated memory used while building the group.
+            */
+            uint64_t getBuildMemory() const { return resultByteSize + scratchByteSize + finalByteSize; }
+        };
+
+        struct Schedule
+        {
+            std::vector<Group> groups;              ///< Groups in build order.
+            std::vector<Placement> placements;      ///< Placement per BLAS.
+            uint64_t resultByteSize = 0;            ///< Required size of the intermediate result buffer.
+            uint64_t scratchByteSize = 0;           ///< Required size of the scratch buffer.
+            uint64_t peakBuildMemory = 0;           ///< Largest estimated memory used while building a group.
+        };
+
+        /** Create a build schedule.
+            \param[in] blasSizes Sizes per BLAS. All result and scratch sizes must be non-zero.
+            \param[in] options Memory budgets.
+            \return The build schedule. Every BLAS is placed in exactly one group.
+        */
+        static Schedule createSchedule(const std::vector<BlasSizes>& blasSizes, const Options& options);
+
+        static Schedule createSchedule(const std::vector<BlasSizes>& blasSizes) { return createSchedule(blasSizes, Options()); }
+    };
+}
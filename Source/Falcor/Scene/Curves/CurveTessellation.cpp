@@ -31,8 +31,11 @@
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/Matrix/Matrix.h"
+#include "Utils/NumericRange.h"
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
 #include <cmath>
+#include <execution>
 
 namespace Falcor
 {
@@ -74,6 +77,9 @@ namespace Falcor
         // To achieve curveWidth on average, however, we need to scale the initial curveWidth by 1.11 (the number was deducted numerically).
         const float kMeshCompensationScale = 1.11f;
 
+        // Number of strands tessellated by one task.
+        const uint32_t kStrandsPerChunk = 64;
+
         float4 transformSphere(const rmcv::mat4& xform, const float4& sphere)
         {
             // Spheres are represented as (center.x, center.y, center.z, radius).
@@ -191,7 +197,7 @@ namespace Falcor
             t = glm::rotate(rotQuat, t);
         }
 
-        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, const float& widthScale, uint32_t j)
+        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, uint32_t meshVertexOffset, uint32_t j)
         {
             // Mesh vertices, normals, tangents, and texCrds (if any).
             for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
@@ -200,32 +206,131 @@ namespace Falcor
                 float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
                 float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
-                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
-                result.normals.push_back(vNormal);
-                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                result.radii.push_back(curveRadius);
+                uint32_t vertexIndex = meshVertexOffset + j * pointCountPerCrossSection + k;
+                result.vertices[vertexIndex] = optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal;
+                result.normals[vertexIndex] = vNormal;
+                result.tangents[vertexIndex] = float4(fwd.x, fwd.y, fwd.z, 1);
+                result.radii[vertexIndex] = curveRadius;
 
                 if (curveArrays.UVs)
                 {
-                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+                    result.texCrds[vertexIndex] = optimizedStrandArrays.UVs[j];
                 }
             }
         }
 
-        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
+        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t faceOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
         {
+            uint32_t face = faceOffset + 2 * j * quadCountLimit;
             for (uint32_t k = 0; k < quadCountLimit; k++)
             {
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k);
+                result.faceVertexCounts[face] = 3;
+                result.faceVertexIndices[3 * face + 0] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                result.faceVertexIndices[3 * face + 1] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                result.faceVertexIndices[3 * face + 2] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                face++;
+
+                result.faceVertexCounts[face] = 3;
+                result.faceVertexIndices[3 * face + 0] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                result.faceVertexIndices[3 * face + 1] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                result.faceVertexIndices[3 * face + 2] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k;
+                face++;
+            }
+        }
+
+        /** Output layout of the strands kept after strand decimation.
+            Tessellation runs in two passes: the number of output points of each strand is counted and prefix summed first,
+            then all strands are tessellated in parallel directly into their preallocated ranges of the result arrays.
+        */
+        struct StrandLayout
+        {
+            std::vector<uint32_t> inputOffsets;     ///< Offset of the first control point of each kept strand in the input arrays.
+            std::vector<uint32_t> outputOffsets;    ///< Offset of the first output point of each kept strand, with the total count appended.
+            uint32_t maxVertexCountPerStrand = 0;
+
+            uint32_t getStrandCount() const { return (uint32_t)inputOffsets.size(); }
+            uint32_t getTotalPointCount() const { return outputOffsets.back(); }
+            uint32_t getPointCount(uint32_t strand) const { return outputOffsets[strand + 1] - outputOffsets[strand]; }
+        };
+
+        StrandLayout computeStrandLayout(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            StrandLayout layout;
+            uint32_t keptStrandCount = div_round_up(strandCount, keepOneEveryXStrands);
+            layout.inputOffsets.resize(keptStrandCount);
+            layout.outputOffsets.resize(keptStrandCount + 1);
+
+            uint32_t pointOffset = 0;
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0)
+                {
+                    layout.inputOffsets[i / keepOneEveryXStrands] = pointOffset;
+                    layout.maxVertexCountPerStrand = std::max(layout.maxVertexCountPerStrand, vertexCountsPerStrand[i]);
+                }
+                pointOffset += vertexCountsPerStrand[i];
+            }
+
+            // Count the output points of each strand. This has to match optimizeStrandGeometry(), which removes duplicate control points.
+            auto range = NumericRange<uint32_t>(0, keptStrandCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t strand)
+            {
+                const float3* strandPoints = controlPoints + layout.inputOffsets[strand];
+                uint32_t vertexCount = vertexCountsPerStrand[strand * keepOneEveryXStrands];
+                uint32_t uniqueCount = 1;
+                for (uint32_t j = 0; j < vertexCount - 1; j++)
+                {
+                    if (strandPoints[j] != strandPoints[j + 1]) uniqueCount++;
+                }
+                layout.outputOffsets[strand] = div_round_up(subdivPerSegment * (uniqueCount - 1), keepOneEveryXVerticesPerStrand) + 1;
+            });
+
+            // Exclusive prefix sum.
+            uint32_t outputOffset = 0;
+            for (uint32_t strand = 0; strand <= keptStrandCount; strand++)
+            {
+                uint32_t count = strand < keptStrandCount ? layout.outputOffsets[strand] : 0;
+                layout.outputOffsets[strand] = outputOffset;
+                outputOffset += count;
             }
+
+            return layout;
+        }
+
+        /** Tessellate the kept strands in parallel. Strands are processed in chunks, each chunk with its own scratch arrays.
+            \param[in] func Function called as func(strand, strandArrays, optimizedStrandArrays, splineCache) after optimizeStrandGeometry().
+        */
+        template<typename Func>
+        void forEachStrandParallel(const StrandLayout& layout, const CurveArrays& curveArrays, const uint32_t* vertexCountsPerStrand, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, Func func)
+        {
+            const uint32_t chunkCount = div_round_up(layout.getStrandCount(), kStrandsPerChunk);
+
+            auto range = NumericRange<uint32_t>(0, chunkCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t chunk)
+            {
+                StrandArrays strandArrays;
+                strandArrays.controlPoints.reserve(layout.maxVertexCountPerStrand);
+                strandArrays.widths.reserve(layout.maxVertexCountPerStrand);
+                strandArrays.UVs.reserve(layout.maxVertexCountPerStrand);
+
+                StrandArrays optimizedStrandArrays;
+                CubicSplineCache splineCache;
+
+                const uint32_t lastStrand = std::min(layout.getStrandCount(), (chunk + 1) * kStrandsPerChunk);
+                for (uint32_t strand = chunk * kStrandsPerChunk; strand < lastStrand; strand++)
+                {
+                    optimizedStrandArrays.controlPoints.clear();
+                    optimizedStrandArrays.UVs.clear();
+                    optimizedStrandArrays.widths.clear();
+                    optimizedStrandArrays.vertexCount = 0;
+                    strandArrays.vertexCount = vertexCountsPerStrand[strand * keepOneEveryXStrands];
+
+                    optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, layout.inputOffsets[strand], subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+                    FALCOR_ASSERT(optimizedStrandArrays.controlPoints.size() == layout.getPointCount(strand));
+
+                    func(strand, strandArrays, optimizedStrandArrays, splineCache);
+                }
+            });
         }
     }
 
@@ -238,40 +343,22 @@ namespace Falcor
         FALCOR_ASSERT(degree == 1);
         result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
-
-        uint32_t pointOffset = 0;
+        // First pass: count output points per strand.
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t pointCount = layout.getTotalPointCount();
+        result.indices.resize(pointCount - layout.getStrandCount());
+        result.points.resize(pointCount);
+        result.radius.resize(pointCount);
+        if (UVs) result.texCrds.resize(pointCount);
 
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
+        // Second pass: tessellate strands into their output ranges.
         CurveArrays curveArrays(controlPoints, widths, UVs);
-
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        forEachStrandParallel(layout, curveArrays, vertexCountsPerStrand, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale,
+            [&](uint32_t strand, const StrandArrays& strandArrays, const StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
         {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
-
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            // Each strand has one segment less than points.
+            uint32_t pointIndex = layout.outputOffsets[strand];
+            uint32_t segmentIndex = pointIndex - strand;
 
             const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
             const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
@@ -284,13 +371,14 @@ namespace Falcor
                     if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                     {
                         float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
+                        result.indices[segmentIndex++] = pointIndex;
 
                         // Pre-transform curve points.
                         float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
 
-                        result.points.push_back(sph.xyz);
-                        result.radius.push_back(sph.w);
+                        result.points[pointIndex] = sph.xyz;
+                        result.radius[pointIndex] = sph.w;
+                        pointIndex++;
                     }
                     tmpCount++;
                 }
@@ -298,12 +386,14 @@ namespace Falcor
 
             // Always keep the last vertex.
             float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f), splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f) * 0.5f * widthScale));
-            result.points.push_back(sph.xyz);
-            result.radius.push_back(sph.w);
+            result.points[pointIndex] = sph.xyz;
+            result.radius[pointIndex] = sph.w;
+            FALCOR_ASSERT(pointIndex + 1 == layout.outputOffsets[strand + 1]);
 
             // Texture coordinates.
             if (UVs)
             {
+                uint32_t texCrdIndex = layout.outputOffsets[strand];
                 const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
                 tmpCount = 0;
                 for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
@@ -313,18 +403,16 @@ namespace Falcor
                         if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                         {
                             float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
+                            result.texCrds[texCrdIndex++] = splineUVs.interpolate(j, t);
                         }
                         tmpCount++;
                     }
                 }
 
                 // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                result.texCrds[texCrdIndex] = splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f);
             }
-
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+        });
 
         return result;
     }
@@ -332,47 +420,26 @@ namespace Falcor
     CurveTessellation::MeshResult CurveTessellation::convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
 
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        // First pass: count output cross-sections per strand.
+        StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t vertexCount = pointCountPerCrossSection * layout.getTotalPointCount();
+        const uint32_t faceCount = 2 * pointCountPerCrossSection * (layout.getTotalPointCount() - layout.getStrandCount());
+        result.vertices.resize(vertexCount);
+        result.normals.resize(vertexCount);
+        result.tangents.resize(vertexCount);
+        if (UVs) result.texCrds.resize(vertexCount);
+        result.radii.resize(vertexCount);
+        result.faceVertexCounts.resize(faceCount);
+        result.faceVertexIndices.resize(faceCount * 3);
+
+        // Second pass: tessellate strands into their output ranges.
+        CurveArrays curveArrays(controlPoints, widths, UVs);
+        forEachStrandParallel(layout, curveArrays, vertexCountsPerStrand, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale,
+            [&](uint32_t strand, const StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
         {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
-
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
-
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.outputOffsets[strand];
+            const uint32_t faceOffset = 2 * pointCountPerCrossSection * (layout.outputOffsets[strand] - strand);
 
             // Build the initial frame.
             float3 fwd, s, t;
@@ -386,20 +453,18 @@ namespace Falcor
                 updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
 
                 // Mesh vertices, normals, tangents, and texCrds (if any).
-                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, widthScale, j);
+                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, meshVertexOffset, j);
 
                 // Mesh faces.
                 if (j < optimizedStrandArrays.controlPoints.size() - 1)
                 {
                     uint32_t quadCountLimit = pointCountPerCrossSection;
-                    connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
+                    connectFaceVertices(result, meshVertexOffset, faceOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
                 }
             }
+        });
 
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)optimizedStrandArrays.controlPoints.size();
-        }
         return result;
     }
 
-
 }
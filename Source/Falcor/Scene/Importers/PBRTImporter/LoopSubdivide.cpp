@@ -34,12 +34,12 @@
 #include "LoopSubdivide.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
 
 #include <algorithm>
-#include <map>
-#include <memory>
-#include <memory_resource>
-#include <set>
+#include <execution>
+#include <limits>
 
 #include <cmath>
 
@@ -47,482 +47,482 @@ namespace Falcor
 {
     namespace pbrt
     {
-        struct SDFace;
-        struct SDVertex;
-
-        #define NEXT(i) (((i) + 1) % 3)
-        #define PREV(i) (((i) + 2) % 3)
-
-        struct SDVertex
+        namespace
         {
-            SDVertex(const float3& p = float3(0.f)) : p(p) {}
+            #define NEXT(i) (((i) + 1) % 3)
+            #define PREV(i) (((i) + 2) % 3)
 
-            int valence();
-            void oneRing(float3 *p);
+            const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
 
-            float3 p;
-            SDFace* startFace = nullptr;
-            SDVertex* child = nullptr;
-            bool regular = false;
-            bool boundary = false;
-        };
+            /// Minimum number of elements for loops to run in parallel.
+            const size_t kMinParallelCount = 4096;
 
-        struct SDFace
-        {
-            SDFace()
-            {
-                for (uint32_t i = 0; i < 3; ++i)
-                {
-                    v[i] = nullptr;
-                    f[i] = nullptr;
-                }
-                for (uint32_t i = 0; i < 4; ++i)
-                {
-                    children[i] = nullptr;
-                }
-            }
+            /// Number of vertices processed per task when per-task scratch memory is needed.
+            const size_t kChunkSize = 4096;
 
-            uint32_t vnum(SDVertex* vert) const
+            template<typename Func>
+            void parallelFor(size_t count, const Func& func)
             {
-                for (int i = 0; i < 3; ++i)
+                if (count < kMinParallelCount)
                 {
-                    if (v[i] == vert) return i;
+                    for (size_t i = 0; i < count; ++i) func(i);
                 }
-                throw RuntimeError("Basic logic error in SDFace::vnum().");
-            }
-
-            SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-            SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-            SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-            SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-            SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
-            {
-                for (uint32_t i = 0; i < 3; ++i)
+                else
                 {
-                    if (v[i] != v0 && v[i] != v1) return v[i];
+                    auto range = NumericRange<size_t>(0, count);
+                    std::for_each(std::execution::par, range.begin(), range.end(), func);
                 }
-                throw RuntimeError("Basic logic error in SDFace::otherVert()");
-            }
-
-            SDVertex* v[3];
-            SDFace* f[3];
-            SDFace* children[4];
-        };
-
-        struct SDEdge
-        {
-            SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
-            {
-                v[0] = std::min(v0, v1);
-                v[1] = std::max(v0, v1);
-                f[0] = f[1] = nullptr;
-                f0edgeNum = -1;
-            }
-
-            bool operator<(const SDEdge &e2) const
-            {
-                if (v[0] == e2.v[0]) return v[1] < e2.v[1];
-                return v[0] < e2.v[0];
             }
 
-            SDVertex* v[2];
-            SDFace* f[2];
-            int f0edgeNum;
-        };
-
-        static float3 weightOneRing(SDVertex* vert, float beta);
-        static float3 weightBoundary(SDVertex* vert, float beta);
-
-        inline int SDVertex::valence()
-        {
-            SDFace* f = startFace;
-            if (!boundary)
+            /** Triangle mesh with face adjacency stored in flat arrays.
+                Faces store their vertices and the neighbor across each edge, where edge i connects vertices i and NEXT(i).
+                Each vertex references one of its faces, from which its one-ring is traversed.
+            */
+            struct SubdivisionMesh
             {
-                // Compute valence of interior vertex.
-                int nf = 1;
-                while ((f = f->nextFace(this)) != startFace) ++nf;
-                return nf;
-            }
-            else
-            {
-                // Compute valence of boundary vertex
-                int nf = 1;
-                while ((f = f->nextFace(this)) != nullptr) ++nf;
-                f = startFace;
-                while ((f = f->prevFace(this)) != nullptr) ++nf;
-                return nf + 1;
-            }
-        }
+                std::vector<float3> positions;
+                std::vector<uint32_t> startFaces;
+                std::vector<uint8_t> regular;
+                std::vector<uint8_t> boundary;
 
-        inline float beta(uint32_t valence)
-        {
-            if (valence == 3)
-                return 3.f / 16.f;
-            else
-                return 3.f / (8.f * valence);
-        }
+                std::vector<uint32_t> faceVertices;     ///< Three vertices per face.
+                std::vector<uint32_t> faceNeighbors;    ///< Three neighbor faces per face, kInvalidIndex on boundaries.
 
-        inline float loopGamma(uint32_t valence)
-        {
-            return 1.f / (valence + 3.f / (8.f * beta(valence)));
-        }
+                uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+                uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
-        {
-            std::vector<SDVertex*> vertices;
-            std::vector<SDFace*> faces;
-
-            // Allocate vertices and faces.
-            std::unique_ptr<SDVertex[]> verts = std::make_unique<SDVertex[]>(positions.size());
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                verts[i] = SDVertex(positions[i]);
-                vertices.push_back(&verts[i]);
-            }
-            size_t faceCount = indices.size() / 3;
-            std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                faces.push_back(&fs[i]);
-            }
-
-            // Set face to vertex pointers.
-            const uint32_t* vp = indices.data();
-            for (size_t i = 0; i < faceCount; ++i, vp += 3)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t j = 0; j < 3; ++j)
+                void resize(uint32_t vertexCount, uint32_t faceCount)
                 {
-                    SDVertex* v = vertices[vp[j]];
-                    f->v[j] = v;
-                    v->startFace = f;
+                    positions.resize(vertexCount);
+                    startFaces.resize(vertexCount);
+                    regular.resize(vertexCount);
+                    boundary.resize(vertexCount);
+                    faceVertices.resize(faceCount * 3);
+                    faceNeighbors.resize(faceCount * 3);
                 }
-            }
 
-            // Set neighbor pointers in faces.
-            std::set<SDEdge> edges;
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+                uint32_t vnum(uint32_t face, uint32_t vertex) const
                 {
-                    // Update neighbor pointer for edgeNum.
-                    int v0 = edgeNum, v1 = NEXT(edgeNum);
-                    SDEdge e(f->v[v0], f->v[v1]);
-                    if (edges.find(e) == edges.end())
-                    {
-                        // Handle new edge.
-                        e.f[0] = f;
-                        e.f0edgeNum = edgeNum;
-                        edges.insert(e);
-                    }
-                    else
+                    for (uint32_t i = 0; i < 3; ++i)
                     {
-                        // Handle previously seen edge.
-                        e =* edges.find(e);
-                        e.f[0]->f[e.f0edgeNum] = f;
-                        f->f[edgeNum] = e.f[0];
-                        edges.erase(e);
+                        if (faceVertices[face * 3 + i] == vertex) return i;
                     }
+                    throw RuntimeError("Basic logic error in SubdivisionMesh::vnum().");
                 }
-            }
 
-            // Finish vertex initialization.
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                SDVertex* v = vertices[i];
-                SDFace* f = v->startFace;
-                do
+                uint32_t nextFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[face * 3 + vnum(face, vertex)]; }
+                uint32_t prevFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[face * 3 + PREV(vnum(face, vertex))]; }
+                uint32_t nextVert(uint32_t face, uint32_t vertex) const { return faceVertices[face * 3 + NEXT(vnum(face, vertex))]; }
+                uint32_t prevVert(uint32_t face, uint32_t vertex) const { return faceVertices[face * 3 + PREV(vnum(face, vertex))]; }
+                uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
                 {
-                    f = f->nextFace(v);
-                } while ((f != nullptr) && f != v->startFace);
-                v->boundary = (f == nullptr);
-                if (!v->boundary && v->valence() == 6) v->regular = true;
-                else if (v->boundary && v->valence() == 4) v->regular = true;
-                else v->regular = false;
-            }
-
-            // Refine LoopSubdiv into triangles.
-            std::vector<SDFace*> f = faces;
-            std::vector<SDVertex*> v = vertices;
-
-            std::pmr::monotonic_buffer_resource buffer;
-            std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-            std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
-
-            for (size_t i = 0; i < levels; ++i)
-            {
-                // Update f and v for next level of subdivision.
-                std::vector<SDFace*> newFaces;
-                std::vector<SDVertex*> newVertices;
-
-                // Allocate next level of children in mesh tree.
-                for (SDVertex* vertex : v)
-                {
-                    vertex->child = vertexAllocator.allocate(1);
-                    vertex->child->regular = vertex->regular;
-                    vertex->child->boundary = vertex->boundary;
-                    newVertices.push_back(vertex->child);
-                }
-                for (SDFace* face : f)
-                {
-                    for (uint32_t k = 0; k < 4; ++k)
+                    for (uint32_t i = 0; i < 3; ++i)
                     {
-                        face->children[k] = faceAllocator.allocate(1);
-                        newFaces.push_back(face->children[k]);
+                        uint32_t v = faceVertices[face * 3 + i];
+                        if (v != v0 && v != v1) return v;
                     }
+                    throw RuntimeError("Basic logic error in SubdivisionMesh::otherVert()");
                 }
 
-                // Update vertex positions and create new edge vertices.
-
-                // Update vertex positions for even vertices.
-                for (SDVertex* vertex : v)
+                uint32_t valence(uint32_t vertex) const
                 {
-                    if (!vertex->boundary)
+                    uint32_t f = startFaces[vertex];
+                    if (!boundary[vertex])
                     {
-                        // Apply one-ring rule for even vertex.
-                        if (vertex->regular) vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                        else vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
+                        // Compute valence of interior vertex.
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != startFaces[vertex]) ++nf;
+                        return nf;
                     }
                     else
                     {
-                        // Apply boundary rule for even vertex.
-                        vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                        // Compute valence of boundary vertex
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != kInvalidIndex) ++nf;
+                        f = startFaces[vertex];
+                        while ((f = prevFace(f, vertex)) != kInvalidIndex) ++nf;
+                        return nf + 1;
                     }
                 }
 
-                // Compute new odd edge vertices.
-                std::map<SDEdge, SDVertex*> edgeVerts;
-                for (SDFace* face : f)
+                /** Visit the one-ring vertices in order.
+                    \param[in] vertex Vertex index.
+                    \param[in] func Function called with the ring index and position of each one-ring vertex.
+                */
+                template<typename Func>
+                void oneRing(uint32_t vertex, const Func& func) const
                 {
-                    for (uint32_t k = 0; k < 3; ++k)
+                    uint32_t i = 0;
+                    if (!boundary[vertex])
                     {
-                        // Compute odd vertex on kth edge.
-                        SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                        SDVertex* vert = edgeVerts[edge];
-                        if (vert == nullptr)
+                        // Get one-ring vertices for interior vertex.
+                        uint32_t face = startFaces[vertex];
+                        do
                         {
-                            // Create and initialize new odd vertex
-                            vert = vertexAllocator.allocate(1);
-                            newVertices.push_back(vert);
-                            vert->regular = true;
-                            vert->boundary = (face->f[k] == nullptr);
-                            vert->startFace = face->children[3];
-
-                            // Apply edge rules to compute new vertex position
-                            if (vert->boundary)
-                            {
-                                vert->p = 0.5f * edge.v[0]->p;
-                                vert->p += 0.5f * edge.v[1]->p;
-                            }
-                            else
-                            {
-                                vert->p = 3.f / 8.f * edge.v[0]->p;
-                                vert->p += 3.f / 8.f * edge.v[1]->p;
-                                vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                                vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                            }
-                            edgeVerts[edge] = vert;
+                            func(i++, positions[nextVert(face, vertex)]);
+                            face = nextFace(face, vertex);
+                        } while (face != startFaces[vertex]);
+                    }
+                    else
+                    {
+                        // Get one-ring vertices for boundary vertex.
+                        uint32_t face = startFaces[vertex];
+                        uint32_t f2;
+                        while ((f2 = nextFace(face, vertex)) != kInvalidIndex)
+                        {
+                            face = f2;
                         }
+                        func(i++, positions[nextVert(face, vertex)]);
+                        do
+                        {
+                            func(i++, positions[prevVert(face, vertex)]);
+                            face = prevFace(face, vertex);
+                        } while (face != kInvalidIndex);
                     }
                 }
 
-                // Update new mesh topology.
-
-                // Update even vertex face pointers.
-                for (SDVertex* vertex : v)
+                float3 weightOneRing(uint32_t vertex, float beta) const
                 {
-                    int vertNum = vertex->startFace->vnum(vertex);
-                    vertex->child->startFace = vertex->startFace->children[vertNum];
+                    uint32_t valence = this->valence(vertex);
+                    float3 p = (1 - valence * beta) * positions[vertex];
+                    oneRing(vertex, [&](uint32_t, const float3& q) { p += beta * q; });
+                    return p;
                 }
 
-                // Update face neighbor pointers.
-                for (SDFace* face : f)
+                float3 weightBoundary(uint32_t vertex, float beta) const
                 {
-                    for (uint32_t j = 0; j < 3; ++j)
+                    uint32_t valence = this->valence(vertex);
+                    float3 first, last;
+                    oneRing(vertex, [&](uint32_t i, const float3& q)
                     {
-                        // Update children f pointers for siblings.
-                        face->children[3]->f[j] = face->children[NEXT(j)];
-                        face->children[j]->f[NEXT(j)] = face->children[3];
+                        if (i == 0) first = q;
+                        if (i == valence - 1) last = q;
+                    });
+                    float3 p = (1 - 2 * beta) * positions[vertex];
+                    p += beta * first;
+                    p += beta * last;
+                    return p;
+                }
+            };
+
+            /** Group the face edges by their (unordered) vertex pair.
+                Face edge e = 3 * face + i connects the face vertices i and NEXT(i). Edges are bucketed by their smaller
+                vertex index, within a bucket they are listed in face edge order. Buckets are small (the vertex valence)
+                and are processed independently.
+            */
+            struct EdgeBuckets
+            {
+                std::vector<uint32_t> offsets;      ///< Offset of each bucket, one per vertex plus one.
+                std::vector<uint32_t> faceEdges;    ///< Face edges of all buckets.
+                std::vector<uint32_t> otherVertex;  ///< Larger vertex index of each bucket entry.
 
-                        // Update children f pointers for neighbor children.
-                        SDFace* f2 = face->f[j];
-                        face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                        f2 = face->f[PREV(j)];
-                        face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
+                EdgeBuckets(const SubdivisionMesh& mesh)
+                {
+                    const uint32_t vertexCount = mesh.getVertexCount();
+                    const uint32_t edgeCount = (uint32_t)mesh.faceVertices.size();
+
+                    offsets.assign(vertexCount + 1, 0);
+                    for (uint32_t e = 0; e < edgeCount; ++e) offsets[getMinVertex(mesh, e) + 1]++;
+                    for (uint32_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+
+                    faceEdges.resize(edgeCount);
+                    otherVertex.resize(edgeCount);
+                    std::vector<uint32_t> counts(vertexCount, 0);
+                    for (uint32_t e = 0; e < edgeCount; ++e)
+                    {
+                        uint32_t v0 = mesh.faceVertices[e];
+                        uint32_t v1 = mesh.faceVertices[e - e % 3 + NEXT(e % 3)];
+                        uint32_t minVertex = std::min(v0, v1);
+                        uint32_t index = offsets[minVertex] + counts[minVertex]++;
+                        faceEdges[index] = e;
+                        otherVertex[index] = std::max(v0, v1);
                     }
                 }
 
-                // Update face vertex pointers.
-                for (SDFace* face : f)
+                static uint32_t getMinVertex(const SubdivisionMesh& mesh, uint32_t e)
                 {
-                    for (uint32_t j = 0; j < 3; ++j)
-                    {
-                        // Update child vertex pointer to new even vertex
-                        face->children[j]->v[j] = face->v[j]->child;
+                    return std::min(mesh.faceVertices[e], mesh.faceVertices[e - e % 3 + NEXT(e % 3)]);
+                }
+            };
 
-                        // Update child vertex pointer to new odd vertex
-                        SDVertex *vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                        face->children[j]->v[NEXT(j)] = vert;
-                        face->children[NEXT(j)]->v[j] = vert;
-                        face->children[3]->v[j] = vert;
-                    }
+            /** Set the face neighbors and vertex flags of the base mesh.
+                Face edges sharing a vertex pair are linked in face edge order, i.e., the first with the second, the third with the fourth and so on.
+            */
+            void initTopology(SubdivisionMesh& mesh)
+            {
+                const uint32_t vertexCount = mesh.getVertexCount();
+                const uint32_t faceCount = mesh.getFaceCount();
+
+                // Set face to vertex pointers, the last face referencing a vertex is its start face.
+                std::fill(mesh.startFaces.begin(), mesh.startFaces.end(), kInvalidIndex);
+                for (uint32_t i = 0; i < faceCount * 3; ++i) mesh.startFaces[mesh.faceVertices[i]] = i / 3;
+                for (uint32_t v = 0; v < vertexCount; ++v)
+                {
+                    if (mesh.startFaces[v] == kInvalidIndex) throw RuntimeError("Vertex {} is not referenced by any face.", v);
                 }
 
-                // Prepare for next level of subdivision
-                f = newFaces;
-                v = newVertices;
+                // Set neighbor pointers in faces.
+                std::fill(mesh.faceNeighbors.begin(), mesh.faceNeighbors.end(), kInvalidIndex);
+                EdgeBuckets buckets(mesh);
+                parallelFor(vertexCount, [&](size_t v)
+                {
+                    for (uint32_t i = buckets.offsets[v]; i < buckets.offsets[v + 1]; ++i)
+                    {
+                        for (uint32_t j = buckets.offsets[v]; j < i; ++j)
+                        {
+                            uint32_t e0 = buckets.faceEdges[j];
+                            if (buckets.otherVertex[j] != buckets.otherVertex[i] || mesh.faceNeighbors[e0] != kInvalidIndex) continue;
+
+                            // Handle previously seen edge.
+                            uint32_t e1 = buckets.faceEdges[i];
+                            mesh.faceNeighbors[e0] = e1 / 3;
+                            mesh.faceNeighbors[e1] = e0 / 3;
+                            break;
+                        }
+                    }
+                });
+
+                // Finish vertex initialization.
+                parallelFor(vertexCount, [&](size_t i)
+                {
+                    uint32_t v = (uint32_t)i;
+                    uint32_t f = mesh.startFaces[v];
+                    do
+                    {
+                        f = mesh.nextFace(f, v);
+                    } while (f != kInvalidIndex && f != mesh.startFaces[v]);
+                    mesh.boundary[v] = f == kInvalidIndex;
+                    uint32_t valence = mesh.valence(v);
+                    mesh.regular[v] = (!mesh.boundary[v] && valence == 6) || (mesh.boundary[v] && valence == 4);
+                });
             }
 
-            // Push vertices to limit surface.
-            std::vector<float3> pLimit(v.size());
-            for (size_t i = 0; i < v.size(); ++i)
+            inline float beta(uint32_t valence)
             {
-                if (v[i]->boundary) pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-                else pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
+                if (valence == 3)
+                    return 3.f / 16.f;
+                else
+                    return 3.f / (8.f * valence);
             }
-            for (size_t i = 0; i < v.size(); ++i)
+
+            inline float loopGamma(uint32_t valence)
             {
-                v[i]->p = pLimit[i];
+                return 1.f / (valence + 3.f / (8.f * beta(valence)));
             }
 
-            // Compute vertex tangents on limit surface.
-            std::vector<float3> Ns;
-            Ns.reserve(v.size());
-            std::vector<float3> pRing(16, float3());
-            for (SDVertex* vertex : v)
+            /** Refine the mesh by one level.
+                Child vertices of the even (existing) vertices keep their indices and are followed by the odd (edge)
+                vertices, in order of the first face edge they appear on. Face i is replaced by the faces 4i to 4i+3,
+                where child j < 3 touches vertex j and child 3 is the center face.
+            */
+            SubdivisionMesh subdivide(const SubdivisionMesh& mesh)
             {
-                float3 S(0.f);
-                float3 T(0.f);
-                uint32_t valence = vertex->valence();
-                if (valence > pRing.size()) pRing.resize(valence);
-                vertex->oneRing(&pRing[0]);
-                if (!vertex->boundary)
+                const uint32_t vertexCount = mesh.getVertexCount();
+                const uint32_t faceCount = mesh.getFaceCount();
+                const uint32_t edgeCount = faceCount * 3;
+
+                // Find the face edge creating the odd vertex of each face edge.
+                std::vector<uint32_t> leaderEdges(edgeCount);
+                EdgeBuckets buckets(mesh);
+                parallelFor(vertexCount, [&](size_t v)
                 {
-                    // Compute tangents of interior face
-                    for (uint32_t j = 0; j < valence; ++j)
+                    for (uint32_t i = buckets.offsets[v]; i < buckets.offsets[v + 1]; ++i)
                     {
-                        S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                        T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        uint32_t j = buckets.offsets[v];
+                        while (buckets.otherVertex[j] != buckets.otherVertex[i]) ++j;
+                        leaderEdges[buckets.faceEdges[i]] = buckets.faceEdges[j];
                     }
+                });
+
+                // Number the odd vertices.
+                std::vector<uint32_t> edgeVertices(edgeCount);
+                std::vector<uint32_t> oddEdges;
+                for (uint32_t e = 0; e < edgeCount; ++e)
+                {
+                    if (leaderEdges[e] != e) continue;
+                    edgeVertices[e] = vertexCount + (uint32_t)oddEdges.size();
+                    oddEdges.push_back(e);
                 }
-                else
+                for (uint32_t e = 0; e < edgeCount; ++e) edgeVertices[e] = edgeVertices[leaderEdges[e]];
+
+                SubdivisionMesh child;
+                child.resize(vertexCount + (uint32_t)oddEdges.size(), faceCount * 4);
+
+                // Update vertex positions for even vertices.
+                parallelFor(vertexCount, [&](size_t i)
                 {
-                    // Compute tangents of boundary face
-                    S = pRing[valence - 1] - pRing[0];
-                    if (valence == 2)
+                    uint32_t v = (uint32_t)i;
+                    if (!mesh.boundary[v])
                     {
-                        T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
+                        // Apply one-ring rule for even vertex.
+                        if (mesh.regular[v]) child.positions[v] = mesh.weightOneRing(v, 1.f / 16.f);
+                        else child.positions[v] = mesh.weightOneRing(v, beta(mesh.valence(v)));
                     }
-                    else if (valence == 3)
+                    else
                     {
-                        T = pRing[1] - vertex->p;
+                        // Apply boundary rule for even vertex.
+                        child.positions[v] = mesh.weightBoundary(v, 1.f / 8.f);
                     }
-                    else if (valence == 4) // regular
+
+                    // Update even vertex face pointers.
+                    uint32_t startFace = mesh.startFaces[v];
+                    child.startFaces[v] = startFace * 4 + mesh.vnum(startFace, v);
+                    child.regular[v] = mesh.regular[v];
+                    child.boundary[v] = mesh.boundary[v];
+                });
+
+                // Compute new odd edge vertices.
+                parallelFor(oddEdges.size(), [&](size_t i)
+                {
+                    uint32_t e = oddEdges[i];
+                    uint32_t face = e / 3;
+                    uint32_t v0 = mesh.faceVertices[e];
+                    uint32_t v1 = mesh.faceVertices[face * 3 + NEXT(e % 3)];
+                    uint32_t neighbor = mesh.faceNeighbors[e];
+
+                    uint32_t v = vertexCount + (uint32_t)i;
+                    child.regular[v] = true;
+                    child.boundary[v] = neighbor == kInvalidIndex;
+                    child.startFaces[v] = face * 4 + 3;
+
+                    // Apply edge rules to compute new vertex position
+                    float3& p = child.positions[v];
+                    if (child.boundary[v])
                     {
-                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
+                        p = 0.5f * mesh.positions[v0];
+                        p += 0.5f * mesh.positions[v1];
                     }
                     else
                     {
-                        float theta = float(M_PI) / float(valence - 1);
-                        T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                        for (uint32_t k = 1; k < valence - 1; ++k)
-                        {
-                            float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                            T += float3(wt * pRing[k]);
-                        }
-                        T = -T;
+                        p = 3.f / 8.f * mesh.positions[v0];
+                        p += 3.f / 8.f * mesh.positions[v1];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
                     }
-                }
-                Ns.push_back(cross(S, T));
-            }
+                });
 
-            // Create triangle mesh from subdivision mesh
-            {
-                size_t ntris = f.size();
-                std::vector<uint32_t> verts(3 * ntris);
-                uint32_t *vp = verts.data();
-                uint32_t totVerts = (uint32_t)v.size();
-                std::map<SDVertex*, uint32_t> usedVerts;
-                for (uint32_t i = 0; i < totVerts; ++i)
-                {
-                    usedVerts[v[i]] = i;
-                }
-                for (size_t i = 0; i < ntris; ++i)
+                // Update new mesh topology.
+                parallelFor(faceCount, [&](size_t i)
                 {
+                    uint32_t face = (uint32_t)i;
+                    const uint32_t* v = &mesh.faceVertices[face * 3];
+                    const uint32_t* f = &mesh.faceNeighbors[face * 3];
+                    auto childFace = [&](uint32_t k) { return face * 4 + k; };
+
                     for (uint32_t j = 0; j < 3; ++j)
                     {
-                        *vp = usedVerts[f[i]->v[j]];
-                        ++vp;
+                        // Update children f pointers for siblings.
+                        child.faceNeighbors[childFace(3) * 3 + j] = childFace(NEXT(j));
+                        child.faceNeighbors[childFace(j) * 3 + NEXT(j)] = childFace(3);
+
+                        // Update children f pointers for neighbor children.
+                        uint32_t f2 = f[j];
+                        child.faceNeighbors[childFace(j) * 3 + j] = f2 != kInvalidIndex ? f2 * 4 + mesh.vnum(f2, v[j]) : kInvalidIndex;
+                        f2 = f[PREV(j)];
+                        child.faceNeighbors[childFace(j) * 3 + PREV(j)] = f2 != kInvalidIndex ? f2 * 4 + mesh.vnum(f2, v[j]) : kInvalidIndex;
+
+                        // Update child vertex pointer to new even vertex
+                        child.faceVertices[childFace(j) * 3 + j] = v[j];
+
+                        // Update child vertex pointer to new odd vertex
+                        uint32_t vert = edgeVertices[face * 3 + j];
+                        child.faceVertices[childFace(j) * 3 + NEXT(j)] = vert;
+                        child.faceVertices[childFace(NEXT(j)) * 3 + j] = vert;
+                        child.faceVertices[childFace(3) * 3 + j] = vert;
                     }
-                }
+                });
 
-                LoopSubdivideResult result;
-                result.positions = std::move(pLimit);
-                result.normals = std::move(Ns);
-                result.indices = std::move(verts);
-                return result;
+                return child;
             }
         }
 
-        static float3 weightOneRing(SDVertex* vert, float beta)
+        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
         {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - valence * beta) * vert->p;
-            for (uint32_t i = 0; i < valence; ++i)
+            SubdivisionMesh mesh;
+            mesh.resize((uint32_t)positions.size(), (uint32_t)(indices.size() / 3));
+            std::copy(positions.begin(), positions.end(), mesh.positions.begin());
+            std::copy(indices.begin(), indices.begin() + mesh.faceVertices.size(), mesh.faceVertices.begin());
+            for (uint32_t index : mesh.faceVertices)
             {
-                p += beta * pRing[i];
+                if (index >= mesh.getVertexCount()) throw RuntimeError("Vertex index {} is out of range.", index);
             }
-            return p;
-        }
+            initTopology(mesh);
 
-        void SDVertex::oneRing(float3* p)
-        {
-            if (!boundary)
+            // Refine LoopSubdiv into triangles.
+            for (uint32_t i = 0; i < levels; ++i) mesh = subdivide(mesh);
+
+            // Push vertices to limit surface.
+            const uint32_t vertexCount = mesh.getVertexCount();
+            std::vector<float3> pLimit(vertexCount);
+            parallelFor(vertexCount, [&](size_t i)
             {
-                // Get one-ring vertices for interior vertex.
-                SDFace* face = startFace;
-                do
-                {
-                    *p++ = face->nextVert(this)->p;
-                    face = face->nextFace(this);
-                } while (face != startFace);
-            }
-            else
+                uint32_t v = (uint32_t)i;
+                if (mesh.boundary[v]) pLimit[v] = mesh.weightBoundary(v, 1.f / 5.f);
+                else pLimit[v] = mesh.weightOneRing(v, loopGamma(mesh.valence(v)));
+            });
+            mesh.positions = pLimit;
+
+            // Compute vertex tangents on limit surface.
+            std::vector<float3> Ns(vertexCount);
+            parallelFor(div_round_up((size_t)vertexCount, kChunkSize), [&](size_t chunk)
             {
-                // Get one-ring vertices for boundary vertex.
-                SDFace* face = startFace;
-                SDFace* f2;
-                while ((f2 = face->nextFace(this)) != nullptr)
+                std::vector<float3> pRing(16, float3());
+                const uint32_t end = (uint32_t)std::min((chunk + 1) * kChunkSize, (size_t)vertexCount);
+                for (uint32_t v = uint32_t(chunk * kChunkSize); v < end; ++v)
                 {
-                    face = f2;
+                    const float3& p = mesh.positions[v];
+                    float3 S(0.f);
+                    float3 T(0.f);
+                    uint32_t valence = mesh.valence(v);
+                    if (valence > pRing.size()) pRing.resize(valence);
+                    mesh.oneRing(v, [&](uint32_t j, const float3& q) { pRing[j] = q; });
+                    if (!mesh.boundary[v])
+                    {
+                        // Compute tangents of interior face
+                        for (uint32_t j = 0; j < valence; ++j)
+                        {
+                            S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                            T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        }
+                    }
+                    else
+                    {
+                        // Compute tangents of boundary face
+                        S = pRing[valence - 1] - pRing[0];
+                        if (valence == 2)
+                        {
+                            T = float3(pRing[0] + pRing[1] - 2.f * p);
+                        }
+                        else if (valence == 3)
+                        {
+                            T = pRing[1] - p;
+                        }
+                        else if (valence == 4) // regular
+                        {
+                            T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
+                        }
+                        else
+                        {
+                            float theta = float(M_PI) / float(valence - 1);
+                            T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                            for (uint32_t k = 1; k < valence - 1; ++k)
+                            {
+                                float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                                T += float3(wt * pRing[k]);
+                            }
+                            T = -T;
+                        }
+                    }
+                    Ns[v] = cross(S, T);
                 }
-                *p++ = face->nextVert(this)->p;
-                do
-                {
-                    *p++ = face->prevVert(this)->p;
-                    face = face->prevFace(this);
-                } while (face != nullptr);
-            }
-        }
+            });
 
-        static float3 weightBoundary(SDVertex* vert, float beta)
-        {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - 2 * beta) * vert->p;
-            p += beta * pRing[0];
-            p += beta * pRing[valence - 1];
-            return p;
+            // Create triangle mesh from subdivision mesh
+            LoopSubdivideResult result;
+            result.positions = std::move(mesh.positions);
+            result.normals = std::move(Ns);
+            result.indices = std::move(mesh.faceVertices);
+            return result;
         }
     }
 }
@@ -32,6 +32,7 @@
 // SPDX: Apache-2.0
 
 #pragma once
+#include "Core/Macros.h"
 #include "Utils/Math/Vector.h"
 #include <fstd/span.h> // TODO C++20: Replace with <span>
 #include <vector>
@@ -47,6 +48,13 @@ namespace Falcor
             std::vector<uint32_t> indices;
         };
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices);
+        /** Subdivide a triangle mesh with Loop's scheme and push the vertices to the limit surface.
+            Adjacency is kept in flat arrays and the vertex rules are evaluated in parallel. The output is identical to pbrt's pointer-based implementation.
+            \param[in] levels Number of subdivision levels.
+            \param[in] positions Vertex positions.
+            \param[in] vertices Triangle vertex indices, three per triangle.
+            \return Limit surface positions and normals, and triangle indices.
+        */
+        FALCOR_API LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices);
     }
 }
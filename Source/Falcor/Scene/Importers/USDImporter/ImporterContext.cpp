@@ -36,6 +36,8 @@
 #include "Utils/Settings.h"
 
 #include <glm/gtx/matrix_decompose.hpp>
+#include <optional>
+#include <unordered_map>
 
 BEGIN_DISABLE_USD_WARNINGS
 #include <pxr/usd/usd/primRange.h>
@@ -78,6 +80,9 @@ namespace Falcor
     {
         const bool kLoadMeshVertexAnimations = true;
 
+        // Number of mesh keyframes processed in parallel before they are compressed. Bounds the uncompressed keyframe data held during import.
+        const size_t kMeshKeyframeBatchSize = 64;
+
         // Subdivide each bspline curve segment into a single linear swept sphere segments (could be more if memory/perf allows).
         uint32_t kCurveSubdivPerSegment = 1;
         // Skip some hair strands, if necessary for memory/pref reasons.
@@ -909,7 +914,10 @@ namespace Falcor
             return true;
         }
 
-        bool processMeshKeyframe(Mesh& mesh, uint32_t subsetIdx, uint32_t sampleIdx, ImporterContext& ctx)
+        /** Process the vertex data of a mesh keyframe.
+            \param[out] keyframeData Vertex data of the keyframe per processed mesh. Empty for subsets that could not be processed.
+        */
+        bool processMeshKeyframe(const Mesh& mesh, uint32_t sampleIdx, ImporterContext& ctx, std::vector<std::vector<PackedStaticVertexData>>& keyframeData)
         {
             MeshGeomData geomData;
 
@@ -930,6 +938,7 @@ namespace Falcor
             // Convert geom data to keyframe data for the mesh at a particular sample
             FALCOR_ASSERT(geomData.geomSubsets.size() == mesh.processedMeshes.size());
             FALCOR_ASSERT(!mesh.meshIDs.empty()); // Mesh should have been added to builder already
+            keyframeData.resize(geomData.geomSubsets.size());
             for (size_t i = 0; i < geomData.geomSubsets.size(); ++i)
             {
                 // Create mesh to set up data according to subsets
@@ -944,7 +953,7 @@ namespace Falcor
                     ctx.builder.generateTangents(sbMesh, geomData.tangents);
                 }
 
-                auto& indices = mesh.attributeIndices[i];
+                const auto& indices = mesh.attributeIndices[i];
 
                 if (!(mesh.processedMeshes[i].staticData.size() == indices.size()))
                 {
@@ -952,12 +961,7 @@ namespace Falcor
                 }
 
                 // Fill vertex data
-                mesh.cachedMeshes[i].timeSamples = mesh.timeSamples;
-                mesh.cachedMeshes[i].meshID = mesh.meshIDs[i];
-                for (auto& t : mesh.cachedMeshes[i].timeSamples) t /= ctx.timeCodesPerSecond; // Convert to seconds
-
-                std::vector<PackedStaticVertexData>& keyframeData = mesh.cachedMeshes[i].vertexData[sampleIdx];
-                keyframeData.reserve(indices.size());
+                keyframeData[i].reserve(indices.size());
                 for (size_t j = 0; j < indices.size(); j++)
                 {
                     SceneBuilder::Mesh::Vertex v = sbMesh.getVertex(indices[j]);
@@ -967,7 +971,7 @@ namespace Falcor
                     data.normal = v.normal;
                     data.tangent = v.tangent;
                     data.texCrd = v.texCrd;
-                    keyframeData.emplace_back(data);
+                    keyframeData[i].emplace_back(data);
                 }
             }
 
@@ -1093,6 +1097,68 @@ namespace Falcor
             }
         }
 
+        Animation::SharedPtr createKeyframeAnimation(const std::string& name, NodeID nodeID, const std::vector<Animation::Keyframe>& keyframes)
+        {
+            Animation::SharedPtr pAnimation = Animation::create(name, nodeID, keyframes.back().time);
+            for (const auto& keyframe : keyframes)
+            {
+                pAnimation->addKeyframe(keyframe);
+            }
+            return pAnimation;
+        }
+
+        /** Add the prototype for a prototype prim to scene builder, including all nested prototypes.
+            \return The scene builder prototype ID, or an empty optional if no prototype exists.
+        */
+        std::optional<PrototypeID> addPrototypeToSceneBuilder(ImporterContext& ctx, const UsdPrim& protoPrim, std::unordered_map<UsdObject, PrototypeID, UsdObjHash>& prototypeIDs)
+        {
+            if (auto it = prototypeIDs.find(protoPrim); it != prototypeIDs.end()) return it->second;
+
+            if (!ctx.hasPrototype(protoPrim))
+            {
+                logError("Cannot create instance of '{}'; no prototype exists.", protoPrim.GetPath().GetString());
+                return {};
+            }
+
+            const PrototypeGeom& protoGeom = ctx.getPrototypeGeom(protoPrim);
+
+            // Node IDs in the PrototypeGeom are local to the prototype, which matches the SceneBuilder prototype convention.
+            SceneBuilder::Prototype prototype;
+            prototype.name = protoPrim.GetPath().GetString();
+            prototype.nodes = protoGeom.nodes;
+
+            for (const auto& animation : protoGeom.animations)
+            {
+                const std::string& animationName = protoGeom.nodes[animation.targetNodeID.get()].name;
+                prototype.animations.push_back(createKeyframeAnimation(animationName, animation.targetNodeID, animation.keyframes));
+            }
+
+            // Add all of the prototype's geom instances (currently limited to meshes). Each mesh may contain more than one submesh.
+            for (const auto& geomInstance : protoGeom.geomInstances)
+            {
+                FALCOR_ASSERT(geomInstance.prim.IsA<UsdGeomMesh>());
+                NodeID nodeID{ prototype.nodes.size() };
+                prototype.nodes.push_back(makeNode(geomInstance.name, geomInstance.xform, rmcv::mat4(1.f), geomInstance.parentID));
+                for (MeshID meshID : ctx.getMesh(geomInstance.prim).meshIDs)
+                {
+                    prototype.meshInstances.push_back({ nodeID, meshID });
+                }
+            }
+
+            for (const auto& instance : protoGeom.prototypeInstances)
+            {
+                auto nestedID = addPrototypeToSceneBuilder(ctx, instance.protoPrim, prototypeIDs);
+                if (!nestedID) continue;
+
+                Animation::SharedPtr pAnimation = instance.keyframes.empty() ? nullptr : createKeyframeAnimation(instance.name, NodeID::Invalid(), instance.keyframes);
+                prototype.prototypeInstances.push_back({ instance.name, *nestedID, instance.parentID, instance.xform, pAnimation });
+            }
+
+            PrototypeID prototypeID = ctx.builder.addPrototype(prototype);
+            prototypeIDs[protoPrim] = prototypeID;
+            return prototypeID;
+        }
+
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected mesh tasks.
@@ -1118,28 +1184,47 @@ namespace Falcor
 
             if (gpFramework->getSettings().getOption("usdImporter:loadMeshVertexAnimations", kLoadMeshVertexAnimations))
             {
-                // Allocate storage for mesh keyframe output
+                // Initialize the compressed keyframes of each processed mesh
                 for (auto& m : ctx.meshes)
                 {
                     if (m.timeSamples.size() > 1)
                     {
                         m.cachedMeshes.resize(m.processedMeshes.size());
-                        for (auto& c : m.cachedMeshes)
+                        for (size_t i = 0; i < m.cachedMeshes.size(); i++)
                         {
-                            c.vertexData.resize(m.timeSamples.size());
+                            m.cachedMeshes[i].meshID = m.meshIDs[i];
+                            m.cachedMeshes[i].keyframes = CompressedVertexKeyframes(CompressedVertexKeyframes::Options());
                         }
                     }
                 }
 
-                // Process time-sampled mesh keyframes
-                NumericRange<size_t> keyframeRange(0, ctx.meshKeyframeTasks.size());
-                std::for_each(std::execution::par, keyframeRange.begin(), keyframeRange.end(),
-                    [&](size_t i)
+                // Process time-sampled mesh keyframes in batches, the keyframes are compressed as soon as a batch is processed.
+                // The tasks of each mesh are ordered by sample index, so each batch continues where the previous one left off.
+                for (size_t first = 0; first < ctx.meshKeyframeTasks.size(); first += kMeshKeyframeBatchSize)
+                {
+                    size_t count = std::min(kMeshKeyframeBatchSize, ctx.meshKeyframeTasks.size() - first);
+                    std::vector<std::vector<std::vector<PackedStaticVertexData>>> keyframeData(count);
+
+                    NumericRange<size_t> keyframeRange(0, count);
+                    std::for_each(std::execution::par, keyframeRange.begin(), keyframeRange.end(),
+                        [&](size_t i)
+                        {
+                            const auto& task = ctx.meshKeyframeTasks[first + i];
+                            processMeshKeyframe(ctx.meshes[task.meshId], task.sampleIdx, ctx, keyframeData[i]);
+                        }
+                    );
+
+                    for (size_t i = 0; i < count; i++)
                     {
-                        auto& task = ctx.meshKeyframeTasks[i];
-                        processMeshKeyframe(ctx.meshes[task.meshId], task.meshId, task.sampleIdx, ctx);
+                        const auto& task = ctx.meshKeyframeTasks[first + i];
+                        auto& m = ctx.meshes[task.meshId];
+                        double time = m.timeSamples[task.sampleIdx] / ctx.timeCodesPerSecond; // Convert to seconds
+                        for (size_t j = 0; j < keyframeData[i].size(); j++)
+                        {
+                            if (!keyframeData[i][j].empty()) m.cachedMeshes[j].keyframes.addKeyframe(time, keyframeData[i][j]);
+                        }
                     }
-                );
+                }
 
                 // Gather keyframe data from all meshes
                 size_t totalMeshes = 0;
@@ -1151,7 +1236,8 @@ namespace Falcor
                 {
                     for (auto& c : m.cachedMeshes)
                     {
-                        cachedMeshes.push_back(std::move(c));
+                        c.keyframes.finalize();
+                        if (c.keyframes.getKeyframeCount() > 0) cachedMeshes.push_back(std::move(c));
                     }
                 }
                 ctx.builder.setCachedMeshes(std::move(cachedMeshes));
@@ -1177,81 +1263,20 @@ namespace Falcor
                 addSubmeshes(instance.prim, instance.name, rmcv::mat4(1.f), instance.bindTransform, instance.parentID);
             }
 
-            // Add instances of prototypes to scene builder. Because SceneBuilder only supports instanced meshes, and not
-            // general instancing, we effectively replicate each Prototype's subgraph. We could in theory collapse the subgraph
-            // if all of the transformations are static, but time-sampled transformations require us to use a more general approach.
+            // Add instances of prototypes to scene builder. Each prototype subgraph is added once and instantiated by reference,
+            // the subgraphs are expanded when the scene is created. Animations inside prototypes are shared by all instances.
+            std::unordered_map<UsdObject, PrototypeID, UsdObjHash> prototypeIDs;
             for (const auto& inst : ctx.prototypeInstances)
             {
-                std::vector<std::pair<PrototypeInstance, NodeID>> protoInstanceStack = { std::make_pair(inst, inst.parentID) };
-                while (!protoInstanceStack.empty())
-                {
-                    PrototypeInstance protoInstance = protoInstanceStack.back().first;
-                    NodeID parentID = protoInstanceStack.back().second;
-                    protoInstanceStack.pop_back();
-
-                    // Add root node for this prototype instance, parented appropriately.
-                    NodeID rootNodeID = ctx.builder.addNode(makeNode(protoInstance.name, protoInstance.xform, rmcv::mat4(1.f), parentID));
-
-                    // If there are keyframes, create an animation from them targeting the root node we just created.
-                    // This could be more cleanly addressed if a Falcor::Animation could target more than one node.
-                    if (protoInstance.keyframes.size() > 0)
-                    {
-                        Animation::SharedPtr pAnimation = Animation::create(protoInstance.name, rootNodeID, protoInstance.keyframes.back().time);
-                        for (const auto& keyframe : protoInstance.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
-                        ctx.builder.addAnimation(pAnimation);
-                    }
-
-                    // Get a reference to the prototype
-                    if (!ctx.hasPrototype(protoInstance.protoPrim))
-                    {
-                        logError("Cannot create instance of '{}'; no prototype exists.", protoInstance.protoPrim.GetPath().GetString());
-                        continue;
-                    }
+                auto prototypeID = addPrototypeToSceneBuilder(ctx, inst.protoPrim, prototypeIDs);
+                if (!prototypeID) continue;
 
-                    const PrototypeGeom& protoGeom = ctx.getPrototypeGeom(protoInstance.protoPrim);
+                NodeID rootNodeID = ctx.builder.addPrototypeInstance(*prototypeID, makeNode(inst.name, inst.xform, rmcv::mat4(1.f), inst.parentID));
 
-                    // Parent IDs of nodes in the PrototypeGeom are relative to the ID of the prototype's root, zero.
-                    // Get the current builder node count, which will be the SceneBuilder node ID of the prototype root node.
-                    // We use this value to map from protoGeom node IDs to SceneBuilder node IDs.
-                    NodeID protoRootID{ ctx.builder.getNodeCount() };
-
-                    for (const auto& node : protoGeom.nodes)
-                    {
-                        SceneBuilder::Node builderNode = node;
-                        builderNode.parent = (node.parent == NodeID::Invalid()) ? rootNodeID : NodeID{ node.parent.get() + protoRootID.get() };
-                        ctx.builder.addNode(builderNode);
-                    }
-
-                    // Create any animations from the stashed keyframes, each targeting the proper node.
-                    // Again, this could be simplified if Animations could target multiple nodes.
-                    for (const auto& animation : protoGeom.animations)
-                    {
-                        // Use the name of the target node as the animation name. Note that this will result in multiple animations with the same name
-                        // if the prototype is instantiated multiple times.
-                        std::string animationName = protoGeom.nodes[animation.targetNodeID.get()].name;
-                        NodeID targetNodeID{ animation.targetNodeID.get() + protoRootID.get() };
-                        Animation::SharedPtr pAnimation = Animation::create(animationName, targetNodeID, animation.keyframes.back().time);
-                        for (const auto& keyframe : animation.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
-                        ctx.builder.addAnimation(pAnimation);
-                    }
-
-                    // Add all of the prototype's geom instances (currently limited to meshes)
-                    for (const auto& meshInstance : protoGeom.geomInstances)
-                    {
-                        addSubmeshes(meshInstance.prim, protoInstance.name + "/" + meshInstance.name, meshInstance.xform, rmcv::mat4(1.f), NodeID{ meshInstance.parentID.get() + protoRootID.get() });
-                    }
-
-                    // Push child prototype instances, and the current nodeID as the parent, onto the stack. Do so in reverse order to maintain traversal ordering.
-                    for (auto it = protoGeom.prototypeInstances.rbegin(); it != protoGeom.prototypeInstances.rend(); ++it)
-                    {
-                        protoInstanceStack.push_back(std::make_pair(*it, NodeID{ it->parentID.get() + protoRootID.get() }));
-                    }
+                // If there are keyframes, create an animation from them targeting the instance root node.
+                if (!inst.keyframes.empty())
+                {
+                    ctx.builder.addAnimation(createKeyframeAnimation(inst.name, rootNodeID, inst.keyframes));
                 }
             }
 
@@ -1756,13 +1781,10 @@ namespace Falcor
         cachedCurve.tessellationMode = curve.tessellationMode;
         cachedCurve.geometryID = curve.geometryID;
 
-        cachedCurve.timeSamples.resize(curve.timeSamples.size());
-        std::memcpy(cachedCurve.timeSamples.data(), curve.timeSamples.data(), cachedCurve.timeSamples.size() * sizeof(double));
-
         // Make sure topology doesn't change across keyframes.
         const auto& refIndexData = curve.processedCurves[0].indexData;
         bool isSameTopology = true;
-        for (size_t i = 1; i < cachedCurve.timeSamples.size(); i++)
+        for (size_t i = 1; i < curve.timeSamples.size(); i++)
         {
             const auto& indexData = curve.processedCurves[i].indexData;
             if (indexData.size() != refIndexData.size())
@@ -1788,14 +1810,17 @@ namespace Falcor
         cachedCurve.indexData.resize(refIndexData.size());
         std::memcpy(cachedCurve.indexData.data(), refIndexData.data(), cachedCurve.indexData.size() * sizeof(uint32_t));
 
-        cachedCurve.vertexData.resize(curve.processedCurves.size());
-        for (size_t i = 0; i < cachedCurve.vertexData.size(); i++)
+        // Compress the keyframes as they are converted.
+        cachedCurve.keyframes = CompressedVertexKeyframes(CompressedVertexKeyframes::Options());
+        std::vector<DynamicCurveVertexData> keyframeData;
+        for (size_t i = 0; i < curve.processedCurves.size(); i++)
         {
-            cachedCurve.vertexData[i].resize(curve.processedCurves[i].staticData.size());
-            for (size_t j = 0; j < cachedCurve.vertexData[i].size(); j++)
+            keyframeData.resize(curve.processedCurves[i].staticData.size());
+            for (size_t j = 0; j < keyframeData.size(); j++)
             {
-                cachedCurve.vertexData[i][j].position = curve.processedCurves[i].staticData[j].position;
+                keyframeData[j].position = curve.processedCurves[i].staticData[j].position;
             }
+            cachedCurve.keyframes.addKeyframe(curve.timeSamples[i], keyframeData);
 
             // Deallocate memory.
             if (i > 0)
@@ -1803,8 +1828,9 @@ namespace Falcor
                 curve.processedCurves[i].staticData = std::vector<StaticCurveVertexData>();
             }
         }
+        cachedCurve.keyframes.finalize();
 
-        cachedCurves.push_back(cachedCurve);
+        cachedCurves.push_back(std::move(cachedCurve));
     }
 
     ImporterContext::ImporterContext(const std::filesystem::path& path, UsdStageRefPtr pStage, SceneBuilder& builder, const Dictionary& dict, TimeReport& timeReport, bool useInstanceProxies /*= false*/)
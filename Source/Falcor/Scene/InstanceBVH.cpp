@@ -0,0 +1,276 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "InstanceBVH.h"
+#include "Core/Assert.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaxDepth = 64;
+
+        // Returns true if a box is valid and finite. Other boxes have undefined centers and extents.
+        bool isBounded(const AABB& box)
+        {
+            return box.valid() && !glm::any(glm::isinf(box.minPoint)) && !glm::any(glm::isinf(box.maxPoint));
+        }
+    }
+
+    void InstanceBVH::build(const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs)
+    {
+        mNodes.clear();
+        mParents.clear();
+        mItems.clear();
+        mUnboundedItems.clear();
+        mItemLeaves.assign(bounds.size(), kInvalidNode);
+
+        for (uint32_t itemID : itemIDs)
+        {
+            FALCOR_ASSERT(itemID < bounds.size());
+            if (isBounded(bounds[itemID])) mItems.push_back(itemID);
+            else
+            {
+                mUnboundedItems.push_back(itemID);
+                mItemLeaves[itemID] = kUnboundedItem;
+            }
+        }
+        mItemBounds.resize(mItems.size());
+
+        if (mItems.empty()) return;
+
+        std::vector<float3> centroids(bounds.size());
+        for (uint32_t itemID : mItems) centroids[itemID] = bounds[itemID].center();
+
+        mNodes.reserve(2 * (mItems.size() / kMaxLeafSize + 1));
+        mParents.reserve(mNodes.capacity());
+        buildNode(bounds, centroids, 0, (uint32_t)mItems.size(), kInvalidNode);
+    }
+
+    uint32_t InstanceBVH::buildNode(const std::vector<AABB>& bounds, std::vector<float3>& centroids, uint32_t first, uint32_t count, uint32_t parent)
+    {
+        const uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.emplace_back();
+        mParents.push_back(parent);
+
+        Node node;
+        node.firstItem = first;
+        node.itemCount = count;
+
+        if (count <= kMaxLeafSize)
+        {
+            for (uint32_t i = first; i < first + count; i++) mItemLeaves[mItems[i]] = nodeIndex;
+            node.bounds = updateLeafBounds(bounds, node);
+            mNodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+
+        // Split at the median along the largest axis of the centroid bounds.
+        AABB centroidBounds;
+        for (uint32_t i = first; i < first + count; i++) centroidBounds.include(centroids[mItems[i]]);
+        const float3 extent = centroidBounds.extent();
+        const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+        const uint32_t half = count / 2;
+        auto begin = mItems.begin() + first;
+        std::nth_element(begin, begin + half, begin + count, [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        buildNode(bounds, centroids, first, half, nodeIndex);
+        node.secondChild = buildNode(bounds, centroids, first + half, count - half, nodeIndex);
+        node.bounds = mNodes[nodeIndex + 1].bounds | mNodes[node.secondChild].bounds;
+        mNodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    AABB InstanceBVH::updateLeafBounds(const std::vector<AABB>& bounds, const Node& node)
+    {
+        FALCOR_ASSERT(node.isLeaf());
+        AABB leafBounds;
+        for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++)
+        {
+            mItemBounds[i] = bounds[mItems[i]];
+            leafBounds |= mItemBounds[i];
+        }
+        return leafBounds;
+    }
+
+    void InstanceBVH::refit(const std::vector<AABB>& bounds, const std::vector<uint32_t>& changedItemIDs)
+    {
+        if (needsRebuild(bounds, changedItemIDs))
+        {
+            rebuild(bounds);
+            return;
+        }
+
+        // Refitting all nodes is cheaper than walking up from many leaves.
+        if (changedItemIDs.size() > mItems.size() / 8)
+        {
+            refit(bounds);
+            return;
+        }
+
+        for (uint32_t itemID : changedItemIDs)
+        {
+            if (itemID >= mItemLeaves.size() || mItemLeaves[itemID] == kInvalidNode || mItemLeaves[itemID] == kUnboundedItem) continue;
+
+            // Update the leaf and walk up until the bounds of a node don't change.
+            uint32_t nodeIndex = mItemLeaves[itemID];
+            AABB nodeBounds = updateLeafBounds(bounds, mNodes[nodeIndex]);
+            while (nodeBounds != mNodes[nodeIndex].bounds)
+            {
+                mNodes[nodeIndex].bounds = nodeBounds;
+                nodeIndex = mParents[nodeIndex];
+                if (nodeIndex == kInvalidNode) break;
+                nodeBounds = mNodes[nodeIndex + 1].bounds | mNodes[mNodes[nodeIndex].secondChild].bounds;
+            }
+        }
+    }
+
+    void InstanceBVH::refit(const std::vector<AABB>& bounds)
+    {
+        if (needsRebuild(bounds, mItems) || needsRebuild(bounds, mUnboundedItems))
+        {
+            rebuild(bounds);
+            return;
+        }
+
+        // Children are stored after their parents, so a reverse pass visits all children first.
+        for (size_t i = mNodes.size(); i-- > 0;)
+        {
+            Node& node = mNodes[i];
+            if (node.isLeaf()) node.bounds = updateLeafBounds(bounds, node);
+            else node.bounds = mNodes[i + 1].bounds | mNodes[node.secondChild].bounds;
+        }
+    }
+
+    bool InstanceBVH::needsRebuild(const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs) const
+    {
+        // Inserted items are in the BVH if and only if they are bounded.
+        for (uint32_t itemID : itemIDs)
+        {
+            if (itemID >= mItemLeaves.size() || mItemLeaves[itemID] == kInvalidNode) continue;
+            if ((mItemLeaves[itemID] != kUnboundedItem) != isBounded(bounds[itemID])) return true;
+        }
+        return false;
+    }
+
+    void InstanceBVH::rebuild(const std::vector<AABB>& bounds)
+    {
+        std::vector<uint32_t> itemIDs = mItems;
+        itemIDs.insert(itemIDs.end(), mUnboundedItems.begin(), mUnboundedItems.end());
+        build(bounds, itemIDs);
+    }
+
+    void InstanceBVH::cull(const Frustum& frustum, std::vector<uint32_t>& visibleItemIDs) const
+    {
+        visibleItemIDs.assign(mUnboundedItems.begin(), mUnboundedItems.end());
+        if (mNodes.empty()) return;
+
+        struct StackEntry
+        {
+            uint32_t nodeIndex;
+            uint32_t planeMask;
+        };
+        StackEntry stack[kMaxDepth];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, Frustum::kAllPlanesMask };
+
+        while (stackSize > 0)
+        {
+            const StackEntry entry = stack[--stackSize];
+            const Node& node = mNodes[entry.nodeIndex];
+
+            uint32_t planeMask = entry.planeMask;
+            const Frustum::Result result = frustum.classify(node.bounds, planeMask);
+            if (result == Frustum::Result::Outside) continue;
+
+            if (result == Frustum::Result::Inside)
+            {
+                // The subtree covers a contiguous range of items.
+                visibleItemIDs.insert(visibleItemIDs.end(), mItems.begin() + node.firstItem, mItems.begin() + node.firstItem + node.itemCount);
+            }
+            else if (node.isLeaf())
+            {
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++)
+                {
+                    uint32_t itemPlaneMask = planeMask;
+                    if (frustum.classify(mItemBounds[i], itemPlaneMask) != Frustum::Result::Outside) visibleItemIDs.push_back(mItems[i]);
+                }
+            }
+            else
+            {
+                FALCOR_ASSERT(stackSize + 2 <= kMaxDepth);
+                stack[stackSize++] = { node.secondChild, planeMask };
+                stack[stackSize++] = { entry.nodeIndex + 1, planeMask };
+            }
+        }
+    }
+
+    void InstanceBatcher::setKeys(std::vector<uint32_t> itemKeys, uint32_t keyCount)
+    {
+        mItemKeys = std::move(itemKeys);
+        mKeyOffsets.assign(keyCount, 0);
+        FALCOR_ASSERT(std::all_of(mItemKeys.begin(), mItemKeys.end(), [keyCount](uint32_t key) { return key < keyCount; }));
+    }
+
+    void InstanceBatcher::setKey(uint32_t itemID, uint32_t key)
+    {
+        FALCOR_ASSERT(itemID < mItemKeys.size() && key < mKeyOffsets.size());
+        mItemKeys[itemID] = key;
+    }
+
+    void InstanceBatcher::createBatches(const std::vector<uint32_t>& itemIDs, std::vector<uint32_t>& sortedItemIDs, std::vector<Batch>& batches)
+    {
+        batches.clear();
+        sortedItemIDs.resize(itemIDs.size());
+
+        // Count the items per key and collect the distinct keys.
+        for (uint32_t itemID : itemIDs)
+        {
+            const uint32_t key = mItemKeys[itemID];
+            if (mKeyOffsets[key]++ == 0) batches.push_back({ key, 0, 0 });
+        }
+        std::sort(batches.begin(), batches.end(), [](const Batch& a, const Batch& b) { return a.key < b.key; });
+
+        // Compute the start of each batch.
+        uint32_t offset = 0;
+        for (auto& batch : batches)
+        {
+            batch.firstItem = offset;
+            batch.itemCount = mKeyOffsets[batch.key];
+            mKeyOffsets[batch.key] = offset;
+            offset += batch.itemCount;
+        }
+
+        // Scatter the items, keeping their relative order within each batch.
+        for (uint32_t itemID : itemIDs) sortedItemIDs[mKeyOffsets[mItemKeys[itemID]]++] = itemID;
+
+        // Clear the scratch space for the next call.
+        for (const auto& batch : batches) mKeyOffsets[batch.key] = 0;
+    }
+}
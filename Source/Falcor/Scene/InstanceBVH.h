@@ -0,0 +1,143 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Frustum.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU bounding volume hierarchy over the world-space bounds of instances, used for view frustum culling.
+
+        The BVH is built top-down with median splits along the largest axis of the centroid bounds.
+        Nodes are stored in depth-first order and each node covers a contiguous range of the reordered items,
+        so subtrees entirely inside the frustum are emitted without visiting their children.
+        Moved items are handled by refitting the bounds of their leaves and ancestors.
+
+        Items with invalid or infinite bounds can't be classified against the frustum planes. They are kept in a
+        separate list outside of the BVH and are always reported as visible.
+    */
+    class FALCOR_API InstanceBVH
+    {
+    public:
+        static constexpr uint32_t kMaxLeafSize = 4;
+
+        struct Node
+        {
+            AABB bounds;
+            uint32_t firstItem = 0;     ///< First item in the reordered item list covered by the node.
+            uint32_t itemCount = 0;     ///< Number of items covered by the node.
+            uint32_t secondChild = 0;   ///< Index of the second child for inner nodes (the first child follows the node), 0 for leaves.
+
+            bool isLeaf() const { return secondChild == 0; }
+        };
+
+        /** Build the BVH.
+            \param[in] bounds World-space bounds indexed by item ID.
+            \param[in] itemIDs IDs of the items to insert. Items with invalid or infinite bounds are never culled.
+        */
+        void build(const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs);
+
+        /** Refit the BVH after items moved. The topology of the BVH is not changed,
+            unless items changed between having finite and invalid or infinite bounds, in which case the BVH is rebuilt.
+            \param[in] bounds World-space bounds indexed by item ID.
+            \param[in] changedItemIDs IDs of the items whose bounds changed. IDs of items not in the BVH are ignored.
+        */
+        void refit(const std::vector<AABB>& bounds, const std::vector<uint32_t>& changedItemIDs);
+
+        /** Refit all nodes of the BVH.
+            \param[in] bounds World-space bounds indexed by item ID.
+        */
+        void refit(const std::vector<AABB>& bounds);
+
+        /** Find the items that potentially overlap a frustum.
+            \param[in] frustum View frustum.
+            \param[out] visibleItemIDs IDs of the items overlapping the frustum. The list is cleared first.
+        */
+        void cull(const Frustum& frustum, std::vector<uint32_t>& visibleItemIDs) const;
+
+        uint32_t getItemCount() const { return (uint32_t)(mItems.size() + mUnboundedItems.size()); }
+        const std::vector<Node>& getNodes() const { return mNodes; }
+
+    private:
+        static constexpr uint32_t kInvalidNode = 0xffffffff;
+        static constexpr uint32_t kUnboundedItem = 0xfffffffe;
+
+        uint32_t buildNode(const std::vector<AABB>& bounds, std::vector<float3>& centroids, uint32_t first, uint32_t count, uint32_t parent);
+        AABB updateLeafBounds(const std::vector<AABB>& bounds, const Node& node);
+        bool needsRebuild(const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs) const;
+        void rebuild(const std::vector<AABB>& bounds);
+
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mParents;     ///< Parent node index per node.
+        std::vector<uint32_t> mItems;       ///< Item IDs in BVH order.
+        std::vector<uint32_t> mUnboundedItems; ///< IDs of the items with invalid or infinite bounds, which are not in the BVH.
+        std::vector<AABB> mItemBounds;      ///< Item bounds in BVH order.
+        std::vector<uint32_t> mItemLeaves;  ///< Leaf node index per item ID, kUnboundedItem for unbounded items or kInvalidNode for items not inserted.
+    };
+
+    /** Groups items into batches of items sharing the same key.
+        Batches are created in increasing key order with a counting sort. Apart from sorting the distinct keys,
+        the cost is linear in the number of items and independent of the total number of keys.
+    */
+    class FALCOR_API InstanceBatcher
+    {
+    public:
+        struct Batch
+        {
+            uint32_t key = 0;
+            uint32_t firstItem = 0;     ///< Index of the first item in the sorted item list.
+            uint32_t itemCount = 0;
+        };
+
+        /** Set the keys of all items.
+            \param[in] itemKeys Key per item ID.
+            \param[in] keyCount Number of distinct keys, all keys must be smaller.
+        */
+        void setKeys(std::vector<uint32_t> itemKeys, uint32_t keyCount);
+
+        /** Change the key of a single item.
+        */
+        void setKey(uint32_t itemID, uint32_t key);
+
+        uint32_t getKey(uint32_t itemID) const { return mItemKeys[itemID]; }
+
+        /** Sort items by key and group them into batches.
+            \param[in] itemIDs IDs of the items.
+            \param[out] sortedItemIDs Item IDs sorted by key.
+            \param[out] batches Batches in increasing key order, referencing ranges of sortedItemIDs.
+        */
+        void createBatches(const std::vector<uint32_t>& itemIDs, std::vector<uint32_t>& sortedItemIDs, std::vector<Batch>& batches);
+
+    private:
+        std::vector<uint32_t> mItemKeys;
+        std::vector<uint32_t> mKeyOffsets;  ///< Scratch space with one entry per key, kept zeroed between calls.
+    };
+}
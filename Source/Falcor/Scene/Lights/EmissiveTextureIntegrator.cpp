@@ -0,0 +1,252 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "EmissiveTextureIntegrator.h"
+#include "Core/Assert.h"
+#include "Core/Platform/OS.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kDirectory = "NVIDIA/Falcor/EmissiveIntegrationCache";
+        const uint32_t kCacheMagic = 0x43494545; ///< "EEIC".
+        const uint32_t kCacheVersion = 1; ///< Increment when the integration changes to invalidate existing cache entries.
+
+        // A triangle clipped by four axis-aligned planes has at most seven vertices.
+        const uint32_t kMaxPolygonVertexCount = 8;
+
+        struct Polygon
+        {
+            float2 v[kMaxPolygonVertexCount];
+            uint32_t count = 0;
+        };
+
+        /** Clip a convex polygon against the half-plane p[axis] >= value (or p[axis] <= value if keepBelow is set).
+        */
+        Polygon clipPolygon(const Polygon& in, uint32_t axis, float value, bool keepBelow)
+        {
+            Polygon out;
+            if (in.count == 0) return out;
+
+            auto distance = [&](const float2& p) { return keepBelow ? value - p[axis] : p[axis] - value; };
+
+            float2 prev = in.v[in.count - 1];
+            float prevDist = distance(prev);
+            for (uint32_t i = 0; i < in.count; i++)
+            {
+                float2 cur = in.v[i];
+                float curDist = distance(cur);
+                if ((prevDist >= 0.f) != (curDist >= 0.f))
+                {
+                    // Edge crosses the plane. Snap the intersection exactly onto the plane.
+                    float t = prevDist / (prevDist - curDist);
+                    float2 p = prev + t * (cur - prev);
+                    p[axis] = value;
+                    FALCOR_ASSERT(out.count < kMaxPolygonVertexCount);
+                    out.v[out.count++] = p;
+                }
+                if (curDist >= 0.f)
+                {
+                    FALCOR_ASSERT(out.count < kMaxPolygonVertexCount);
+                    out.v[out.count++] = cur;
+                }
+                prev = cur;
+                prevDist = curDist;
+            }
+            return out;
+        }
+
+        /** Returns the unsigned area of a polygon.
+        */
+        double computeArea(const Polygon& polygon)
+        {
+            if (polygon.count < 3) return 0.0;
+            double area = 0.0;
+            for (uint32_t i = 0, j = polygon.count - 1; i < polygon.count; j = i++)
+            {
+                area += (double)polygon.v[j].x * polygon.v[i].y - (double)polygon.v[i].x * polygon.v[j].y;
+            }
+            return std::abs(0.5 * area);
+        }
+
+        int64_t applyAddressMode(int64_t t, int64_t n, Sampler::AddressMode mode)
+        {
+            switch (mode)
+            {
+            case Sampler::AddressMode::Wrap:
+                return ((t % n) + n) % n;
+            case Sampler::AddressMode::Mirror:
+            {
+                int64_t m = ((t % (2 * n)) + 2 * n) % (2 * n);
+                return m < n ? m : 2 * n - 1 - m;
+            }
+            case Sampler::AddressMode::MirrorOnce:
+                return std::clamp(t < 0 ? -1 - t : t, (int64_t)0, n - 1);
+            case Sampler::AddressMode::Clamp:
+                return std::clamp(t, (int64_t)0, n - 1);
+            case Sampler::AddressMode::Border:
+                return t >= 0 && t < n ? t : -1;
+            default:
+                FALCOR_UNREACHABLE();
+                return 0;
+            }
+        }
+    }
+
+    float3 EmissiveTextureIntegrator::TextureData::fetch(int64_t x, int64_t y) const
+    {
+        FALCOR_ASSERT(width > 0 && height > 0 && texels.size() == (size_t)width * height);
+        x = applyAddressMode(x, width, addressModeU);
+        y = applyAddressMode(y, height, addressModeV);
+        if (x < 0 || y < 0) return borderColor;
+        return texels[(size_t)y * width + (size_t)x];
+    }
+
+    float3 EmissiveTextureIntegrator::TextureData::sample(const float2& uv) const
+    {
+        return fetch((int64_t)std::floor(uv.x * width), (int64_t)std::floor(uv.y * height));
+    }
+
+    float3 EmissiveTextureIntegrator::integrateTriangle(const TextureData& texture, const float2 texCoords[3])
+    {
+        if (texture.width == 0 || texture.height == 0) return float3(0.f);
+
+        // Place the triangle in texel space, offset by an integer number of texture tiles to keep the coordinates small.
+        // This is the same transform as used by the GPU integrator.
+        const float2 dim = float2(texture.width, texture.height);
+        const float2 uvOffset = floor(min(min(texCoords[0], texCoords[1]), texCoords[2]));
+        const int64_t texelOffsetX = (int64_t)uvOffset.x * texture.width;
+        const int64_t texelOffsetY = (int64_t)uvOffset.y * texture.height;
+
+        Polygon triangle;
+        triangle.count = 3;
+        for (uint32_t i = 0; i < 3; i++) triangle.v[i] = (texCoords[i] - uvOffset) * dim;
+
+        const float yMin = std::min({ triangle.v[0].y, triangle.v[1].y, triangle.v[2].y });
+        const float yMax = std::max({ triangle.v[0].y, triangle.v[1].y, triangle.v[2].y });
+
+        // Clip the triangle to each row of texels, and the row to each texel it overlaps.
+        // Texels are weighted by the area of overlap, which is one for texels fully covered by the triangle.
+        glm::dvec3 sum = glm::dvec3(0.0);
+        double weightSum = 0.0;
+
+        for (int64_t y = (int64_t)std::floor(yMin); y < (int64_t)std::ceil(yMax); y++)
+        {
+            Polygon row = clipPolygon(clipPolygon(triangle, 1, (float)y, false), 1, (float)(y + 1), true);
+            if (row.count < 3) continue;
+
+            float xMin = row.v[0].x, xMax = row.v[0].x;
+            for (uint32_t i = 1; i < row.count; i++)
+            {
+                xMin = std::min(xMin, row.v[i].x);
+                xMax = std::max(xMax, row.v[i].x);
+            }
+
+            for (int64_t x = (int64_t)std::floor(xMin); x < (int64_t)std::ceil(xMax); x++)
+            {
+                Polygon cell = clipPolygon(clipPolygon(row, 0, (float)x, false), 0, (float)(x + 1), true);
+                double weight = std::min(computeArea(cell), 1.0);
+                if (weight <= 0.0) continue;
+
+                float3 color = texture.fetch(texelOffsetX + x, texelOffsetY + y);
+                sum += weight * glm::dvec3(color);
+                weightSum += weight;
+            }
+        }
+
+        if (weightSum > 0.0) return float3(sum / weightSum);
+
+        // The triangle is degenerate in texture space (line or point).
+        return (texture.sample(texCoords[0]) + texture.sample(texCoords[1]) + texture.sample(texCoords[2])) / 3.f;
+    }
+
+    std::vector<float3> EmissiveTextureIntegrator::integrateTriangles(const TextureData& texture, const std::vector<float2>& texCoords)
+    {
+        FALCOR_ASSERT(texCoords.size() % 3 == 0);
+        const uint32_t triangleCount = (uint32_t)(texCoords.size() / 3);
+
+        std::vector<float3> averages(triangleCount);
+        NumericRange<uint32_t> range(0, triangleCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t triIdx)
+        {
+            averages[triIdx] = integrateTriangle(texture, &texCoords[3 * triIdx]);
+        });
+        return averages;
+    }
+
+    SHA1::MD EmissiveTextureIntegrator::computeKey(const SHA1::MD& textureHash, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, const std::vector<float2>& texCoords)
+    {
+        SHA1 sha1;
+        sha1.update(&kCacheVersion, sizeof(kCacheVersion));
+        sha1.update(textureHash.data(), textureHash.size());
+        sha1.update(&addressModeU, sizeof(addressModeU));
+        sha1.update(&addressModeV, sizeof(addressModeV));
+        sha1.update(texCoords.data(), texCoords.size() * sizeof(float2));
+        return sha1.finalize();
+    }
+
+    EmissiveTextureIntegrator::Cache::Cache(const std::filesystem::path& directory)
+        : mFiles(directory.empty() ? getAppDataDirectory() / kDirectory : directory, ".bin")
+    {
+    }
+
+    bool EmissiveTextureIntegrator::Cache::load(const SHA1::MD& key, size_t triangleCount, std::vector<float3>& averages) const
+    {
+        std::ifstream fs(mFiles.getPath(key), std::ios_base::binary);
+        if (!fs) return false;
+
+        uint32_t header[2] = {};
+        uint64_t count = 0;
+        fs.read(reinterpret_cast<char*>(header), sizeof(header));
+        fs.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!fs || header[0] != kCacheMagic || header[1] != kCacheVersion || count != triangleCount) return false;
+
+        averages.resize(triangleCount);
+        fs.read(reinterpret_cast<char*>(averages.data()), triangleCount * sizeof(float3));
+        return (bool)fs;
+    }
+
+    void EmissiveTextureIntegrator::Cache::store(const SHA1::MD& key, const std::vector<float3>& averages) const
+    {
+        mFiles.store(key, [&](const std::filesystem::path& path)
+        {
+            std::ofstream fs(path, std::ios_base::binary);
+            const uint32_t header[2] = { kCacheMagic, kCacheVersion };
+            const uint64_t count = averages.size();
+            fs.write(reinterpret_cast<const char*>(header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            fs.write(reinterpret_cast<const char*>(averages.data()), averages.size() * sizeof(float3));
+            return (bool)fs;
+        });
+    }
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Sampler.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/PersistentCache.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU integrator computing the average emission of textured emissive triangles.
+
+        The average is computed in texture space by weighting each texel by its exact area of overlap with
+        the triangle, which matches the GPU integrator in EmissiveIntegrator.3d.slang. The result is exact
+        under the assumption that the emissive texture is sampled with nearest filtering at the finest mip.
+        Triangles that are degenerate in texture space use the average of the texels at the three vertices.
+
+        Results can be stored in a persistent cache keyed by the hash of the texture content and the
+        texture coordinates, so that reloading a scene skips the integration entirely.
+    */
+    class FALCOR_API EmissiveTextureIntegrator
+    {
+    public:
+        /** Emissive texture data, finest mip level in linear RGB.
+        */
+        struct TextureData
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float3> texels;                                     ///< Texels in row-major order.
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap;
+            Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap;
+            float3 borderColor = float3(0.f);                               ///< Color returned for texels outside the texture with border addressing.
+
+            /** Fetch a texel with the texture addressing modes applied.
+            */
+            float3 fetch(int64_t x, int64_t y) const;
+
+            /** Sample the texture with nearest filtering.
+            */
+            float3 sample(const float2& uv) const;
+        };
+
+        /** Compute the average texture color over a triangle.
+            \param[in] texture Texture data.
+            \param[in] texCoords Texture coordinates of the triangle vertices.
+            \return Texel-overlap-weighted average color.
+        */
+        static float3 integrateTriangle(const TextureData& texture, const float2 texCoords[3]);
+
+        /** Compute the average texture color over a list of triangles in parallel.
+            \param[in] texture Texture data.
+            \param[in] texCoords Texture coordinates, three per triangle.
+            \return Average color per triangle.
+        */
+        static std::vector<float3> integrateTriangles(const TextureData& texture, const std::vector<float2>& texCoords);
+
+        /** Compute the cache key of the integration of a list of triangles.
+            \param[in] textureHash Hash of the texture content, see TextureData and LightCollection.
+            \param[in] addressModeU Texture addressing mode in U.
+            \param[in] addressModeV Texture addressing mode in V.
+            \param[in] texCoords Texture coordinates, three per triangle.
+            \return Cache key.
+        */
+        static SHA1::MD computeKey(const SHA1::MD& textureHash, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, const std::vector<float2>& texCoords);
+
+        /** Persistent on-disk cache of integration results.
+            Entries are never evicted, each entry holds one float3 per triangle.
+        */
+        class FALCOR_API Cache
+        {
+        public:
+            /** Create a cache.
+                \param[in] directory Cache directory. If empty, a directory in the application data directory is used.
+            */
+            Cache(const std::filesystem::path& directory = {});
+
+            /** Load a cache entry.
+                \param[in] key Cache key.
+                \param[in] triangleCount Expected number of triangles.
+                \param[out] averages Average color per triangle.
+                \return True if a valid entry was found.
+            */
+            bool load(const SHA1::MD& key, size_t triangleCount, std::vector<float3>& averages) const;
+
+            /** Store a cache entry. Failures are ignored as the cache is an optimization only.
+                \param[in] key Cache key.
+                \param[in] averages Average color per triangle.
+            */
+            void store(const SHA1::MD& key, const std::vector<float3>& averages) const;
+
+            const std::filesystem::path& getDirectory() const { return mFiles.getDirectory(); }
+
+        private:
+            PersistentCache mFiles;
+        };
+    };
+}
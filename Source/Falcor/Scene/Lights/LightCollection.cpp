@@ -27,12 +27,18 @@
  **************************************************************************/
 #include "LightCollection.h"
 #include "LightCollectionShared.slang"
+#include "EmissiveTextureIntegrator.h"
 #include "Core/API/Device.h"
 #include "Scene/Scene.h"
 #include "Scene/Material/BasicMaterial.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Logger.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/Image/TextureCache.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Timing/Profiler.h"
+#include <map>
 #include <sstream>
 
 namespace Falcor
@@ -47,14 +53,48 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        /** Read back the finest mip of an emissive texture in linear RGB.
+            Formats that can't be converted on the CPU, e.g., block compressed formats, are first decoded on the GPU.
+        */
+        EmissiveTextureIntegrator::TextureData readTextureData(RenderContext* pRenderContext, const Texture::SharedPtr& pTexture, const Sampler::SharedPtr& pSampler)
+        {
+            EmissiveTextureIntegrator::TextureData data;
+            data.width = pTexture->getWidth(0);
+            data.height = pTexture->getHeight(0);
+            if (pSampler)
+            {
+                data.addressModeU = pSampler->getAddressModeU();
+                data.addressModeV = pSampler->getAddressModeV();
+                data.borderColor = float3(pSampler->getBorderColor());
+            }
+
+            Texture::SharedPtr pSrc = pTexture;
+            ResourceFormat format = pTexture->getFormat();
+            if (!PixelConversion::isConvertibleToRGBA32Float(format))
+            {
+                format = ResourceFormat::RGBA32Float;
+                pSrc = Texture::create2D(data.width, data.height, format, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget);
+                pRenderContext->blit(pTexture->getSRV(0, 1, 0, 1), pSrc->getRTV(), RenderContext::kMaxRect, RenderContext::kMaxRect, Sampler::Filter::Point);
+            }
+
+            std::vector<uint8_t> texels = pRenderContext->readTextureSubresource(pSrc.get(), 0);
+            std::vector<float> rgba((size_t)data.width * data.height * 4);
+            PixelConversion::convertToRGBA32Float(format, data.width, data.height, texels.data(), getFormatRowPitch(format, data.width), rgba.data());
+
+            data.texels.resize((size_t)data.width * data.height);
+            for (size_t i = 0; i < data.texels.size(); i++) data.texels[i] = float3(rgba[4 * i + 0], rgba[4 * i + 1], rgba[4 * i + 2]);
+            return data;
+        }
     }
 
-    LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
+    LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, bool useGPUIntegrator)
     {
-        return SharedPtr(new LightCollection(pRenderContext, pScene));
+        return SharedPtr(new LightCollection(pRenderContext, pScene, useGPUIntegrator));
     }
 
-    LightCollection::LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
+    LightCollection::LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, bool useGPUIntegrator)
+        : mUseGPUIntegrator(useGPUIntegrator)
     {
         FALCOR_ASSERT(pScene);
         mpScene = pScene;
@@ -64,7 +104,7 @@ namespace Falcor
 
         // Create program for integrating emissive textures.
         // This should be done after lights are setup, so that we know which sampler state etc. to use.
-        initIntegrator(*pScene);
+        if (mUseGPUIntegrator) initIntegrator(*pScene);
 
         // Create programs for building/updating the mesh lights.
         Shader::DefineList defines = pScene->getSceneDefines();
@@ -246,17 +286,24 @@ namespace Falcor
             timeReport.measure("LightCollection::build preparation");
 
             // Pre-integrate emissive triangles.
+            // The CPU integrator leaves the CPU data in sync, the GPU integrator requires reading back all data.
             // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
-            integrateEmissive(pRenderContext, scene);
+            if (mUseGPUIntegrator)
+            {
+                integrateEmissive(pRenderContext, scene);
+                mCPUInvalidData = CPUOutOfDateFlags::All;
+                mStagingBufferValid = false;
+                prepareSyncCPUData(pRenderContext);
+            }
+            else
+            {
+                integrateEmissiveCPU(pRenderContext, scene);
+            }
 
             timeReport.measure("LightCollection::build integrate emissive");
 
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
             mStatsValid = false;
-
-            prepareSyncCPUData(pRenderContext);
             updateActiveTriangleList();
 
             timeReport.measure("LightCollection::build finalize");
@@ -407,6 +454,126 @@ namespace Falcor
 #endif
     }
 
+    void LightCollection::integrateEmissiveCPU(RenderContext* pRenderContext, const Scene& scene)
+    {
+        FALCOR_ASSERT(mTriangleCount > 0);
+        FALCOR_ASSERT(mMeshLights.size() > 0);
+
+        // Read back the triangle data for the texture coordinates and areas.
+        mCPUInvalidData = CPUOutOfDateFlags::TriangleData;
+        mStagingBufferValid = false;
+        prepareSyncCPUData(pRenderContext);
+        syncCPUData();
+
+        // Compute the average emissive color per triangle.
+        // Mesh lights are grouped by emissive texture so that each texture is read back at most once.
+        // Results are looked up by the hash of the texture content and the texture coordinates,
+        // first among the mesh lights integrated so far (e.g. instances of the same mesh) and then in the persistent cache.
+        std::vector<float3> averageColors(mTriangleCount);
+        std::map<Texture::SharedPtr, std::vector<uint32_t>> texturedLights;
+
+        for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); lightIdx++)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+
+            if (auto pTexture = pMaterial->getEmissiveTexture()) texturedLights[pTexture].push_back(lightIdx);
+            else std::fill_n(averageColors.begin() + meshLight.triangleOffset, meshLight.triangleCount, pMaterial->getData().emissive);
+        }
+
+        EmissiveTextureIntegrator::Cache cache;
+        std::map<SHA1::MD, std::vector<float3>> results;
+        uint32_t integratedCount = 0;
+        uint32_t cachedCount = 0;
+
+        for (const auto& it : texturedLights)
+        {
+            const Texture::SharedPtr& pTexture = it.first;
+            const std::vector<uint32_t>& lightIndices = it.second;
+
+            // Read back the texture lazily, it's not needed if all results are found in the cache.
+            EmissiveTextureIntegrator::TextureData textureData;
+            bool hasTextureData = false;
+            auto loadTextureData = [&]()
+            {
+                if (hasTextureData) return;
+                textureData = readTextureData(pRenderContext, pTexture, mpSamplerState);
+                hasTextureData = true;
+            };
+
+            SHA1::MD textureHash;
+            if (!TextureCache::computeSourceHash(*pTexture, textureHash))
+            {
+                loadTextureData();
+                SHA1 sha1;
+                sha1.update(&textureData.width, sizeof(textureData.width));
+                sha1.update(&textureData.height, sizeof(textureData.height));
+                sha1.update(textureData.texels.data(), textureData.texels.size() * sizeof(float3));
+                textureHash = sha1.finalize();
+            }
+
+            const auto addressModeU = mpSamplerState ? mpSamplerState->getAddressModeU() : Sampler::AddressMode::Wrap;
+            const auto addressModeV = mpSamplerState ? mpSamplerState->getAddressModeV() : Sampler::AddressMode::Wrap;
+
+            for (uint32_t lightIdx : lightIndices)
+            {
+                const MeshLightData& meshLight = mMeshLights[lightIdx];
+
+                std::vector<float2> texCoords(3 * (size_t)meshLight.triangleCount);
+                for (uint32_t i = 0; i < meshLight.triangleCount; i++)
+                {
+                    const auto& tri = mMeshLightTriangles[meshLight.triangleOffset + i];
+                    for (uint32_t j = 0; j < 3; j++) texCoords[3 * i + j] = tri.vtx[j].uv;
+                }
+
+                auto key = EmissiveTextureIntegrator::computeKey(textureHash, addressModeU, addressModeV, texCoords);
+                auto resultIt = results.find(key);
+                if (resultIt == results.end())
+                {
+                    std::vector<float3> averages;
+                    if (cache.load(key, meshLight.triangleCount, averages))
+                    {
+                        cachedCount += meshLight.triangleCount;
+                    }
+                    else
+                    {
+                        loadTextureData();
+                        averages = EmissiveTextureIntegrator::integrateTriangles(textureData, texCoords);
+                        cache.store(key, averages);
+                        integratedCount += meshLight.triangleCount;
+                    }
+                    resultIt = results.emplace(key, std::move(averages)).first;
+                }
+
+                FALCOR_ASSERT(resultIt->second.size() == meshLight.triangleCount);
+                std::copy(resultIt->second.begin(), resultIt->second.end(), averageColors.begin() + meshLight.triangleOffset);
+            }
+        }
+
+        logInfo("LightCollection: Integrated {} textured emissive triangles, {} loaded from cache.", integratedCount, cachedCount);
+
+        // Compute the per-triangle flux values. This matches FinalizeIntegration.cs.slang.
+        // We assume diffuse emitters and integrate per side (hemisphere) => the scale factor is pi.
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        {
+            auto& tri = mMeshLightTriangles[triIdx];
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(mMeshLights[tri.lightIdx].materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+
+            tri.averageRadiance = averageColors[triIdx] * pMaterial->getData().emissiveFactor;
+            tri.flux = luminance(tri.averageRadiance) * tri.area * (float)M_PI;
+            fluxData[triIdx].flux = tri.flux;
+            fluxData[triIdx].averageRadiance = tri.averageRadiance;
+        }
+
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+
+        // The CPU triangle list is now up-to-date with the GPU data.
+        FALCOR_ASSERT(mCPUInvalidData == CPUOutOfDateFlags::None);
+    }
+
     void LightCollection::computeStats() const
     {
         if (mStatsValid) return;
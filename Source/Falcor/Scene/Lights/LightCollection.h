@@ -122,9 +122,11 @@ namespace Falcor
             Note that update() must be called before the collection is ready to use.
             \param[in] pRenderContext The render context.
             \param[in] pScene The scene.
+            \param[in] useGPUIntegrator Integrate textured emissive triangles by rasterization on the GPU instead of on the CPU.
+                The GPU integrator requires conservative rasterization tier 3 and Shader Model 6.6, and does not use the integration cache.
             \return A pointer to a new light collection object, or throws an exception if creation failed.
         */
-        static SharedPtr create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene);
+        static SharedPtr create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, bool useGPUIntegrator = false);
 
         /** Updates the light collection to the current state of the scene.
             \param[in] pRenderContext The render context.
@@ -183,7 +185,7 @@ namespace Falcor
         };
 
     protected:
-        LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene);
+        LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, bool useGPUIntegrator);
 
         void initIntegrator(const Scene& scene);
         void setupMeshLights(const Scene& scene);
@@ -191,6 +193,7 @@ namespace Falcor
         void prepareTriangleData(RenderContext* pRenderContext, const Scene& scene);
         void prepareMeshData(const Scene& scene);
         void integrateEmissive(RenderContext* pRenderContext, const Scene& scene);
+        void integrateEmissiveCPU(RenderContext* pRenderContext, const Scene& scene);
         void computeStats() const;
         void buildTriangleList(RenderContext* pRenderContext, const Scene& scene);
         void updateActiveTriangleList();
@@ -224,6 +227,7 @@ namespace Falcor
         GpuFence::SharedPtr                     mpStagingFence;         ///< Fence used for waiting on the staging buffer being filled in.
 
         Sampler::SharedPtr                      mpSamplerState;         ///< Material sampler for emissive textures.
+        bool                                    mUseGPUIntegrator = false; ///< True if textured emissive triangles are integrated on the GPU.
 
         // Shader programs.
         struct
@@ -71,6 +71,9 @@ namespace Falcor
 
         mpFence = GpuFence::create();
         mpTextureManager = TextureManager::create(kMaxTextureCount);
+        mSamplersPath = ShaderVarPath(kMaterialSamplersName);
+        mTexturesPath = ShaderVarPath(kMaterialTexturesName);
+        mBuffersPath = ShaderVarPath(kMaterialBuffersName);
         mMaterialCountByType.resize((size_t)MaterialType::Count, 0);
 
         // Create a default texture sampler.
@@ -230,8 +233,8 @@ namespace Falcor
             pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
         }
 
-        pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
         mMaterials.push_back(pMaterial);
+        registerMaterialUpdateCallback(materialID.get());
         mMaterialsChanged = true;
 
         // Update metadata.
@@ -291,8 +294,24 @@ namespace Falcor
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
+            // Removed materials no longer belong to the material system, clear their update callbacks.
+            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
+            {
+                const auto& pMaterial = mMaterials[materialID];
+                if (uniqueMaterials[idMap[materialID].get()] != pMaterial) pMaterial->registerUpdateCallback(nullptr);
+            }
+
             mMaterials = uniqueMaterials;
             mMaterialsChanged = true;
+
+            // Material IDs changed, drop the dirty list and re-register the update callbacks.
+            // All materials are uploaded on the next update as the material set changed.
+            mDirtyMaterials.clear();
+            mMaterialDirty.assign(mMaterials.size(), false);
+            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
+            {
+                registerMaterialUpdateCallback(materialID);
+            }
         }
 
         return removed;
@@ -394,40 +413,68 @@ namespace Falcor
             forceUpdate = true; // Trigger full upload of all materials
         }
 
-        // Update all materials.
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        // Update materials.
+        if (forceUpdate)
         {
+            // Update all materials and upload all material data in one copy.
             for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
             {
-                auto& pMaterial = mMaterials[materialID];
-                const auto materialUpdates = pMaterial->update(this);
+                flags |= mMaterials[materialID]->update(this);
+            }
+            if (!mMaterials.empty()) uploadMaterials(0, (uint32_t)mMaterials.size());
+        }
+        else if (!mDirtyMaterials.empty())
+        {
+            // Update materials on the dirty list only. Materials may add themselves to the list while updating,
+            // so we iterate by index as the list may grow.
+            std::vector<uint32_t> uploadIDs;
+            for (size_t i = 0; i < mDirtyMaterials.size(); ++i)
+            {
+                const uint32_t materialID = mDirtyMaterials[i];
+                const auto materialUpdates = mMaterials[materialID]->update(this);
 
-                if (forceUpdate || materialUpdates != Material::UpdateFlags::None)
+                if (materialUpdates != Material::UpdateFlags::None)
                 {
-                    uploadMaterial(materialID);
-
+                    uploadIDs.push_back(materialID);
                     flags |= materialUpdates;
                 }
             }
+
+            // Upload contiguous runs of updated materials in one copy each.
+            std::sort(uploadIDs.begin(), uploadIDs.end());
+            uploadIDs.erase(std::unique(uploadIDs.begin(), uploadIDs.end()), uploadIDs.end());
+            for (size_t i = 0; i < uploadIDs.size();)
+            {
+                size_t first = i;
+                while (++i < uploadIDs.size() && uploadIDs[i] == uploadIDs[i - 1] + 1) {}
+                uploadMaterials(uploadIDs[first], (uint32_t)(i - first));
+            }
         }
 
+        for (uint32_t materialID : mDirtyMaterials) mMaterialDirty[materialID] = false;
+        mDirtyMaterials.clear();
+
         // Update samplers.
         if (forceUpdate || mSamplersChanged)
         {
-            auto var = mpMaterialsBlock[kMaterialSamplersName];
+            auto var = mSamplersPath.get(mpMaterialsBlock->getRootVar());
             for (size_t i = 0; i < mTextureSamplers.size(); i++) var[i] = mTextureSamplers[i];
         }
 
-        // Update textures.
-        if (forceUpdate || is_set(flags, Material::UpdateFlags::ResourcesChanged))
+        // Update textures. Unless the parameter block changed, only descriptors of textures that changed are rebound.
+        if (forceUpdate)
         {
-            mpTextureManager->setShaderData(mpMaterialsBlock[kMaterialTexturesName], mTextureDescCount);
+            mpTextureManager->setShaderData(mTexturesPath.get(mpMaterialsBlock->getRootVar()), mTextureDescCount);
+        }
+        else if (is_set(flags, Material::UpdateFlags::ResourcesChanged))
+        {
+            mpTextureManager->updateShaderData(mTexturesPath.get(mpMaterialsBlock->getRootVar()), mTextureDescCount);
         }
 
         // Update buffers.
         if (forceUpdate || mBuffersChanged)
         {
-            auto var = mpMaterialsBlock[kMaterialBuffersName];
+            auto var = mBuffersPath.get(mpMaterialsBlock->getRootVar());
             for (size_t i = 0; i < mBuffers.size(); i++) var[i] = mBuffers[i];
         }
 
@@ -454,7 +501,6 @@ namespace Falcor
         mSamplersChanged = false;
         mBuffersChanged = false;
         mMaterialsChanged = false;
-        mMaterialUpdates = Material::UpdateFlags::None;
 
         return flags;
     }
@@ -572,15 +618,40 @@ namespace Falcor
         mpMaterialsBlock["materialCount"] = getMaterialCount();
     }
 
-    void MaterialSystem::uploadMaterial(const uint32_t materialID)
+    void MaterialSystem::registerMaterialUpdateCallback(const uint32_t materialID)
     {
         FALCOR_ASSERT(materialID < mMaterials.size());
-        const auto& pMaterial = mMaterials[materialID];
-        FALCOR_ASSERT(pMaterial);
+        mMaterials[materialID]->registerUpdateCallback([this, materialID](Material::UpdateFlags) { markMaterialDirty(materialID); });
+    }
 
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
+    void MaterialSystem::markMaterialDirty(const uint32_t materialID)
+    {
+        if (materialID >= mMaterials.size()) return;
+        if (mMaterialDirty.size() < mMaterials.size()) mMaterialDirty.resize(mMaterials.size(), false);
+        if (mMaterialDirty[materialID]) return;
+
+        mMaterialDirty[materialID] = true;
+        mDirtyMaterials.push_back(materialID);
+    }
+
+    void MaterialSystem::uploadMaterial(const uint32_t materialID)
+    {
+        uploadMaterials(materialID, 1);
+    }
+
+    void MaterialSystem::uploadMaterials(uint32_t firstMaterialID, uint32_t count)
+    {
+        FALCOR_ASSERT(firstMaterialID + count <= mMaterials.size());
         FALCOR_ASSERT(mpMaterialDataBuffer);
-        mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
+
+        mUploadStaging.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& pMaterial = mMaterials[firstMaterialID + i];
+            FALCOR_ASSERT(pMaterial);
+            mUploadStaging[i] = pMaterial->getDataBlob();
+        }
+
+        mpMaterialDataBuffer->setBlob(mUploadStaging.data(), firstMaterialID * sizeof(MaterialDataBlob), count * sizeof(MaterialDataBlob));
     }
 }
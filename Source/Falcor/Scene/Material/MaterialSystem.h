@@ -33,6 +33,7 @@
 #include "Core/API/Buffer.h"
 #include "Core/API/Sampler.h"
 #include "Core/Program/Program.h"
+#include "Core/Program/ShaderVarPath.h"
 #include "Utils/Image/TextureManager.h"
 #include "Utils/UI/Gui.h"
 #include <memory>
@@ -220,7 +221,10 @@ namespace Falcor
 
         void updateUI();
         void createParameterBlock();
+        void registerMaterialUpdateCallback(const uint32_t materialID);
+        void markMaterialDirty(const uint32_t materialID);
         void uploadMaterial(const uint32_t materialID);
+        void uploadMaterials(uint32_t firstMaterialID, uint32_t count);
 
         std::vector<Material::SharedPtr> mMaterials;                ///< List of all materials.
         std::vector<uint32_t> mMaterialCountByType;                 ///< Number of materials of each type, indexed by MaterialType.
@@ -236,7 +240,9 @@ namespace Falcor
         bool mSamplersChanged = false;                              ///< Flag indicating if samplers were added/removed since last update.
         bool mBuffersChanged = false;                               ///< Flag indicating if buffers were added/removed since last update.
         bool mMaterialsChanged = false;                             ///< Flag indicating if materials were added/removed since last update. Per-material updates are tracked by each material's update flags.
-        Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
+        std::vector<uint32_t> mDirtyMaterials;                      ///< IDs of materials that were updated since last update. Materials register themselves here when they change.
+        std::vector<bool> mMaterialDirty;                           ///< Flag per material, true if the material is on the dirty list.
+        std::vector<MaterialDataBlob> mUploadStaging;               ///< Staging memory for batched material data uploads.
 
         // GPU resources
         GpuFence::SharedPtr mpFence;
@@ -245,6 +251,9 @@ namespace Falcor
         Sampler::SharedPtr mpDefaultTextureSampler;                 ///< Default texture sampler to use for all materials.
         std::vector<Sampler::SharedPtr> mTextureSamplers;           ///< Texture sampler states. These are indexed by ID in the materials.
         std::vector<Buffer::SharedPtr> mBuffers;                    ///< Buffers used by the materials. These are indexed by ID in the materials.
+        ShaderVarPath mSamplersPath;                                ///< Precompiled path to the texture samplers in the parameter block.
+        ShaderVarPath mTexturesPath;                                ///< Precompiled path to the textures in the parameter block.
+        ShaderVarPath mBuffersPath;                                 ///< Precompiled path to the buffers in the parameter block.
 
         // UI variables
         std::vector<uint32_t> mSortedMaterialIndices;               ///< Indices of materials, sorted alphabetically by case-insensitive name.
@@ -30,6 +30,26 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Block compression mode requested for each texture slot when loading through a texture cache.
+            Normal maps are stored as two channel BC5 textures, the z component is reconstructed at runtime.
+            Displacement maps are kept uncompressed as they are sensitive to quantization.
+        */
+        ImageIO::CompressionMode getCompressionMode(Material::TextureSlot slot)
+        {
+            switch (slot)
+            {
+            case Material::TextureSlot::Normal:
+                return ImageIO::CompressionMode::BC5;
+            case Material::TextureSlot::Displacement:
+                return ImageIO::CompressionMode::None;
+            default:
+                return ImageIO::CompressionMode::BC7;
+            }
+        }
+    }
+
     MaterialTextureLoader::MaterialTextureLoader(const TextureManager::SharedPtr& pTextureManager, bool useSrgb)
         : mpTextureManager(pTextureManager)
         , mUseSrgb(useSrgb)
@@ -53,7 +73,7 @@ namespace Falcor
         bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
 
         // Request texture to be loaded.
-        auto handle = mpTextureManager->loadTexture(path, true, srgb);
+        auto handle = mpTextureManager->loadTexture(path, true, srgb, Resource::BindFlags::ShaderResource, true, getCompressionMode(slot));
 
         // Store assignment to material for later.
         mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle });
@@ -0,0 +1,314 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshOptimizer.h"
+#include "Core/Assert.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Parameters of Forsyth's vertex scoring function. The optimizer models an LRU cache of kModelCacheSize entries.
+        const uint32_t kModelCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriangleScore = 0.75f;
+        const float kValenceBoostScale = 2.f;
+        const float kValenceBoostPower = 0.5f;
+        const uint32_t kMaxTableValence = 32;
+
+        const uint32_t kInvalidTriangle = 0xffffffff;
+
+        struct VertexScoreTable
+        {
+            float cache[kModelCacheSize];
+            float valence[kMaxTableValence + 1];
+
+            VertexScoreTable()
+            {
+                for (uint32_t i = 0; i < kModelCacheSize; i++)
+                {
+                    // The three vertices of the last emitted triangle get a fixed score, so that the next triangle
+                    // doesn't prefer a particular edge of it. The remaining entries decay with their position.
+                    if (i < 3) cache[i] = kLastTriangleScore;
+                    else cache[i] = std::pow(1.f - float(i - 3) / float(kModelCacheSize - 3), kCacheDecayPower);
+                }
+
+                // Boost vertices with few remaining triangles to avoid leaving isolated triangles behind.
+                valence[0] = 0.f;
+                for (uint32_t i = 1; i <= kMaxTableValence; i++) valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+            }
+
+            float getScore(int32_t cachePosition, uint32_t activeTriangleCount) const
+            {
+                if (activeTriangleCount == 0) return -1.f;
+                float score = cachePosition >= 0 ? cache[cachePosition] : 0.f;
+                score += activeTriangleCount <= kMaxTableValence ? valence[activeTriangleCount] : kValenceBoostScale * std::pow(float(activeTriangleCount), -kValenceBoostPower);
+                return score;
+            }
+        };
+
+        /** Interleave the lower 10 bits of x with two zero bits.
+        */
+        uint32_t expandBits(uint32_t x)
+        {
+            x &= 0x3ff;
+            x = (x | (x << 16)) & 0x030000ff;
+            x = (x | (x << 8)) & 0x0300f00f;
+            x = (x | (x << 4)) & 0x030c30c3;
+            x = (x | (x << 2)) & 0x09249249;
+            return x;
+        }
+
+        /** Compute a 30-bit Morton code for a point with normalized coordinates in [0,1].
+        */
+        uint32_t computeMortonCode(const float3& p)
+        {
+            uint32_t x = (uint32_t)std::clamp(p.x * 1024.f, 0.f, 1023.f);
+            uint32_t y = (uint32_t)std::clamp(p.y * 1024.f, 0.f, 1023.f);
+            uint32_t z = (uint32_t)std::clamp(p.z * 1024.f, 0.f, 1023.f);
+            return (expandBits(x) << 2) | (expandBits(y) << 1) | expandBits(z);
+        }
+    }
+
+    MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        FALCOR_ASSERT(cacheSize > 0);
+
+        VertexCacheStats stats;
+        stats.triangleCount = indices.size() / 3;
+
+        // A vertex is in the FIFO cache if fewer than cacheSize misses happened since it was last inserted.
+        std::vector<uint32_t> insertTime(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+
+        for (uint32_t index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            if (insertTime[index] == 0) stats.vertexCount++;
+            if (time - insertTime[index] > cacheSize)
+            {
+                insertTime[index] = time++;
+                stats.cacheMissCount++;
+            }
+        }
+
+        return stats;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        if (triangleCount == 0) return;
+
+        static const VertexScoreTable kScoreTable;
+
+        // Build the list of adjacent triangles for each vertex.
+        // The first activeTriangleCount[v] entries of a vertex's list are the triangles that have not been emitted yet.
+        std::vector<uint32_t> activeTriangleCount(vertexCount, 0);
+        for (uint32_t index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            activeTriangleCount[index]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + activeTriangleCount[v];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fillOffset(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (uint32_t i = 0; i < (uint32_t)indices.size(); i++) adjacency[fillOffset[indices[i]]++] = i / 3;
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) vertexScore[v] = kScoreTable.getScore(-1, activeTriangleCount[v]);
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+
+        uint32_t cache[kModelCacheSize + 3];
+        uint32_t cacheCount = 0;
+        uint32_t nextCandidate = 0;
+        uint32_t bestTriangle = kInvalidTriangle;
+
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            // If no triangle touches the cache, continue with the next triangle in input order.
+            // This replaces the full search for the highest scoring triangle and keeps the run time linear.
+            if (bestTriangle == kInvalidTriangle)
+            {
+                while (emitted[nextCandidate]) nextCandidate++;
+                bestTriangle = nextCandidate;
+            }
+
+            const uint32_t* triangle = &indices[bestTriangle * 3];
+            output.insert(output.end(), triangle, triangle + 3);
+            emitted[bestTriangle] = true;
+
+            // Remove the triangle from the active lists of its vertices.
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                uint32_t v = triangle[j];
+                uint32_t* active = &adjacency[adjacencyOffset[v]];
+                uint32_t& count = activeTriangleCount[v];
+                auto it = std::find(active, active + count, bestTriangle);
+                FALCOR_ASSERT(it != active + count);
+                std::swap(*it, active[count - 1]);
+                count--;
+            }
+
+            // Move the triangle's vertices to the front of the LRU cache.
+            uint32_t newCache[kModelCacheSize + 3];
+            uint32_t newCacheCount = 0;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                if (std::find(newCache, newCache + newCacheCount, triangle[j]) == newCache + newCacheCount) newCache[newCacheCount++] = triangle[j];
+            }
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheCount++] = v;
+            }
+
+            // Update the scores of the vertices that were pushed out of the cache.
+            for (uint32_t i = kModelCacheSize; i < newCacheCount; i++)
+            {
+                uint32_t v = newCache[i];
+                cachePosition[v] = -1;
+                vertexScore[v] = kScoreTable.getScore(-1, activeTriangleCount[v]);
+            }
+
+            cacheCount = std::min(newCacheCount, kModelCacheSize);
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = newCache[i];
+                cache[i] = v;
+                cachePosition[v] = (int32_t)i;
+                vertexScore[v] = kScoreTable.getScore((int32_t)i, activeTriangleCount[v]);
+            }
+
+            // Pick the highest scoring triangle among the ones referencing a cached vertex.
+            bestTriangle = kInvalidTriangle;
+            float bestScore = -1.f;
+            for (uint32_t i = 0; i < cacheCount; i++)
+            {
+                uint32_t v = cache[i];
+                const uint32_t* active = &adjacency[adjacencyOffset[v]];
+                for (uint32_t k = 0; k < activeTriangleCount[v]; k++)
+                {
+                    uint32_t t = active[k];
+                    const uint32_t* tri = &indices[t * 3];
+                    float score = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        indices = std::move(output);
+    }
+
+    void MeshOptimizer::sortClustersSpatially(std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t clusterTriangleCount)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        FALCOR_ASSERT(clusterTriangleCount > 0);
+
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        const uint32_t clusterCount = div_round_up(triangleCount, clusterTriangleCount);
+        if (clusterCount <= 1) return;
+
+        // Compute the centroid of each cluster as the average of its triangle centroids.
+        std::vector<float3> centroids(clusterCount, float3(0.f));
+        AABB bounds;
+        for (uint32_t c = 0; c < clusterCount; c++)
+        {
+            uint32_t first = c * clusterTriangleCount;
+            uint32_t count = std::min(clusterTriangleCount, triangleCount - first);
+            float3 sum(0.f);
+            for (uint32_t i = first * 3; i < (first + count) * 3; i++)
+            {
+                FALCOR_ASSERT(indices[i] < positions.size());
+                sum += positions[indices[i]];
+            }
+            centroids[c] = sum / float(count * 3);
+            bounds.include(centroids[c]);
+        }
+
+        // Sort the clusters by the Morton codes of their centroids.
+        const float3 extent = bounds.extent();
+        const float3 scale = float3(extent.x > 0.f ? 1.f / extent.x : 0.f, extent.y > 0.f ? 1.f / extent.y : 0.f, extent.z > 0.f ? 1.f / extent.z : 0.f);
+
+        std::vector<std::pair<uint32_t, uint32_t>> keys(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++) keys[c] = { computeMortonCode((centroids[c] - bounds.minPoint) * scale), c };
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (const auto& key : keys)
+        {
+            uint32_t first = key.second * clusterTriangleCount;
+            uint32_t count = std::min(clusterTriangleCount, triangleCount - first);
+            output.insert(output.end(), indices.begin() + first * 3, indices.begin() + (first + count) * 3);
+        }
+
+        indices = std::move(output);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        const uint32_t kUnused = 0xffffffff;
+        std::vector<uint32_t> remap(vertexCount, kUnused);
+        uint32_t nextVertex = 0;
+
+        for (uint32_t& index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            if (remap[index] == kUnused) remap[index] = nextVertex++;
+            index = remap[index];
+        }
+
+        // Keep unreferenced vertices at the end so that the vertex count is unchanged.
+        for (uint32_t& r : remap)
+        {
+            if (r == kUnused) r = nextVertex++;
+        }
+        FALCOR_ASSERT(nextVertex == vertexCount);
+
+        return remap;
+    }
+}
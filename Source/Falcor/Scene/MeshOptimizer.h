@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Assert.h"
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Utility functions for improving the memory locality of indexed triangle meshes.
+
+        The typical use is to call optimizeVertexCache() followed by sortClustersSpatially() and optimizeVertexFetch().
+        The first reorders triangles for post-transform vertex cache efficiency using Forsyth's
+        linear-speed vertex cache optimization (https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html).
+        The second reorders fixed-size clusters of consecutive triangles along a Morton curve so that
+        nearby triangles end up close in memory, which improves the coherence of BLAS builds and hit shading.
+        The last remaps vertices in the order they are first referenced, which improves vertex fetch locality.
+    */
+    class FALCOR_API MeshOptimizer
+    {
+    public:
+        static constexpr uint32_t kDefaultCacheSize = 16;           ///< FIFO cache size used for computing statistics.
+        static constexpr uint32_t kDefaultClusterTriangleCount = 64; ///< Number of triangles per cluster used for spatial sorting.
+
+        /** Post-transform vertex cache statistics.
+        */
+        struct VertexCacheStats
+        {
+            uint64_t triangleCount = 0;     ///< Number of triangles.
+            uint64_t vertexCount = 0;       ///< Number of unique vertices referenced by the triangles.
+            uint64_t cacheMissCount = 0;    ///< Number of vertex shader invocations, i.e., cache misses.
+
+            /** Average cache miss ratio, the number of cache misses per triangle. Range [0.5, 3] with 0.5 being optimal for large regular meshes.
+            */
+            double getACMR() const { return triangleCount > 0 ? (double)cacheMissCount / (double)triangleCount : 0.0; }
+
+            /** Average transformed vertex ratio, the number of cache misses per vertex. Range [1, 6] with 1 being optimal.
+            */
+            double getATVR() const { return vertexCount > 0 ? (double)cacheMissCount / (double)vertexCount : 0.0; }
+
+            VertexCacheStats& operator+=(const VertexCacheStats& other)
+            {
+                triangleCount += other.triangleCount;
+                vertexCount += other.vertexCount;
+                cacheMissCount += other.cacheMissCount;
+                return *this;
+            }
+        };
+
+        /** Simulate a FIFO post-transform vertex cache.
+            \param[in] indices Triangle list indices.
+            \param[in] vertexCount Number of vertices.
+            \param[in] cacheSize Number of cache entries.
+            \return Vertex cache statistics.
+        */
+        static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder triangles for post-transform vertex cache efficiency.
+            \param[in,out] indices Triangle list indices, reordered in place. The winding of each triangle is preserved.
+            \param[in] vertexCount Number of vertices.
+        */
+        static void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Reorder clusters of consecutive triangles along a Morton curve through their centroids.
+            The order of triangles within a cluster is preserved, so vertex cache efficiency is only affected at cluster boundaries.
+            \param[in,out] indices Triangle list indices, reordered in place.
+            \param[in] positions Vertex positions.
+            \param[in] clusterTriangleCount Number of triangles per cluster.
+        */
+        static void sortClustersSpatially(std::vector<uint32_t>& indices, const std::vector<float3>& positions, uint32_t clusterTriangleCount = kDefaultClusterTriangleCount);
+
+        /** Remap vertices in the order they are first referenced by the indices. Unreferenced vertices are moved to the end.
+            \param[in,out] indices Triangle list indices, rewritten to reference the remapped vertices.
+            \param[in] vertexCount Number of vertices.
+            \return Remapping table from old to new vertex index. Use remapVertices() to apply it to vertex data.
+        */
+        static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Apply a vertex remapping table as returned by optimizeVertexFetch().
+            \param[in,out] vertices Vertex data, reordered in place.
+            \param[in] remap Remapping table from old to new vertex index.
+        */
+        template<typename T>
+        static void remapVertices(std::vector<T>& vertices, const std::vector<uint32_t>& remap)
+        {
+            FALCOR_ASSERT(vertices.size() == remap.size());
+            std::vector<T> remapped(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++) remapped[remap[i]] = std::move(vertices[i]);
+            vertices = std::move(remapped);
+        }
+    };
+}
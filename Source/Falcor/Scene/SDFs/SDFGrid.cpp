@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SDFGrid.h"
+#include "SDFMeshVoxelizer.h"
 #include "NormalizedDenseSDFGrid/NDSDFGrid.h"
 #include "SparseVoxelSet/SDFSVS.h"
 #include "SparseBrickSet/SDFSBS.h"
@@ -44,6 +45,7 @@
 #include <rapidjson/error/en.h>
 #include <random>
 #include <fstream>
+#include <sstream>
 
 namespace Falcor
 {
@@ -347,6 +349,15 @@ namespace Falcor
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
+            if (SDFSparseGridFile::isSparseGridFile(fullPath))
+            {
+                // Never fall back to the dense parser, it would interpret the sparse header as the grid width.
+                SDFSparseGridFile::Reader reader;
+                if (reader.open(fullPath) && setValuesFromSparseReader(reader)) return true;
+                logWarning("SDFGrid::loadValuesFromFile() sparse SDF grid file '{}' could not be loaded!", path);
+                return false;
+            }
+
             std::ifstream file(fullPath, std::ios::in | std::ios::binary);
 
             if (file.is_open())
@@ -370,6 +381,117 @@ namespace Falcor
         return false;
     }
 
+    bool SDFGrid::setValuesFromMesh(const TriangleMesh::SharedPtr& pMesh, uint32_t gridWidth, float narrowBandThickness, uint32_t brickWidth)
+    {
+        checkArgument(pMesh != nullptr, "'pMesh' must be a valid mesh");
+
+        SDFMeshVoxelizer::Options options;
+        options.gridWidth = gridWidth;
+        options.brickWidth = brickWidth;
+        options.narrowBandThickness = narrowBandThickness;
+
+        // The voxelized bricks go through an in-memory sparse grid, the dense grid is never created.
+        auto pStream = std::make_unique<std::stringstream>(std::ios::in | std::ios::out | std::ios::binary);
+        SDFMeshVoxelizer voxelizer(*pMesh);
+        if (!voxelizer.write(*pStream, options))
+        {
+            logWarning("SDFGrid::setValuesFromMesh() failed to voxelize mesh.");
+            return false;
+        }
+
+        pStream->seekg(0);
+        SDFSparseGridFile::Reader reader;
+        return reader.open(std::move(pStream)) && setValuesFromSparseReader(reader);
+    }
+
+    bool SDFGrid::voxelizeMeshToFile(const std::filesystem::path& meshPath, const std::filesystem::path& sparsePath, uint32_t gridWidth, float narrowBandThickness, uint32_t brickWidth)
+    {
+        TriangleMesh::SharedPtr pMesh = TriangleMesh::createFromFile(meshPath);
+        if (!pMesh)
+        {
+            logWarning("SDFGrid::voxelizeMeshToFile() mesh '{}' could not be loaded!", meshPath);
+            return false;
+        }
+
+        SDFMeshVoxelizer::Options options;
+        options.gridWidth = gridWidth;
+        options.brickWidth = brickWidth;
+        options.narrowBandThickness = narrowBandThickness;
+
+        SDFMeshVoxelizer voxelizer(*pMesh);
+        return voxelizer.writeToFile(sparsePath, options);
+    }
+
+    bool SDFGrid::convertValuesFileToSparse(const std::filesystem::path& densePath, const std::filesystem::path& sparsePath, uint32_t brickWidth, float narrowBandThickness)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(densePath, fullPath))
+        {
+            logWarning("SDFGrid::convertValuesFileToSparse() file '{}' could not be found!", densePath);
+            return false;
+        }
+
+        return SDFSparseGridFile::convertFromDense(fullPath, sparsePath, brickWidth, narrowBandThickness);
+    }
+
+    bool SDFGrid::setValuesFromSparseReader(SDFSparseGridFile::Reader& reader)
+    {
+        uint32_t gridWidth = reader.getHeader().gridWidth;
+        Type type = getType();
+        if (type != Type::SparseBrickSet)
+        {
+            checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2 for SDFGrid type of {}", gridWidth, getTypeName(type));
+        }
+
+        mGridWidth = gridWidth;
+        if (!setValuesFromSparseFile(reader)) return false;
+
+        mInitializedWithPrimitives = false;
+        return true;
+    }
+
+    bool SDFGrid::setValuesFromSparseFile(SDFSparseGridFile::Reader& reader)
+    {
+        const auto& header = reader.getHeader();
+        const uint32_t gridWidthInValues = mGridWidth + 1;
+        const uint32_t brickWidthInValues = reader.getBrickWidthInValues();
+
+        std::vector<float> cornerValues(size_t(gridWidthInValues) * gridWidthInValues * gridWidthInValues);
+
+        // Fill bricks outside of the narrow band with the narrow band distance, signed by the brick state.
+        const auto& brickStates = reader.getBrickStates();
+        for (uint32_t virtualBrickID = 0; virtualBrickID < (uint32_t)brickStates.size(); virtualBrickID++)
+        {
+            if (brickStates[virtualBrickID] == SDFSparseGridFile::BrickState::NarrowBand) continue;
+
+            float value = brickStates[virtualBrickID] == SDFSparseGridFile::BrickState::Inside ? -header.narrowBandDistance : header.narrowBandDistance;
+            uint3 brickOrigin = reader.getBrickCoords(virtualBrickID) * header.brickWidth;
+            uint3 brickEnd = glm::min(brickOrigin + brickWidthInValues, uint3(gridWidthInValues));
+
+            for (uint32_t z = brickOrigin.z; z < brickEnd.z; z++)
+                for (uint32_t y = brickOrigin.y; y < brickEnd.y; y++)
+                    for (uint32_t x = brickOrigin.x; x < brickEnd.x; x++)
+                        cornerValues[x + gridWidthInValues * (y + size_t(gridWidthInValues) * z)] = value;
+        }
+
+        // Narrow band bricks are written last so that their values take precedence on shared brick borders.
+        SDFSparseGridFile::BrickHeader brickHeader;
+        std::vector<float> brickValues;
+        while (reader.readNextBrick(brickHeader, brickValues))
+        {
+            uint3 brickOrigin = reader.getBrickCoords(brickHeader.virtualBrickID) * header.brickWidth;
+            uint3 brickExtent = glm::min(brickOrigin + brickWidthInValues, uint3(gridWidthInValues)) - brickOrigin;
+
+            for (uint32_t z = 0; z < brickExtent.z; z++)
+                for (uint32_t y = 0; y < brickExtent.y; y++)
+                    for (uint32_t x = 0; x < brickExtent.x; x++)
+                        cornerValues[(brickOrigin.x + x) + gridWidthInValues * ((brickOrigin.y + y) + size_t(gridWidthInValues) * (brickOrigin.z + z))] = brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)];
+        }
+
+        setValuesInternal(cornerValues);
+        return true;
+    }
+
     void SDFGrid::generateCheeseValues(uint32_t gridWidth, uint32_t seed)
     {
         const float kHalfCheeseExtent = 0.4f;
@@ -642,6 +764,9 @@ namespace Falcor
         sdfGrid.def_static("createSBS", createSBS);
         sdfGrid.def_static("createSVO", [](){ return SDFGrid::SharedPtr(SDFSVO::create()); });
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
+        sdfGrid.def("setValuesFromMesh", &SDFGrid::setValuesFromMesh, "mesh"_a, "gridWidth"_a, "narrowBandThickness"_a = 2.f, "brickWidth"_a = 8);
+        sdfGrid.def_static("voxelizeMeshToFile", &SDFGrid::voxelizeMeshToFile, "meshPath"_a, "sparsePath"_a, "gridWidth"_a, "narrowBandThickness"_a = 2.f, "brickWidth"_a = 8);
+        sdfGrid.def_static("convertValuesFileToSparse", &SDFGrid::convertValuesFileToSparse, "densePath"_a, "sparsePath"_a, "brickWidth"_a = 8, "narrowBandThickness"_a = 2.f);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
@@ -30,6 +30,8 @@
 #include "Core/API/Buffer.h"
 #include "Core/API/Texture.h"
 #include "Scene/SDFs/SDF3DPrimitiveCommon.slang"
+#include "Scene/SDFs/SDFSparseGridFile.h"
+#include "Scene/TriangleMesh.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include <memory>
 #include <vector>
@@ -123,11 +125,43 @@ namespace Falcor
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
         /** Set the signed distance values of the SDF grid from a file.
+            Both dense .sdfg files and sparse narrow band files (see SDFSparseGridFile) are supported.
+            Sparse files are streamed brick by brick and never staged as a dense grid by SDFSVS and uncompressed SDFSBS grids.
             \param[in] path The path of a .sdfg file.
             \return true if the values could be set, otherwise false.
         */
         bool loadValuesFromFile(const std::filesystem::path& path);
 
+        /** Set the signed distance values of the SDF grid by voxelizing a triangle mesh on the CPU (see SDFMeshVoxelizer).
+            Only the narrow band around the surface is evaluated and the dense grid is never created for SDFSVS and uncompressed SDFSBS grids.
+            The mesh is uniformly scaled and centered to fit the grid, see SDFMeshVoxelizer::getMeshToGridTransform().
+            \param[in] pMesh The mesh to voxelize, should be closed for the sign to be meaningful.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] narrowBandThickness Thickness of the narrow band in voxels.
+            \param[in] brickWidth Width of the bricks in voxels used for the narrow band.
+            \return true if the values could be set, otherwise false.
+        */
+        bool setValuesFromMesh(const TriangleMesh::SharedPtr& pMesh, uint32_t gridWidth, float narrowBandThickness = 2.f, uint32_t brickWidth = 8);
+
+        /** Voxelize a mesh file on the CPU and write the result as a sparse SDF grid file that can be loaded with loadValuesFromFile().
+            \param[in] meshPath The path of the mesh file.
+            \param[in] sparsePath The path of the sparse output file.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] narrowBandThickness Thickness of the narrow band in voxels.
+            \param[in] brickWidth Width of the bricks in voxels.
+            \return true if the file could be written, otherwise false.
+        */
+        static bool voxelizeMeshToFile(const std::filesystem::path& meshPath, const std::filesystem::path& sparsePath, uint32_t gridWidth, float narrowBandThickness = 2.f, uint32_t brickWidth = 8);
+
+        /** Convert a dense .sdfg file to the sparse narrow band format.
+            \param[in] densePath The path of a dense .sdfg file.
+            \param[in] sparsePath The path of the sparse output file.
+            \param[in] brickWidth Width of the bricks in voxels.
+            \param[in] narrowBandThickness Thickness of the narrow band in voxels.
+            \return true if the file could be converted, otherwise false.
+        */
+        static bool convertValuesFileToSparse(const std::filesystem::path& densePath, const std::filesystem::path& sparsePath, uint32_t brickWidth = 8, float narrowBandThickness = 2.f);
+
         /** Set the signed distance values of the SDF grid to represent a swiss cheese like shape.
             \param[in] gridWidth The grid width, note that this represents the grid width in voxels, not in values, i.e., cornerValues should have a size of (gridWidth + 1)^3.
             \param[in] seed Set the seed used to create the random holes in the swiss cheese..
@@ -236,6 +270,16 @@ namespace Falcor
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Set the values of the SDF grid by streaming the bricks of a sparse SDF grid file.
+            The default implementation reconstructs the dense grid and calls setValuesInternal(),
+            values in bricks outside of the narrow band are set to plus or minus the narrow band distance.
+            \param[in] reader Reader of the sparse file, positioned at the first brick.
+            \return true if the values could be set, otherwise false.
+        */
+        virtual bool setValuesFromSparseFile(SDFSparseGridFile::Reader& reader);
+
+        bool setValuesFromSparseReader(SDFSparseGridFile::Reader& reader);
+
         void createEvaluatePrimitivesPass(bool writeToTexture3D, bool mergeWithSDField);
 
         void updatePrimitivesBuffer();
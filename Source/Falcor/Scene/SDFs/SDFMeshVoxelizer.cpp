@@ -0,0 +1,412 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFMeshVoxelizer.h"
+#include "SDFSparseGridFile.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <execution>
+#include <fstream>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaxTrianglesPerLeaf = 4;
+
+        /** Nodes further away than kWindingNumberAccuracy times their radius use the dipole approximation.
+        */
+        const float kWindingNumberAccuracy = 2.f;
+
+        /** Returns the closest point on a triangle (Ericson, "Real-Time Collision Detection", 5.1.5).
+        */
+        float3 closestPointOnTriangle(const float3& p, const float3& a, const float3& b, const float3& c)
+        {
+            float3 ab = b - a;
+            float3 ac = c - a;
+            float3 ap = p - a;
+            float d1 = glm::dot(ab, ap);
+            float d2 = glm::dot(ac, ap);
+            if (d1 <= 0.f && d2 <= 0.f) return a;
+
+            float3 bp = p - b;
+            float d3 = glm::dot(ab, bp);
+            float d4 = glm::dot(ac, bp);
+            if (d3 >= 0.f && d4 <= d3) return b;
+
+            float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return a + ab * (d1 / (d1 - d3));
+
+            float3 cp = p - c;
+            float d5 = glm::dot(ab, cp);
+            float d6 = glm::dot(ac, cp);
+            if (d6 >= 0.f && d5 <= d6) return c;
+
+            float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return a + ac * (d2 / (d2 - d6));
+
+            float va = d3 * d6 - d5 * d4;
+            if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+            float denom = 1.f / (va + vb + vc);
+            return a + ab * (vb * denom) + ac * (vc * denom);
+        }
+
+        /** Returns the solid angle of a triangle as seen from the origin (Van Oosterom and Strackee 1983).
+        */
+        float triangleSolidAngle(const float3& a, const float3& b, const float3& c)
+        {
+            float la = glm::length(a);
+            float lb = glm::length(b);
+            float lc = glm::length(c);
+            float numerator = glm::dot(a, glm::cross(b, c));
+            float denominator = la * lb * lc + glm::dot(a, b) * lc + glm::dot(b, c) * la + glm::dot(c, a) * lb;
+            return 2.f * std::atan2(numerator, denominator);
+        }
+
+        float distanceSquaredToAABB(const float3& p, const AABB& aabb)
+        {
+            float3 d = glm::max(glm::max(aabb.minPoint - p, p - aabb.maxPoint), float3(0.f));
+            return glm::dot(d, d);
+        }
+    }
+
+    SDFMeshVoxelizer::SDFMeshVoxelizer(const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+        : mPositions(positions)
+    {
+        checkArgument(indices.size() % 3 == 0, "'indices' size ({}) must be a multiple of 3", indices.size());
+
+        mTriangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            uint3 triangle(indices[i], indices[i + 1], indices[i + 2]);
+            checkArgument(triangle.x < positions.size() && triangle.y < positions.size() && triangle.z < positions.size(), "Triangle {} references an invalid vertex", i / 3);
+            mTriangles.push_back(triangle);
+        }
+
+        for (const float3& p : mPositions) mMeshBounds.include(p);
+    }
+
+    SDFMeshVoxelizer::SDFMeshVoxelizer(const TriangleMesh& mesh)
+        : SDFMeshVoxelizer([&mesh]()
+            {
+                std::vector<float3> positions;
+                positions.reserve(mesh.getVertices().size());
+                for (const auto& v : mesh.getVertices()) positions.push_back(v.position);
+                return positions;
+            }(), mesh.getIndices())
+    {
+    }
+
+    rmcv::mat4 SDFMeshVoxelizer::getMeshToGridTransform(const Options& options) const
+    {
+        float3 extent = mMeshBounds.valid() ? mMeshBounds.extent() : float3(1.f);
+        float maxExtent = std::max(std::max(extent.x, extent.y), std::max(extent.z, std::numeric_limits<float>::min()));
+        float scale = std::max(1.f - 2.f * options.paddingVoxels / float(options.gridWidth), 0.f) / maxExtent;
+        float3 center = mMeshBounds.valid() ? mMeshBounds.center() : float3(0.f);
+        return rmcv::scale(float3(scale)) * rmcv::translate(-center);
+    }
+
+    void SDFMeshVoxelizer::prepare(const Options& options)
+    {
+        checkArgument(options.gridWidth > 0, "'gridWidth' must be larger than 0");
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        rmcv::mat4 meshToGrid = getMeshToGridTransform(options);
+        mGridPositions.resize(mPositions.size());
+        for (size_t i = 0; i < mPositions.size(); i++) mGridPositions[i] = float3(meshToGrid * float4(mPositions[i], 1.f));
+
+        mTriangleOrder.resize(mTriangles.size());
+        for (uint32_t i = 0; i < (uint32_t)mTriangles.size(); i++) mTriangleOrder[i] = i;
+
+        mNodes.clear();
+        mNodes.reserve(2 * div_round_up((uint32_t)mTriangles.size(), kMaxTrianglesPerLeaf));
+        if (!mTriangles.empty()) buildNode(0, (uint32_t)mTriangles.size(), 0);
+
+        mPreparedOptions = options;
+        mPrepared = true;
+        mBVHBuildTimeInMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    uint32_t SDFMeshVoxelizer::buildNode(uint32_t first, uint32_t count, uint32_t depth)
+    {
+        uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.emplace_back();
+
+        // Compute node bounds and the dipole data used for winding number approximation.
+        Node node;
+        AABB centroidBounds;
+        float totalArea = 0.f;
+        float3 weightedCenter(0.f);
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            const uint3& triangle = mTriangles[mTriangleOrder[i]];
+            const float3& a = mGridPositions[triangle.x];
+            const float3& b = mGridPositions[triangle.y];
+            const float3& c = mGridPositions[triangle.z];
+            node.bounds.include(a).include(b).include(c);
+
+            float3 areaNormal = 0.5f * glm::cross(b - a, c - a);
+            float area = glm::length(areaNormal);
+            float3 centroid = (a + b + c) / 3.f;
+            node.areaNormal += areaNormal;
+            weightedCenter += area * centroid;
+            totalArea += area;
+            centroidBounds.include(centroid);
+        }
+
+        node.center = totalArea > 0.f ? weightedCenter / totalArea : node.bounds.center();
+        float3 farCorner = glm::max(glm::abs(node.bounds.minPoint - node.center), glm::abs(node.bounds.maxPoint - node.center));
+        node.radius = glm::length(farCorner);
+
+        float3 centroidExtent = centroidBounds.extent();
+        if (count <= kMaxTrianglesPerLeaf || glm::all(glm::equal(centroidExtent, float3(0.f))))
+        {
+            node.first = first;
+            node.count = count;
+            mNodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+
+        // Split at the median along the largest centroid axis.
+        int axis = centroidExtent.x > centroidExtent.y ? (centroidExtent.x > centroidExtent.z ? 0 : 2) : (centroidExtent.y > centroidExtent.z ? 1 : 2);
+        uint32_t mid = first + count / 2;
+        auto centroidOnAxis = [&](uint32_t triangleIndex)
+        {
+            const uint3& triangle = mTriangles[triangleIndex];
+            return mGridPositions[triangle.x][axis] + mGridPositions[triangle.y][axis] + mGridPositions[triangle.z][axis];
+        };
+        std::nth_element(mTriangleOrder.begin() + first, mTriangleOrder.begin() + mid, mTriangleOrder.begin() + first + count,
+            [&](uint32_t lhs, uint32_t rhs) { return centroidOnAxis(lhs) < centroidOnAxis(rhs); });
+
+        buildNode(first, mid - first, depth + 1);
+        node.first = buildNode(mid, first + count - mid, depth + 1);
+        node.count = 0;
+        mNodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    float SDFMeshVoxelizer::evalSignedDistance(const float3& p) const
+    {
+        FALCOR_ASSERT(mPrepared);
+        if (mNodes.empty()) return std::numeric_limits<float>::max();
+
+        float bestDistanceSquared = std::numeric_limits<float>::max();
+        uint32_t stack[64];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (distanceSquaredToAABB(p, node.bounds) >= bestDistanceSquared) continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    const uint3& triangle = mTriangles[mTriangleOrder[i]];
+                    float3 q = closestPointOnTriangle(p, mGridPositions[triangle.x], mGridPositions[triangle.y], mGridPositions[triangle.z]);
+                    bestDistanceSquared = std::min(bestDistanceSquared, glm::dot(q - p, q - p));
+                }
+            }
+            else
+            {
+                // Visit the closer child first.
+                uint32_t left = uint32_t(&node - mNodes.data()) + 1;
+                uint32_t right = node.first;
+                float leftDistance = distanceSquaredToAABB(p, mNodes[left].bounds);
+                float rightDistance = distanceSquaredToAABB(p, mNodes[right].bounds);
+                if (leftDistance < rightDistance) std::swap(left, right);
+                FALCOR_ASSERT(stackSize + 2 <= 64);
+                stack[stackSize++] = left;
+                stack[stackSize++] = right;
+            }
+        }
+
+        float distance = std::sqrt(bestDistanceSquared);
+        return std::abs(evalWindingNumber(p)) >= 0.5f ? -distance : distance;
+    }
+
+    float SDFMeshVoxelizer::evalWindingNumber(const float3& p) const
+    {
+        FALCOR_ASSERT(mPrepared);
+        if (mNodes.empty()) return 0.f;
+        return evalWindingNumberNode(0, p) / (4.f * glm::pi<float>());
+    }
+
+    float SDFMeshVoxelizer::evalWindingNumberNode(uint32_t nodeIndex, const float3& p) const
+    {
+        const Node& node = mNodes[nodeIndex];
+        float3 d = node.center - p;
+        float distance = glm::length(d);
+
+        // Far field: approximate the node by its dipole.
+        if (distance > kWindingNumberAccuracy * node.radius)
+        {
+            return glm::dot(d, node.areaNormal) / (distance * distance * distance);
+        }
+
+        if (node.count > 0)
+        {
+            float solidAngle = 0.f;
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                const uint3& triangle = mTriangles[mTriangleOrder[i]];
+                solidAngle += triangleSolidAngle(mGridPositions[triangle.x] - p, mGridPositions[triangle.y] - p, mGridPositions[triangle.z] - p);
+            }
+            return solidAngle;
+        }
+
+        return evalWindingNumberNode(nodeIndex + 1, p) + evalWindingNumberNode(node.first, p);
+    }
+
+    bool SDFMeshVoxelizer::write(std::ostream& stream, const Options& options, Stats* pStats)
+    {
+        prepare(options);
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        SDFSparseGridFile::Writer writer(stream, options.gridWidth, options.brickWidth, options.narrowBandThickness);
+
+        const uint32_t gridWidth = options.gridWidth;
+        const uint32_t brickWidth = options.brickWidth;
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        const uint32_t bricksPerAxis = writer.getHeader().bricksPerAxis;
+        const float narrowBandDistance = writer.getHeader().narrowBandDistance;
+        const float halfBrickDiagonal = 0.5f * glm::root_three<float>() * float(brickWidth) / float(gridWidth);
+
+        struct BrickResult
+        {
+            SDFSparseGridFile::BrickHeader header;
+            SDFSparseGridFile::BrickState state = SDFSparseGridFile::BrickState::Outside;
+            bool evaluated = false;
+            std::vector<float> values;
+        };
+
+        Stats stats;
+        stats.triangleCount = (uint32_t)mTriangles.size();
+        stats.bvhNodeCount = (uint32_t)mNodes.size();
+        stats.totalBrickCount = bricksPerAxis * bricksPerAxis * bricksPerAxis;
+        stats.bvhBuildTimeInMs = mBVHBuildTimeInMs;
+
+        // Process one slab of bricks at a time to bound memory use, bricks within a slab are evaluated in parallel.
+        std::vector<BrickResult> slab(size_t(bricksPerAxis) * bricksPerAxis);
+        for (uint32_t bz = 0; bz < bricksPerAxis; bz++)
+        {
+            auto range = NumericRange<uint32_t>(0, bricksPerAxis * bricksPerAxis);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t slabIndex)
+            {
+                BrickResult& result = slab[slabIndex];
+                uint3 brickCoords(slabIndex % bricksPerAxis, slabIndex / bricksPerAxis, bz);
+                uint3 brickOrigin = brickCoords * brickWidth;
+
+                result.header.virtualBrickID = brickCoords.x + bricksPerAxis * (brickCoords.y + bricksPerAxis * brickCoords.z);
+                result.evaluated = false;
+
+                // Classify the whole brick from its center if it cannot overlap the narrow band.
+                float3 brickCenter = (float3(brickOrigin) + 0.5f * float(brickWidth)) / float(gridWidth) - 0.5f;
+                float centerDistance = evalSignedDistance(brickCenter);
+                if (std::abs(centerDistance) > halfBrickDiagonal + narrowBandDistance)
+                {
+                    result.state = centerDistance < 0.f ? SDFSparseGridFile::BrickState::Inside : SDFSparseGridFile::BrickState::Outside;
+                    return;
+                }
+
+                result.evaluated = true;
+                result.values.resize(writer.getBrickValueCount());
+                result.header.minValue = std::numeric_limits<float>::max();
+                result.header.maxValue = std::numeric_limits<float>::lowest();
+
+                for (uint32_t z = 0; z < brickWidthInValues; z++)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y++)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x++)
+                        {
+                            uint3 valueCoords = brickOrigin + uint3(x, y, z);
+                            float value = std::numeric_limits<float>::max();
+
+                            if (glm::all(glm::lessThanEqual(valueCoords, uint3(gridWidth))))
+                            {
+                                value = evalSignedDistance(float3(valueCoords) / float(gridWidth) - 0.5f);
+                                result.header.minValue = std::min(result.header.minValue, value);
+                                result.header.maxValue = std::max(result.header.maxValue, value);
+                            }
+
+                            result.values[x + brickWidthInValues * (y + brickWidthInValues * z)] = value;
+                        }
+                    }
+                }
+            });
+
+            for (BrickResult& result : slab)
+            {
+                if (result.evaluated)
+                {
+                    stats.evaluatedBrickCount++;
+                    writer.writeBrick(result.header, result.values);
+                }
+                else
+                {
+                    writer.setBrickState(result.header.virtualBrickID, result.state);
+                }
+            }
+        }
+
+        bool success = writer.finish();
+
+        stats.narrowBandBrickCount = writer.getHeader().narrowBandBrickCount;
+        stats.voxelizeTimeInMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        if (pStats) *pStats = stats;
+
+        logInfo("Voxelized {} triangles into a {}^3 SDF grid in {:.1f} ms (BVH build {:.1f} ms): {} of {} bricks evaluated, {} in narrow band.",
+            stats.triangleCount, gridWidth, stats.voxelizeTimeInMs, stats.bvhBuildTimeInMs, stats.evaluatedBrickCount, stats.totalBrickCount, stats.narrowBandBrickCount);
+
+        return success;
+    }
+
+    bool SDFMeshVoxelizer::writeToFile(const std::filesystem::path& path, const Options& options, Stats* pStats)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            logWarning("SDFMeshVoxelizer::writeToFile() file '{}' could not be created!", path);
+            return false;
+        }
+
+        return write(file, options, pStats);
+    }
+}
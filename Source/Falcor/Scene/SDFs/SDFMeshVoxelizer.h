@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU voxelizer creating signed distance grids from triangle meshes.
+
+        The mesh is uniformly scaled and centered to fit the SDF grid local space [-0.5, 0.5]^3.
+        Unsigned distances are computed with a BVH-accelerated closest triangle query. The sign is computed from
+        the generalized winding number, which is robust to small holes and self-intersections. Far away BVH nodes
+        are approximated by their area weighted normal dipole (Barill et al. 2018, "Fast Winding Numbers for Soups and Clouds").
+
+        Output is written brick by brick to the sparse SDF grid format (see SDFSparseGridFile). Bricks are processed
+        in parallel and distances are only evaluated for bricks that may overlap the narrow band, all other bricks are
+        classified as inside or outside from a single winding number query. The result can be loaded directly into
+        SDFSBS and SDFSVS grids with SDFGrid::loadValuesFromFile() or SDFGrid::setValuesFromMesh().
+    */
+    class FALCOR_API SDFMeshVoxelizer
+    {
+    public:
+        struct Options
+        {
+            uint32_t gridWidth = 256;           ///< Grid width in voxels.
+            uint32_t brickWidth = 8;            ///< Brick width in voxels of the sparse output.
+            float narrowBandThickness = 2.f;    ///< Narrow band thickness in voxels.
+            float paddingVoxels = 2.f;          ///< Number of voxels left empty between the mesh bounds and the grid bounds.
+        };
+
+        struct Stats
+        {
+            uint32_t triangleCount = 0;
+            uint32_t bvhNodeCount = 0;
+            uint32_t totalBrickCount = 0;
+            uint32_t evaluatedBrickCount = 0;   ///< Bricks for which all values were evaluated.
+            uint32_t narrowBandBrickCount = 0;  ///< Bricks written to the output.
+            double bvhBuildTimeInMs = 0.0;
+            double voxelizeTimeInMs = 0.0;
+        };
+
+        /** Create a voxelizer from a triangle list.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle indices, three per triangle.
+        */
+        SDFMeshVoxelizer(const std::vector<float3>& positions, const std::vector<uint32_t>& indices);
+
+        /** Create a voxelizer from a triangle mesh.
+        */
+        SDFMeshVoxelizer(const TriangleMesh& mesh);
+
+        /** Returns the transform from mesh space to the SDF grid local space [-0.5, 0.5]^3, with the given padding.
+            Place the SDF grid instance using the inverse of this transform to match the original mesh.
+        */
+        rmcv::mat4 getMeshToGridTransform(const Options& options) const;
+
+        /** Returns the distance from a point in grid local space to the closest triangle, negative inside the mesh.
+            Must be preceded by a call to prepare() with the same options.
+        */
+        float evalSignedDistance(const float3& p) const;
+
+        /** Returns the generalized winding number of the mesh at a point in grid local space.
+            Must be preceded by a call to prepare() with the same options.
+        */
+        float evalWindingNumber(const float3& p) const;
+
+        /** Transform the mesh into grid local space and build the BVH. Called implicitly by write().
+        */
+        void prepare(const Options& options);
+
+        /** Voxelize the mesh and write a sparse SDF grid.
+            \param[in] stream Output stream, must support seeking.
+            \param[in] options Voxelization options.
+            \param[out] pStats Optional statistics.
+            \return True if the sparse grid was written successfully.
+        */
+        bool write(std::ostream& stream, const Options& options, Stats* pStats = nullptr);
+
+        /** Voxelize the mesh and write a sparse SDF grid file.
+        */
+        bool writeToFile(const std::filesystem::path& path, const Options& options, Stats* pStats = nullptr);
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            float3 areaNormal = float3(0.f);    ///< Sum of area weighted triangle normals.
+            float3 center = float3(0.f);        ///< Area weighted triangle centroid.
+            float radius = 0.f;                 ///< Radius of the bounding sphere around center.
+            uint32_t first = 0;                 ///< First triangle for leaves, index of the second child for inner nodes (first child follows the node).
+            uint32_t count = 0;                 ///< Triangle count for leaves, 0 for inner nodes.
+        };
+
+        uint32_t buildNode(uint32_t first, uint32_t count, uint32_t depth);
+        float evalWindingNumberNode(uint32_t nodeIndex, const float3& p) const;
+
+        std::vector<float3> mPositions;         ///< Mesh space positions.
+        std::vector<uint3> mTriangles;
+        AABB mMeshBounds;
+
+        // Data in grid local space, created by prepare().
+        std::vector<float3> mGridPositions;
+        std::vector<uint32_t> mTriangleOrder;
+        std::vector<Node> mNodes;
+        Options mPreparedOptions;
+        bool mPrepared = false;
+        double mBVHBuildTimeInMs = 0.0;
+    };
+}
@@ -0,0 +1,360 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFSparseGridFile.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        int8_t quantizeNormalizedValue(float value, float normalizationMultiplier)
+        {
+            float normalizedValue = glm::clamp(value * normalizationMultiplier, -1.0f, 1.0f);
+            float integerScale = normalizedValue * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        }
+    }
+
+    bool SDFSparseGridFile::Reader::open(const std::filesystem::path& path)
+    {
+        auto pStream = std::make_unique<std::ifstream>(path, std::ios::in | std::ios::binary);
+        if (!pStream->is_open()) return false;
+
+        if (!open(std::move(pStream)))
+        {
+            logWarning("File '{}' is not a valid sparse SDF grid file.", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SDFSparseGridFile::Reader::open(std::unique_ptr<std::istream> pStream)
+    {
+        mpStream = std::move(pStream);
+        mpStream->read(reinterpret_cast<char*>(&mHeader), sizeof(Header));
+        if (!*mpStream || mHeader.magic != kMagic) return false;
+
+        if (mHeader.version != kVersion)
+        {
+            logWarning("Sparse SDF grid has unsupported version {} (expected {}).", mHeader.version, kVersion);
+            return false;
+        }
+
+        if (mHeader.brickWidth == 0 || mHeader.bricksPerAxis != div_round_up(mHeader.gridWidth, mHeader.brickWidth)) return false;
+
+        size_t brickCount = size_t(mHeader.bricksPerAxis) * mHeader.bricksPerAxis * mHeader.bricksPerAxis;
+        mBrickStates.resize(brickCount);
+        mpStream->read(reinterpret_cast<char*>(mBrickStates.data()), brickCount * sizeof(BrickState));
+        mBricksRead = 0;
+
+        return (bool)*mpStream;
+    }
+
+    uint3 SDFSparseGridFile::Reader::getBrickCoords(uint32_t virtualBrickID) const
+    {
+        uint32_t bricksPerAxis = mHeader.bricksPerAxis;
+        return uint3(virtualBrickID % bricksPerAxis, (virtualBrickID / bricksPerAxis) % bricksPerAxis, virtualBrickID / (bricksPerAxis * bricksPerAxis));
+    }
+
+    bool SDFSparseGridFile::Reader::readNextBrick(BrickHeader& brickHeader, std::vector<float>& values)
+    {
+        if (mBricksRead >= mHeader.narrowBandBrickCount) return false;
+
+        values.resize(getBrickValueCount());
+        mpStream->read(reinterpret_cast<char*>(&brickHeader), sizeof(BrickHeader));
+        mpStream->read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+
+        if (!*mpStream || brickHeader.virtualBrickID >= mBrickStates.size() || mBrickStates[brickHeader.virtualBrickID] != BrickState::NarrowBand)
+        {
+            logWarning("Sparse SDF grid file is corrupt, failed to read brick {}.", mBricksRead);
+            return false;
+        }
+
+        mBricksRead++;
+        return true;
+    }
+
+    SDFSparseGridFile::Writer::Writer(std::ostream& stream, uint32_t gridWidth, uint32_t brickWidth, float narrowBandThickness)
+        : mStream(stream)
+    {
+        checkArgument(gridWidth > 0, "'gridWidth' must be larger than 0");
+        checkArgument(brickWidth > 0, "'brickWidth' must be larger than 0");
+        checkArgument(narrowBandThickness > 0.f, "'narrowBandThickness' must be larger than 0");
+
+        mHeader.gridWidth = gridWidth;
+        mHeader.brickWidth = brickWidth;
+        mHeader.bricksPerAxis = div_round_up(gridWidth, brickWidth);
+        mHeader.narrowBandDistance = narrowBandThickness / float(gridWidth);
+
+        size_t brickCount = size_t(mHeader.bricksPerAxis) * mHeader.bricksPerAxis * mHeader.bricksPerAxis;
+        mBrickStates.resize(brickCount, BrickState::Outside);
+
+        // Reserve space for the header and brick states, they are written once all bricks have been classified.
+        mStartPos = mStream.tellp();
+        mStream.write(reinterpret_cast<const char*>(&mHeader), sizeof(Header));
+        mStream.write(reinterpret_cast<const char*>(mBrickStates.data()), mBrickStates.size() * sizeof(BrickState));
+    }
+
+    SDFSparseGridFile::BrickState SDFSparseGridFile::Writer::writeBrick(const BrickHeader& brickHeader, const std::vector<float>& values)
+    {
+        FALCOR_ASSERT(values.size() == getBrickValueCount());
+        BrickState& state = mBrickStates[brickHeader.virtualBrickID];
+
+        if (brickHeader.minValue > mHeader.narrowBandDistance)
+        {
+            state = BrickState::Outside;
+        }
+        else if (brickHeader.maxValue < -mHeader.narrowBandDistance)
+        {
+            state = BrickState::Inside;
+        }
+        else
+        {
+            state = BrickState::NarrowBand;
+            mHeader.narrowBandBrickCount++;
+            mStream.write(reinterpret_cast<const char*>(&brickHeader), sizeof(BrickHeader));
+            mStream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+        }
+
+        return state;
+    }
+
+    void SDFSparseGridFile::Writer::setBrickState(uint32_t virtualBrickID, BrickState state)
+    {
+        FALCOR_ASSERT(state != BrickState::NarrowBand);
+        mBrickStates[virtualBrickID] = state;
+    }
+
+    bool SDFSparseGridFile::Writer::finish()
+    {
+        std::streampos endPos = mStream.tellp();
+        mStream.seekp(mStartPos);
+        mStream.write(reinterpret_cast<const char*>(&mHeader), sizeof(Header));
+        mStream.write(reinterpret_cast<const char*>(mBrickStates.data()), mBrickStates.size() * sizeof(BrickState));
+        mStream.seekp(endPos);
+        return (bool)mStream;
+    }
+
+    bool SDFSparseGridFile::isSparseGridFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) return false;
+
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+        return file && magic == kMagic;
+    }
+
+    bool SDFSparseGridFile::convertFromDense(const std::filesystem::path& densePath, const std::filesystem::path& sparsePath, uint32_t brickWidth, float narrowBandThickness)
+    {
+        std::ifstream denseFile(densePath, std::ios::in | std::ios::binary);
+        if (!denseFile.is_open())
+        {
+            logWarning("SDFSparseGridFile::convertFromDense() file '{}' could not be opened!", densePath);
+            return false;
+        }
+
+        uint32_t gridWidth = 0;
+        denseFile.read(reinterpret_cast<char*>(&gridWidth), sizeof(uint32_t));
+        if (!denseFile || gridWidth == 0)
+        {
+            logWarning("SDFSparseGridFile::convertFromDense() file '{}' is not a valid SDF grid file!", densePath);
+            return false;
+        }
+
+        std::ofstream sparseFile(sparsePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!sparseFile.is_open())
+        {
+            logWarning("SDFSparseGridFile::convertFromDense() file '{}' could not be created!", sparsePath);
+            return false;
+        }
+
+        Writer writer(sparseFile, gridWidth, brickWidth, narrowBandThickness);
+
+        const uint32_t gridWidthInValues = gridWidth + 1;
+        const uint32_t brickWidthInValues = brickWidth + 1;
+        const uint32_t bricksPerAxis = writer.getHeader().bricksPerAxis;
+        const size_t sliceValueCount = size_t(gridWidthInValues) * gridWidthInValues;
+
+        // Values outside of the grid are treated as being outside of the surface.
+        const float outsideValue = std::numeric_limits<float>::max();
+
+        std::vector<float> slab(sliceValueCount * brickWidthInValues);
+        std::vector<float> brickValues(writer.getBrickValueCount());
+
+        for (uint32_t bz = 0; bz < bricksPerAxis; bz++)
+        {
+            // Load the value slices covered by this row of bricks, slices beyond the grid are left unread.
+            uint32_t firstSlice = bz * brickWidth;
+            uint32_t sliceCount = std::min(brickWidthInValues, gridWidthInValues - firstSlice);
+            denseFile.seekg(sizeof(uint32_t) + firstSlice * sliceValueCount * sizeof(float), std::ios::beg);
+            denseFile.read(reinterpret_cast<char*>(slab.data()), sliceCount * sliceValueCount * sizeof(float));
+
+            if (!denseFile)
+            {
+                logWarning("SDFSparseGridFile::convertFromDense() failed to read values from '{}'!", densePath);
+                return false;
+            }
+
+            for (uint32_t by = 0; by < bricksPerAxis; by++)
+            {
+                for (uint32_t bx = 0; bx < bricksPerAxis; bx++)
+                {
+                    BrickHeader brickHeader;
+                    brickHeader.virtualBrickID = bx + bricksPerAxis * (by + bricksPerAxis * bz);
+                    brickHeader.minValue = std::numeric_limits<float>::max();
+                    brickHeader.maxValue = std::numeric_limits<float>::lowest();
+
+                    uint3 brickOrigin = uint3(bx, by, bz) * brickWidth;
+                    for (uint32_t z = 0; z < brickWidthInValues; z++)
+                    {
+                        for (uint32_t y = 0; y < brickWidthInValues; y++)
+                        {
+                            for (uint32_t x = 0; x < brickWidthInValues; x++)
+                            {
+                                uint3 valueCoords = brickOrigin + uint3(x, y, z);
+                                float value = outsideValue;
+
+                                if (valueCoords.x < gridWidthInValues && valueCoords.y < gridWidthInValues && valueCoords.z < gridWidthInValues)
+                                {
+                                    value = slab[valueCoords.x + gridWidthInValues * (valueCoords.y + size_t(gridWidthInValues) * z)];
+                                    brickHeader.minValue = std::min(brickHeader.minValue, value);
+                                    brickHeader.maxValue = std::max(brickHeader.maxValue, value);
+                                }
+
+                                brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)] = value;
+                            }
+                        }
+                    }
+
+                    writer.writeBrick(brickHeader, brickValues);
+                }
+            }
+        }
+
+        if (!writer.finish())
+        {
+            logWarning("SDFSparseGridFile::convertFromDense() failed to write '{}'!", sparsePath);
+            return false;
+        }
+
+        logInfo("Converted SDF grid '{}' to sparse format: {} of {} bricks in narrow band.", densePath, writer.getHeader().narrowBandBrickCount, size_t(bricksPerAxis) * bricksPerAxis * bricksPerAxis);
+        return true;
+    }
+
+    bool SDFSparseBrickValues::load(SDFSparseGridFile::Reader& reader)
+    {
+        const auto& header = reader.getHeader();
+        mGridWidth = header.gridWidth;
+        mBrickWidth = header.brickWidth;
+        mBricksPerAxis = header.bricksPerAxis;
+        mBrickValueCount = reader.getBrickValueCount();
+
+        const auto& brickStates = reader.getBrickStates();
+        mBrickOffsets.resize(brickStates.size());
+        for (size_t i = 0; i < brickStates.size(); i++)
+        {
+            mBrickOffsets[i] = brickStates[i] == SDFSparseGridFile::BrickState::Inside ? kInsideOffset : kOutsideOffset;
+        }
+
+        mValues.clear();
+        mValues.reserve(size_t(header.narrowBandBrickCount) * mBrickValueCount);
+
+        const float normalizationMultiplier = 2.0f * mGridWidth / glm::root_three<float>();
+
+        SDFSparseGridFile::BrickHeader brickHeader;
+        std::vector<float> brickValues;
+        for (uint32_t b = 0; b < header.narrowBandBrickCount; b++)
+        {
+            if (!reader.readNextBrick(brickHeader, brickValues)) return false;
+
+            mBrickOffsets[brickHeader.virtualBrickID] = b;
+            for (float value : brickValues) mValues.push_back(quantizeNormalizedValue(value, normalizationMultiplier));
+        }
+
+        return true;
+    }
+
+    int8_t SDFSparseBrickValues::getValue(const int3& valueCoords) const
+    {
+        if (glm::any(glm::lessThan(valueCoords, int3(0))) || glm::any(glm::greaterThan(valueCoords, int3(mGridWidth)))) return INT8_MAX;
+
+        uint3 brickCoords = glm::min(uint3(valueCoords) / mBrickWidth, uint3(mBricksPerAxis - 1));
+        uint32_t virtualBrickID = brickCoords.x + mBricksPerAxis * (brickCoords.y + mBricksPerAxis * brickCoords.z);
+
+        uint32_t offset = mBrickOffsets[virtualBrickID];
+        if (offset == kOutsideOffset) return INT8_MAX;
+        if (offset == kInsideOffset) return -INT8_MAX;
+
+        uint3 local = uint3(valueCoords) - brickCoords * mBrickWidth;
+        uint32_t brickWidthInValues = mBrickWidth + 1;
+        return mValues[size_t(offset) * mBrickValueCount + local.x + brickWidthInValues * (local.y + brickWidthInValues * local.z)];
+    }
+
+    bool SDFSparseBrickValues::voxelContainsSurface(const int3& voxelCoords) const
+    {
+        if (glm::any(glm::lessThan(voxelCoords, int3(0))) || glm::any(glm::greaterThanEqual(voxelCoords, int3(mGridWidth)))) return false;
+
+        bool anyNegative = false;
+        bool anyPositive = false;
+        for (int i = 0; i < 8; i++)
+        {
+            int8_t value = getValue(voxelCoords + int3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+            anyNegative |= value <= 0;
+            anyPositive |= value >= 0;
+        }
+
+        return anyNegative && anyPositive;
+    }
+
+    bool SDFSparseBrickValues::overlapsNarrowBand(const int3& minValueCoords, const int3& maxValueCoords) const
+    {
+        // Values on brick borders are shared between bricks, so include the neighboring brick when the region starts on a border.
+        int3 minBrick = glm::max(minValueCoords - 1, int3(0)) / int(mBrickWidth);
+        int3 maxBrick = glm::min(glm::max(maxValueCoords, int3(0)) / int(mBrickWidth), int3(mBricksPerAxis - 1));
+
+        for (int z = minBrick.z; z <= maxBrick.z; z++)
+        {
+            for (int y = minBrick.y; y <= maxBrick.y; y++)
+            {
+                for (int x = minBrick.x; x <= maxBrick.x; x++)
+                {
+                    uint32_t offset = mBrickOffsets[x + mBricksPerAxis * (y + mBricksPerAxis * z)];
+                    if (offset != kInsideOffset && offset != kOutsideOffset) return true;
+                }
+            }
+        }
+
+        return false;
+    }
+}
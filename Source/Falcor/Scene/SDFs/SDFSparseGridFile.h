@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace Falcor
+{
+    /** Sparse SDF grid file format storing only a narrow band of bricks around the implicit surface.
+
+        The grid is divided into bricks of brickWidth^3 voxels. Each brick holds (brickWidth + 1)^3 corner values,
+        i.e., values on brick borders are duplicated between neighboring bricks. Only bricks whose values lie within
+        the narrow band are stored. All other bricks are tagged as being entirely outside or inside the surface.
+
+        File layout:
+        - Header.
+        - One BrickState per brick (bricksPerAxis^3 bytes), in virtual brick ID order (x fastest).
+        - For each narrow band brick, in virtual brick ID order: a BrickHeader followed by (brickWidth + 1)^3 floats (x fastest).
+
+        This allows bricks to be consumed one by one without ever having to stage the dense grid in memory.
+    */
+    class FALCOR_API SDFSparseGridFile
+    {
+    public:
+        static constexpr uint32_t kMagic = 0x53464453; ///< "SDFS".
+        static constexpr uint32_t kVersion = 1;
+
+        enum class BrickState : uint8_t
+        {
+            Outside = 0,        ///< All values in the brick are larger than the narrow band.
+            Inside = 1,         ///< All values in the brick are smaller than the negated narrow band.
+            NarrowBand = 2,     ///< The brick is stored in the file.
+        };
+
+        struct Header
+        {
+            uint32_t magic = kMagic;
+            uint32_t version = kVersion;
+            uint32_t gridWidth = 0;             ///< Grid width in voxels.
+            uint32_t brickWidth = 0;            ///< Brick width in voxels.
+            uint32_t bricksPerAxis = 0;         ///< ceil(gridWidth / brickWidth).
+            uint32_t narrowBandBrickCount = 0;  ///< Number of bricks stored in the file.
+            float narrowBandDistance = 0.f;     ///< Distance in grid local space ([-0.5, 0.5]^3) covered by the narrow band.
+            uint32_t reserved = 0;
+        };
+
+        struct BrickHeader
+        {
+            uint32_t virtualBrickID = 0;
+            float minValue = 0.f;
+            float maxValue = 0.f;
+        };
+
+        /** Sequential reader of sparse SDF grid files.
+        */
+        class FALCOR_API Reader
+        {
+        public:
+            /** Open a sparse SDF grid file and read the header and brick states.
+                \param[in] path Full path to the file.
+                \return True if the file was successfully opened and is a valid sparse SDF grid file.
+            */
+            bool open(const std::filesystem::path& path);
+
+            /** Open a sparse SDF grid from a stream, e.g., one written to memory by Writer.
+                \param[in] pStream Stream positioned at the start of the sparse SDF grid.
+                \return True if the stream contains a valid sparse SDF grid.
+            */
+            bool open(std::unique_ptr<std::istream> pStream);
+
+            const Header& getHeader() const { return mHeader; }
+            uint32_t getBrickWidthInValues() const { return mHeader.brickWidth + 1; }
+            uint32_t getBrickValueCount() const { return getBrickWidthInValues() * getBrickWidthInValues() * getBrickWidthInValues(); }
+            BrickState getBrickState(uint32_t virtualBrickID) const { return mBrickStates[virtualBrickID]; }
+            const std::vector<BrickState>& getBrickStates() const { return mBrickStates; }
+
+            /** Compute the coordinates of a brick from its virtual brick ID.
+            */
+            uint3 getBrickCoords(uint32_t virtualBrickID) const;
+
+            /** Read the next narrow band brick.
+                \param[out] brickHeader Header of the brick.
+                \param[out] values Corner values of the brick, resized to getBrickValueCount().
+                \return False when all bricks have been read or if the file is corrupt.
+            */
+            bool readNextBrick(BrickHeader& brickHeader, std::vector<float>& values);
+
+        private:
+            std::unique_ptr<std::istream> mpStream;
+            Header mHeader;
+            std::vector<BrickState> mBrickStates;
+            uint32_t mBricksRead = 0;
+        };
+
+        /** Writer of sparse SDF grid files. Bricks are expected to be written in virtual brick ID order.
+        */
+        class FALCOR_API Writer
+        {
+        public:
+            /** Start writing a sparse SDF grid, space for the header and brick states is reserved in the stream.
+                Bricks that are never written are tagged as outside.
+                \param[in] stream Output stream, must support seeking.
+                \param[in] gridWidth Grid width in voxels.
+                \param[in] brickWidth Brick width in voxels.
+                \param[in] narrowBandThickness Thickness of the narrow band in voxels.
+            */
+            Writer(std::ostream& stream, uint32_t gridWidth, uint32_t brickWidth, float narrowBandThickness);
+
+            const Header& getHeader() const { return mHeader; }
+            uint32_t getBrickValueCount() const { return (mHeader.brickWidth + 1) * (mHeader.brickWidth + 1) * (mHeader.brickWidth + 1); }
+
+            /** Classify a brick using its min/max values and write its values if it lies in the narrow band.
+                \param[in] brickHeader Header of the brick, with min/max computed over the values inside the grid.
+                \param[in] values The (brickWidth + 1)^3 corner values of the brick.
+                \return The state assigned to the brick.
+            */
+            BrickState writeBrick(const BrickHeader& brickHeader, const std::vector<float>& values);
+
+            /** Tag a brick as entirely inside or outside without writing any values.
+            */
+            void setBrickState(uint32_t virtualBrickID, BrickState state);
+
+            /** Write the header and brick states.
+                \return True if all data was successfully written.
+            */
+            bool finish();
+
+        private:
+            std::ostream& mStream;
+            std::streampos mStartPos;
+            Header mHeader;
+            std::vector<BrickState> mBrickStates;
+        };
+
+        /** Check if a file is a sparse SDF grid file.
+            \param[in] path Full path to the file.
+        */
+        static bool isSparseGridFile(const std::filesystem::path& path);
+
+        /** Convert a dense SDF grid file (as written by SDFGrid::writeValuesFromPrimitivesToFile) to the sparse format.
+            The dense file is read (brickWidth + 1) value slices at a time so that the conversion never holds the full grid in memory.
+            \param[in] densePath Full path to the dense input file.
+            \param[in] sparsePath Path to the sparse output file.
+            \param[in] brickWidth Width of the bricks in voxels.
+            \param[in] narrowBandThickness Thickness of the narrow band in voxels. Must be at least half a voxel diagonal (sqrt(3) / 2) for SDFSVS and SDFSBS to reproduce the dense grid exactly.
+            \return True if the conversion succeeded.
+        */
+        static bool convertFromDense(const std::filesystem::path& densePath, const std::filesystem::path& sparsePath, uint32_t brickWidth = 8, float narrowBandThickness = 2.f);
+    };
+
+    /** Narrow band bricks of a sparse SDF grid, kept in memory as normalized 8-bit snorm values.
+        Values are normalized so that 1 represents half a voxel diagonal, which is the representation used by SDFSVS and SDFSBS.
+        Memory use is proportional to the number of narrow band bricks, never to the full grid.
+    */
+    class FALCOR_API SDFSparseBrickValues
+    {
+    public:
+        /** Stream all narrow band bricks from a reader.
+            \param[in] reader A reader that has been opened but whose bricks have not been read yet.
+            \return True if all bricks were read successfully.
+        */
+        bool load(SDFSparseGridFile::Reader& reader);
+
+        uint32_t getGridWidth() const { return mGridWidth; }
+        uint32_t getBrickWidth() const { return mBrickWidth; }
+        uint32_t getBricksPerAxis() const { return mBricksPerAxis; }
+        uint32_t getNarrowBandBrickCount() const { return (uint32_t)(mValues.size() / mBrickValueCount); }
+        size_t getMemoryUsageInBytes() const { return mValues.size() * sizeof(int8_t) + mBrickOffsets.size() * sizeof(uint32_t); }
+
+        /** Returns the normalized value at the given grid value coordinates. Coordinates outside of the grid return 1.
+        */
+        int8_t getValue(const int3& valueCoords) const;
+
+        /** Returns the normalized value at the given grid value coordinates as a float in [-1, 1].
+        */
+        float getValueFloat(const int3& valueCoords) const { return std::max(-1.f, float(getValue(valueCoords)) / float(INT8_MAX)); }
+
+        /** Checks if the voxel conservatively contains part of the implicit surface, matches SDFVoxelCommon::containsSurface().
+        */
+        bool voxelContainsSurface(const int3& voxelCoords) const;
+
+        /** Checks if any narrow band brick overlaps the value region [minValueCoords, maxValueCoords].
+            Surface containing voxels can only exist in regions overlapping narrow band bricks.
+        */
+        bool overlapsNarrowBand(const int3& minValueCoords, const int3& maxValueCoords) const;
+
+    private:
+        static constexpr uint32_t kInsideOffset = 0xfffffffe;
+        static constexpr uint32_t kOutsideOffset = 0xffffffff;
+
+        uint32_t mGridWidth = 0;
+        uint32_t mBrickWidth = 0;
+        uint32_t mBricksPerAxis = 0;
+        uint32_t mBrickValueCount = 0;
+        std::vector<uint32_t> mBrickOffsets;    ///< Offset (in bricks) into mValues per virtual brick, or kInsideOffset/kOutsideOffset.
+        std::vector<int8_t> mValues;            ///< Normalized values of all narrow band bricks.
+    };
+}
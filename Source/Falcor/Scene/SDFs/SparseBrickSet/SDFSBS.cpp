@@ -29,8 +29,11 @@
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
 #include "Core/API/IndirectCommands.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
+#include <execution>
 
 namespace Falcor
 {
@@ -89,7 +92,7 @@ namespace Falcor
     SDFGrid::UpdateFlags SDFSBS::update(RenderContext* pRenderContext)
     {
         // No update is performed if the SDF grid isn't dirty or isn't constructed from primitives and should not be created as an empty grid.
-        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && !mWasEmpty;
+        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && !mWasEmpty && !mpSparseValues;
         if ((!mPrimitivesDirty || (mPrimitives.empty() && !mHasGridRepresentation)) && !isEmpty) return UpdateFlags::None;
 
         // Update grid texture, if user loads an sdf-file.
@@ -112,7 +115,11 @@ namespace Falcor
             mSDField.clear();
         }
 
-        if (!mPrimitives.empty())
+        if (mPrimitives.empty() && mpSparseValues)
+        {
+            createResourcesFromSparseValues();
+        }
+        else if (!mPrimitives.empty())
         {
             createResourcesFromPrimitivesAndSDField(pRenderContext, deleteScratchData);
         }
@@ -966,6 +973,8 @@ namespace Falcor
 
     void SDFSBS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mpSparseValues.reset();
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mSDField.resize(valueCount);
@@ -980,6 +989,125 @@ namespace Falcor
         }
     }
 
+    bool SDFSBS::setValuesFromSparseFile(SDFSparseGridFile::Reader& reader)
+    {
+        // Compressed bricks are encoded on the GPU from the dense grid texture.
+        if (mCompressed) return SDFGrid::setValuesFromSparseFile(reader);
+
+        auto pSparseValues = std::make_unique<SDFSparseBrickValues>();
+        if (!pSparseValues->load(reader)) return false;
+
+        mpSparseValues = std::move(pSparseValues);
+        mSDField.clear();
+        mSDField.shrink_to_fit();
+        mpSDFGridTexture.reset();
+        mHasGridRepresentation = false;
+        return true;
+    }
+
+    void SDFSBS::createResourcesFromSparseValues()
+    {
+        const SDFSparseBrickValues& values = *mpSparseValues;
+        const int gridWidth = (int)mGridWidth;
+        const int brickWidth = (int)mBrickWidth;
+        const uint32_t brickWidthInValues = mBrickWidth + 1;
+
+        mVirtualBricksPerAxis = std::max(mVirtualBricksPerAxis, (uint32_t)std::ceil(float(mGridWidth) / mBrickWidth));
+        const uint32_t virtualBricksPerAxis = mVirtualBricksPerAxis;
+        const uint32_t virtualBrickCount = virtualBricksPerAxis * virtualBricksPerAxis * virtualBricksPerAxis;
+
+        auto getVirtualBrickOrigin = [&](uint32_t virtualBrickID)
+        {
+            return int3(virtualBrickID % virtualBricksPerAxis, (virtualBrickID / virtualBricksPerAxis) % virtualBricksPerAxis, virtualBrickID / (virtualBricksPerAxis * virtualBricksPerAxis)) * brickWidth;
+        };
+
+        // Assign brick validity, matches SDFSBSAssignBrickValidityFromSDFieldPass. Bricks not overlapping the narrow band are skipped early.
+        std::vector<uint32_t> indirection(virtualBrickCount, 0);
+        {
+            auto range = NumericRange<uint32_t>(0, virtualBrickCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t virtualBrickID)
+            {
+                int3 brickOrigin = getVirtualBrickOrigin(virtualBrickID);
+                int3 brickEnd = glm::min(brickOrigin + brickWidth, int3(gridWidth));
+                if (glm::any(glm::greaterThanEqual(brickOrigin, brickEnd)) || !values.overlapsNarrowBand(brickOrigin, brickEnd)) return;
+
+                for (int z = brickOrigin.z; z < brickEnd.z; z++)
+                    for (int y = brickOrigin.y; y < brickEnd.y; y++)
+                        for (int x = brickOrigin.x; x < brickEnd.x; x++)
+                            if (values.voxelContainsSurface(int3(x, y, z)))
+                            {
+                                indirection[virtualBrickID] = 1;
+                                return;
+                            }
+            });
+        }
+
+        // Exclusive prefix sum over the validity to assign brick IDs.
+        std::vector<uint32_t> validBricks;
+        for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; virtualBrickID++)
+        {
+            if (indirection[virtualBrickID] != 0)
+            {
+                indirection[virtualBrickID] = (uint32_t)validBricks.size();
+                validBricks.push_back(virtualBrickID);
+            }
+            else
+            {
+                indirection[virtualBrickID] = UINT32_MAX;
+            }
+        }
+        mBrickCount = (uint32_t)validBricks.size();
+
+        // Layout the brick texture the same way as createResourcesFromSDField().
+        uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)mBrickCount / brickWidthInValues));
+        uint32_t bricksAlongY = (uint32_t)std::ceil((float)mBrickCount / bricksAlongX);
+        mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+
+        uint32_t textureWidth = brickWidthInValues * brickWidthInValues * bricksAlongX;
+        uint32_t textureHeight = brickWidthInValues * bricksAlongY;
+        mBrickTextureDimensions = uint2(textureWidth, textureHeight);
+
+        std::vector<int8_t> brickTexels(size_t(textureWidth) * textureHeight, 0);
+        std::vector<AABB> brickAABBs(mBrickCount);
+
+        // Create bricks and brick AABBs, matches SDFSBSCreateBricksFromSDField.
+        {
+            auto range = NumericRange<uint32_t>(0, mBrickCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickID)
+            {
+                int3 brickOrigin = getVirtualBrickOrigin(validBricks[brickID]);
+
+                float3 brickAABBMin = -0.5f + float3(brickOrigin) / float(gridWidth);
+                float3 brickAABBMax = glm::min(brickAABBMin + float(brickWidth) / float(gridWidth), float3(0.5f));
+                brickAABBs[brickID] = AABB(brickAABBMin, brickAABBMax);
+
+                uint2 brickTextureCoords = uint2(brickID % bricksAlongX, brickID / bricksAlongX) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+                for (uint32_t z = 0; z < brickWidthInValues; z++)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y++)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x++)
+                        {
+                            int3 valueCoords = brickOrigin + int3(x, y, z);
+                            bool insideGrid = glm::all(glm::lessThan(valueCoords, int3(gridWidth)));
+                            uint2 texelCoords = brickTextureCoords + uint2(x + z * brickWidthInValues, y);
+                            brickTexels[texelCoords.x + size_t(textureWidth) * texelCoords.y] = insideGrid ? values.getValue(valueCoords) : INT8_MAX;
+                        }
+                    }
+                }
+            });
+        }
+
+        mpIndirectionTexture = Texture::create3D(virtualBricksPerAxis, virtualBricksPerAxis, virtualBricksPerAxis, ResourceFormat::R32Uint, 1, indirection.data(), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        mpIndirectionTexture->setName("SDFSBS::IndirectionTextureValues");
+        mpBrickTexture = Texture::create2D(textureWidth, textureHeight, ResourceFormat::R8Snorm, 1, 1, brickTexels.data(), ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+        mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, brickAABBs.data(), false);
+
+        logInfo("Created SDFSBS with {} bricks from {} narrow band bricks ({} MB of brick data).", mBrickCount, values.getNarrowBandBrickCount(), values.getMemoryUsageInBytes() / (1024 * 1024));
+
+        mWasEmpty = false;
+    }
+
     void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int16_t>& sdField)
     {
         checkArgument(!sdField.empty(), "Cannot create SDF grid texture from empty values vector");
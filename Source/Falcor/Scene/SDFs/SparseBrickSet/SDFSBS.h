@@ -34,6 +34,8 @@
 namespace Falcor
 {
     /** A single SDF Sparse Brick Set. Can only be utilized on the GPU.
+        Uncompressed brick sets loaded from sparse SDF grid files are built on the CPU directly from the narrow band bricks.
+        Such brick sets have no dense value representation, so primitives added afterwards are not combined with the loaded values.
     */
     class FALCOR_API SDFSBS : public SDFGrid
     {
@@ -78,6 +80,11 @@ namespace Falcor
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual bool setValuesFromSparseFile(SDFSparseGridFile::Reader& reader) override;
+
+        /** Creates bricks, brick AABBs and the indirection texture on the CPU from narrow band bricks, bypassing the dense grid texture.
+        */
+        void createResourcesFromSparseValues();
 
         void createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int16_t>& sdField);
 
@@ -91,6 +98,7 @@ namespace Falcor
 
         // CPU data.
         std::vector<int16_t> mSDField;
+        std::unique_ptr<SDFSparseBrickValues> mpSparseValues;  ///< Narrow band bricks, set when loaded from a sparse file.
 
         // Specs.
         uint32_t mDefaultGridWidth = 0;                 ///< The grid width used if the grid was not loaded from a file (it is empty).
@@ -28,8 +28,11 @@
 #include "SDFSVS.h"
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
+#include <execution>
 
 namespace Falcor
 {
@@ -37,6 +40,32 @@ namespace Falcor
     {
         const std::string kSDFCountSurfaceVoxelsShaderName = "Scene/SDFs/SDFSurfaceVoxelCounter.cs.slang";
         const std::string kSDFSVSVoxelizerShaderName = "Scene/SDFs/SparseVoxelSet/SDFSVSVoxelizer.cs.slang";
+
+        /** Matches safeLoadValue() in SDFSVSVoxelizer.cs.slang.
+        */
+        uint32_t safeLoadPackedValue(const SDFSparseBrickValues& values, const int3& coords)
+        {
+            int gridWidth = (int)values.getGridWidth();
+            if (glm::any(glm::lessThan(coords, int3(0))) || glm::any(glm::greaterThanEqual(coords, int3(gridWidth)))) return uint32_t(uint8_t(INT8_MAX));
+            return uint32_t(uint8_t(values.getValue(coords)));
+        }
+
+        /** Matches loadAndPackSlice() in SDFSVSVoxelizer.cs.slang.
+        */
+        uint4 loadAndPackSlice(const SDFSparseBrickValues& values, const int3& voxelCoords, int x)
+        {
+            uint4 packedValues;
+            for (int y = 0; y < 4; y++)
+            {
+                uint32_t packed = 0;
+                for (int z = 0; z < 4; z++)
+                {
+                    packed |= safeLoadPackedValue(values, voxelCoords + int3(x, y - 1, z - 1)) << (8 * z);
+                }
+                packedValues[y] = packed;
+            }
+            return packedValues;
+        }
     }
 
     SDFSVS::SharedPtr SDFSVS::create()
@@ -61,6 +90,12 @@ namespace Falcor
             throw RuntimeError("An SDFSVS instance cannot be created from primitives!");
         }
 
+        if (mpSparseValues)
+        {
+            createResourcesFromSparseValues();
+            return;
+        }
+
         if (mpSDFGridTexture && mpSDFGridTexture->getWidth() == mGridWidth + 1)
         {
             pRenderContext->updateTextureData(mpSDFGridTexture.get(), mValues.data());
@@ -174,6 +209,8 @@ namespace Falcor
 
     void SDFSVS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mpSparseValues.reset();
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mValues.resize(valueCount);
@@ -187,4 +224,99 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    bool SDFSVS::setValuesFromSparseFile(SDFSparseGridFile::Reader& reader)
+    {
+        auto pSparseValues = std::make_unique<SDFSparseBrickValues>();
+        if (!pSparseValues->load(reader)) return false;
+
+        mpSparseValues = std::move(pSparseValues);
+        mValues.clear();
+        mValues.shrink_to_fit();
+        return true;
+    }
+
+    void SDFSVS::createResourcesFromSparseValues()
+    {
+        const SDFSparseBrickValues& values = *mpSparseValues;
+        const int gridWidth = (int)mGridWidth;
+        const int brickWidth = (int)values.getBrickWidth();
+        const uint32_t bricksPerAxis = values.getBricksPerAxis();
+
+        // Voxels containing surface can only be found in narrow band bricks, visit those in parallel.
+        std::vector<uint32_t> narrowBandBricks;
+        for (uint32_t virtualBrickID = 0; virtualBrickID < bricksPerAxis * bricksPerAxis * bricksPerAxis; virtualBrickID++)
+        {
+            int3 brickOrigin = int3(virtualBrickID % bricksPerAxis, (virtualBrickID / bricksPerAxis) % bricksPerAxis, virtualBrickID / (bricksPerAxis * bricksPerAxis)) * brickWidth;
+            if (values.overlapsNarrowBand(brickOrigin + 1, brickOrigin + brickWidth - 1)) narrowBandBricks.push_back(virtualBrickID);
+        }
+
+        std::vector<std::vector<AABB>> brickAABBs(narrowBandBricks.size());
+        std::vector<std::vector<SDFSVSVoxel>> brickVoxels(narrowBandBricks.size());
+
+        auto range = NumericRange<size_t>(0, narrowBandBricks.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            uint32_t virtualBrickID = narrowBandBricks[i];
+            int3 brickOrigin = int3(virtualBrickID % bricksPerAxis, (virtualBrickID / bricksPerAxis) % bricksPerAxis, virtualBrickID / (bricksPerAxis * bricksPerAxis)) * brickWidth;
+            int3 brickEnd = glm::min(brickOrigin + brickWidth, int3(gridWidth));
+
+            for (int z = brickOrigin.z; z < brickEnd.z; z++)
+            {
+                for (int y = brickOrigin.y; y < brickEnd.y; y++)
+                {
+                    for (int x = brickOrigin.x; x < brickEnd.x; x++)
+                    {
+                        int3 voxelCoords(x, y, z);
+                        if (!values.voxelContainsSurface(voxelCoords)) continue;
+
+                        float3 p = float3(voxelCoords) - float(gridWidth) * 0.5f;
+                        brickAABBs[i].push_back(AABB(p / float(gridWidth), (p + 1.0f) / float(gridWidth)));
+
+                        SDFSVSVoxel voxel;
+                        for (int slice = 0; slice < 4; slice++) voxel.packedValuesSlices[slice] = loadAndPackSlice(values, voxelCoords, slice - 1);
+
+                        voxel.validNeighborsMask = 0;
+                        for (int nz = 0; nz <= 2; nz++)
+                            for (int ny = 0; ny <= 2; ny++)
+                                for (int nx = 0; nx <= 2; nx++)
+                                    if (values.voxelContainsSurface(voxelCoords + int3(nx - 1, ny - 1, nz - 1))) voxel.validNeighborsMask |= (1 << (nz + 3 * (ny + 3 * nx)));
+
+                        brickVoxels[i].push_back(voxel);
+                    }
+                }
+            }
+        });
+
+        // Concatenate in brick order to keep the voxel order deterministic.
+        std::vector<AABB> aabbs;
+        std::vector<SDFSVSVoxel> voxels;
+        for (size_t i = 0; i < narrowBandBricks.size(); i++)
+        {
+            aabbs.insert(aabbs.end(), brickAABBs[i].begin(), brickAABBs[i].end());
+            voxels.insert(voxels.end(), brickVoxels[i].begin(), brickVoxels[i].end());
+        }
+
+        mVoxelCount = (uint32_t)voxels.size();
+
+        if (!mpVoxelAABBBuffer || mpVoxelAABBBuffer->getElementCount() < mVoxelCount)
+        {
+            mpVoxelAABBBuffer = Buffer::createStructured(sizeof(AABB), mVoxelCount, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, aabbs.data());
+        }
+        else
+        {
+            mpVoxelAABBBuffer->setBlob(aabbs.data(), 0, aabbs.size() * sizeof(AABB));
+        }
+
+        if (!mpVoxelBuffer || mpVoxelBuffer->getElementCount() < mVoxelCount)
+        {
+            mpVoxelBuffer = Buffer::createStructured(sizeof(SDFSVSVoxel), mVoxelCount, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, voxels.data());
+        }
+        else
+        {
+            mpVoxelBuffer->setBlob(voxels.data(), 0, voxels.size() * sizeof(SDFSVSVoxel));
+        }
+
+        logInfo("Created SDFSVS with {} voxels from {} narrow band bricks ({} MB of brick data).", mVoxelCount, values.getNarrowBandBrickCount(), values.getMemoryUsageInBytes() / (1024 * 1024));
+    }
 }
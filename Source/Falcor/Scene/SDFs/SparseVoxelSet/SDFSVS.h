@@ -59,12 +59,18 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual bool setValuesFromSparseFile(SDFSparseGridFile::Reader& reader) override;
+
+        /** Voxelizes the narrow band bricks on the CPU, bypassing the dense grid texture.
+        */
+        void createResourcesFromSparseValues();
 
     private:
         SDFSVS() = default;
 
         // CPU data.
         std::vector<int8_t> mValues;
+        std::unique_ptr<SDFSparseBrickValues> mpSparseValues;  ///< Narrow band bricks, set when loaded from a sparse file.
 
         // Specs.
         Buffer::SharedPtr mpVoxelAABBBuffer;
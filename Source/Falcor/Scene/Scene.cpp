@@ -28,6 +28,7 @@
 #include "Scene.h"
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
+#include "BlasBuildScheduler.h"
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
 #include "SDFs/SDFGrid.h"
@@ -38,6 +39,7 @@
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
 #include "Core/API/IndirectCommands.h"
+#include "Utils/NumericRange.h"
 #include "Utils/StringUtils.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/MathHelpers.h"
@@ -45,7 +47,10 @@
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 
+#include <algorithm>
+#include <execution>
 #include <fstream>
+#include <functional>
 #include <numeric>
 #include <sstream>
 
@@ -54,12 +59,19 @@ namespace Falcor
     static_assert(sizeof(MeshDesc) % 16 == 0, "MeshDesc size should be a multiple of 16");
     static_assert(sizeof(GeometryInstanceData) == 32, "GeometryInstanceData size should be 32");
     static_assert(sizeof(PackedStaticVertexData) % 16 == 0, "PackedStaticVertexData size should be a multiple of 16");
+    static_assert(sizeof(CompressedStaticVertexData) == 16, "CompressedStaticVertexData size should be 16");
+    static_assert(sizeof(VertexQuantization) % 16 == 0, "VertexQuantization size should be a multiple of 16");
 
     namespace
     {
         // Large scenes are split into multiple BLAS groups in order to reduce build memory usage.
-        // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
+        // The target is max 0.5GB memory for building a BLAS group, including the final BLASes. Note that this is not a strict limit.
+        // Builds within a group are issued in batches that alias their scratch memory, with max 128MB scratch per batch.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
+        const size_t kMaxBLASBuildBatchScratchMemory = 1ull << 27;
+
+        // Estimated ratio of compacted to uncompacted BLAS size, used for planning the first build.
+        const double kBLASCompactionRatioEstimate = 0.5;
 
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
@@ -67,6 +79,7 @@ namespace Falcor
         const std::string kIndexBufferName = "indexData";
         const std::string kVertexBufferName = "vertices";
         const std::string kPrevVertexBufferName = "prevVertices";
+        const std::string kVertexQuantizationBufferName = "vertexQuantization";
         const std::string kProceduralPrimAABBBufferName = "proceduralPrimitiveAABBs";
         const std::string kCurveBufferName = "curves";
         const std::string kCurveIndexBufferName = "curveIndices";
@@ -124,6 +137,33 @@ namespace Falcor
         {
             return rmcv::determinant((rmcv::mat3)m) < 0.f;
         }
+
+        const uint32_t kCurveAABBBlockSize = 4096;  ///< Number of curve segments per task when generating curve AABBs in parallel.
+        const uint32_t kCustomPrimitiveTrimDivisor = 4; ///< Removed custom primitive slots at the end are released once they make up 1/kCustomPrimitiveTrimDivisor of all slots.
+
+        const uint32_t kMaxUploadRangeGap = 16; ///< Maximum number of unchanged elements between two changed elements uploaded in the same range.
+
+        /** Calls func(first, count) for ranges covering a sorted list of indices.
+            Ranges with gaps of up to kMaxUploadRangeGap elements are coalesced to reduce the number of uploads.
+        */
+        template<typename Func>
+        void forEachCoalescedRange(const std::vector<uint32_t>& sortedIndices, Func func)
+        {
+            size_t i = 0;
+            while (i < sortedIndices.size())
+            {
+                uint32_t first = sortedIndices[i];
+                uint32_t last = first;
+                while (++i < sortedIndices.size() && sortedIndices[i] - last <= kMaxUploadRangeGap + 1) last = sortedIndices[i];
+                func(first, last - first + 1);
+            }
+        }
+
+        // Checks if the box touches or extends beyond any face of the bounds.
+        bool touchesBounds(const AABB& box, const AABB& bounds)
+        {
+            return glm::any(glm::lessThanEqual(box.minPoint, bounds.minPoint)) || glm::any(glm::greaterThanEqual(box.maxPoint, bounds.maxPoint));
+        }
     }
 
     const FileDialogFilterVec& Scene::getFileExtensionFilters()
@@ -164,6 +204,9 @@ namespace Falcor
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
+        mVertexCacheStats = sceneData.vertexCacheStats;
+        mHasCompressedVertices = !sceneData.meshCompressedStaticData.empty();
+        mVertexQuantization = std::move(sceneData.meshVertexQuantization);
 
         mCurveDesc = std::move(sceneData.curveDesc);
         mCurveBBs = std::move(sceneData.curveBBs);
@@ -176,6 +219,8 @@ namespace Falcor
 
         mCustomPrimitiveDesc = std::move(sceneData.customPrimitiveDesc);
         mCustomPrimitiveAABBs = std::move(sceneData.customPrimitiveAABBs);
+        mCustomPrimitiveActive.assign(mCustomPrimitiveDesc.size(), true);
+        mCustomPrimitiveDirty.assign(mCustomPrimitiveDesc.size(), false);
 
         // Setup additional resources.
         mFrontClockwiseRS[RasterizerState::CullMode::None] = RasterizerState::create(RasterizerState::Desc().setFrontCounterCW(false).setCullMode(RasterizerState::CullMode::None));
@@ -192,7 +237,7 @@ namespace Falcor
         setSDFGridConfig();
 
         // Create vertex array objects for meshes and curves.
-        createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
+        createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshCompressedStaticData, sceneData.meshSkinningData);
         createCurveVao(mCurveIndexData, mCurveStaticData);
 
         // Create animation controller.
@@ -209,11 +254,8 @@ namespace Falcor
         for (const auto &mesh : sceneData.cachedMeshes)
         {
             if (!mMeshDesc[mesh.meshID.get()].isAnimated()) throw RuntimeError("Cached Mesh Animation: Referenced mesh ID is not dynamic");
-            if (mesh.timeSamples.size() != mesh.vertexData.size()) throw RuntimeError("Cached Mesh Animation: Time sample count mismatch.");
-            for (const auto &vertices : mesh.vertexData)
-            {
-                if (vertices.size() != mMeshDesc[mesh.meshID.get()].vertexCount) throw RuntimeError("Cached Mesh Animation: Vertex count mismatch.");
-            }
+            if (mesh.keyframes.getKeyframeCount() == 0) throw RuntimeError("Cached Mesh Animation: No keyframes.");
+            if (mesh.keyframes.getVertexCount() != mMeshDesc[mesh.meshID.get()].vertexCount) throw RuntimeError("Cached Mesh Animation: Vertex count mismatch.");
         }
         for (const auto& cache : sceneData.cachedCurves)
         {
@@ -249,6 +291,7 @@ namespace Falcor
         defines.add("SCENE_HAS_INDEXED_VERTICES", "0");
         defines.add("SCENE_HAS_16BIT_INDICES", "0");
         defines.add("SCENE_HAS_32BIT_INDICES", "0");
+        defines.add("SCENE_HAS_COMPRESSED_VERTICES", "0");
         defines.add("SCENE_USE_LIGHT_PROFILE", "0");
 
         defines.add(MaterialSystem::getDefaultDefines());
@@ -264,6 +307,7 @@ namespace Falcor
         defines.add("SCENE_HAS_INDEXED_VERTICES", hasIndexBuffer() ? "1" : "0");
         defines.add("SCENE_HAS_16BIT_INDICES", mHas16BitIndices ? "1" : "0");
         defines.add("SCENE_HAS_32BIT_INDICES", mHas32BitIndices ? "1" : "0");
+        defines.add("SCENE_HAS_COMPRESSED_VERTICES", mHasCompressedVertices ? "1" : "0");
         defines.add("SCENE_USE_LIGHT_PROFILE", mpLightProfile != nullptr ? "1" : "0");
 
         defines.add(mHitInfo.getDefines());
@@ -332,17 +376,47 @@ namespace Falcor
     {
         FALCOR_PROFILE("rasterizeScene");
 
+        if (mDrawListDirty)
+        {
+            updateDrawList(mDrawList, mMeshInstanceIDs);
+            mDrawListDirty = false;
+        }
+
+        rasterizeDrawList(pContext, pState, pVars, mDrawList, pRasterizerStateCW, pRasterizerStateCCW);
+    }
+
+    void Scene::rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const Frustum& frustum, RasterizerState::CullMode cullMode)
+    {
+        rasterize(pContext, pState, pVars, frustum, mFrontClockwiseRS[cullMode], mFrontCounterClockwiseRS[cullMode]);
+    }
+
+    void Scene::rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const Frustum& frustum, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW)
+    {
+        FALCOR_PROFILE("rasterizeScene");
+
+        {
+            FALCOR_PROFILE("cullInstances");
+            mInstanceBVH.cull(frustum, mVisibleMeshInstanceIDs);
+            mVisibleMeshInstanceIDs.insert(mVisibleMeshInstanceIDs.end(), mUnculledMeshInstanceIDs.begin(), mUnculledMeshInstanceIDs.end());
+            updateDrawList(mCulledDrawList, mVisibleMeshInstanceIDs);
+        }
+
+        rasterizeDrawList(pContext, pState, pVars, mCulledDrawList, pRasterizerStateCW, pRasterizerStateCCW);
+    }
+
+    void Scene::rasterizeDrawList(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const DrawList& drawList, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW)
+    {
         pVars->setParameterBlock(kParameterBlockName, mpSceneBlock);
 
         auto pCurrentRS = pState->getRasterizerState();
         bool isIndexed = hasIndexBuffer();
 
-        for (const auto& draw : mDrawArgs)
+        for (const auto& draw : drawList.draws)
         {
             FALCOR_ASSERT(draw.count > 0);
 
             // Set state.
-            pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao);
+            pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? drawList.pVao16Bit : drawList.pVao);
 
             if (draw.ccw) pState->setRasterizerState(pRasterizerStateCCW);
             else pState->setRasterizerState(pRasterizerStateCW);
@@ -350,11 +424,11 @@ namespace Falcor
             // Draw the primitives.
             if (isIndexed)
             {
-                pContext->drawIndexedIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pContext->drawIndexedIndirect(pState, pVars, draw.count, draw.pBuffer.get(), draw.offset, nullptr, 0);
             }
             else
             {
-                pContext->drawIndirect(pState, pVars, draw.count, draw.pBuffer.get(), 0, nullptr, 0);
+                pContext->drawIndirect(pState, pVars, draw.count, draw.pBuffer.get(), draw.offset, nullptr, 0);
             }
         }
 
@@ -391,7 +465,7 @@ namespace Falcor
         pContext->raytrace(pProgram, pVars.get(), dispatchDims.x, dispatchDims.y, dispatchDims.z);
     }
 
-    void Scene::createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<SkinningVertexData>& skinningData)
+    void Scene::createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<CompressedStaticVertexData>& compressedData, const std::vector<SkinningVertexData>& skinningData)
     {
         if (drawCount == 0) return;
 
@@ -410,8 +484,12 @@ namespace Falcor
         }
 
         // Create the vertex data structured buffer.
-        const size_t vertexCount = (uint32_t)staticData.size();
-        size_t staticVbSize = sizeof(PackedStaticVertexData) * vertexCount;
+        // Packed vertex data is uploaded by the animation controller, compressed vertex data is static and uploaded here.
+        FALCOR_ASSERT(staticData.empty() || compressedData.empty());
+        const bool useCompressedVertices = !compressedData.empty();
+        const size_t vertexCount = useCompressedVertices ? compressedData.size() : staticData.size();
+        const size_t vertexStride = useCompressedVertices ? sizeof(CompressedStaticVertexData) : sizeof(PackedStaticVertexData);
+        size_t staticVbSize = vertexStride * vertexCount;
         if (staticVbSize > std::numeric_limits<uint32_t>::max())
         {
             throw RuntimeError("Vertex buffer size exceeds 4GB");
@@ -421,7 +499,14 @@ namespace Falcor
         if (vertexCount > 0)
         {
             ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
-            pStaticBuffer = Buffer::createStructured(sizeof(PackedStaticVertexData), (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+            pStaticBuffer = Buffer::createStructured((uint32_t)vertexStride, (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, useCompressedVertices ? compressedData.data() : nullptr, false);
+        }
+
+        if (useCompressedVertices)
+        {
+            FALCOR_ASSERT(mVertexQuantization.size() == mMeshDesc.size());
+            mpVertexQuantizationBuffer = Buffer::createStructured(sizeof(VertexQuantization), (uint32_t)mVertexQuantization.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mVertexQuantization.data(), false);
+            mpVertexQuantizationBuffer->setName("Scene::mpVertexQuantizationBuffer");
         }
 
         Vao::BufferVec pVBs(kVertexBufferCount);
@@ -455,10 +540,20 @@ namespace Falcor
         VertexLayout::SharedPtr pLayout = VertexLayout::create();
 
         // Add the packed static vertex data layout.
+        // For compressed vertices only the quantized position is exposed, the remaining attributes are fetched in the vertex shader.
+        // Note that the stride is computed from the elements, so we add a dummy element to cover the full vertex.
         VertexBufferLayout::SharedPtr pStaticLayout = VertexBufferLayout::create();
-        pStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
-        pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
-        pStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC);
+        if (useCompressedVertices)
+        {
+            pStaticLayout->addElement(VERTEX_POSITION_NAME, 0, ResourceFormat::RGBA16Snorm, 1, VERTEX_POSITION_LOC);
+            pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, 8, ResourceFormat::RG32Uint, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
+        }
+        else
+        {
+            pStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
+            pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
+            pStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC);
+        }
         pLayout->addBufferLayout(kStaticDataBufferIndex, pStaticLayout);
 
         // Add the draw ID layout.
@@ -701,6 +796,7 @@ namespace Falcor
             if (hasIndexBuffer()) mpSceneBlock->setBuffer(kIndexBufferName, mpMeshVao->getIndexBuffer());
             mpSceneBlock->setBuffer(kVertexBufferName, mpMeshVao->getVertexBuffer(Scene::kStaticDataBufferIndex));
             mpSceneBlock->setBuffer(kPrevVertexBufferName, mpAnimationController->getPrevVertexData()); // Can be nullptr
+            if (mHasCompressedVertices) mpSceneBlock->setBuffer(kVertexQuantizationBufferName, mpVertexQuantizationBuffer);
         }
 
         if (mpCurveVao != nullptr)
@@ -718,40 +814,13 @@ namespace Falcor
 
     void Scene::updateBounds()
     {
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
-
         mSceneBB = AABB();
 
-        for (const auto& inst : mGeometryInstanceData)
+        mGeometryInstanceBBs.resize(mGeometryInstanceData.size());
+        for (size_t i = 0; i < mGeometryInstanceData.size(); i++)
         {
-            const rmcv::mat4& transform = globalMatrices[inst.globalMatrixID];
-            switch (inst.getType())
-            {
-            case GeometryType::TriangleMesh:
-            case GeometryType::DisplacedTriangleMesh:
-            {
-                const AABB& meshBB = mMeshBBs[inst.geometryID];
-                mSceneBB |= meshBB.transform(transform);
-                break;
-            }
-            case GeometryType::Curve:
-            {
-                const AABB& curveBB = mCurveBBs[inst.geometryID];
-                mSceneBB |= curveBB.transform(transform);
-                break;
-            }
-            case GeometryType::SDFGrid:
-            {
-                rmcv::mat3 transform3x3 = rmcv::mat3(transform);
-                transform3x3[0] = glm::abs(transform3x3[0]);
-                transform3x3[1] = glm::abs(transform3x3[1]);
-                transform3x3[2] = glm::abs(transform3x3[2]);
-                float3 center = transform.getCol(3);
-                float3 halfExtent = transform3x3 * float3(0.5f);
-                mSceneBB |= AABB(center - halfExtent, center + halfExtent);
-                break;
-            }
-            }
+            mGeometryInstanceBBs[i] = computeInstanceBounds(mGeometryInstanceData[i]);
+            mSceneBB |= mGeometryInstanceBBs[i];
         }
 
         for (const auto& aabb : mCustomPrimitiveAABBs)
@@ -765,56 +834,187 @@ namespace Falcor
         }
     }
 
+    void Scene::updateBounds(const std::vector<uint32_t>& changedInstances)
+    {
+        FALCOR_ASSERT(mGeometryInstanceBBs.size() == mGeometryInstanceData.size());
+
+        // Growing the scene bounds only requires the new instance bounds. If an instance touched the
+        // scene bounds before moving, the scene bounds may shrink and have to be recomputed from all instances.
+        bool recompute = false;
+        for (uint32_t instanceID : changedInstances)
+        {
+            AABB& instanceBB = mGeometryInstanceBBs[instanceID];
+            recompute = recompute || touchesBounds(instanceBB, mSceneBB);
+            instanceBB = computeInstanceBounds(mGeometryInstanceData[instanceID]);
+            mSceneBB |= instanceBB;
+        }
+
+        if (recompute)
+        {
+            mSceneBB = AABB();
+            for (const auto& instanceBB : mGeometryInstanceBBs) mSceneBB |= instanceBB;
+            for (const auto& aabb : mCustomPrimitiveAABBs) mSceneBB |= aabb;
+            for (const auto& pGridVolume : mGridVolumes) mSceneBB |= pGridVolume->getBounds();
+        }
+    }
+
+    AABB Scene::computeInstanceBounds(const GeometryInstanceData& instance) const
+    {
+        const rmcv::mat4& transform = mpAnimationController->getGlobalMatrices()[instance.globalMatrixID];
+        switch (instance.getType())
+        {
+        case GeometryType::TriangleMesh:
+        case GeometryType::DisplacedTriangleMesh:
+            return mMeshBBs[instance.geometryID].transform(transform);
+        case GeometryType::Curve:
+            return mCurveBBs[instance.geometryID].transform(transform);
+        case GeometryType::SDFGrid:
+        {
+            rmcv::mat3 transform3x3 = rmcv::mat3(transform);
+            transform3x3[0] = glm::abs(transform3x3[0]);
+            transform3x3[1] = glm::abs(transform3x3[1]);
+            transform3x3[2] = glm::abs(transform3x3[2]);
+            float3 center = transform.getCol(3);
+            float3 halfExtent = transform3x3 * float3(0.5f);
+            return AABB(center - halfExtent, center + halfExtent);
+        }
+        default:
+            return AABB();
+        }
+    }
+
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
 
         bool dataChanged = false;
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
-
         for (auto& inst : mGeometryInstanceData)
         {
-            if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
+            dataChanged |= updateGeometryInstanceFlags(inst);
+        }
+
+        if (forceUpdate || dataChanged)
+        {
+            uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
+            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+        }
+    }
+
+    void Scene::updateGeometryInstances(const std::vector<uint32_t>& changedInstances)
+    {
+        // Only the flags depend on the transform. Upload the instances whose flags changed.
+        std::vector<uint32_t> dirtyInstances;
+        for (uint32_t instanceID : changedInstances)
+        {
+            auto& instance = mGeometryInstanceData[instanceID];
+            if (!updateGeometryInstanceFlags(instance)) continue;
+            dirtyInstances.push_back(instanceID);
+
+            // Move instances whose winding flipped to the draws with the matching rasterizer state.
+            if (instance.getType() == GeometryType::TriangleMesh)
             {
-                uint32_t prevFlags = inst.flags;
+                uint32_t drawKey = getDrawKey(instance);
+                if (drawKey != mInstanceBatcher.getKey(instanceID))
+                {
+                    mInstanceBatcher.setKey(instanceID, drawKey);
+                    mDrawListDirty = true;
+                }
+            }
+        }
+
+        forEachCoalescedRange(dirtyInstances, [&](uint32_t first, uint32_t count)
+        {
+            mpGeometryInstancesBuffer->setBlob(&mGeometryInstanceData[first], first * sizeof(GeometryInstanceData), count * sizeof(GeometryInstanceData));
+        });
+    }
 
-                FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-                const rmcv::mat4& transform = globalMatrices[inst.globalMatrixID];
-                bool isTransformFlipped = doesTransformFlip(transform);
-                bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
-                bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+    bool Scene::updateGeometryInstanceFlags(GeometryInstanceData& inst) const
+    {
+        if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh) return false;
 
-                if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+        uint32_t prevFlags = inst.flags;
 
-                if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+        const rmcv::mat4& transform = globalMatrices[inst.globalMatrixID];
+        bool isTransformFlipped = doesTransformFlip(transform);
+        bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
+        bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
 
-                if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
 
-                dataChanged |= (inst.flags != prevFlags);
-            }
+        if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+
+        if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+        else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+
+        return inst.flags != prevFlags;
+    }
+
+    void Scene::buildNodeInstanceIndex()
+    {
+        // Counting sort of the geometry instances by global matrix ID.
+        mNodeInstanceOffsets.assign(mSceneGraph.size() + 1, 0);
+        for (const auto& inst : mGeometryInstanceData)
+        {
+            FALCOR_ASSERT(inst.globalMatrixID < mSceneGraph.size());
+            mNodeInstanceOffsets[inst.globalMatrixID + 1]++;
         }
+        for (size_t i = 1; i < mNodeInstanceOffsets.size(); i++) mNodeInstanceOffsets[i] += mNodeInstanceOffsets[i - 1];
 
-        if (forceUpdate || dataChanged)
+        mNodeInstanceIDs.resize(mGeometryInstanceData.size());
+        std::vector<uint32_t> nextIndex(mNodeInstanceOffsets.begin(), mNodeInstanceOffsets.end() - 1);
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
         {
-            uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
-            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            mNodeInstanceIDs[nextIndex[mGeometryInstanceData[instanceID].globalMatrixID]++] = instanceID;
         }
     }
 
+    void Scene::gatherChangedInstances(const std::vector<NodeID>& changedNodes, std::vector<uint32_t>& changedInstances) const
+    {
+        changedInstances.clear();
+        for (NodeID nodeID : changedNodes)
+        {
+            FALCOR_ASSERT(nodeID.get() + 1 < mNodeInstanceOffsets.size());
+            uint32_t first = mNodeInstanceOffsets[nodeID.get()];
+            uint32_t last = mNodeInstanceOffsets[nodeID.get() + 1];
+            changedInstances.insert(changedInstances.end(), mNodeInstanceIDs.begin() + first, mNodeInstanceIDs.begin() + last);
+        }
+        std::sort(changedInstances.begin(), changedInstances.end());
+    }
+
     Scene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
     {
         // This function updates the global list of AABBs for all procedural primitives.
+        // Only the AABBs of dirty curves and custom primitives are regenerated and uploaded.
+        // The list of dirty custom primitives is expected to be sorted and is cleared by the caller.
         // TODO: Move this code to the GPU. Then the CPU copies of some buffers won't be needed anymore.
         Scene::UpdateFlags flags = Scene::UpdateFlags::None;
 
-        size_t curveAABBCount = 0;
-        for (const auto& curve : mCurveDesc) curveAABBCount += curve.indexCount;
+        if (forceUpdate)
+        {
+            // Compute the offsets of the curve segment AABBs. The custom primitive AABBs are placed after all curves.
+            size_t curveAABBCount = 0;
+            mCurveAABBOffsets.resize(mCurveDesc.size());
+            for (size_t curveID = 0; curveID < mCurveDesc.size(); curveID++)
+            {
+                mCurveAABBOffsets[curveID] = (uint32_t)curveAABBCount;
+                curveAABBCount += mCurveDesc[curveID].indexCount;
+            }
+            mCurveAABBsDirty.assign(mCurveDesc.size(), false);
+            mDirtyCurves.clear();
+            for (uint32_t curveID = 0; curveID < (uint32_t)mCurveDesc.size(); curveID++) markCurveDirty(curveID);
 
-        size_t customAABBCount = mCustomPrimitiveAABBs.size();
-        size_t totalAABBCount = curveAABBCount + customAABBCount;
+            if (curveAABBCount > std::numeric_limits<uint32_t>::max())
+            {
+                throw RuntimeError("Procedural primitive count exceeds the maximum");
+            }
+            mCustomPrimitiveAABBOffset = (uint32_t)curveAABBCount;
+        }
+
+        size_t totalAABBCount = (size_t)mCustomPrimitiveAABBOffset + mCustomPrimitiveAABBs.size();
 
         if (totalAABBCount > std::numeric_limits<uint32_t>::max())
         {
@@ -830,25 +1030,25 @@ namespace Falcor
         }
 
         mRtAABBRaw.resize(totalAABBCount);
-        uint32_t offset = 0;
 
-        size_t firstUpdated = std::numeric_limits<size_t>::max();
-        size_t lastUpdated = 0;
+        // Compute AABBs of curve segments of dirty curves. Segments are processed in parallel in blocks.
+        FALCOR_ASSERT(mCurveAABBsDirty.size() == mCurveDesc.size());
+        std::sort(mDirtyCurves.begin(), mDirtyCurves.end());
 
-        if (forceUpdate)
+        for (uint32_t curveID : mDirtyCurves)
         {
-            // Compute AABBs of curve segments.
-            for (const auto& curve : mCurveDesc)
-            {
-                // Track range of updated AABBs.
-                // TODO: Per-curve flag to indicate changes. For now assume all curves need updating.
-                firstUpdated = std::min(firstUpdated, (size_t)offset);
-                lastUpdated = std::max(lastUpdated, (size_t)offset + curve.indexCount);
+            const auto& curve = mCurveDesc[curveID];
+            const auto* indexData = &mCurveIndexData[curve.ibOffset];
+            const auto* staticData = &mCurveStaticData[curve.vbOffset];
+            RtAABB* pCurveAABBs = mRtAABBRaw.data() + mCurveAABBOffsets[curveID];
 
-                const auto* indexData = &mCurveIndexData[curve.ibOffset];
-                const auto* staticData = &mCurveStaticData[curve.vbOffset];
+            auto blocks = NumericRange<uint32_t>(0, div_round_up(curve.indexCount, kCurveAABBBlockSize));
+            std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](uint32_t block)
+            {
+                const uint32_t first = block * kCurveAABBBlockSize;
+                const uint32_t last = std::min(first + kCurveAABBBlockSize, curve.indexCount);
 
-                for (uint32_t j = 0; j < curve.indexCount; j++)
+                for (uint32_t j = first; j < last; j++)
                 {
                     AABB curveSegBB;
                     uint32_t v = indexData[j];
@@ -859,27 +1059,22 @@ namespace Falcor
                         curveSegBB.include(staticData[v + k].position + float3(staticData[v + k].radius));
                     }
 
-                    mRtAABBRaw[offset++] = static_cast<RtAABB>(curveSegBB);
+                    pCurveAABBs[j] = static_cast<RtAABB>(curveSegBB);
                 }
-                flags |= Scene::UpdateFlags::CurvesMoved;
-            }
-            FALCOR_ASSERT(offset == curveAABBCount);
+            });
+
+            mCurveAABBsDirty[curveID] = false;
+            flags |= Scene::UpdateFlags::CurvesMoved;
         }
-        offset = (uint32_t)curveAABBCount;
 
-        if (forceUpdate || mCustomPrimitivesChanged || mCustomPrimitivesMoved)
+        // Copy AABBs of dirty custom primitives.
+        if (!mDirtyCustomPrimitives.empty())
         {
-            mCustomPrimitiveAABBOffset = offset;
-
-            // Track range of updated AABBs.
-            firstUpdated = std::min(firstUpdated, (size_t)offset);
-            lastUpdated = std::max(lastUpdated, (size_t)offset + customAABBCount);
-
-            for (auto& aabb : mCustomPrimitiveAABBs)
+            RtAABB* pCustomAABBs = mRtAABBRaw.data() + mCustomPrimitiveAABBOffset;
+            std::for_each(std::execution::par, mDirtyCustomPrimitives.begin(), mDirtyCustomPrimitives.end(), [&](uint32_t index)
             {
-                mRtAABBRaw[offset++] = static_cast<RtAABB>(aabb);
-            }
-            FALCOR_ASSERT(offset == totalAABBCount);
+                pCustomAABBs[index] = static_cast<RtAABB>(mCustomPrimitiveAABBs[index]);
+            });
             flags |= Scene::UpdateFlags::CustomPrimitivesMoved;
         }
 
@@ -887,24 +1082,29 @@ namespace Falcor
         // Requires unordered access and will be in Non-Pixel Shader Resource state.
         if (mpRtAABBBuffer == nullptr || mpRtAABBBuffer->getElementCount() < (uint32_t)mRtAABBRaw.size())
         {
-            mpRtAABBBuffer = Buffer::createStructured(sizeof(RtAABB), (uint32_t)mRtAABBRaw.size(), Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, mRtAABBRaw.data(), false);
+            // Leave some headroom when growing the buffer so that adding custom primitives doesn't reallocate it every frame.
+            size_t elementCount = mpRtAABBBuffer ? std::min(totalAABBCount + totalAABBCount / 2, (size_t)std::numeric_limits<uint32_t>::max()) : totalAABBCount;
+            mpRtAABBBuffer = Buffer::createStructured(sizeof(RtAABB), (uint32_t)elementCount, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
             mpRtAABBBuffer->setName("Scene::mpRtAABBBuffer");
+            mpRtAABBBuffer->setBlob(mRtAABBRaw.data(), 0, sizeof(RtAABB) * mRtAABBRaw.size());
 
             // Bind the new buffer to the scene.
             FALCOR_ASSERT(mpSceneBlock);
             mpSceneBlock->setBuffer(kProceduralPrimAABBBufferName, mpRtAABBBuffer);
         }
-        else if (firstUpdated < lastUpdated)
+        else
         {
-            size_t bytes = sizeof(RtAABB) * mRtAABBRaw.size();
-            FALCOR_ASSERT(mpRtAABBBuffer && mpRtAABBBuffer->getSize() >= bytes);
+            // Update the modified ranges of the GPU buffer.
+            auto uploadRange = [&](uint32_t first, uint32_t count)
+            {
+                mpRtAABBBuffer->setBlob(mRtAABBRaw.data() + first, first * sizeof(RtAABB), count * sizeof(RtAABB));
+            };
 
-            // Update the modified range of the GPU buffer.
-            size_t offset = firstUpdated * sizeof(RtAABB);
-            bytes = (lastUpdated - firstUpdated) * sizeof(RtAABB);
-            mpRtAABBBuffer->setBlob(mRtAABBRaw.data() + firstUpdated, offset, bytes);
+            for (uint32_t curveID : mDirtyCurves) uploadRange(mCurveAABBOffsets[curveID], mCurveDesc[curveID].indexCount);
+            forEachCoalescedRange(mDirtyCustomPrimitives, [&](uint32_t first, uint32_t count) { uploadRange(mCustomPrimitiveAABBOffset + first, count); });
         }
 
+        mDirtyCurves.clear();
         return flags;
     }
 
@@ -1017,36 +1217,52 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::updateProceduralPrimitives(bool forceUpdate)
     {
+        if (forceUpdate)
+        {
+            for (uint32_t index = 0; index < getCustomPrimitiveSlotCount(); index++) markCustomPrimitiveDirty(index);
+        }
+        // Drop duplicates and slots that have been released since they were marked.
+        std::sort(mDirtyCustomPrimitives.begin(), mDirtyCustomPrimitives.end());
+        mDirtyCustomPrimitives.erase(std::unique(mDirtyCustomPrimitives.begin(), mDirtyCustomPrimitives.end()), mDirtyCustomPrimitives.end());
+        mDirtyCustomPrimitives.erase(std::lower_bound(mDirtyCustomPrimitives.begin(), mDirtyCustomPrimitives.end(), getCustomPrimitiveSlotCount()), mDirtyCustomPrimitives.end());
+
         // Update the AABB buffer.
-        // The bounds are updated if any primitive has moved or been added/removed.
+        // Only the AABBs of dirty curves and custom primitives are updated.
         Scene::UpdateFlags flags = updateRaytracingAABBData(forceUpdate);
 
-        // Update the procedural primitives metadata.
-        if (forceUpdate || mCustomPrimitivesChanged)
+        // Update the custom primitives buffer.
+        if (!mCustomPrimitiveDesc.empty())
         {
-            // Update the custom primitives buffer.
-            if (!mCustomPrimitiveDesc.empty())
+            if (mpCustomPrimitivesBuffer == nullptr || mpCustomPrimitivesBuffer->getElementCount() < (uint32_t)mCustomPrimitiveDesc.size())
             {
-                if (mpCustomPrimitivesBuffer == nullptr || mpCustomPrimitivesBuffer->getElementCount() < (uint32_t)mCustomPrimitiveDesc.size())
-                {
-                    mpCustomPrimitivesBuffer = Buffer::createStructured(mpSceneBlock[kCustomPrimitiveBufferName], (uint32_t)mCustomPrimitiveDesc.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mCustomPrimitiveDesc.data(), false);
-                    mpCustomPrimitivesBuffer->setName("Scene::mpCustomPrimitivesBuffer");
-
-                    // Bind the buffer to the scene.
-                    FALCOR_ASSERT(mpSceneBlock);
-                    mpSceneBlock->setBuffer(kCustomPrimitiveBufferName, mpCustomPrimitivesBuffer);
-                }
-                else
+                size_t elementCount = mCustomPrimitiveDesc.size();
+                if (mpCustomPrimitivesBuffer) elementCount = std::min(elementCount + elementCount / 2, (size_t)std::numeric_limits<uint32_t>::max());
+                mpCustomPrimitivesBuffer = Buffer::createStructured(mpSceneBlock[kCustomPrimitiveBufferName], (uint32_t)elementCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+                mpCustomPrimitivesBuffer->setName("Scene::mpCustomPrimitivesBuffer");
+                mpCustomPrimitivesBuffer->setBlob(mCustomPrimitiveDesc.data(), 0, sizeof(CustomPrimitiveDesc) * mCustomPrimitiveDesc.size());
+
+                // Bind the buffer to the scene.
+                FALCOR_ASSERT(mpSceneBlock);
+                mpSceneBlock->setBuffer(kCustomPrimitiveBufferName, mpCustomPrimitivesBuffer);
+            }
+            else
+            {
+                forEachCoalescedRange(mDirtyCustomPrimitives, [&](uint32_t first, uint32_t count)
                 {
-                    size_t bytes = sizeof(CustomPrimitiveDesc) * mCustomPrimitiveDesc.size();
-                    FALCOR_ASSERT(mpCustomPrimitivesBuffer && mpCustomPrimitivesBuffer->getSize() >= bytes);
-                    mpCustomPrimitivesBuffer->setBlob(mCustomPrimitiveDesc.data(), 0, bytes);
-                }
+                    mpCustomPrimitivesBuffer->setBlob(mCustomPrimitiveDesc.data() + first, first * sizeof(CustomPrimitiveDesc), count * sizeof(CustomPrimitiveDesc));
+                });
             }
+        }
+
+        for (uint32_t index : mDirtyCustomPrimitives) mCustomPrimitiveDirty[index] = false;
+        mDirtyCustomPrimitives.clear();
 
+        // Update the procedural primitives metadata.
+        if (forceUpdate || mCustomPrimitivesChanged)
+        {
             // Update scene constants.
             uint32_t customPrimitiveInstanceOffset = getGeometryInstanceCount();
-            uint32_t customPrimitiveInstanceCount = getCustomPrimitiveCount();
+            uint32_t customPrimitiveInstanceCount = getCustomPrimitiveSlotCount();
 
             auto var = mpSceneBlock->getRootVar();
             var["customPrimitiveInstanceOffset"] = customPrimitiveInstanceOffset;
@@ -1067,7 +1283,7 @@ namespace Falcor
         if (hasDisplaced) mGeometryTypes |= GeometryTypeFlags::DisplacedTriangleMesh;
         if (getCurveCount() > 0) mGeometryTypes |= GeometryTypeFlags::Curve;
         if (getSDFGridCount() > 0) mGeometryTypes |= GeometryTypeFlags::SDFGrid;
-        if (getCustomPrimitiveCount() > 0) mGeometryTypes |= GeometryTypeFlags::Custom;
+        if (getCustomPrimitiveSlotCount() > 0) mGeometryTypes |= GeometryTypeFlags::Custom;
     }
 
     void Scene::finalize()
@@ -1086,6 +1302,7 @@ namespace Falcor
         initResources(); // Requires scene defines
         mpAnimationController->animate(gpDevice->getRenderContext(), 0); // Requires Scene block to exist
         updateGeometry(true); // Requires scene defines
+        buildNodeInstanceIndex();
         updateGeometryInstances(true);
 
         // DEMO21: Setup light profile.
@@ -1163,6 +1380,10 @@ namespace Falcor
 
         s.customPrimitiveCount = getCustomPrimitiveCount();
 
+        s.vertexCacheMissCount = mVertexCacheStats.cacheMissCount;
+        s.vertexCacheACMR = mVertexCacheStats.getACMR();
+        s.vertexCacheATVR = mVertexCacheStats.getATVR();
+
         for (uint32_t instanceID = 0; instanceID < getGeometryInstanceCount(); instanceID++)
         {
             const auto& instance = getGeometryInstance(instanceID);
@@ -1224,6 +1445,7 @@ namespace Falcor
 
             s.indexMemoryInBytes += pIB ? pIB->getSize() : 0;
             s.vertexMemoryInBytes += pVB ? pVB->getSize() : 0;
+            s.vertexMemoryInBytes += mpVertexQuantizationBuffer ? mpVertexQuantizationBuffer->getSize() : 0;
             s.geometryMemoryInBytes += pDrawID ? pDrawID->getSize() : 0;
         }
 
@@ -1252,10 +1474,10 @@ namespace Falcor
         s.geometryMemoryInBytes += mpCustomPrimitivesBuffer ? mpCustomPrimitivesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpRtAABBBuffer ? mpRtAABBBuffer->getSize() : 0;
 
-        for (const auto& draw : mDrawArgs)
+        for (const DrawList* pDrawList : { &mDrawList, &mCulledDrawList })
         {
-            FALCOR_ASSERT(draw.pBuffer);
-            s.geometryMemoryInBytes += draw.pBuffer->getSize();
+            s.geometryMemoryInBytes += pDrawList->pArgBuffer ? pDrawList->pArgBuffer->getSize() : 0;
+            s.geometryMemoryInBytes += pDrawList->pInstanceIDBuffer ? pDrawList->pInstanceIDBuffer->getSize() : 0;
         }
 
         s.animationMemoryInBytes += getAnimationController()->getMemoryUsageInBytes();
@@ -1298,6 +1520,7 @@ namespace Falcor
 
         if (mpBlasScratch) s.blasScratchMemoryInBytes += mpBlasScratch->getSize();
         if (mpBlasStaticWorldMatrices) s.blasScratchMemoryInBytes += mpBlasStaticWorldMatrices->getSize();
+        if (mpBlasVertexTransforms) s.blasScratchMemoryInBytes += mpBlasVertexTransforms->getSize();
     }
 
     void Scene::updateRaytracingTLASStats()
@@ -1463,7 +1686,7 @@ namespace Falcor
 
         if (combinedChanges != Light::Changes::None || forceUpdate)
         {
-            mpSceneBlock["lightCount"] = (uint32_t)mActiveLights.size();
+            mLightCountPath.get(mpSceneBlock->getRootVar()) = (uint32_t)mActiveLights.size();
             updateLightStats();
         }
 
@@ -1496,7 +1719,7 @@ namespace Falcor
         // Upload grids.
         if (forceUpdate)
         {
-            auto var = mpSceneBlock["grids"];
+            auto var = mGridsPath.get(mpSceneBlock->getRootVar());
             for (size_t i = 0; i < mGrids.size(); ++i)
             {
                 mGrids[i]->setShaderData(var[i]);
@@ -1526,7 +1749,7 @@ namespace Falcor
             volumeIndex++;
         }
 
-        mpSceneBlock["gridVolumeCount"] = (uint32_t)mGridVolumes.size();
+        mGridVolumeCountPath.get(mpSceneBlock->getRootVar()) = (uint32_t)mGridVolumes.size();
 
         UpdateFlags flags = UpdateFlags::None;
         if (is_set(combinedUpdates, GridVolume::UpdateFlags::TransformChanged)) flags |= UpdateFlags::GridVolumesMoved;
@@ -1601,7 +1824,6 @@ namespace Falcor
             mBlasDataValid = false;
         }
 
-        mCustomPrimitivesMoved = false;
         mCustomPrimitivesChanged = false;
         return flags;
     }
@@ -1618,13 +1840,9 @@ namespace Falcor
             mUpdates |= UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
 
-            for (const auto& inst : mGeometryInstanceData)
-            {
-                if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
-                {
-                    mUpdates |= UpdateFlags::GeometryMoved;
-                }
-            }
+            // Use the node to instance reverse index to find the moved instances without visiting all instances.
+            gatherChangedInstances(mpAnimationController->getChangedNodes(), mChangedInstances);
+            if (!mChangedInstances.empty()) mUpdates |= UpdateFlags::GeometryMoved;
 
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
@@ -1647,8 +1865,10 @@ namespace Falcor
 
         if (is_set(mUpdates, UpdateFlags::GeometryMoved))
         {
-            invalidateTlasCache();
-            updateGeometryInstances(false);
+            updateGeometryInstances(mChangedInstances);
+            updateBounds(mChangedInstances);
+            updateInstanceDescs(mChangedInstances);
+            mInstanceBVH.refit(mGeometryInstanceBBs, mChangedInstances);
         }
 
         // Update existing BLASes if skinned animation and/or procedural primitives moved.
@@ -1896,6 +2116,7 @@ namespace Falcor
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
+                << "  Vertex cache misses: " << s.vertexCacheMissCount << " (ACMR " << s.vertexCacheACMR << ", ATVR " << s.vertexCacheATVR << ")" << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
                 << "  Curve instance count: " << s.curveInstanceCount << std::endl
                 << "  Unique curve segment count: " << s.uniqueCurveSegmentCount << std::endl
@@ -2282,9 +2503,18 @@ namespace Falcor
         return geometryID.get() - (uint32_t)customPrimitiveOffset;
     }
 
+    bool Scene::isCustomPrimitiveActive(uint32_t index) const
+    {
+        if (index >= getCustomPrimitiveSlotCount())
+        {
+            throw ArgumentError("'index' ({}) is out of range.", index);
+        }
+        return mCustomPrimitiveActive[index];
+    }
+
     const CustomPrimitiveDesc& Scene::getCustomPrimitive(uint32_t index) const
     {
-        if (index >= getCustomPrimitiveCount())
+        if (index >= getCustomPrimitiveSlotCount())
         {
             throw ArgumentError("'index' ({}) is out of range.", index);
         }
@@ -2293,7 +2523,7 @@ namespace Falcor
 
     const AABB& Scene::getCustomPrimitiveAABB(uint32_t index) const
     {
-        if (index >= getCustomPrimitiveCount())
+        if (index >= getCustomPrimitiveSlotCount())
         {
             throw ArgumentError("'index' ({}) is out of range.", index);
         }
@@ -2304,7 +2534,31 @@ namespace Falcor
     {
         // Currently each custom primitive has exactly one AABB. This may change in the future.
         FALCOR_ASSERT(mCustomPrimitiveDesc.size() == mCustomPrimitiveAABBs.size());
-        if (mCustomPrimitiveAABBs.size() > std::numeric_limits<uint32_t>::max())
+        if (userID == CustomPrimitiveDesc::kInvalidUserID)
+        {
+            throw ArgumentError("'userID' ({}) is reserved for removed custom primitives.", userID);
+        }
+
+        // Reuse the lowest slot of a removed primitive if available, so that removed slots gather at the end where they can be released.
+        // The free list may hold stale entries of reused or released slots.
+        while (!mCustomPrimitiveFreeList.empty())
+        {
+            std::pop_heap(mCustomPrimitiveFreeList.begin(), mCustomPrimitiveFreeList.end(), std::greater<uint32_t>());
+            const uint32_t index = mCustomPrimitiveFreeList.back();
+            mCustomPrimitiveFreeList.pop_back();
+            if (index >= getCustomPrimitiveSlotCount() || mCustomPrimitiveActive[index]) continue;
+
+            mCustomPrimitiveDesc[index].userID = userID;
+            mCustomPrimitiveAABBs[index] = aabb;
+            mCustomPrimitiveActive[index] = true;
+            mRemovedCustomPrimitiveCount--;
+
+            // The number of primitives is unchanged, so the acceleration structure only needs to be updated.
+            markCustomPrimitiveDirty(index);
+            return index;
+        }
+
+        if (mCustomPrimitiveAABBs.size() >= std::numeric_limits<uint32_t>::max())
         {
             throw RuntimeError("Custom primitive count exceeds the maximum");
         }
@@ -2313,10 +2567,13 @@ namespace Falcor
 
         CustomPrimitiveDesc desc = {};
         desc.userID = userID;
-        desc.aabbOffset = (uint32_t)mCustomPrimitiveAABBs.size();
+        desc.aabbOffset = index;
 
         mCustomPrimitiveDesc.push_back(desc);
         mCustomPrimitiveAABBs.push_back(aabb);
+        mCustomPrimitiveActive.push_back(true);
+        mCustomPrimitiveDirty.push_back(false);
+        markCustomPrimitiveDirty(index);
         mCustomPrimitivesChanged = true;
 
         return index;
@@ -2324,38 +2581,105 @@ namespace Falcor
 
     void Scene::removeCustomPrimitives(uint32_t first, uint32_t last)
     {
-        if (first > last || last > getCustomPrimitiveCount())
+        if (first > last || last > getCustomPrimitiveSlotCount())
         {
             throw ArgumentError("'first' ({}) and 'last' ({}) is not a valid range of custom primitives.", first, last);
         }
 
-        if (first == last) return;
-
-        mCustomPrimitiveDesc.erase(mCustomPrimitiveDesc.begin() + first, mCustomPrimitiveDesc.begin() + last);
-        mCustomPrimitiveAABBs.erase(mCustomPrimitiveAABBs.begin() + first, mCustomPrimitiveAABBs.begin() + last);
-
-        // Update AABB offsets for all subsequent primitives.
-        // The offset is currently redundant since there is one AABB per primitive. This may change in the future.
-        for (uint32_t i = first; i < mCustomPrimitiveDesc.size(); i++)
+        // Removed primitives keep their slot so that the indices of other primitives don't change.
+        // Their AABB is collapsed to a point. Primitives can't be deactivated in an acceleration structure update,
+        // so this avoids a rebuild at the cost of a few degenerate leaves until the slot is reused.
+        // The invalid user ID lets intersection shaders reject rays that still reach the degenerate AABB.
+        for (uint32_t index = first; index < last; index++)
         {
-            mCustomPrimitiveDesc[i].aabbOffset = i;
+            if (!mCustomPrimitiveActive[index]) continue;
+
+            const AABB& aabb = mCustomPrimitiveAABBs[index];
+            float3 center = aabb.valid() ? aabb.center() : float3(0.f);
+            mCustomPrimitiveAABBs[index] = AABB(center, center);
+            mCustomPrimitiveDesc[index].userID = CustomPrimitiveDesc::kInvalidUserID;
+            mCustomPrimitiveActive[index] = false;
+            mCustomPrimitiveFreeList.push_back(index);
+            std::push_heap(mCustomPrimitiveFreeList.begin(), mCustomPrimitiveFreeList.end(), std::greater<uint32_t>());
+            mRemovedCustomPrimitiveCount++;
+            markCustomPrimitiveDirty(index);
         }
 
+        trimCustomPrimitiveSlots();
+    }
+
+    void Scene::trimCustomPrimitiveSlots()
+    {
+        // Removed slots are never compacted as that would change the indices of other primitives.
+        // Instead, removed slots at the end are released once there are enough of them to be worth the rebuild
+        // of the acceleration structure caused by changing the slot count.
+        uint32_t slotCount = getCustomPrimitiveSlotCount();
+        while (slotCount > 0 && !mCustomPrimitiveActive[slotCount - 1]) slotCount--;
+
+        const uint32_t trimCount = getCustomPrimitiveSlotCount() - slotCount;
+        if (trimCount == 0 || trimCount < getCustomPrimitiveSlotCount() / kCustomPrimitiveTrimDivisor) return;
+
+        // Stale entries of released slots in the free list and dirty list are skipped when they are used.
+        mCustomPrimitiveDesc.resize(slotCount);
+        mCustomPrimitiveAABBs.resize(slotCount);
+        mCustomPrimitiveActive.resize(slotCount);
+        mCustomPrimitiveDirty.resize(slotCount);
+        mRemovedCustomPrimitiveCount -= trimCount;
         mCustomPrimitivesChanged = true;
     }
 
     void Scene::updateCustomPrimitive(uint32_t index, const AABB& aabb)
     {
-        if (index >= getCustomPrimitiveCount())
+        if (index >= getCustomPrimitiveSlotCount())
         {
             throw ArgumentError("'index' ({}) is out of range.", index);
         }
+        if (!mCustomPrimitiveActive[index])
+        {
+            throw ArgumentError("Custom primitive {} has been removed.", index);
+        }
 
         if (mCustomPrimitiveAABBs[index] != aabb)
         {
             mCustomPrimitiveAABBs[index] = aabb;
-            mCustomPrimitivesMoved = true;
+            markCustomPrimitiveDirty(index);
+        }
+    }
+
+    void Scene::updateCurveVertices(CurveID curveID, const std::vector<StaticCurveVertexData>& vertices)
+    {
+        if (curveID.get() >= getCurveCount())
+        {
+            throw ArgumentError("'curveID' ({}) is out of range.", curveID);
         }
+
+        const auto& curve = mCurveDesc[curveID.get()];
+        if (vertices.size() != curve.vertexCount)
+        {
+            throw ArgumentError("'vertices' has {} elements, but curve {} has {} vertices.", vertices.size(), curveID, curve.vertexCount);
+        }
+
+        std::copy(vertices.begin(), vertices.end(), mCurveStaticData.begin() + curve.vbOffset);
+
+        FALCOR_ASSERT(mpCurveVao);
+        mpCurveVao->getVertexBuffer(kStaticDataBufferIndex)->setBlob(vertices.data(), curve.vbOffset * sizeof(StaticCurveVertexData), vertices.size() * sizeof(StaticCurveVertexData));
+        markCurveDirty(curveID.get());
+    }
+
+    void Scene::markCurveDirty(uint32_t curveID)
+    {
+        FALCOR_ASSERT(curveID < mCurveAABBsDirty.size());
+        if (mCurveAABBsDirty[curveID]) return;
+        mCurveAABBsDirty[curveID] = true;
+        mDirtyCurves.push_back(curveID);
+    }
+
+    void Scene::markCustomPrimitiveDirty(uint32_t index)
+    {
+        FALCOR_ASSERT(index < mCustomPrimitiveDirty.size());
+        if (mCustomPrimitiveDirty[index]) return;
+        mCustomPrimitiveDirty[index] = true;
+        mDirtyCustomPrimitives.push_back(index);
     }
 
     GridVolume::SharedPtr Scene::getGridVolumeByName(const std::string& name) const
@@ -2393,85 +2717,142 @@ namespace Falcor
 
     void Scene::createDrawList()
     {
-        // This function creates argument buffers for draw indirect calls to rasterize the scene.
-        // The updateGeometryInstances() function must have been called before so that the flags are accurate.
+        // This function sets up the data structures for rasterizing the scene.
+        // The updateGeometryInstances() and updateBounds() functions must have been called before so that the flags and bounds are accurate.
         //
-        // Note that we create four draw buffers to handle all combinations of:
+        // Instances of the same mesh are merged into instanced draws, which fetch their geometry instance IDs
+        // from a per draw list instance ID buffer bound in place of the draw ID buffer.
+        // The draws are grouped into four segments to handle all combinations of:
         // 1) mesh is using 16- or 32-bit indices,
         // 2) mesh triangle winding is CW or CCW after transformation.
         //
-        // TODO: Update the draw args if a mesh undergoes animation that flips the winding.
+        // Instances of static meshes are inserted into a BVH for view frustum culling. The BVH is refit when instances move.
+        // Instances of dynamic meshes are never culled as their bounds are not known on the CPU.
 
-        mDrawArgs.clear();
+        mMeshInstanceIDs.clear();
+        mUnculledMeshInstanceIDs.clear();
+        std::vector<uint32_t> culledInstanceIDs;
+        std::vector<uint32_t> drawKeys(mGeometryInstanceData.size(), 0);
 
-        // Helper to create the draw-indirect buffer.
-        auto createDrawBuffer = [this](const auto& drawMeshes, bool ccw, ResourceFormat ibFormat = ResourceFormat::Unknown)
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
         {
-            if (drawMeshes.size() > 0)
-            {
-                DrawArgs draw;
-                draw.pBuffer = Buffer::create(sizeof(drawMeshes[0]) * drawMeshes.size(), Resource::BindFlags::IndirectArg, Buffer::CpuAccess::None, drawMeshes.data());
-                draw.pBuffer->setName("Scene draw buffer");
-                FALCOR_ASSERT(drawMeshes.size() <= std::numeric_limits<uint32_t>::max());
-                draw.count = (uint32_t)drawMeshes.size();
-                draw.ccw = ccw;
-                draw.ibFormat = ibFormat;
-                mDrawArgs.push_back(draw);
-            }
-        };
+            const auto& instance = mGeometryInstanceData[instanceID];
+            if (instance.getType() != GeometryType::TriangleMesh) continue;
+
+            mMeshInstanceIDs.push_back(instanceID);
+            drawKeys[instanceID] = getDrawKey(instance);
+
+            if (mMeshDesc[instance.geometryID].isDynamic()) mUnculledMeshInstanceIDs.push_back(instanceID);
+            else culledInstanceIDs.push_back(instanceID);
+        }
+
+        mInstanceBatcher.setKeys(std::move(drawKeys), 4 * (uint32_t)mMeshDesc.size());
+        mInstanceBVH.build(mGeometryInstanceBBs, culledInstanceIDs);
 
-        if (hasIndexBuffer())
+        mDrawList = {};
+        mCulledDrawList = {};
+        mDrawListDirty = true;
+    }
+
+    uint32_t Scene::getDrawKey(const GeometryInstanceData& instance) const
+    {
+        FALCOR_ASSERT(instance.getType() == GeometryType::TriangleMesh);
+        const auto& mesh = mMeshDesc[instance.geometryID];
+        uint32_t segment = (mesh.use16BitIndices() ? 0 : 2) + (instance.isWorldFrontFaceCW() ? 0 : 1);
+        return segment * (uint32_t)mMeshDesc.size() + instance.geometryID;
+    }
+
+    void Scene::updateDrawList(DrawList& drawList, const std::vector<uint32_t>& instanceIDs)
+    {
+        mInstanceBatcher.createBatches(instanceIDs, mSortedMeshInstanceIDs, mDrawBatches);
+        drawList.draws.clear();
+
+        if (mDrawBatches.empty()) return;
+        FALCOR_ASSERT(mpMeshVao);
+
+        const bool isIndexed = hasIndexBuffer();
+        const size_t argSize = isIndexed ? sizeof(DrawIndexedArguments) : sizeof(DrawArguments);
+        const ResourceFormat drawIDFormat = mpMeshVao->getVertexLayout()->getBufferLayout(kDrawIdBufferIndex)->getElementFormat(0);
+
+        // Create the buffers on first use. They are sized for one draw per mesh instance so they never need to grow.
+        if (!drawList.pArgBuffer)
         {
-            std::vector<DrawIndexedArguments> drawClockwiseMeshes[2], drawCounterClockwiseMeshes[2];
+            const size_t maxDrawCount = mMeshInstanceIDs.size();
+            drawList.pArgBuffer = Buffer::create(argSize * maxDrawCount, Resource::BindFlags::IndirectArg, Buffer::CpuAccess::None);
+            drawList.pArgBuffer->setName("Scene draw buffer");
+            drawList.pInstanceIDBuffer = Buffer::create(getFormatBytesPerBlock(drawIDFormat) * maxDrawCount, ResourceBindFlags::Vertex, Buffer::CpuAccess::None);
+            drawList.pInstanceIDBuffer->setName("Scene draw instance ID buffer");
 
-            uint32_t instanceID = 0;
-            for (const auto& instance : mGeometryInstanceData)
+            // Create VAOs sharing the mesh data but reading the draw IDs from the instance ID buffer.
+            Vao::BufferVec pVBs(mpMeshVao->getVertexBuffersCount());
+            for (uint32_t i = 0; i < (uint32_t)pVBs.size(); i++) pVBs[i] = mpMeshVao->getVertexBuffer(i);
+            pVBs[kDrawIdBufferIndex] = drawList.pInstanceIDBuffer;
+            drawList.pVao = Vao::create(Vao::Topology::TriangleList, mpMeshVao->getVertexLayout(), pVBs, mpMeshVao->getIndexBuffer(), ResourceFormat::R32Uint);
+            drawList.pVao16Bit = Vao::create(Vao::Topology::TriangleList, mpMeshVao->getVertexLayout(), pVBs, mpMeshVao->getIndexBuffer(), ResourceFormat::R16Uint);
+        }
+
+        // Upload the geometry instance IDs in batch order.
+        if (drawIDFormat == ResourceFormat::R16Uint)
+        {
+            std::vector<uint16_t> instanceIDs16(mSortedMeshInstanceIDs.size());
+            for (size_t i = 0; i < instanceIDs16.size(); i++) instanceIDs16[i] = (uint16_t)mSortedMeshInstanceIDs[i];
+            drawList.pInstanceIDBuffer->setBlob(instanceIDs16.data(), 0, instanceIDs16.size() * sizeof(uint16_t));
+        }
+        else
+        {
+            drawList.pInstanceIDBuffer->setBlob(mSortedMeshInstanceIDs.data(), 0, mSortedMeshInstanceIDs.size() * sizeof(uint32_t));
+        }
+
+        // Create one instanced draw per batch. Batches are sorted by key, so each segment is a contiguous range of draws.
+        std::vector<DrawIndexedArguments> drawIndexedArgs;
+        std::vector<DrawArguments> drawArgs;
+        const uint32_t meshCount = (uint32_t)mMeshDesc.size();
+        uint32_t prevSegment = std::numeric_limits<uint32_t>::max();
+
+        for (const auto& batch : mDrawBatches)
+        {
+            const uint32_t segment = batch.key / meshCount;
+            const auto& mesh = mMeshDesc[batch.key % meshCount];
+
+            if (segment != prevSegment)
             {
-                if (instance.getType() != GeometryType::TriangleMesh) continue;
+                DrawArgs draw;
+                draw.pBuffer = drawList.pArgBuffer;
+                draw.offset = (isIndexed ? drawIndexedArgs.size() : drawArgs.size()) * argSize;
+                draw.ccw = (segment & 1) != 0;
+                draw.ibFormat = isIndexed ? ((segment & 2) ? ResourceFormat::R32Uint : ResourceFormat::R16Uint) : ResourceFormat::Unknown;
+                drawList.draws.push_back(draw);
+                prevSegment = segment;
+            }
+            drawList.draws.back().count++;
 
-                const auto& mesh = mMeshDesc[instance.geometryID];
+            if (isIndexed)
+            {
                 bool use16Bit = mesh.use16BitIndices();
 
                 DrawIndexedArguments draw;
                 draw.IndexCountPerInstance = mesh.indexCount;
-                draw.InstanceCount = 1;
+                draw.InstanceCount = batch.itemCount;
                 draw.StartIndexLocation = mesh.ibOffset * (use16Bit ? 2 : 1);
                 draw.BaseVertexLocation = mesh.vbOffset;
-                draw.StartInstanceLocation = instanceID++;
-
-                int i = use16Bit ? 0 : 1;
-                (instance.isWorldFrontFaceCW()) ? drawClockwiseMeshes[i].push_back(draw) : drawCounterClockwiseMeshes[i].push_back(draw);
+                draw.StartInstanceLocation = batch.firstItem;
+                drawIndexedArgs.push_back(draw);
             }
-
-            createDrawBuffer(drawClockwiseMeshes[0], false, ResourceFormat::R16Uint);
-            createDrawBuffer(drawClockwiseMeshes[1], false, ResourceFormat::R32Uint);
-            createDrawBuffer(drawCounterClockwiseMeshes[0], true, ResourceFormat::R16Uint);
-            createDrawBuffer(drawCounterClockwiseMeshes[1], true, ResourceFormat::R32Uint);
-        }
-        else
-        {
-            std::vector<DrawArguments> drawClockwiseMeshes, drawCounterClockwiseMeshes;
-
-            uint32_t instanceID = 0;
-            for (const auto& instance : mGeometryInstanceData)
+            else
             {
-                if (instance.getType() != GeometryType::TriangleMesh) continue;
-
-                const auto& mesh = mMeshDesc[instance.geometryID];
                 FALCOR_ASSERT(mesh.indexCount == 0);
 
                 DrawArguments draw;
                 draw.VertexCountPerInstance = mesh.vertexCount;
-                draw.InstanceCount = 1;
+                draw.InstanceCount = batch.itemCount;
                 draw.StartVertexLocation = mesh.vbOffset;
-                draw.StartInstanceLocation = instanceID++;
-
-                (instance.isWorldFrontFaceCW()) ? drawClockwiseMeshes.push_back(draw) : drawCounterClockwiseMeshes.push_back(draw);
+                draw.StartInstanceLocation = batch.firstItem;
+                drawArgs.push_back(draw);
             }
-
-            createDrawBuffer(drawClockwiseMeshes, false);
-            createDrawBuffer(drawCounterClockwiseMeshes, true);
         }
+
+        if (isIndexed) drawList.pArgBuffer->setBlob(drawIndexedArgs.data(), 0, drawIndexedArgs.size() * argSize);
+        else drawList.pArgBuffer->setBlob(drawArgs.data(), 0, drawArgs.size() * argSize);
     }
 
     void Scene::initGeomDesc(RenderContext* pContext)
@@ -2521,6 +2902,39 @@ namespace Falcor
                 return mpBlasStaticWorldMatrices;
             };
 
+            // Compressed vertex positions are quantized to the mesh bounds and need to be dequantized by DXR as part of the BLAS build.
+            // We create one transform per mesh, which also includes the object-to-world transform for static meshes.
+            auto getVertexTransformsBuffer = [&]()
+            {
+                if (!mpBlasVertexTransforms)
+                {
+                    FALCOR_ASSERT(mVertexQuantization.size() == mMeshDesc.size());
+                    std::vector<rmcv::mat4> transposedMatrices(mMeshDesc.size());
+                    for (const auto& meshGroup : mMeshGroups)
+                    {
+                        for (const MeshID meshID : meshGroup.meshList)
+                        {
+                            const VertexQuantization& q = mVertexQuantization[meshID.get()];
+                            rmcv::mat4 m = rmcv::translate(q.positionOffset) * rmcv::scale(q.positionScale);
+                            if (meshGroup.isStatic)
+                            {
+                                uint32_t instanceID = mMeshIdToInstanceIds[meshID.get()][0];
+                                m = globalMatrices[mGeometryInstanceData[instanceID].globalMatrixID] * m;
+                            }
+                            transposedMatrices[meshID.get()] = rmcv::transpose(m);
+                        }
+                    }
+
+                    uint32_t float4Count = (uint32_t)transposedMatrices.size() * 4;
+                    mpBlasVertexTransforms = Buffer::createStructured(sizeof(float4), float4Count, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, transposedMatrices.data(), false);
+                    mpBlasVertexTransforms->setName("Scene::mpBlasVertexTransforms");
+
+                    // Transition the resource to non-pixel shader state as expected by DXR.
+                    pContext->resourceBarrier(mpBlasVertexTransforms.get(), Resource::State::NonPixelShader);
+                }
+                return mpBlasVertexTransforms;
+            };
+
             // Iterate over the mesh groups. One BLAS will be created for each group.
             // Each BLAS may contain multiple geometries.
             for (size_t i = 0; i < mMeshGroups.size(); i++)
@@ -2551,7 +2965,18 @@ namespace Falcor
                         desc.type = RtGeometryType::Triangles;
                         desc.content.triangles.transform3x4 = 0; // The default is no transform
 
-                        if (isStatic)
+                        if (mHasCompressedVertices)
+                        {
+                            // The vertex transform includes the object-to-world transform for static meshes.
+                            desc.content.triangles.transform3x4 = getVertexTransformsBuffer()->getGpuAddress() + meshID.get() * 64ull;
+
+                            if (isStatic)
+                            {
+                                uint32_t matrixID = mGeometryInstanceData[mMeshIdToInstanceIds[meshID.get()][0]].globalMatrixID;
+                                if (rmcv::determinant(globalMatrices[matrixID]) < 0.f) frontFaceCW = !frontFaceCW;
+                            }
+                        }
+                        else if (isStatic)
                         {
                             // Static meshes will be pre-transformed when building the BLAS.
                             // Lookup the matrix ID here. If it is an identity matrix, no action is needed.
@@ -2808,73 +3233,47 @@ namespace Falcor
 
     void Scene::computeBlasGroups()
     {
-        mBlasGroups.clear();
-        uint64_t groupSize = 0;
-
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        // Plan the build using the prebuild sizes. The final sizes are estimated from the previous build if there was one.
+        std::vector<BlasBuildScheduler::BlasSizes> blasSizes(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
         {
-            auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
-
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
-            {
-                mBlasGroups.push_back({});
-                groupSize = 0;
-            }
-
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
-
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
-
-            groupSize += blasSize;
+            const auto& blas = mBlasData[blasId];
+            auto& sizes = blasSizes[blasId];
+            sizes.resultByteSize = blas.resultByteSize;
+            sizes.scratchByteSize = blas.scratchByteSize;
+            if (blas.blasByteSize > 0) sizes.finalByteSize = blas.blasByteSize;
+            else if (blas.useCompaction) sizes.finalByteSize = align_to(kAccelerationStructureByteAlignment, (uint64_t)(blas.resultByteSize * kBLASCompactionRatioEstimate));
         }
 
-        // Validation that all offsets and sizes are correct.
-        uint64_t totalResultSize = 0;
-        uint64_t totalScratchSize = 0;
-        std::set<uint32_t> blasIDs;
+        BlasBuildScheduler::Options options;
+        options.memoryBudget = kMaxBLASBuildMemory;
+        options.batchScratchBudget = kMaxBLASBuildBatchScratchMemory;
+        auto schedule = BlasBuildScheduler::createSchedule(blasSizes, options);
 
+        mBlasGroups.clear();
+        mBlasGroups.resize(schedule.groups.size());
         for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
         {
-            uint64_t resultSize = 0;
-            uint64_t scratchSize = 0;
-
-            const auto& group = mBlasGroups[blasGroupIndex];
-            FALCOR_ASSERT(!group.blasIndices.empty());
-
-            for (auto blasId : group.blasIndices)
-            {
-                FALCOR_ASSERT(blasId < mBlasData.size());
-                const auto& blas = mBlasData[blasId];
-
-                FALCOR_ASSERT(blasIDs.insert(blasId).second);
-                FALCOR_ASSERT(blas.blasGroupIndex == blasGroupIndex);
-
-                FALCOR_ASSERT(blas.resultByteSize > 0);
-                FALCOR_ASSERT(blas.resultByteOffset == resultSize);
-                resultSize += blas.resultByteSize;
-
-                FALCOR_ASSERT(blas.scratchByteSize > 0);
-                FALCOR_ASSERT(blas.scratchByteOffset == scratchSize);
-                scratchSize += blas.scratchByteSize;
-
-                FALCOR_ASSERT(blas.blasByteOffset == 0);
-                FALCOR_ASSERT(blas.blasByteSize == 0);
-            }
+            const auto& scheduledGroup = schedule.groups[blasGroupIndex];
+            auto& group = mBlasGroups[blasGroupIndex];
+            group.blasIndices = scheduledGroup.blasIndices;
+            group.resultByteSize = scheduledGroup.resultByteSize;
+            group.scratchByteSize = scheduledGroup.scratchByteSize;
+        }
 
-            FALCOR_ASSERT(resultSize == group.resultByteSize);
-            FALCOR_ASSERT(scratchSize == group.scratchByteSize);
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            const auto& placement = schedule.placements[blasId];
+            auto& blas = mBlasData[blasId];
+            blas.blasGroupIndex = placement.groupIndex;
+            blas.buildBatchIndex = placement.batchIndex;
+            blas.resultByteOffset = placement.resultByteOffset;
+            blas.scratchByteOffset = placement.scratchByteOffset;
+            blas.blasByteOffset = 0;
+            blas.blasByteSize = 0;
         }
-        FALCOR_ASSERT(blasIDs.size() == mBlasData.size());
+
+        logInfo("BLAS build estimated peak memory: {}", formatByteSize(schedule.peakBuildMemory));
     }
 
     void Scene::buildBlas(RenderContext* pContext)
@@ -2950,7 +3349,7 @@ namespace Falcor
             {
                 logInfo("Initiating BLAS build for {} mesh groups", mBlasData.size());
 
-                // Compute pre-build info per BLAS and organize the BLASes into groups
+                // Compute pre-build info per BLAS and schedule the BLASes into groups and batches
                 // in order to limit GPU memory usage during BLAS build.
                 preparePrebuildInfo(pContext);
                 computeBlasGroups();
@@ -3019,11 +3418,14 @@ namespace Falcor
 
                     // Build the BLASes into the intermediate result buffer.
                     // We output post-build info in order to find out the final size requirements.
+                    // Builds in different batches alias their scratch memory, so we insert a barrier between batches.
                     for (size_t i = 0; i < group.blasIndices.size(); ++i)
                     {
                         const uint32_t blasId = group.blasIndices[i];
                         const auto& blas = mBlasData[blasId];
 
+                        if (i > 0 && blas.buildBatchIndex != mBlasData[group.blasIndices[i - 1]].buildBatchIndex) pContext->uavBarrier(mpBlasScratch.get());
+
                         hasDynamicGeometry |= blas.hasDynamicGeometry();
                         hasProceduralPrimitives |= blas.hasProceduralPrimitives;
 
@@ -3165,6 +3567,8 @@ namespace Falcor
             pContext->uavBarrier(mpBlasScratch.get());
 
             // Iterate over all BLASes in group.
+            // Builds in different batches alias their scratch memory, so we insert a barrier between batches.
+            uint32_t prevBatchIndex = std::numeric_limits<uint32_t>::max();
             for (uint32_t blasId : group.blasIndices)
             {
                 const auto& blas = mBlasData[blasId];
@@ -3173,6 +3577,9 @@ namespace Falcor
                 if (blas.hasProceduralPrimitives && !updateProcedural) continue;
                 if (!blas.hasProceduralPrimitives && !blas.hasDynamicGeometry()) continue;
 
+                if (prevBatchIndex != std::numeric_limits<uint32_t>::max() && blas.buildBatchIndex != prevBatchIndex) pContext->uavBarrier(mpBlasScratch.get());
+                prevBatchIndex = blas.buildBatchIndex;
+
                 // Rebuild/update BLAS.
                 RtAccelerationStructure::BuildDesc asDesc = {};
                 asDesc.inputs = blas.buildInputs;
@@ -3198,9 +3605,10 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceDescMatrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const
     {
         instanceDescs.clear();
+        instanceDescMatrixIDs.clear();
         uint32_t instanceContributionToHitGroupIndex = 0;
         uint32_t instanceID = 0;
 
@@ -3264,12 +3672,14 @@ namespace Falcor
                 instanceID += (uint32_t)meshList.size();
 
                 rmcv::mat4 transform4x4 = rmcv::identity<rmcv::mat4>();
+                uint32_t descMatrixID = NodeID::kInvalidID;
                 if (!isStatic)
                 {
                     // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
                     // Just pick the matrix from the first mesh.
                     const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
                     transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
+                    descMatrixID = matrixId;
 
                     // Verify that all meshes have matching tranforms.
                     for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
@@ -3287,6 +3697,7 @@ namespace Falcor
                 }
 
                 instanceDescs.push_back(desc);
+                instanceDescMatrixIDs.push_back(descMatrixID);
             }
         }
 
@@ -3328,6 +3739,7 @@ namespace Falcor
             }
 
             instanceDescs.push_back(desc);
+            instanceDescMatrixIDs.push_back(matrixId);
         }
 
         // One instance per SDF grid instance.
@@ -3371,6 +3783,7 @@ namespace Falcor
                 FALCOR_ASSERT(0 == instance.geometryIndex);
 
                 instanceDescs.push_back(desc);
+                instanceDescMatrixIDs.push_back(instance.globalMatrixID);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -3398,6 +3811,7 @@ namespace Falcor
             rmcv::mat4 identityMat = rmcv::identity<rmcv::mat4>();
             std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
             instanceDescs.push_back(desc);
+            instanceDescMatrixIDs.push_back(NodeID::kInvalidID);
         }
     }
 
@@ -3406,6 +3820,48 @@ namespace Falcor
         for (auto& tlas : mTlasCache)
         {
             tlas.second.pTlasObject = nullptr;
+            tlas.second.dirtyInstanceDescs.clear();
+        }
+        mInstanceDescsValid = false;
+    }
+
+    void Scene::updateInstanceDescs(const std::vector<uint32_t>& changedInstances)
+    {
+        // If the instance descs are regenerated on next TLAS build anyway there is nothing to do.
+        if (!mInstanceDescsValid) return;
+
+        // Multiple geometry instances can share an instance desc.
+        std::vector<uint32_t> dirtyInstanceDescs;
+        dirtyInstanceDescs.reserve(changedInstances.size());
+        for (uint32_t instanceID : changedInstances)
+        {
+            uint32_t descIndex = mGeometryInstanceData[instanceID].instanceIndex;
+            FALCOR_ASSERT(descIndex < mInstanceDescMatrixIDs.size());
+            if (mInstanceDescMatrixIDs[descIndex] != NodeID::kInvalidID) dirtyInstanceDescs.push_back(descIndex);
+        }
+        std::sort(dirtyInstanceDescs.begin(), dirtyInstanceDescs.end());
+        dirtyInstanceDescs.erase(std::unique(dirtyInstanceDescs.begin(), dirtyInstanceDescs.end()), dirtyInstanceDescs.end());
+
+        if (dirtyInstanceDescs.empty()) return;
+
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        for (uint32_t descIndex : dirtyInstanceDescs)
+        {
+            mInstanceDescs[descIndex].setTransform(globalMatrices[mInstanceDescMatrixIDs[descIndex]]);
+        }
+
+        // Record the modified instance descs for all cached TLASes. They are uploaded and the TLAS is rebuilt or refit on next use.
+        for (auto& [rayTypeCount, tlas] : mTlasCache)
+        {
+            if (!tlas.pTlasObject) continue;
+            auto& dirty = tlas.dirtyInstanceDescs;
+            size_t prevSize = dirty.size();
+            dirty.insert(dirty.end(), dirtyInstanceDescs.begin(), dirtyInstanceDescs.end());
+            if (prevSize > 0)
+            {
+                std::inplace_merge(dirty.begin(), dirty.begin() + prevSize, dirty.end());
+                dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+            }
         }
     }
 
@@ -3419,7 +3875,15 @@ namespace Falcor
 
         // Prepare instance descs.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+        // The instance descs are shared between TLASes and kept up-to-date incrementally, see updateInstanceDescs().
+        // They only need to be regenerated if they are invalid or were generated for a different ray type count.
+        bool fillInstanceDescs = !mInstanceDescsValid || mInstanceDescsRayTypeCount != rayTypeCount;
+        if (fillInstanceDescs)
+        {
+            fillInstanceDesc(mInstanceDescs, mInstanceDescMatrixIDs, rayTypeCount, perMeshHitEntry);
+            mInstanceDescsValid = true;
+            mInstanceDescsRayTypeCount = rayTypeCount;
+        }
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
@@ -3486,16 +3950,26 @@ namespace Falcor
         // Else update instance descs and barrier TLAS buffers
         else
         {
-            FALCOR_ASSERT(mpAnimationController->hasAnimations() || mpAnimationController->hasAnimatedVertexCaches());
             pContext->uavBarrier(tlas.pTlasBuffer.get());
             pContext->uavBarrier(mpTlasScratch.get());
             if (tlas.pInstanceDescs)
             {
                 FALCOR_ASSERT(!mInstanceDescs.empty());
-                tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, inputs.descCount * sizeof(RtInstanceDesc));
+                if (fillInstanceDescs)
+                {
+                    tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, inputs.descCount * sizeof(RtInstanceDesc));
+                }
+                else
+                {
+                    // Upload modified instance descs only.
+                    forEachCoalescedRange(tlas.dirtyInstanceDescs, [&](uint32_t first, uint32_t count)
+                    {
+                        tlas.pInstanceDescs->setBlob(&mInstanceDescs[first], first * sizeof(RtInstanceDesc), count * sizeof(RtInstanceDesc));
+                    });
+                }
             }
-            asDesc.source = tlas.pTlasObject.get(); // Perform the update in-place
         }
+        tlas.dirtyInstanceDescs.clear();
 
         FALCOR_ASSERT(tlas.pTlasBuffer && tlas.pTlasBuffer->getApiHandle() && mpTlasScratch->getApiHandle());
         FALCOR_ASSERT(inputs.descCount == 0 || (tlas.pInstanceDescs && tlas.pInstanceDescs->getApiHandle()));
@@ -3537,7 +4011,7 @@ namespace Falcor
         // Note that for DXR 1.1 ray queries, the shader table is not used and the ray type count doesn't matter and can be set to zero.
         //
         auto tlasIt = mTlasCache.find(rayTypeCount);
-        if (tlasIt == mTlasCache.end() || !tlasIt->second.pTlasObject)
+        if (tlasIt == mTlasCache.end() || !tlasIt->second.pTlasObject || !tlasIt->second.dirtyInstanceDescs.empty())
         {
             // We need a hit entry per mesh right now to pass GeometryIndex()
             buildTlas(pContext, rayTypeCount, true);
@@ -3819,6 +4293,9 @@ namespace Falcor
         d["vertexMemoryInBytes"] = vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = geometryMemoryInBytes;
         d["animationMemoryInBytes"] = animationMemoryInBytes;
+        d["vertexCacheMissCount"] = vertexCacheMissCount;
+        d["vertexCacheACMR"] = vertexCacheACMR;
+        d["vertexCacheATVR"] = vertexCacheATVR;
 
         // Curve stats
         d["curveCount"] = curveCount;
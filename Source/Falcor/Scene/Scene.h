@@ -29,6 +29,8 @@
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "InstanceBVH.h"
+#include "MeshOptimizer.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -46,7 +48,9 @@
 #include "Core/Macros.h"
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Core/Program/ShaderVarPath.h"
 #include "Utils/Math/AABB.h"
+#include "Utils/Math/Frustum.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/UI/Gui.h"
@@ -323,7 +327,10 @@ namespace Falcor
 
             std::vector<uint32_t> meshIndexData;                    ///< Vertex indices for all meshes in either 32-bit or 16-bit format packed tightly, decided per mesh.
             std::vector<PackedStaticVertexData> meshStaticData;     ///< Vertex attributes for all meshes in packed format.
+            std::vector<CompressedStaticVertexData> meshCompressedStaticData; ///< Vertex attributes for all meshes in compressed format. If non-empty, used instead of meshStaticData.
+            std::vector<VertexQuantization> meshVertexQuantization; ///< Quantization frame per mesh for compressed vertex attributes.
             std::vector<SkinningVertexData> meshSkinningData;       ///< Additional vertex attributes for skinned meshes.
+            MeshOptimizer::VertexCacheStats vertexCacheStats;       ///< Simulated post-transform vertex cache statistics for all indexed meshes. Only computed with SceneBuilder::Flags::OptimizeVertexLocality.
 
             // Curve data
             std::vector<CurveDesc> curveDesc;                       ///< List of curve descriptors.
@@ -362,6 +369,9 @@ namespace Falcor
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
+            uint64_t vertexCacheMissCount = 0;          ///< Number of simulated post-transform vertex cache misses when drawing all unique indexed triangles once. Zero unless built with SceneBuilder::Flags::OptimizeVertexLocality.
+            double vertexCacheACMR = 0.0;               ///< Average cache miss ratio, i.e., vertex cache misses per triangle.
+            double vertexCacheATVR = 0.0;               ///< Average transformed vertex ratio, i.e., vertex cache misses per referenced vertex.
 
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
@@ -698,6 +708,14 @@ namespace Falcor
         */
         const CurveDesc& getCurve(CurveID curveID) const { return mCurveDesc[curveID.get()]; }
 
+        /** Update the vertices of a curve.
+            Only the segment AABBs of updated curves are regenerated and uploaded on the next scene update.
+            Curves driven by animated vertex caches are overwritten by the animation.
+            \param[in] curveID Curve ID.
+            \param[in] vertices Vertex data. Must have the vertex count of the curve.
+        */
+        void updateCurveVertices(CurveID curveID, const std::vector<StaticCurveVertexData>& vertices);
+
         /** Returns what SDF grid implementation is used for this scene.
         */
         SDFGrid::Type getSDFGridImplementation() const { return mSDFGridConfig.implementation; }
@@ -750,9 +768,20 @@ namespace Falcor
         */
         void updateNodeTransform(uint32_t nodeID, const rmcv::mat4& transform);
 
-        /** Get the number of custom primitives.
+        /** Get the number of custom primitives that have not been removed.
+        */
+        uint32_t getCustomPrimitiveCount() const { return getCustomPrimitiveSlotCount() - mRemovedCustomPrimitiveCount; }
+
+        /** Get the number of custom primitive slots.
+            Valid custom primitive indices are in [0, getCustomPrimitiveSlotCount()). This includes slots of removed primitives
+            that have not been reused yet, see isCustomPrimitiveActive().
+        */
+        uint32_t getCustomPrimitiveSlotCount() const { return (uint32_t)mCustomPrimitiveDesc.size(); }
+
+        /** Check if a custom primitive slot holds a primitive, i.e., it has not been removed.
+            \param[in] index Index of the custom primitive.
         */
-        uint32_t getCustomPrimitiveCount() const { return (uint32_t)mCustomPrimitiveDesc.size(); }
+        bool isCustomPrimitiveActive(uint32_t index) const;
 
         /** Get the custom primitive index for a geometry.
             \param[in] geometryID Global geometry ID.
@@ -771,32 +800,34 @@ namespace Falcor
         const AABB& getCustomPrimitiveAABB(uint32_t index) const;
 
         /** Add a custom primitive.
-            Custom primitives are sequentially numbered in the scene. The function returns the index at
-            which the primitive was inserted. Note that this index may change if primitives are removed.
-            Adding/removing custom primitives is a slow operation as the acceleration structure is rebuilt.
-            \param[in] userID User ID of primitive.
+            The returned index is a stable handle that stays valid until the primitive is removed.
+            Slots of removed primitives are reused before new slots are appended, lowest index first. Reusing a slot only updates
+            the acceleration structure, while appending a slot is a slow operation as the acceleration structure is rebuilt.
+            \param[in] userID User ID of primitive. Must not be CustomPrimitiveDesc::kInvalidUserID.
             \param[in] aabb AABB of the primitive.
             \return Index of the custom primitive that was added.
         */
         uint32_t addCustomPrimitive(uint32_t userID, const AABB& aabb);
 
         /** Remove a custom primitive.
-            Custom primitives are sequentially numbered in the scene. The function removes the primitive at
-            the given index. Note that the index of subsequent primtives will change.
-            Adding/removing custom primitives is a slow operation as the acceleration structure is rebuilt.
+            The indices of other primitives do not change. The slot of the removed primitive keeps a degenerate AABB
+            and the user ID CustomPrimitiveDesc::kInvalidUserID until it is reused by a later call to addCustomPrimitive().
+            Removed slots at the end are released once they make up a quarter of all slots, which rebuilds the acceleration structure.
             \param[in] index Index of custom primitive to remove.
         */
         void removeCustomPrimitive(uint32_t index) { removeCustomPrimitives(index, index + 1); }
 
         /** Remove a range [first,last) of custom primitives.
             Note that the last index is non-inclusive. If first == last no action is performed.
+            Slots in the range that have already been removed are ignored.
             \param[in] first Index of first custom primitive to remove.
             \param[in] last Index one past the last custom primitive to remove.
         */
         void removeCustomPrimitives(uint32_t first, uint32_t last);
 
         /** Update a custom primitive.
-            \param[in] index Index of the custom primitive.
+            Only the AABBs of updated primitives are regenerated and uploaded on the next scene update.
+            \param[in] index Index of the custom primitive. Throws if the primitive has been removed.
             \param[in] aabb AABB of the primitive.
         */
         void updateCustomPrimitive(uint32_t index, const AABB& aabb);
@@ -941,6 +972,29 @@ namespace Falcor
         */
         void rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW);
 
+        /** Render the instances overlapping a view frustum using the rasterizer.
+            Instances are culled on the CPU against their world-space bounds and instances sharing a mesh are merged into instanced draws.
+            Instances of skinned or vertex animated meshes are never culled.
+            Note the rasterizer state bound to 'pState' is ignored.
+            \param[in] pContext Render context.
+            \param[in] pState Graphics state.
+            \param[in] pVars Graphics vars.
+            \param[in] frustum View frustum, e.g., created from the view-projection matrix of the camera used for rendering.
+            \param[in] cullMode Optional rasterizer cull mode. The default is to cull back-facing primitives.
+        */
+        void rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const Frustum& frustum, RasterizerState::CullMode cullMode = RasterizerState::CullMode::Back);
+
+        /** Render the instances overlapping a view frustum using the rasterizer.
+            This overload uses the supplied rasterizer states.
+            \param[in] pContext Render context.
+            \param[in] pState Graphics state.
+            \param[in] pVars Graphics vars.
+            \param[in] frustum View frustum.
+            \param[in] pRasterizerStateCW Rasterizer state for meshes with clockwise triangle winding.
+            \param[in] pRasterizerStateCCW Rasterizer state for meshes with counter-clockwise triangle winding. Can be the same as for clockwise.
+        */
+        void rasterize(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const Frustum& frustum, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW);
+
         /** Get the required raytracing maximum attribute size for this scene.
             Note: This depends on what types of geometry are used in the scene.
             \return Max attribute size in bytes.
@@ -1076,7 +1130,7 @@ namespace Falcor
         static constexpr uint32_t kDrawIdBufferIndex = kStaticDataBufferIndex + 1;
         static constexpr uint32_t kVertexBufferCount = kDrawIdBufferIndex + 1;
 
-        void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<SkinningVertexData>& skinningData);
+        void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<CompressedStaticVertexData>& compressedData, const std::vector<SkinningVertexData>& skinningData);
         void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
 
         Shader::DefineList getSceneSDFGridDefines() const;
@@ -1105,10 +1159,39 @@ namespace Falcor
         */
         void updateBounds();
 
+        /** Incrementally update the scene's global bounding box after the given instances moved.
+            \param[in] changedInstances Sorted list of geometry instance IDs.
+        */
+        void updateBounds(const std::vector<uint32_t>& changedInstances);
+
+        /** Compute the world space bounding box of a geometry instance.
+        */
+        AABB computeInstanceBounds(const GeometryInstanceData& instance) const;
+
         /** Update geometry instances.
         */
         void updateGeometryInstances(bool forceUpdate);
 
+        /** Update the given geometry instances and upload the modified ranges.
+            \param[in] changedInstances Sorted list of geometry instance IDs.
+        */
+        void updateGeometryInstances(const std::vector<uint32_t>& changedInstances);
+
+        /** Update the flags of a geometry instance based on its current transform.
+            \return True if the flags changed.
+        */
+        bool updateGeometryInstanceFlags(GeometryInstanceData& instance) const;
+
+        /** Build the reverse index from scene graph nodes to the geometry instances using their global matrix.
+        */
+        void buildNodeInstanceIndex();
+
+        /** Gather the geometry instances affected by a list of changed scene graph nodes.
+            \param[in] changedNodes List of changed nodes.
+            \param[out] changedInstances Sorted list of affected geometry instance IDs.
+        */
+        void gatherChangedInstances(const std::vector<NodeID>& changedNodes, std::vector<uint32_t>& changedInstances) const;
+
         /** Update geometry type flags.
         */
         void updateGeometryTypes();
@@ -1117,10 +1200,23 @@ namespace Falcor
         */
         void finalize();
 
-        /** Create the draw list for rasterization.
+        /** Create the instance BVH and draw keys for rasterization.
         */
         void createDrawList();
 
+        struct DrawList;
+
+        /** Returns the key used to merge triangle mesh instances into instanced draws.
+            Keys are grouped by draw segments (index format and winding) and ordered by mesh ID within a segment.
+        */
+        uint32_t getDrawKey(const GeometryInstanceData& instance) const;
+
+        /** Fill a draw list with instanced draws for a list of triangle mesh instances.
+        */
+        void updateDrawList(DrawList& drawList, const std::vector<uint32_t>& instanceIDs);
+
+        void rasterizeDrawList(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const DrawList& drawList, const RasterizerState::SharedPtr& pRasterizerStateCW, const RasterizerState::SharedPtr& pRasterizerStateCCW);
+
         /** Initialize geometry descs for each BLAS.
         */
         void initGeomDesc(RenderContext* pContext);
@@ -1129,7 +1225,7 @@ namespace Falcor
         */
         void preparePrebuildInfo(RenderContext* pContext);
 
-        /** Compute BLAS groups.
+        /** Compute BLAS groups and build batches using BlasBuildScheduler.
         */
         void computeBlasGroups();
 
@@ -1140,7 +1236,13 @@ namespace Falcor
         /** Generate data for creating a TLAS.
             #SCENE TODO: Add argument to build descs based off a draw list.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& instanceDescMatrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+
+        /** Update the transforms of the TLAS instance descs referenced by the given geometry instances.
+            Cached TLASes are updated with the modified instance descs on next use instead of being rebuilt from scratch.
+            \param[in] changedInstances Sorted list of geometry instance IDs.
+        */
+        void updateInstanceDescs(const std::vector<uint32_t>& changedInstances);
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1155,6 +1257,10 @@ namespace Falcor
         */
         bool hasIndexBuffer() const { return mpMeshVao && mpMeshVao->getIndexBuffer() != nullptr; }
 
+        /** Returns true if the mesh vertices are stored in compressed format (see CompressedStaticVertexData).
+        */
+        bool hasCompressedVertices() const { return mHasCompressedVertices; }
+
         /** Initialize all cameras in the scene through the animation controller using their corresponding scene graph nodes.
         */
         void initializeCameras();
@@ -1175,6 +1281,9 @@ namespace Falcor
         UpdateFlags updateGeometry(bool forceUpdate);
         UpdateFlags updateProceduralPrimitives(bool forceUpdate);
         UpdateFlags updateRaytracingAABBData(bool forceUpdate);
+        void markCustomPrimitiveDirty(uint32_t index);
+        void trimCustomPrimitiveSlots();
+        void markCurveDirty(uint32_t curveID);
         UpdateFlags updateDisplacement(bool forceUpdate);
         UpdateFlags updateSDFGrids(RenderContext* pRenderContext);
 
@@ -1192,23 +1301,49 @@ namespace Falcor
         struct DrawArgs
         {
             Buffer::SharedPtr pBuffer;      ///< Buffer holding the draw-indirect arguments.
+            uint64_t offset = 0;            ///< Byte offset of the arguments of the first draw in the buffer.
             uint32_t count = 0;             ///< Number of draws.
             bool ccw = true;                ///< True if counterclockwise triangle winding.
             ResourceFormat ibFormat = ResourceFormat::Unknown;  ///< Index buffer format.
         };
 
+        struct DrawList
+        {
+            std::vector<DrawArgs> draws;            ///< Draws grouped by index format and winding.
+            Buffer::SharedPtr pArgBuffer;           ///< Draw-indirect arguments of all draws, sized for one draw per instance.
+            Buffer::SharedPtr pInstanceIDBuffer;    ///< Geometry instance IDs in draw order, read through the draw ID vertex attribute.
+            Vao::SharedPtr pVao;                    ///< VAO using pInstanceIDBuffer as draw ID buffer, for 32-bit indices.
+            Vao::SharedPtr pVao16Bit;               ///< VAO using pInstanceIDBuffer as draw ID buffer, for 16-bit indices.
+        };
+
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
 
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
+        std::vector<uint32_t> mNodeInstanceOffsets;                 ///< Offset into mNodeInstanceIDs per scene graph node. Has one extra entry at the end.
+        std::vector<uint32_t> mNodeInstanceIDs;                     ///< Geometry instance IDs grouped by the node providing their global matrix.
+        std::vector<uint32_t> mChangedInstances;                    ///< Geometry instances that moved this frame, sorted by ID.
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
         bool mHas32BitIndices = false;                              ///< True if any meshes use 32-bit indices.
+        bool mHasCompressedVertices = false;                        ///< True if mesh vertices are stored in compressed format.
+        std::vector<VertexQuantization> mVertexQuantization;        ///< Quantization frame per mesh for compressed vertices.
+        Buffer::SharedPtr mpVertexQuantizationBuffer;               ///< GPU buffer holding mVertexQuantization.
+        MeshOptimizer::VertexCacheStats mVertexCacheStats;          ///< Simulated post-transform vertex cache statistics computed by the scene builder.
 
         Vao::SharedPtr mpMeshVao;                                   ///< Vertex array object for the global mesh vertex/index buffers.
         Vao::SharedPtr mpMeshVao16Bit;                              ///< VAO for drawing meshes with 16-bit vertex indices.
         Vao::SharedPtr mpCurveVao;                                  ///< Vertex array object for the global curve vertex/index buffers.
-        std::vector<DrawArgs> mDrawArgs;                            ///< List of draw arguments for rasterizing the meshes in the scene.
+        std::vector<uint32_t> mMeshInstanceIDs;                     ///< IDs of all triangle mesh instances drawn by the rasterizer.
+        std::vector<uint32_t> mUnculledMeshInstanceIDs;             ///< IDs of triangle mesh instances with dynamic meshes, which are excluded from culling.
+        InstanceBVH mInstanceBVH;                                   ///< BVH over the world-space bounds of the static triangle mesh instances.
+        InstanceBatcher mInstanceBatcher;                           ///< Groups instances by draw key into instanced draws.
+        DrawList mDrawList;                                         ///< Draw list of all triangle mesh instances.
+        DrawList mCulledDrawList;                                   ///< Draw list of the instances overlapping the last culled view.
+        bool mDrawListDirty = true;                                 ///< True if mDrawList needs to be updated, e.g., after instance winding flipped.
+        std::vector<uint32_t> mVisibleMeshInstanceIDs;              ///< Scratch list of the instances overlapping a view.
+        std::vector<uint32_t> mSortedMeshInstanceIDs;               ///< Scratch list of instances sorted by draw key.
+        std::vector<InstanceBatcher::Batch> mDrawBatches;           ///< Scratch list of instanced draws.
 
         // Triangle meshes
         std::vector<MeshDesc> mMeshDesc;                            ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
@@ -1244,8 +1379,16 @@ namespace Falcor
         std::vector<CustomPrimitiveDesc> mCustomPrimitiveDesc;      ///< Copy of custom primitive data GPU buffer (mpCustomPrimitivesBuffer).
         std::vector<AABB> mCustomPrimitiveAABBs;                    ///< User-defined custom primitive AABBs.
         uint32_t mCustomPrimitiveAABBOffset = 0;                    ///< Offset of custom primitive AABBs in global AABB list.
-        bool mCustomPrimitivesMoved = false;                        ///< Flag indicating that custom primitives were moved since last frame.
-        bool mCustomPrimitivesChanged = false;                      ///< Flag indicating that custom primitives were added/removed since last frame.
+        std::vector<bool> mCustomPrimitiveActive;                   ///< Per-slot flag indicating that the custom primitive has not been removed.
+        std::vector<uint32_t> mCustomPrimitiveFreeList;             ///< Min-heap of slots of removed custom primitives available for reuse. May contain stale entries of slots that have been reused or released.
+        uint32_t mRemovedCustomPrimitiveCount = 0;                  ///< Number of slots of removed custom primitives.
+        std::vector<bool> mCustomPrimitiveDirty;                    ///< Per-slot flag indicating that the AABB and descriptor need to be uploaded.
+        std::vector<uint32_t> mDirtyCustomPrimitives;               ///< List of slots flagged in mCustomPrimitiveDirty.
+        bool mCustomPrimitivesChanged = false;                      ///< Flag indicating that the number of custom primitive slots changed since last frame.
+
+        std::vector<uint32_t> mCurveAABBOffsets;                    ///< Offset of the segment AABBs of each curve in global AABB list.
+        std::vector<bool> mCurveAABBsDirty;                         ///< Per-curve flag indicating that the segment AABBs need to be regenerated.
+        std::vector<uint32_t> mDirtyCurves;                         ///< List of curves flagged in mCurveAABBsDirty.
 
         // The following array and buffer records the AABBs of all procedural primitives, including custom primitives, curves, etc.
         std::vector<RtAABB> mRtAABBRaw;                             ///< Raw AABB data (min, max) for all procedural primitives.
@@ -1272,6 +1415,7 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        std::vector<AABB> mGeometryInstanceBBs;                     ///< Bounding boxes of geometry instances in world space.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
@@ -1286,6 +1430,9 @@ namespace Falcor
         Buffer::SharedPtr mpLightsBuffer;
         Buffer::SharedPtr mpGridVolumesBuffer;
         ParameterBlock::SharedPtr mpSceneBlock;
+        ShaderVarPath mLightCountPath = ShaderVarPath("lightCount");            ///< Precompiled paths to scene block parameters updated per frame.
+        ShaderVarPath mGridsPath = ShaderVarPath("grids");
+        ShaderVarPath mGridVolumeCountPath = ShaderVarPath("gridVolumeCount");
 
         // Camera
         UpDirection mUpDirection = UpDirection::YPos;
@@ -1322,6 +1469,9 @@ namespace Falcor
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
         std::vector<RtInstanceDesc> mInstanceDescs; ///< Shared between TLAS builds to avoid reallocating CPU memory.
+        std::vector<uint32_t> mInstanceDescMatrixIDs; ///< Global matrix ID per instance desc, or invalid for instance descs with identity transform.
+        bool mInstanceDescsValid = false;           ///< True if mInstanceDescs is up-to-date for mInstanceDescsRayTypeCount.
+        uint32_t mInstanceDescsRayTypeCount = 0;    ///< Ray type count mInstanceDescs was generated for.
 
         struct TlasData
         {
@@ -1329,6 +1479,7 @@ namespace Falcor
             Buffer::SharedPtr pTlasBuffer;
             Buffer::SharedPtr pInstanceDescs;               ///< Buffer holding instance descs for the TLAS.
             UpdateMode updateMode = UpdateMode::Rebuild;    ///< Update mode this TLAS was created with.
+            std::vector<uint32_t> dirtyInstanceDescs;       ///< Instance descs that changed since the TLAS was last built.
         };
 
         std::unordered_map<uint32_t, TlasData> mTlasCache;  ///< Top Level Acceleration Structure for scene data cached per shader ray type count.
@@ -1345,6 +1496,7 @@ namespace Falcor
             std::vector<RtGeometryDesc> geomDescs;
 
             uint32_t blasGroupIndex = 0;                    ///< Index of the BLAS group that contains this BLAS.
+            uint32_t buildBatchIndex = 0;                   ///< Index of the build batch within the BLAS group. Builds in the same batch use disjoint scratch memory.
 
             uint64_t resultByteSize = 0;                    ///< Maximum result data size for the BLAS build, including padding.
             uint64_t resultByteOffset = 0;                  ///< Offset into the BLAS result buffer.
@@ -1385,6 +1537,7 @@ namespace Falcor
         std::vector<BlasGroup> mBlasGroups;                 ///< BLAS group data.
         Buffer::SharedPtr mpBlasScratch;                    ///< Scratch buffer used for BLAS builds.
         Buffer::SharedPtr mpBlasStaticWorldMatrices;        ///< Object-to-world transform matrices in row-major format. Only valid for static meshes.
+        Buffer::SharedPtr mpBlasVertexTransforms;           ///< Per-mesh transforms dequantizing compressed vertex positions in row-major format. Includes the object-to-world transform for static meshes.
         bool mBlasDataValid = false;                        ///< Flag to indicate if the BLAS data is valid. This will be reset when geometry is changed.
         bool mRebuildBlas = true;                           ///< Flag to indicate BLASes need to be rebuilt.
 
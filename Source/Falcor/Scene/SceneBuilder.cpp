@@ -28,6 +28,7 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshOptimizer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
@@ -37,21 +38,59 @@
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include <mikktspace.h>
+#include <array>
 #include <filesystem>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
 
 namespace Falcor
 {
     namespace
     {
-        // Large mesh groups are split in order to reduce the size of the largest BLAS.
-        // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
-        const size_t kMaxTrianglesPerBLAS = 1ull << 24;
+        // Large mesh groups are split in order to reduce the size of the largest BLAS (see SceneBuilder::MeshGroupBudget).
+        // With the SAH strategy, meshes are binned by centroid. Whole-mesh partitions where the two sides overlap by more
+        // than the given fraction of the group volume are rejected in favor of cutting meshes at the spatial midpoint.
+        const uint32_t kSAHBinCount = 16;
+        const float kMaxSAHOverlapFraction = 0.1f;
 
         // Texture coordinates for textured emissive materials are quantized for performance reasons.
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        /** Computes the quantization frame for compressed vertices of a mesh from the bounds of its vertex data.
+            Zero extents are replaced by one to keep the quantization invertible.
+        */
+        VertexQuantization computeVertexQuantization(const std::vector<StaticVertexData>& vertices)
+        {
+            float3 minPos(std::numeric_limits<float>::infinity());
+            float3 maxPos(-std::numeric_limits<float>::infinity());
+            float2 minTexCrd(std::numeric_limits<float>::infinity());
+            float2 maxTexCrd(-std::numeric_limits<float>::infinity());
+            for (const auto& v : vertices)
+            {
+                minPos = min(minPos, v.position);
+                maxPos = max(maxPos, v.position);
+                minTexCrd = min(minTexCrd, v.texCrd);
+                maxTexCrd = max(maxTexCrd, v.texCrd);
+            }
+
+            VertexQuantization q = {};
+            q.positionOffset = (minPos + maxPos) * 0.5f;
+            q.positionScale = (maxPos - minPos) * 0.5f;
+            q.texCrdOffset = minTexCrd;
+            q.texCrdScale = maxTexCrd - minTexCrd;
+            for (int i = 0; i < 3; i++) if (!(q.positionScale[i] > 0.f)) q.positionScale[i] = 1.f;
+            for (int i = 0; i < 2; i++) if (!(q.texCrdScale[i] > 0.f)) q.texCrdScale[i] = 1.f;
+            return q;
+        }
+
+        float angleBetween(const float3& a, const float3& b)
+        {
+            return std::acos(std::clamp(dot(a, b) / std::sqrt(dot(a, a) * dot(b, b)), -1.f, 1.f));
+        }
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -59,6 +98,178 @@ namespace Falcor
             else return 2;
         }
 
+        /** Returns the fraction of the parent volume that is covered by both child boxes.
+            The extents are padded relative to the parent size to give meaningful results for flat geometry.
+        */
+        float calcOverlapFraction(const AABB& parent, const AABB& left, const AABB& right)
+        {
+            AABB overlap = left & right;
+            if (!overlap.valid()) return 0.f;
+
+            float3 extent = parent.extent();
+            float3 padding = float3(1e-3f * std::max(extent.x, std::max(extent.y, extent.z)));
+            float3 overlapExtent = overlap.extent() + padding;
+            float3 parentExtent = extent + padding;
+            return (overlapExtent.x * overlapExtent.y * overlapExtent.z) / (parentExtent.x * parentExtent.y * parentExtent.z);
+        }
+
+        /** Best whole-mesh partition of a list of meshes found by the binned SAH.
+        */
+        struct SAHSplit
+        {
+            int axis = -1;                  ///< Split axis, or -1 if there is no partition with meshes on both sides.
+            AABB leftBounds;
+            AABB rightBounds;
+            std::vector<uint32_t> left;     ///< Indices of the meshes on the left side.
+            std::vector<uint32_t> right;    ///< Indices of the meshes on the right side.
+        };
+
+        /** Find the whole-mesh partition minimizing the SAH cost, with meshes binned by their centroids along each axis.
+            \param[in] items List of meshes.
+            \param[in] indices Indices of the meshes to partition.
+        */
+        SAHSplit findSAHSplit(const std::vector<SceneBuilder::MeshGroupPartitionItem>& items, const std::vector<uint32_t>& indices)
+        {
+            AABB centroidBounds;
+            for (uint32_t i : indices) centroidBounds.include(items[i].bounds.center());
+            const float3 centroidExtent = centroidBounds.extent();
+
+            auto getBinIndex = [&](uint32_t i, int axis)
+            {
+                float t = (items[i].bounds.center()[axis] - centroidBounds.minPoint[axis]) / centroidExtent[axis];
+                return std::min((uint32_t)(t * kSAHBinCount), kSAHBinCount - 1);
+            };
+
+            struct Bin
+            {
+                AABB bounds;
+                size_t triangleCount = 0;
+                size_t meshCount = 0;
+
+                void include(const Bin& other)
+                {
+                    bounds.include(other.bounds);
+                    triangleCount += other.triangleCount;
+                    meshCount += other.meshCount;
+                }
+            };
+
+            SAHSplit split;
+            float bestCost = std::numeric_limits<float>::infinity();
+            uint32_t bestBin = 0;
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (!(centroidExtent[axis] > 0.f)) continue;
+
+                std::array<Bin, kSAHBinCount> bins;
+                for (uint32_t i : indices)
+                {
+                    Bin& bin = bins[getBinIndex(i, axis)];
+                    bin.bounds.include(items[i].bounds);
+                    bin.triangleCount += items[i].triangleCount;
+                    bin.meshCount++;
+                }
+
+                // Accumulate the right side of each split from the right.
+                std::array<Bin, kSAHBinCount> rightBins;
+                Bin right;
+                for (uint32_t i = kSAHBinCount - 1; i > 0; i--)
+                {
+                    right.include(bins[i]);
+                    rightBins[i] = right;
+                }
+
+                // Evaluate the cost of splitting between bins i - 1 and i.
+                Bin left;
+                for (uint32_t i = 1; i < kSAHBinCount; i++)
+                {
+                    left.include(bins[i - 1]);
+                    if (left.meshCount == 0 || rightBins[i].meshCount == 0) continue;
+
+                    float cost = left.bounds.area() * (float)left.triangleCount + rightBins[i].bounds.area() * (float)rightBins[i].triangleCount;
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestBin = i;
+                        split.axis = axis;
+                        split.leftBounds = left.bounds;
+                        split.rightBounds = rightBins[i].bounds;
+                    }
+                }
+            }
+
+            if (split.axis >= 0)
+            {
+                for (uint32_t i : indices)
+                {
+                    if (getBinIndex(i, split.axis) < bestBin) split.left.push_back(i);
+                    else split.right.push_back(i);
+                }
+            }
+            return split;
+        }
+
+        bool exceedsMeshGroupBudget(const std::vector<SceneBuilder::MeshGroupPartitionItem>& items, const std::vector<uint32_t>& indices, const SceneBuilder::MeshGroupBudget& budget)
+        {
+            size_t triangleCount = 0;
+            size_t byteSize = 0;
+            for (uint32_t i : indices)
+            {
+                triangleCount += items[i].triangleCount;
+                byteSize += items[i].byteSize;
+            }
+            return triangleCount > budget.maxTriangleCount || (budget.maxMemoryInBytes > 0 && byteSize > budget.maxMemoryInBytes);
+        }
+
+        void partitionMeshesSAHRecursive(std::vector<SceneBuilder::MeshGroupPartitionItem>& items, std::vector<uint32_t> indices, const SceneBuilder::MeshGroupBudget& budget, const SceneBuilder::MeshGroupCutFunc& cut, std::vector<std::vector<uint32_t>>& groups)
+        {
+            if (!exceedsMeshGroupBudget(items, indices, budget))
+            {
+                groups.push_back(std::move(indices));
+                return;
+            }
+
+            // Find the best whole-mesh partition.
+            AABB bounds;
+            for (uint32_t i : indices) bounds.include(items[i].bounds);
+            SAHSplit split = findSAHSplit(items, indices);
+
+            std::vector<uint32_t> left, right;
+            if (cut && (split.axis < 0 || calcOverlapFraction(bounds, split.leftBounds, split.rightBounds) > kMaxSAHOverlapFraction))
+            {
+                // Cut meshes straddling the midpoint of the largest axis.
+                const int axis = largestAxis(bounds.extent());
+                cut(indices, axis, bounds.center()[axis], left, right);
+            }
+
+            // If either side contains all meshes, no mesh was cut. Fall back on the whole-mesh partition if there is one.
+            if (left.empty() || right.empty())
+            {
+                if (split.axis >= 0)
+                {
+                    left = std::move(split.left);
+                    right = std::move(split.right);
+                }
+                else if (indices.size() > 1)
+                {
+                    // All mesh centroids coincide and no mesh could be cut, split the list in half.
+                    auto splitIter = indices.begin() + indices.size() / 2;
+                    left.assign(indices.begin(), splitIter);
+                    right.assign(splitIter, indices.end());
+                }
+                else
+                {
+                    logWarning("Mesh group with {} triangles cannot be split, expect extraneous GPU memory usage.", items[indices[0]].triangleCount);
+                    groups.push_back(std::move(indices));
+                    return;
+                }
+            }
+
+            partitionMeshesSAHRecursive(items, std::move(left), budget, cut, groups);
+            partitionMeshesSAHRecursive(items, std::move(right), budget, cut, groups);
+        }
+
         class MikkTSpaceWrapper
         {
         public:
@@ -191,7 +402,7 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::UseTextureCache));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -199,6 +410,93 @@ namespace Falcor
             return sha1.finalize();
 
         }
+
+        bool doesAnimationTargetNode(const Animation& animation, NodeID nodeID)
+        {
+            if (animation.getNodeID() == nodeID) return true;
+            const auto& instanceNodeIDs = animation.getInstanceNodeIDs();
+            return std::find(instanceNodeIDs.begin(), instanceNodeIDs.end(), nodeID) != instanceNodeIDs.end();
+        }
+
+        /** Nodes that are created for each instance of a prototype.
+            Static prototype nodes are folded into the closest ancestor that is animated (or the instance root),
+            and are only created if they carry objects or are on the path to an animated node.
+        */
+        struct PrototypeLayout
+        {
+            std::vector<SceneBuilder::Node> nodes;  ///< Nodes created per instance. Parents index this list, invalid parents refer to the instance root.
+            std::vector<NodeID> nodeMap;            ///< Per prototype node, index into nodes of the node holding its objects, invalid for the instance root.
+            std::vector<std::pair<NodeID, Animation::SharedPtr>> animations; ///< Animations and their prototype-local target nodes.
+        };
+
+        PrototypeLayout createPrototypeLayout(const SceneBuilder::Prototype& prototype)
+        {
+            const rmcv::mat4 identity = rmcv::identity<rmcv::mat4>();
+            const size_t nodeCount = prototype.nodes.size();
+
+            PrototypeLayout layout;
+            layout.nodeMap.resize(nodeCount, NodeID::Invalid());
+
+            // Animated nodes and bones keep their own transforms, all other nodes can be folded.
+            std::vector<bool> pinned(nodeCount, false);
+            for (const auto& pAnimation : prototype.animations)
+            {
+                layout.animations.emplace_back(pAnimation->getNodeID(), pAnimation);
+                pinned[pAnimation->getNodeID().get()] = true;
+            }
+            for (size_t i = 0; i < nodeCount; i++)
+            {
+                if (prototype.nodes[i].localToBindPose != identity) pinned[i] = true;
+            }
+
+            // Find the nodes that are required in every instance. Pinned nodes are always required and also require their parent.
+            std::vector<bool> required = pinned;
+            for (const auto& meshInstance : prototype.meshInstances) required[meshInstance.nodeID.get()] = true;
+            for (const auto& instance : prototype.prototypeInstances)
+            {
+                if (instance.parent.isValid()) required[instance.parent.get()] = true;
+            }
+            for (size_t i = nodeCount; i-- > 0;)
+            {
+                NodeID parent = prototype.nodes[i].parent;
+                if (pinned[i] && parent.isValid()) required[parent.get()] = true;
+            }
+
+            // Accumulate transforms relative to the closest pinned ancestor (the anchor).
+            std::vector<NodeID> anchors(nodeCount, NodeID::Invalid());
+            std::vector<rmcv::mat4> relativeTransforms(nodeCount, identity);
+            for (size_t i = 0; i < nodeCount; i++)
+            {
+                const auto& node = prototype.nodes[i];
+                NodeID parent = node.parent;
+                auto addNode = [&](const rmcv::mat4& transform, NodeID layoutParent)
+                {
+                    SceneBuilder::Node layoutNode = node;
+                    layoutNode.transform = transform;
+                    layoutNode.parent = layoutParent;
+                    layout.nodeMap[i] = NodeID{ layout.nodes.size() };
+                    layout.nodes.push_back(std::move(layoutNode));
+                };
+
+                if (pinned[i])
+                {
+                    anchors[i] = NodeID{ i };
+                    addNode(node.transform, parent.isValid() ? layout.nodeMap[parent.get()] : NodeID::Invalid());
+                    continue;
+                }
+
+                const bool parentIsAnchor = !parent.isValid() || pinned[parent.get()];
+                anchors[i] = parent.isValid() ? anchors[parent.get()] : NodeID::Invalid();
+                relativeTransforms[i] = parentIsAnchor ? node.transform : relativeTransforms[parent.get()] * node.transform;
+
+                if (!required[i]) continue;
+                NodeID anchorNode = anchors[i].isValid() ? layout.nodeMap[anchors[i].get()] : NodeID::Invalid();
+                if (relativeTransforms[i] == identity && node.meshBind == identity) layout.nodeMap[i] = anchorNode;
+                else addNode(relativeTransforms[i], anchorNode);
+            }
+
+            return layout;
+        }
     }
 
     SceneBuilder::SceneBuilder(Flags flags)
@@ -206,6 +504,11 @@ namespace Falcor
     {
         mpFence = GpuFence::create();
         mSceneData.pMaterials = MaterialSystem::create();
+
+        if (is_set(mFlags, Flags::UseTextureCache))
+        {
+            mSceneData.pMaterials->getTextureManager()->setTextureCache(TextureCache::create());
+        }
     }
 
     SceneBuilder::SharedPtr SceneBuilder::create(Flags flags)
@@ -239,7 +542,8 @@ namespace Falcor
         {
             try
             {
-                pBuilder->mpScene = Scene::create(SceneCache::readCache(pBuilder->mSceneCacheKey));
+                auto pTextureCache = pBuilder->mSceneData.pMaterials->getTextureManager()->getTextureCache();
+                pBuilder->mpScene = Scene::create(SceneCache::readCache(pBuilder->mSceneCacheKey, pTextureCache));
                 return pBuilder;
             }
             catch (const std::exception& e)
@@ -282,6 +586,11 @@ namespace Falcor
         // Post-process the scene data.
         TimeReport timeReport;
 
+        // Expand prototype instances and build the per node animation flags used by the scene graph passes.
+        flattenPrototypeInstances();
+        updateNodeAnimationFlags();
+        timeReport.measure("Expanding prototype instances");
+
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
         prepareDisplacementMaps();
@@ -296,6 +605,7 @@ namespace Falcor
         calculateMeshBoundingBoxes();
         createMeshGroups();
         optimizeGeometry();
+        optimizeVertexLocality();
         sortMeshes();
         createGlobalBuffers();
         createCurveGlobalBuffers();
@@ -698,6 +1008,10 @@ namespace Falcor
         {
             throw RuntimeError("Custom primitive count exceeds the maximum");
         }
+        if (userID == CustomPrimitiveDesc::kInvalidUserID)
+        {
+            throw ArgumentError("'userID' ({}) is reserved for removed custom primitives.", userID);
+        }
 
         CustomPrimitiveDesc desc = {};
         desc.userID = userID;
@@ -912,6 +1226,7 @@ namespace Falcor
     {
         checkArgument(pAnimation != nullptr, "'pAnimation' is missing");
         mSceneData.animations.push_back(pAnimation);
+        mNodeHasAnimation.clear();
     }
 
     Animation::SharedPtr SceneBuilder::createAnimation(Animatable::SharedPtr pAnimatable, const std::string& name, double duration)
@@ -1012,14 +1327,34 @@ namespace Falcor
     bool SceneBuilder::doesNodeHaveAnimation(NodeID nodeID) const
     {
         FALCOR_ASSERT(nodeID != NodeID::Invalid() && nodeID.get() < mSceneGraph.size());
+
+        // Nodes added after the flags were built are never animated, as adding an animation invalidates the flags.
+        if (!mNodeHasAnimation.empty()) return nodeID.get() < mNodeHasAnimation.size() && mNodeHasAnimation[nodeID.get()];
+
         for (const auto& pAnimation : mSceneData.animations)
         {
-            if (pAnimation->getNodeID() == nodeID) return true;
+            if (doesAnimationTargetNode(*pAnimation, nodeID)) return true;
         }
 
         return false;
     }
 
+    void SceneBuilder::updateNodeAnimationFlags()
+    {
+        // The scene graph passes query animations per node, which is quadratic without the flags.
+        mNodeHasAnimation.assign(mSceneGraph.size(), false);
+        auto setFlag = [this](NodeID nodeID)
+        {
+            if (nodeID.isValid() && nodeID.get() < mNodeHasAnimation.size()) mNodeHasAnimation[nodeID.get()] = true;
+        };
+
+        for (const auto& pAnimation : mSceneData.animations)
+        {
+            setFlag(pAnimation->getNodeID());
+            for (NodeID nodeID : pAnimation->getInstanceNodeIDs()) setFlag(nodeID);
+        }
+    }
+
     bool SceneBuilder::isNodeAnimated(NodeID nodeID) const
     {
         while (nodeID != NodeID::Invalid())
@@ -1039,7 +1374,7 @@ namespace Falcor
         {
             for (const auto& pAnimation : mSceneData.animations)
             {
-                if (pAnimation->getNodeID() == nodeID)
+                if (doesAnimationTargetNode(*pAnimation, nodeID))
                 {
                     pAnimation->setInterpolationMode(interpolationMode);
                     pAnimation->setEnableWarping(enableWarping);
@@ -1049,6 +1384,44 @@ namespace Falcor
         }
     }
 
+    PrototypeID SceneBuilder::addPrototype(const Prototype& prototype)
+    {
+        const size_t nodeCount = prototype.nodes.size();
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = prototype.nodes[i].parent;
+            checkArgument(!parent.isValid() || parent.get() < i, "Prototype '{}' node '{}' must be preceded by its parent", prototype.name, prototype.nodes[i].name);
+        }
+        for (const auto& meshInstance : prototype.meshInstances)
+        {
+            checkArgument(meshInstance.nodeID.isValid() && meshInstance.nodeID.get() < nodeCount, "Prototype '{}' mesh instance node ({}) is out of range", prototype.name, meshInstance.nodeID);
+            checkArgument(meshInstance.meshID.get() < mMeshes.size(), "Prototype '{}' mesh ({}) is out of range", prototype.name, meshInstance.meshID);
+        }
+        for (const auto& pAnimation : prototype.animations)
+        {
+            checkArgument(pAnimation != nullptr, "Prototype '{}' has a missing animation", prototype.name);
+            checkArgument(pAnimation->getNodeID().isValid() && pAnimation->getNodeID().get() < nodeCount, "Prototype '{}' animation '{}' node is out of range", prototype.name, pAnimation->getName());
+        }
+        for (const auto& instance : prototype.prototypeInstances)
+        {
+            checkArgument(instance.prototypeID.get() < mPrototypes.size(), "Prototype '{}' instance '{}' prototype ({}) is out of range", prototype.name, instance.name, instance.prototypeID);
+            checkArgument(!instance.parent.isValid() || instance.parent.get() < nodeCount, "Prototype '{}' instance '{}' parent is out of range", prototype.name, instance.name);
+        }
+
+        PrototypeID prototypeID{ mPrototypes.size() };
+        mPrototypes.push_back(prototype);
+        return prototypeID;
+    }
+
+    NodeID SceneBuilder::addPrototypeInstance(PrototypeID prototypeID, const Node& rootNode)
+    {
+        checkArgument(prototypeID.get() < mPrototypes.size(), "'prototypeID' ({}) is out of range", prototypeID);
+
+        NodeID rootNodeID = addNode(rootNode);
+        mPrototypeInstances.push_back({ prototypeID, rootNodeID });
+        return rootNodeID;
+    }
+
     // Internal
 
     void SceneBuilder::updateLinkedObjects(NodeID nodeID, NodeID newNodeID)
@@ -1198,6 +1571,76 @@ namespace Falcor
         return true;
     }
 
+    void SceneBuilder::flattenPrototypeInstances()
+    {
+        // This function expands all prototype instances into the scene graph.
+        // The node layout of each prototype is computed once and replicated per instance.
+        // Animations are shared, the first instance binds the animation node and all other instances are added as instance nodes.
+        if (mPrototypeInstances.empty()) return;
+
+        std::vector<PrototypeLayout> layouts;
+        layouts.reserve(mPrototypes.size());
+        for (const auto& prototype : mPrototypes) layouts.push_back(createPrototypeLayout(prototype));
+
+        std::unordered_set<const Animation*> boundAnimations;
+        auto bindAnimation = [&](const Animation::SharedPtr& pAnimation, NodeID nodeID)
+        {
+            if (boundAnimations.insert(pAnimation.get()).second)
+            {
+                pAnimation->setNodeID(nodeID);
+                addAnimation(pAnimation);
+            }
+            else
+            {
+                pAnimation->addInstanceNodeID(nodeID);
+            }
+        };
+
+        const size_t initialNodeCount = mSceneGraph.size();
+        std::vector<PrototypeInstanceSpec> stack;
+        std::vector<NodeID> nodeIDs;
+
+        for (const auto& rootInstance : mPrototypeInstances)
+        {
+            stack.push_back(rootInstance);
+            while (!stack.empty())
+            {
+                const PrototypeInstanceSpec instance = stack.back();
+                stack.pop_back();
+
+                const auto& prototype = mPrototypes[instance.prototypeID.get()];
+                const auto& layout = layouts[instance.prototypeID.get()];
+                auto getNodeID = [&](NodeID layoutNodeID) { return layoutNodeID.isValid() ? nodeIDs[layoutNodeID.get()] : instance.rootNodeID; };
+                auto getLocalNodeID = [&](NodeID localNodeID) { return getNodeID(localNodeID.isValid() ? layout.nodeMap[localNodeID.get()] : NodeID::Invalid()); };
+
+                // Node names are prefixed with the instance name to keep them unique per instance.
+                const std::string namePrefix = mSceneGraph[instance.rootNodeID.get()].name + "/";
+                nodeIDs.resize(layout.nodes.size());
+                for (size_t i = 0; i < layout.nodes.size(); i++)
+                {
+                    Node node = layout.nodes[i];
+                    node.name = namePrefix + node.name;
+                    node.parent = getNodeID(node.parent);
+                    nodeIDs[i] = addNode(node);
+                }
+
+                for (const auto& [localNodeID, pAnimation] : layout.animations) bindAnimation(pAnimation, getLocalNodeID(localNodeID));
+                for (const auto& meshInstance : prototype.meshInstances) addMeshInstance(getLocalNodeID(meshInstance.nodeID), meshInstance.meshID);
+
+                // Nested instances are pushed in reverse to be expanded in order.
+                for (auto it = prototype.prototypeInstances.rbegin(); it != prototype.prototypeInstances.rend(); ++it)
+                {
+                    NodeID nestedRootID = addNode(Node{ it->name, it->transform, rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), getLocalNodeID(it->parent) });
+                    if (it->pAnimation) bindAnimation(it->pAnimation, nestedRootID);
+                    stack.push_back({ it->prototypeID, nestedRootID });
+                }
+            }
+        }
+
+        logInfo("Expanded {} prototype instances of {} prototypes into {} scene graph nodes.", mPrototypeInstances.size(), mPrototypes.size(), mSceneGraph.size() - initialNodeCount);
+        mPrototypeInstances.clear();
+    }
+
     void SceneBuilder::prepareDisplacementMaps()
     {
         for (const auto& pMaterial : mSceneData.pMaterials->getMaterials())
@@ -1996,6 +2439,12 @@ namespace Falcor
         throw RuntimeError("SceneBuilder::splitNonIndexedMesh() not implemented");
     }
 
+    void SceneBuilder::setMeshGroupBudget(const MeshGroupBudget& budget)
+    {
+        checkArgument(budget.maxTriangleCount > 0, "'maxTriangleCount' must be larger than zero.");
+        mMeshGroupBudget = budget;
+    }
+
     size_t SceneBuilder::countTriangles(const MeshGroup& meshGroup) const
     {
         size_t triangleCount = 0;
@@ -2006,6 +2455,22 @@ namespace Falcor
         return triangleCount;
     }
 
+    size_t SceneBuilder::calculateMemoryUsage(MeshID meshID) const
+    {
+        const auto& mesh = mMeshes[meshID.get()];
+        return mesh.vertexCount * sizeof(PackedStaticVertexData) + mesh.indexCount * (mesh.use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+    }
+
+    size_t SceneBuilder::calculateMemoryUsage(const MeshGroup& meshGroup) const
+    {
+        size_t byteSize = 0;
+        for (auto meshID : meshGroup.meshList)
+        {
+            byteSize += calculateMemoryUsage(meshID);
+        }
+        return byteSize;
+    }
+
     AABB SceneBuilder::calculateBoundingBox(const MeshGroup& meshGroup) const
     {
         AABB bb;
@@ -2033,14 +2498,14 @@ namespace Falcor
 
         triangleCount = countTriangles(meshGroup);
 
-        if (triangleCount <= kMaxTrianglesPerBLAS)
+        if (!exceedsBudget(meshGroup))
         {
             return false;
         }
         else if (meshGroup.meshList.size() == 1)
         {
-            // Issue warning if single mesh exceeds the triangle count limit.
-            // TODO: Implement mesh splitting to handle this case.
+            // Issue warning if single mesh exceeds the budget.
+            // Use the SAH strategy (SceneBuilder::Flags::UseSAHMeshGroupSplit) to split the mesh itself.
             const auto& mesh = mMeshes[meshGroup.meshList[0].get()];
             FALCOR_ASSERT(mesh.getTriangleCount() == triangleCount);
             logWarning("Mesh '{}' has {} triangles, expect extraneous GPU memory usage.", mesh.name, triangleCount);
@@ -2048,11 +2513,24 @@ namespace Falcor
             return false;
         }
         FALCOR_ASSERT(meshGroup.meshList.size() > 1);
-        FALCOR_ASSERT(triangleCount > kMaxTrianglesPerBLAS);
 
         return true;
     }
 
+    bool SceneBuilder::exceedsBudget(const MeshGroup& meshGroup) const
+    {
+        if (countTriangles(meshGroup) > mMeshGroupBudget.maxTriangleCount) return true;
+        if (mMeshGroupBudget.maxMemoryInBytes > 0 && calculateMemoryUsage(meshGroup) > mMeshGroupBudget.maxMemoryInBytes) return true;
+        return false;
+    }
+
+    bool SceneBuilder::canSplitMesh(MeshID meshID) const
+    {
+        // This matches the meshes supported by splitMesh().
+        const auto& mesh = mMeshes[meshID.get()];
+        return !mesh.isDynamic() && mesh.topology == Vao::Topology::TriangleList && mesh.indexCount > 0;
+    }
+
     SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroupSimple(MeshGroup& meshGroup) const
     {
         // This function partitions a mesh group into smaller groups based on triangle count.
@@ -2065,7 +2543,11 @@ namespace Falcor
 
         // Each new group holds at least one mesh, or if multiple, up to the target number of triangles.
         FALCOR_ASSERT(triangleCount > 0);
-        size_t targetGroupCount = div_round_up(triangleCount, kMaxTrianglesPerBLAS);
+        size_t targetGroupCount = div_round_up(triangleCount, mMeshGroupBudget.maxTriangleCount);
+        if (mMeshGroupBudget.maxMemoryInBytes > 0)
+        {
+            targetGroupCount = std::max(targetGroupCount, div_round_up(calculateMemoryUsage(meshGroup), mMeshGroupBudget.maxMemoryInBytes));
+        }
         size_t targetTrianglesPerGroup = triangleCount / targetGroupCount;
 
         triangleCount = 0;
@@ -2190,6 +2672,70 @@ namespace Falcor
         return leftList;
     }
 
+    SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroupSAH(MeshGroup& meshGroup)
+    {
+        // This function partitions a mesh group into smaller groups using a binned surface area heuristic (SAH)
+        // over the mesh bounds, weighted by triangle count. See partitionMeshesSAH() for details.
+        // Meshes are only cut if the best whole-mesh partition has a large spatial overlap.
+
+        // Early out if splitting is not needed or possible. Groups with dynamic meshes are not supported.
+        FALCOR_ASSERT(!meshGroup.meshList.empty());
+        for (auto meshID : meshGroup.meshList)
+        {
+            if (mMeshes[meshID.get()].isDynamic()) return MeshGroupList{ std::move(meshGroup) };
+        }
+        if (!exceedsBudget(meshGroup)) return MeshGroupList{ std::move(meshGroup) };
+
+        std::vector<MeshGroupPartitionItem> items;
+        std::vector<MeshID> meshIDs;
+        auto addItem = [&](MeshID meshID)
+        {
+            const auto& mesh = mMeshes[meshID.get()];
+            items.push_back({ mesh.boundingBox, mesh.getTriangleCount(), calculateMemoryUsage(meshID) });
+            meshIDs.push_back(meshID);
+            return (uint32_t)items.size() - 1;
+        };
+        for (auto meshID : meshGroup.meshList) addItem(meshID);
+
+        // Meshes that cannot be cut are placed by their centroid.
+        auto cut = [&](const std::vector<uint32_t>& indices, int axis, float pos, std::vector<uint32_t>& left, std::vector<uint32_t>& right)
+        {
+            for (uint32_t i : indices)
+            {
+                const MeshID meshID = meshIDs[i];
+                if (canSplitMesh(meshID))
+                {
+                    auto result = splitMesh(meshID, axis, pos);
+                    if (auto leftMeshID = result.first) left.push_back(*leftMeshID == meshID ? i : addItem(*leftMeshID));
+                    if (auto rightMeshID = result.second) right.push_back(*rightMeshID == meshID ? i : addItem(*rightMeshID));
+                }
+                else if (items[i].bounds.center()[axis] < pos) left.push_back(i);
+                else right.push_back(i);
+            }
+        };
+
+        MeshGroupList groups;
+        for (const auto& group : partitionMeshesSAH(items, mMeshGroupBudget, cut))
+        {
+            groups.push_back({ std::vector<MeshID>(), meshGroup.isStatic });
+            for (uint32_t i : group) groups.back().meshList.push_back(meshIDs[i]);
+        }
+        return groups;
+    }
+
+    std::vector<std::vector<uint32_t>> SceneBuilder::partitionMeshesSAH(std::vector<MeshGroupPartitionItem>& items, const MeshGroupBudget& budget, const MeshGroupCutFunc& cut)
+    {
+        checkArgument(budget.maxTriangleCount > 0, "'maxTriangleCount' must be larger than zero.");
+
+        std::vector<std::vector<uint32_t>> groups;
+        if (items.empty()) return groups;
+
+        std::vector<uint32_t> indices(items.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        partitionMeshesSAHRecursive(items, std::move(indices), budget, cut, groups);
+        return groups;
+    }
+
     void SceneBuilder::optimizeGeometry()
     {
         // This function optimizes the geometry for raytracing performance and memory usage.
@@ -2207,11 +2753,39 @@ namespace Falcor
 
         for (auto& meshGroup : mMeshGroups)
         {
+            const size_t meshCount = mMeshes.size();
+
             //auto groups = splitMeshGroupSimple(meshGroup);
             //auto groups = splitMeshGroupMedian(meshGroup);
-            auto groups = splitMeshGroupMidpointMeshes(meshGroup);
+            auto groups = is_set(mFlags, Flags::UseSAHMeshGroupSplit) ? splitMeshGroupSAH(meshGroup) : splitMeshGroupMidpointMeshes(meshGroup);
+
+            if (groups.size() > 1)
+            {
+                // Gather statistics about the group sizes and the spatial overlap between the groups.
+                size_t minTriangleCount = std::numeric_limits<size_t>::max();
+                size_t maxTriangleCount = 0;
+                std::vector<AABB> bounds;
+                AABB totalBounds;
+                for (const auto& group : groups)
+                {
+                    size_t triangleCount = countTriangles(group);
+                    minTriangleCount = std::min(minTriangleCount, triangleCount);
+                    maxTriangleCount = std::max(maxTriangleCount, triangleCount);
+                    bounds.push_back(calculateBoundingBox(group));
+                    totalBounds.include(bounds.back());
+                }
 
-            if (groups.size() > 1) logWarning("SceneBuilder::optimizeGeometry() performance warning - Mesh group was split into {} groups.", groups.size());
+                float overlapFraction = 0.f;
+                for (size_t i = 0; i < bounds.size(); i++)
+                {
+                    for (size_t j = i + 1; j < bounds.size(); j++) overlapFraction += calcOverlapFraction(totalBounds, bounds[i], bounds[j]);
+                }
+
+                logWarning(
+                    "SceneBuilder::optimizeGeometry() performance warning - Mesh group was split into {} groups with {} to {} triangles. "
+                    "{} meshes were cut, pairwise overlap between groups is {:.1f}% of the total volume.",
+                    groups.size(), minTriangleCount, maxTriangleCount, mMeshes.size() - meshCount, overlapFraction * 100.f);
+            }
 
             optimizedGroups.insert(
                 optimizedGroups.end(),
@@ -2222,6 +2796,64 @@ namespace Falcor
         mMeshGroups = std::move(optimizedGroups);
     }
 
+    void SceneBuilder::optimizeVertexLocality()
+    {
+        // This function improves the memory locality of static triangle meshes if enabled by the build flags.
+        // For each mesh it:
+        //  - Reorders triangles for post-transform vertex cache efficiency.
+        //  - Reorders clusters of triangles along a Morton curve, so that spatially close triangles are close in memory.
+        //    This improves the coherence of BLAS builds and of shading hits in the same region.
+        //  - Remaps vertices in the order they are first referenced to improve vertex fetch locality.
+        //
+        // Dynamic meshes are skipped, as their skinning data and vertex caches reference the original vertex order.
+        // Note that the pass changes primitive indices, which affects anything that is keyed on them.
+        //
+        // The simulated vertex cache statistics (ACMR/ATVR) are only computed when the optimization is enabled, as simulating
+        // the cache is not free for large scenes. They then cover all indexed triangle meshes, including the skipped dynamic
+        // ones, and are reported in the scene stats. Otherwise they are left at zero.
+
+        if (!is_set(mFlags, Flags::OptimizeVertexLocality)) return;
+
+        MeshOptimizer::VertexCacheStats statsBefore;
+        MeshOptimizer::VertexCacheStats statsAfter;
+        size_t optimizedMeshCount = 0;
+
+        for (auto& mesh : mMeshes)
+        {
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0) continue;
+
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t i = 0; i < mesh.indexCount; i++) indices[i] = mesh.getIndex(i);
+
+            auto stats = MeshOptimizer::analyzeVertexCache(indices, mesh.vertexCount);
+            statsBefore += stats;
+
+            if (!mesh.isDynamic())
+            {
+                FALCOR_ASSERT(mesh.staticData.size() == mesh.vertexCount);
+
+                std::vector<float3> positions(mesh.vertexCount);
+                for (uint32_t i = 0; i < mesh.vertexCount; i++) positions[i] = mesh.staticData[i].position;
+
+                MeshOptimizer::optimizeVertexCache(indices, mesh.vertexCount);
+                MeshOptimizer::sortClustersSpatially(indices, positions);
+                auto remap = MeshOptimizer::optimizeVertexFetch(indices, mesh.vertexCount);
+                MeshOptimizer::remapVertices(mesh.staticData, remap);
+
+                stats = MeshOptimizer::analyzeVertexCache(indices, mesh.vertexCount);
+                mesh.indexData = mesh.use16BitIndices ? compact16BitIndices(indices) : std::move(indices);
+                optimizedMeshCount++;
+            }
+
+            statsAfter += stats;
+        }
+
+        mSceneData.vertexCacheStats = statsAfter;
+
+        logInfo("Optimized vertex locality of {} meshes. ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.",
+            optimizedMeshCount, statsBefore.getACMR(), statsAfter.getACMR(), statsBefore.getATVR(), statsAfter.getATVR());
+    }
+
     void SceneBuilder::sortMeshes()
     {
         // This function sorts meshes by the order they are used in the mesh groups.
@@ -2271,10 +2903,28 @@ namespace Falcor
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
         FALCOR_ASSERT(mSceneData.meshStaticData.empty());
+        FALCOR_ASSERT(mSceneData.meshCompressedStaticData.empty());
         FALCOR_ASSERT(mSceneData.meshSkinningData.empty());
 
         const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
 
+        // Compressed vertices are only used if all meshes are static, as the skinning and vertex cache passes write vertices in packed format.
+        // Meshes tessellated from curves are also excluded as the compressed format doesn't store the curve radius.
+        bool useCompressedVertices = is_set(mFlags, Flags::UseCompressedVertices);
+        if (useCompressedVertices)
+        {
+            for (const auto& mesh : mMeshes)
+            {
+                bool hasCurveRadius = std::any_of(mesh.staticData.begin(), mesh.staticData.end(), [](const StaticVertexData& v) { return v.curveRadius > 0.f; });
+                if (mesh.isDynamic() || hasCurveRadius)
+                {
+                    logWarning("Scene has dynamic meshes or meshes tessellated from curves. Ignoring the UseCompressedVertices flag.");
+                    useCompressedVertices = false;
+                    break;
+                }
+            }
+        }
+
         // Count total number of vertex and index data elements.
         size_t totalIndexDataCount = 0;
         size_t totalStaticVertexCount = 0;
@@ -2297,19 +2947,75 @@ namespace Falcor
         }
 
         mSceneData.meshIndexData.reserve(totalIndexDataCount);
-        mSceneData.meshStaticData.reserve(totalStaticVertexCount);
+        if (useCompressedVertices)
+        {
+            mSceneData.meshCompressedStaticData.reserve(totalStaticVertexCount);
+            mSceneData.meshVertexQuantization.reserve(mMeshes.size());
+        }
+        else
+        {
+            mSceneData.meshStaticData.reserve(totalStaticVertexCount);
+        }
         mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
 
+        // Max compression errors. Position errors are absolute and relative to the mesh extent, angles are in degrees.
+        float maxPositionError = 0.f;
+        float maxRelativePositionError = 0.f;
+        float maxNormalError = 0.f;
+        float maxTangentError = 0.f;
+        float maxTexelError = 0.f;
+        size_t halfTexCrdMeshCount = 0;
+
         // Copy all vertex and index data into the global buffers.
         for (auto& mesh : mMeshes)
         {
-            mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
+            mesh.staticVertexOffset = (uint32_t)(useCompressedVertices ? mSceneData.meshCompressedStaticData.size() : mSceneData.meshStaticData.size());
             mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
 
-            // Insert the static vertex data in the global array.
-            // The vertices are automatically converted to their packed format in this step.
-            mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            if (useCompressedVertices)
+            {
+                // Compress the vertices relative to the mesh bounds. Texture coordinates are stored in fp16 if the error in texels is acceptable.
+                // Textured emissives always use fp16 to match the format of PackedEmissiveTriangle (see quantizeTexCoords()).
+                const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
+                const auto& pBasicMaterial = pMaterial->toBasicMaterial();
+                const float2 maxTexDim = float2(pMaterial->getMaxTextureDimensions());
+                const bool isTexturedEmissive = pBasicMaterial && pBasicMaterial->getEmissiveTexture() != nullptr;
+
+                VertexQuantization q = computeVertexQuantization(mesh.staticData);
+                float2 maxHalfTexCrdError = float2(0.f);
+                for (const auto& v : mesh.staticData) maxHalfTexCrdError = max(maxHalfTexCrdError, abs(f16tof32(f32tof16(v.texCrd)) - v.texCrd));
+                float halfTexelError = std::max(maxHalfTexCrdError.x * maxTexDim.x, maxHalfTexCrdError.y * maxTexDim.y);
+                q.useHalfTexCrd = isTexturedEmissive || halfTexelError <= kMaxTexelError ? 1 : 0;
+                if (q.useHalfTexCrd) halfTexCrdMeshCount++;
+
+                const float extent = 2.f * std::max(q.positionScale.x, std::max(q.positionScale.y, q.positionScale.z));
+                for (const auto& v : mesh.staticData)
+                {
+                    CompressedStaticVertexData c;
+                    c.pack(v, q);
+                    mSceneData.meshCompressedStaticData.push_back(c);
+
+                    // Measure the compression error.
+                    StaticVertexData u = c.unpack(q);
+                    float3 positionError = abs(u.position - v.position);
+                    float positionErrorMax = std::max(positionError.x, std::max(positionError.y, positionError.z));
+                    maxPositionError = std::max(maxPositionError, positionErrorMax);
+                    maxRelativePositionError = std::max(maxRelativePositionError, positionErrorMax / extent);
+                    maxNormalError = std::max(maxNormalError, angleBetween(u.normal, v.normal));
+                    if (v.tangent.w != 0.f) maxTangentError = std::max(maxTangentError, angleBetween(u.tangent.xyz(), v.tangent.xyz()));
+                    float2 texCrdError = abs(u.texCrd - v.texCrd) * maxTexDim;
+                    maxTexelError = std::max(maxTexelError, std::max(texCrdError.x, texCrdError.y));
+                }
+
+                mSceneData.meshVertexQuantization.push_back(q);
+            }
+            else
+            {
+                // Insert the static vertex data in the global array.
+                // The vertices are automatically converted to their packed format in this step.
+                mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            }
 
             if (isIndexed)
             {
@@ -2335,6 +3041,17 @@ namespace Falcor
             mesh.skinningData.clear();
         }
 
+        if (useCompressedVertices)
+        {
+            logInfo("Compressed {} vertices ({} meshes with fp16 texture coordinates). Max position error {} ({} of mesh extent), max normal error {} deg, max tangent error {} deg, max texture coordinate error {} texels.",
+                mSceneData.meshCompressedStaticData.size(), halfTexCrdMeshCount, maxPositionError, maxRelativePositionError,
+                glm::degrees(maxNormalError), glm::degrees(maxTangentError), maxTexelError);
+            if (maxTexelError > kMaxTexelError)
+            {
+                logWarning("Compressed texture coordinates have a large quantization error of {} texels.", maxTexelError);
+            }
+        }
+
         // Initialize offsets for prev vertex data for vertex-animated meshes
         uint32_t prevOffset = (uint32_t)mSceneData.meshSkinningData.size();
         for (auto& cache : mSceneData.cachedMeshes)
@@ -2454,6 +3171,9 @@ namespace Falcor
         // Match texture coordinate quantization for textured emissives to format of PackedEmissiveTriangle.
         // This is to avoid mismatch when sampling and evaluating emissive triangles.
         // Note that non-emissive meshes are unmodified and use full precision texcoords.
+        // Compressed vertices already store texture coordinates of textured emissives in fp16 (see createGlobalBuffers()).
+        if (!mSceneData.meshCompressedStaticData.empty()) return;
+
         for (auto& mesh : mMeshes)
         {
             const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
@@ -2819,10 +3539,41 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("UseSAHMeshGroupSplit", SceneBuilder::Flags::UseSAHMeshGroupSplit);
+        flags.value("OptimizeVertexLocality", SceneBuilder::Flags::OptimizeVertexLocality);
+        flags.value("UseCompressedVertices", SceneBuilder::Flags::UseCompressedVertices);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("UseTextureCache", SceneBuilder::Flags::UseTextureCache);
         ScriptBindings::addEnumBinaryOperators(flags);
 
+        ScriptBindings::SerializableStruct<SceneBuilder::MeshGroupBudget> meshGroupBudget(m, "SceneBuilderMeshGroupBudget");
+#define field(f_) field(#f_, &SceneBuilder::MeshGroupBudget::f_)
+        meshGroupBudget.field(maxTriangleCount);
+        meshGroupBudget.field(maxMemoryInBytes);
+#undef field
+
+        pybind11::class_<SceneBuilder::Prototype> prototype(m, "SceneBuilderPrototype");
+        prototype.def(pybind11::init([] (const std::string& name) { SceneBuilder::Prototype p; p.name = name; return p; }), "name"_a = "");
+        prototype.def_readwrite("name", &SceneBuilder::Prototype::name);
+        prototype.def("addNode", [] (SceneBuilder::Prototype& prototype, const std::string& name, const Transform& transform, NodeID parent) {
+            SceneBuilder::Node node;
+            node.name = name;
+            node.transform = transform.getMatrix();
+            node.parent = parent;
+            prototype.nodes.push_back(node);
+            return NodeID{ prototype.nodes.size() - 1 };
+        }, "name"_a, "transform"_a = Transform(), "parent"_a = NodeID::kInvalidID);
+        prototype.def("addMeshInstance", [] (SceneBuilder::Prototype& prototype, NodeID nodeID, MeshID meshID) {
+            prototype.meshInstances.push_back({ nodeID, meshID });
+        }, "nodeID"_a, "meshID"_a);
+        prototype.def("addAnimation", [] (SceneBuilder::Prototype& prototype, const Animation::SharedPtr& pAnimation) {
+            prototype.animations.push_back(pAnimation);
+        }, "animation"_a);
+        prototype.def("addPrototypeInstance", [] (SceneBuilder::Prototype& prototype, PrototypeID prototypeID, const std::string& name, const Transform& transform, NodeID parent, const Animation::SharedPtr& pAnimation) {
+            prototype.prototypeInstances.push_back({ name, prototypeID, parent, transform.getMatrix(), pAnimation });
+        }, "prototypeID"_a, "name"_a, "transform"_a = Transform(), "parent"_a = NodeID::kInvalidID, "animation"_a = nullptr);
+
         pybind11::class_<SceneBuilder, SceneBuilder::SharedPtr> sceneBuilder(m, "SceneBuilder");
         sceneBuilder.def_property_readonly("flags", &SceneBuilder::getFlags);
         sceneBuilder.def_property_readonly("materials", &SceneBuilder::getMaterials);
@@ -2835,6 +3586,8 @@ namespace Falcor
         sceneBuilder.def_property("envMap", &SceneBuilder::getEnvMap, &SceneBuilder::setEnvMap);
         sceneBuilder.def_property("selectedCamera", &SceneBuilder::getSelectedCamera, &SceneBuilder::setSelectedCamera);
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
+        sceneBuilder.def_property("meshGroupBudget", &SceneBuilder::getMeshGroupBudget, &SceneBuilder::setMeshGroupBudget);
+        sceneBuilder.def_property_readonly("prototypeCount", &SceneBuilder::getPrototypeCount);
         sceneBuilder.def("importScene", [] (SceneBuilder* pSceneBuilder, const std::filesystem::path& path, const pybind11::dict& dict, const std::vector<Transform>& instances) {
             SceneBuilder::InstanceMatrices instanceMatrices;
             for (const auto& instance : instances)
@@ -2868,6 +3621,15 @@ namespace Falcor
             return pSceneBuilder->addNode(node);
         }, "name"_a, "transform"_a = Transform(), "parent"_a = NodeID::kInvalidID);
         sceneBuilder.def("addMeshInstance", &SceneBuilder::addMeshInstance);
+        sceneBuilder.def("addPrototype", &SceneBuilder::addPrototype, "prototype"_a);
+        sceneBuilder.def("addPrototypeInstance", [] (SceneBuilder* pSceneBuilder, PrototypeID prototypeID, const std::string& name, const Transform& transform, NodeID parent) {
+            checkArgument(pSceneBuilder, "'pSceneBuilder' is missing");
+            SceneBuilder::Node node;
+            node.name = name;
+            node.transform = transform.getMatrix();
+            node.parent = parent;
+            return pSceneBuilder->addPrototypeInstance(prototypeID, node);
+        }, "prototypeID"_a, "name"_a, "transform"_a = Transform(), "parent"_a = NodeID::kInvalidID);
         sceneBuilder.def("addSDFGridInstance", &SceneBuilder::addSDFGridInstance);
         sceneBuilder.def("addCustomPrimitive", &SceneBuilder::addCustomPrimitive);
     }
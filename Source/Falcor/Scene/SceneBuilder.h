@@ -43,6 +43,7 @@
 #include "Utils/Scripting/Dictionary.h"
 
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -76,9 +77,13 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            UseSAHMeshGroupSplit            = 0x20000,  ///< Split mesh groups exceeding the BLAS budget using a binned SAH over mesh bounds. Meshes are only cut if whole-mesh partitions overlap heavily. The default splits groups at the spatial midpoint.
+            OptimizeVertexLocality          = 0x40000,  ///< Reorder triangles and vertices of static meshes for vertex cache efficiency and memory locality.
+            UseCompressedVertices           = 0x80000,  ///< Store mesh vertices in compressed format (quantized positions, octahedral normals/tangents, 16-bit texture coordinates). Ignored if the scene has dynamic meshes.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            UseTextureCache                 = 0x40000000, ///< Enable the persistent texture cache. Material textures are mip-mapped and block compressed once and loaded from disk afterwards.
 
             Default = None
         };
@@ -326,6 +331,73 @@ namespace Falcor
 
         using InstanceMatrices = std::vector<rmcv::mat4>;
 
+        /** Reusable scene graph subgraph (e.g. a USD prototype) that is instantiated by reference.
+            All IDs in the prototype are local to the prototype, except mesh and prototype IDs which refer to the builder.
+            Instances are expanded into the scene graph when the scene is created, see addPrototypeInstance().
+        */
+        struct Prototype
+        {
+            struct MeshInstance
+            {
+                NodeID nodeID;                          ///< Local node ID.
+                MeshID meshID;                          ///< Mesh ID returned by addTriangleMesh()/addMesh().
+            };
+
+            struct PrototypeInstance
+            {
+                std::string name;
+                PrototypeID prototypeID;                ///< Nested prototype. Must have been added before this prototype.
+                NodeID parent{ NodeID::Invalid() };     ///< Local parent node, or invalid to attach to the instance root.
+                rmcv::mat4 transform = rmcv::identity<rmcv::mat4>();
+                Animation::SharedPtr pAnimation;        ///< Optional animation of the nested instance root, shared by all instances.
+            };
+
+            std::string name;
+            std::vector<Node> nodes;                    ///< Nodes in topological order. Parents are local node IDs, invalid parents attach to the instance root.
+            std::vector<MeshInstance> meshInstances;
+            std::vector<Animation::SharedPtr> animations; ///< Animations targeting local node IDs. Shared by all instances.
+            std::vector<PrototypeInstance> prototypeInstances;
+        };
+
+
+        /** Budget for the geometry in a single mesh group (BLAS).
+            Mesh groups exceeding the budget are split into multiple groups. Note that this is not a strict limit,
+            groups that cannot be split further (e.g., dynamic meshes) may exceed it.
+        */
+        struct MeshGroupBudget
+        {
+            size_t maxTriangleCount = 1ull << 24;   ///< Max number of triangles per group. The default 16M triangles is approx 0.5GB post-compaction.
+            size_t maxMemoryInBytes = 0;            ///< Max size of the vertex and index data per group in bytes, or zero for no limit.
+        };
+
+        /** Description of a mesh for partitioning meshes into mesh groups.
+        */
+        struct MeshGroupPartitionItem
+        {
+            AABB bounds;                            ///< Bounding box of the mesh.
+            size_t triangleCount = 0;               ///< Number of triangles.
+            size_t byteSize = 0;                    ///< Size of the vertex and index data in bytes.
+        };
+
+        /** Function cutting meshes by an axis-aligned plane for partitioning meshes into mesh groups.
+            The function is called with the indices of the meshes in a group, the axis and the position of the plane.
+            It returns the indices of the meshes on the left and right side of the plane in the last two arguments.
+            Meshes that are cut are replaced by their halves, which are appended to the list of meshes.
+        */
+        using MeshGroupCutFunc = std::function<void(const std::vector<uint32_t>& indices, int axis, float pos, std::vector<uint32_t>& left, std::vector<uint32_t>& right)>;
+
+        /** Partition meshes into groups using a binned surface area heuristic (SAH) over the mesh bounds, weighted by triangle count.
+            This is the partitioning used for splitting mesh groups with Flags::UseSAHMeshGroupSplit.
+            Groups are split recursively until they fit the budget. Whole meshes are partitioned by their centroids.
+            Only if the best whole-mesh partition has a large spatial overlap, or if the group holds a single mesh,
+            meshes straddling the midpoint of the largest axis are cut using the cut function.
+            \param[in,out] items List of meshes to partition. Halves of cut meshes are appended to the list.
+            \param[in] budget Budget for the geometry in a single group.
+            \param[in] cut Function cutting meshes, or nullptr to only partition whole meshes.
+            \return List of groups, each holding indices into the list of meshes. Meshes that have been cut are not referenced.
+        */
+        static std::vector<std::vector<uint32_t>> partitionMeshesSAH(std::vector<MeshGroupPartitionItem>& items, const MeshGroupBudget& budget, const MeshGroupCutFunc& cut = nullptr);
+
         /** Create a new object
         */
         static SharedPtr create(Flags mFlags = Flags::Default);
@@ -354,6 +426,14 @@ namespace Falcor
         */
         Flags getFlags() const { return mFlags; }
 
+        /** Set the budget for the geometry in a single mesh group (BLAS). Must be called before the scene is created.
+        */
+        void setMeshGroupBudget(const MeshGroupBudget& budget);
+
+        /** Get the budget for the geometry in a single mesh group (BLAS).
+        */
+        const MeshGroupBudget& getMeshGroupBudget() const { return mMeshGroupBudget; }
+
         /** Set the render settings.
         */
         void setRenderSettings(const Scene::RenderSettings& renderSettings) { mSceneData.renderSettings = renderSettings; }
@@ -607,6 +687,10 @@ namespace Falcor
         */
         uint32_t getNodeCount() const { return uint32_t(mSceneGraph.size()); }
 
+        /** Get a node in the scene graph.
+        */
+        const Node& getNode(NodeID nodeID) const { return mSceneGraph[nodeID.get()]; }
+
         /** Add a mesh instance to a node
         */
         void addMeshInstance(NodeID nodeID, MeshID meshID);
@@ -619,6 +703,27 @@ namespace Falcor
         */
         void addSDFGridInstance(NodeID nodeID, SdfDescID sdfGridID);
 
+        /** Add a prototype subgraph that can be instantiated with addPrototypeInstance().
+            Animations in the prototype are shared by all instances and must not be added with addAnimation().
+            \param[in] prototype The prototype.
+            \return The prototype ID.
+        */
+        PrototypeID addPrototype(const Prototype& prototype);
+
+        /** Get the number of prototypes.
+        */
+        uint32_t getPrototypeCount() const { return uint32_t(mPrototypes.size()); }
+
+        /** Add an instance of a prototype. Only the instance root node is created immediately, the prototype subgraph
+            is expanded when the scene is created. Static prototype nodes are collapsed into their closest animated
+            ancestor or into the instance root, so each instance only creates nodes that carry objects or animations.
+            The names of the created nodes are prefixed with the name of the instance root, e.g. "Instance/Node".
+            \param[in] prototypeID The prototype ID.
+            \param[in] rootNode Root node of the instance. Can be animated like any other node.
+            \return The ID of the instance root node.
+        */
+        NodeID addPrototypeInstance(PrototypeID prototypeID, const Node& rootNode);
+
         /** Check if a scene node is animated. This check is done recursively through parent nodes.
             \return Returns true if node is animated.
         */
@@ -732,8 +837,19 @@ namespace Falcor
         SceneGraph mSceneGraph;
         const Flags mFlags;
 
+        struct PrototypeInstanceSpec
+        {
+            PrototypeID prototypeID;
+            NodeID rootNodeID;
+        };
+
+        std::vector<Prototype> mPrototypes;
+        std::vector<PrototypeInstanceSpec> mPrototypeInstances;
+        std::vector<bool> mNodeHasAnimation;    ///< Per node flag, true if an animation targets the node. Built in getScene(), empty when not built.
+
         MeshList mMeshes;
         MeshGroupList mMeshGroups; ///< Groups of meshes. Each group represents all the geometries in a BLAS for ray tracing.
+        MeshGroupBudget mMeshGroupBudget;
 
         CurveList mCurves;
 
@@ -742,6 +858,7 @@ namespace Falcor
 
         // Helpers
         bool doesNodeHaveAnimation(NodeID nodeID) const;
+        void updateNodeAnimationFlags();
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
         bool mergeNodes(NodeID dstNodeID, NodeID srcNodeID);
@@ -758,13 +875,19 @@ namespace Falcor
 
         // Mesh group helpers
         size_t countTriangles(const MeshGroup& meshGroup) const;
+        size_t calculateMemoryUsage(MeshID meshID) const;
+        size_t calculateMemoryUsage(const MeshGroup& meshGroup) const;
         AABB calculateBoundingBox(const MeshGroup& meshGroup) const;
+        bool exceedsBudget(const MeshGroup& meshGroup) const;
         bool needsSplit(const MeshGroup& meshGroup, size_t& triangleCount) const;
+        bool canSplitMesh(MeshID meshID) const;
         MeshGroupList splitMeshGroupSimple(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMedian(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
+        MeshGroupList splitMeshGroupSAH(MeshGroup& meshGroup);
 
         // Post processing
+        void flattenPrototypeInstances();
         void prepareDisplacementMaps();
         void prepareSceneGraph();
         void prepareMeshes();
@@ -776,6 +899,7 @@ namespace Falcor
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
+        void optimizeVertexLocality();
         void sortMeshes();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
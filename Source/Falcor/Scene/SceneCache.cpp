@@ -44,7 +44,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 29;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -233,7 +233,7 @@ namespace Falcor
         if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
     }
 
-    Scene::SceneData SceneCache::readCache(const Key& key)
+    Scene::SceneData SceneCache::readCache(const Key& key, const TextureCache::SharedPtr& pTextureCache)
     {
         auto cachePath = getCachePath(key);
 
@@ -251,7 +251,7 @@ namespace Falcor
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream);
+        auto sceneData = readSceneData(stream, pTextureCache);
         if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
         return sceneData;
     }
@@ -342,9 +342,7 @@ namespace Falcor
         for (const auto& cachedMesh : sceneData.cachedMeshes)
         {
             stream.write(cachedMesh.meshID);
-            stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            writeVertexKeyframes(stream, cachedMesh.keyframes);
         }
         stream.write(sceneData.useCompressedHitInfo);
         stream.write(sceneData.has16BitIndices);
@@ -352,7 +350,10 @@ namespace Falcor
         stream.write(sceneData.meshDrawCount);
         stream.write(sceneData.meshIndexData);
         stream.write(sceneData.meshStaticData);
+        stream.write(sceneData.meshCompressedStaticData);
+        stream.write(sceneData.meshVertexQuantization);
         stream.write(sceneData.meshSkinningData);
+        stream.write(sceneData.vertexCacheStats);
 
         writeMarker(stream, "Curves");
         stream.write(sceneData.curveDesc);
@@ -366,10 +367,8 @@ namespace Falcor
         {
             stream.write(cachedCurve.tessellationMode);
             stream.write(cachedCurve.geometryID);
-            stream.write(cachedCurve.timeSamples);
             stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            writeVertexKeyframes(stream, cachedCurve.keyframes);
         }
 
         writeMarker(stream, "CustomPrimitives");
@@ -379,10 +378,11 @@ namespace Falcor
         writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream)
+    Scene::SceneData SceneCache::readSceneData(InputStream& stream, const TextureCache::SharedPtr& pTextureCache)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = MaterialSystem::create();
+        if (pTextureCache) sceneData.pMaterials->getTextureManager()->setTextureCache(pTextureCache);
 
         readMarker(stream, "Path");
         stream.read(sceneData.path);
@@ -463,9 +463,7 @@ namespace Falcor
         for (auto& cachedMesh : sceneData.cachedMeshes)
         {
             stream.read(cachedMesh.meshID);
-            stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
+            cachedMesh.keyframes = readVertexKeyframes(stream);
         }
         stream.read(sceneData.useCompressedHitInfo);
         stream.read(sceneData.has16BitIndices);
@@ -473,7 +471,10 @@ namespace Falcor
         stream.read(sceneData.meshDrawCount);
         stream.read(sceneData.meshIndexData);
         stream.read(sceneData.meshStaticData);
+        stream.read(sceneData.meshCompressedStaticData);
+        stream.read(sceneData.meshVertexQuantization);
         stream.read(sceneData.meshSkinningData);
+        stream.read(sceneData.vertexCacheStats);
 
         readMarker(stream, "Curves");
         stream.read(sceneData.curveDesc);
@@ -487,10 +488,8 @@ namespace Falcor
         {
             stream.read(cachedCurve.tessellationMode);
             stream.read(cachedCurve.geometryID);
-            stream.read(cachedCurve.timeSamples);
             stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
+            cachedCurve.keyframes = readVertexKeyframes(stream);
         }
 
         readMarker(stream, "CustomPrimitives");
@@ -916,12 +915,18 @@ namespace Falcor
     {
         stream.write(pAnimation->mName);
         stream.write(pAnimation->mNodeID);
+        stream.write(pAnimation->mInstanceNodeIDs);
         stream.write(pAnimation->mDuration);
         stream.write(pAnimation->mPreInfinityBehavior);
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        std::vector<Animation::Keyframe> keyframes(pAnimation->getKeyframeCount());
+        for (size_t i = 0; i < keyframes.size(); i++)
+        {
+            keyframes[i] = { pAnimation->mTimes[i], pAnimation->mTranslations[i], pAnimation->mScalings[i], pAnimation->mRotations[i] };
+        }
+        stream.write(keyframes);
     }
 
     Animation::SharedPtr SceneCache::readAnimation(InputStream& stream)
@@ -929,15 +934,49 @@ namespace Falcor
         Animation::SharedPtr pAnimation = Animation::create("", NodeID(), 0.0);
         stream.read(pAnimation->mName);
         stream.read(pAnimation->mNodeID);
+        stream.read(pAnimation->mInstanceNodeIDs);
         stream.read(pAnimation->mDuration);
         stream.read(pAnimation->mPreInfinityBehavior);
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        std::vector<Animation::Keyframe> keyframes;
+        stream.read(keyframes);
+        for (const auto& keyframe : keyframes) pAnimation->addKeyframe(keyframe);
         return pAnimation;
     }
 
+    // CompressedVertexKeyframes
+
+    void SceneCache::writeVertexKeyframes(OutputStream& stream, const CompressedVertexKeyframes& keyframes)
+    {
+        FALCOR_ASSERT(keyframes.mPending.empty());
+        stream.write(keyframes.mOptions);
+        stream.write(keyframes.mVertexCount);
+        stream.write(keyframes.mTimeSamples);
+        stream.write(keyframes.mReferencePositions);
+        stream.write(keyframes.mReferenceVertices);
+        stream.write(keyframes.mQuantization);
+        stream.write(keyframes.mPositionDeltas);
+        stream.write(keyframes.mNormals);
+        stream.write(keyframes.mTangents);
+    }
+
+    CompressedVertexKeyframes SceneCache::readVertexKeyframes(InputStream& stream)
+    {
+        CompressedVertexKeyframes keyframes;
+        stream.read(keyframes.mOptions);
+        stream.read(keyframes.mVertexCount);
+        stream.read(keyframes.mTimeSamples);
+        stream.read(keyframes.mReferencePositions);
+        stream.read(keyframes.mReferenceVertices);
+        stream.read(keyframes.mQuantization);
+        stream.read(keyframes.mPositionDeltas);
+        stream.read(keyframes.mNormals);
+        stream.read(keyframes.mTangents);
+        return keyframes;
+    }
+
     // Marker
 
     void SceneCache::writeMarker(OutputStream& stream, const std::string& id)
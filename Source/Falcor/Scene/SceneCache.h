@@ -36,6 +36,7 @@
 #include "Material/BasicMaterial.h"
 #include "Material/MaterialSystem.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Utils/Image/TextureCache.h"
 
 #include "Core/Macros.h"
 #include "Utils/CryptoUtils.h"
@@ -69,9 +70,10 @@ namespace Falcor
 
         /** Read a scene cache.
             \param[in] key Cache key.
+            \param[in] pTextureCache Optional texture cache used for loading material textures.
             \return Returns the loaded scene data.
         */
-        static Scene::SceneData readCache(const Key& key);
+        static Scene::SceneData readCache(const Key& key, const TextureCache::SharedPtr& pTextureCache = nullptr);
 
     private:
         class OutputStream;
@@ -80,7 +82,7 @@ namespace Falcor
         static std::filesystem::path getCachePath(const Key& key);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream);
+        static Scene::SceneData readSceneData(InputStream& stream, const TextureCache::SharedPtr& pTextureCache);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
@@ -116,6 +118,9 @@ namespace Falcor
         static void writeAnimation(OutputStream& stream, const Animation::SharedPtr& pAnimation);
         static Animation::SharedPtr readAnimation(InputStream& stream);
 
+        static void writeVertexKeyframes(OutputStream& stream, const CompressedVertexKeyframes& keyframes);
+        static CompressedVertexKeyframes readVertexKeyframes(InputStream& stream);
+
         static void writeMarker(OutputStream& stream, const std::string& id);
         static void readMarker(InputStream& stream, const std::string& id);
     };
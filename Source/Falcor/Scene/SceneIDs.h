@@ -43,6 +43,7 @@ namespace Falcor
         kLight,
         kCamera,
         kVolume,
+        kPrototype,   ///< SceneBuilder prototype subgraph, see SceneBuilder::addPrototype().
         kGlobalGeometry, ///< The linearized global ID, current in order: mest, curve, sdf, custom. Not to be confused with geometryID in curves, which is "either Mesh or Curve, depending on tessellation mode".
     };
 
@@ -57,5 +58,6 @@ namespace Falcor
     using LightID = ObjectID<SceneObjectKind, SceneObjectKind::kLight, uint32_t>;
     using CameraID = ObjectID<SceneObjectKind, SceneObjectKind::kCamera, uint32_t>;
     using VolumeID = ObjectID<SceneObjectKind, SceneObjectKind::kVolume, uint32_t>;
+    using PrototypeID = ObjectID<SceneObjectKind, SceneObjectKind::kPrototype, uint32_t>;
     using GlobalGeometryID = ObjectID<SceneObjectKind, SceneObjectKind::kGlobalGeometry, uint32_t>;
 }
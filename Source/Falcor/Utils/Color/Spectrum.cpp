@@ -120,6 +120,76 @@ namespace Falcor
     const DenseleySampledSpectrum Spectra::kCIE_Y(360.f, 830.f, CIE_Y);
     const DenseleySampledSpectrum Spectra::kCIE_Z(360.f, 830.f, CIE_Z);
 
+    namespace
+    {
+        /** Color matching functions at integer wavelengths, sampled the same way as Spectra::kCIE_X/Y/Z.
+        */
+        struct CIE1931Table
+        {
+            float minWavelength;
+            float maxWavelength;
+            std::vector<float3> values;
+
+            CIE1931Table()
+            {
+                auto range = Spectra::kCIE_Y.getWavelengthRange();
+                FALCOR_ASSERT(range.x == std::floor(range.x));
+                minWavelength = range.x;
+                maxWavelength = range.y;
+                for (float wavelength = minWavelength; wavelength <= maxWavelength; wavelength += 1.f)
+                {
+                    values.push_back(float3(Spectra::kCIE_X.eval(wavelength), Spectra::kCIE_Y.eval(wavelength), Spectra::kCIE_Z.eval(wavelength)));
+                }
+            }
+        };
+
+        const CIE1931Table& getCIE1931Table()
+        {
+            static const CIE1931Table table;
+            return table;
+        }
+    }
+
+    float3 spectrumToXYZ(const PiecewiseLinearSpectrum& s)
+    {
+        const auto& wavelengths = s.getWavelengths();
+        const auto& values = s.getValues();
+        if (wavelengths.empty()) return float3(0.f);
+
+        // Integrate over the same wavelengths as innerProduct().
+        const CIE1931Table& table = getCIE1931Table();
+        auto range = s.getWavelengthRange();
+        float minWavelength = std::max(range.x, table.minWavelength);
+        float maxWavelength = std::min(range.y, table.maxWavelength);
+
+        // If the integration starts at an integer wavelength, all wavelengths fall on the table samples.
+        const bool useTable = minWavelength == std::floor(minWavelength);
+
+        float3 xyz(0.f);
+        size_t next = 0;
+        for (float wavelength = minWavelength; wavelength <= maxWavelength; wavelength += 1.f)
+        {
+            // Evaluate the spectrum the same way as PiecewiseLinearSpectrum::eval().
+            // The wavelengths are increasing, so the segment search continues from the previous one.
+            while (next < wavelengths.size() && wavelengths[next] < wavelength) next++;
+            FALCOR_ASSERT(next < wavelengths.size());
+            float value = values.front();
+            if (next > 0)
+            {
+                size_t index = next - 1;
+                float t = (wavelength - wavelengths[index]) / (wavelengths[index + 1] - wavelengths[index]);
+                value = lerp(values[index], values[index + 1], t);
+            }
+
+            float3 cmf = useTable
+                ? table.values[(size_t)(wavelength - table.minWavelength)]
+                : float3(Spectra::kCIE_X.eval(wavelength), Spectra::kCIE_Y.eval(wavelength), Spectra::kCIE_Z.eval(wavelength));
+            xyz += value * cmf;
+        }
+
+        return xyz / Spectra::kCIE_Y_Integral;
+    }
+
     namespace
     {
         const std::unordered_map<std::string, PiecewiseLinearSpectrum> kNamedSpectra
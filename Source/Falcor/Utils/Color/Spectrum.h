@@ -111,6 +111,9 @@ namespace Falcor
             return mMaxValue;
         }
 
+        const std::vector<float>& getWavelengths() const { return mWavelengths; }
+        const std::vector<float>& getValues() const { return mValues; }
+
     private:
         std::vector<float> mWavelengths;    ///< Wavelengths in nm.
         std::vector<float> mValues;         ///< Values at each wavelength.
@@ -275,6 +278,12 @@ namespace Falcor
         ) / Spectra::kCIE_Y_Integral;
     }
 
+    /** Convert piecewise linear spectrum to CIE 1931 XYZ.
+        Returns the same result as the generic version, but evaluates the spectrum only once per wavelength
+        by walking its segments in order, and reads the color matching functions from a precomputed table.
+    */
+    FALCOR_API float3 spectrumToXYZ(const PiecewiseLinearSpectrum& s);
+
     /** Convert spectrum to RGB in Rec.709.
     */
     template<typename S>
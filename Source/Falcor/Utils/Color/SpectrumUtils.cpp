@@ -27,10 +27,16 @@
  **************************************************************************/
 #include "SpectrumUtils.h"
 #include "Utils/Color/ColorUtils.h"
+#include "Utils/NumericRange.h"
 
 #include <xyzcurves/ciexyzCurves1931_1nm.h>
 #include <illuminants/D65_5nm.h>
 
+#include <execution>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 namespace Falcor
 {
     // Initialize static data.
@@ -52,4 +58,88 @@ namespace Falcor
         float3 XYZ = wavelengthToXYZ_CIE1931(lambda);
         return XYZtoRGB_Rec709(XYZ);
     }
+
+    const std::vector<float3>& SpectrumUtils::getIntegrationWeights(float lambdaStart, float lambdaEnd, size_t sampleCount, bool multiplyD65, uint32_t integrationSteps)
+    {
+        checkArgument(lambdaEnd > lambdaStart, "'lambdaEnd' must be larger than 'lambdaStart'.");
+        checkArgument(sampleCount > 1, "'sampleCount' must be at least two.");
+        checkArgument(integrationSteps >= 1, "'integrationSteps' must be at least one.");
+
+        using Key = std::tuple<float, float, size_t, bool, uint32_t>;
+        static std::map<Key, std::vector<float3>> sCache;
+        static std::mutex sMutex;
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto [it, inserted] = sCache.try_emplace(Key(lambdaStart, lambdaEnd, sampleCount, multiplyD65, integrationSteps));
+        if (!inserted) return it->second;
+
+        // Same Riemann sum as integrate(). Each evaluation contributes to the two samples interpolated by SampledSpectrum::eval().
+        auto& weights = it->second;
+        weights.resize(sampleCount, float3(0.f));
+        uint32_t numEvaluations = uint32_t(sampleCount + (integrationSteps - 1) * (sampleCount - 1));
+        float waveLengthDelta = (lambdaEnd - lambdaStart) / (numEvaluations - 1.0f);
+
+        for (uint32_t q = 0; q < numEvaluations; q++)
+        {
+            float wavelength = std::min(lambdaStart + waveLengthDelta * q, lambdaEnd);
+            float3 f = wavelengthToXYZ_CIE1931(wavelength);
+            if (multiplyD65) f *= wavelengthToD65(wavelength);
+            f *= waveLengthDelta * ((q == 0 || q == numEvaluations - 1) ? 0.5f : 1.0f);
+
+            float x = ((wavelength - lambdaStart) / (lambdaEnd - lambdaStart)) * (sampleCount - 1.0f);
+            size_t i = (size_t)std::floor(x);
+            if (i + 1 >= sampleCount)
+            {
+                weights[sampleCount - 1] += f;
+            }
+            else
+            {
+                float w = x - (float)i;
+                weights[i] += f * (1.f - w);
+                weights[i + 1] += f * w;
+            }
+        }
+
+        return weights;
+    }
+
+    void SpectrumUtils::toRGB_D65(fstd::span<const SampledSpectrum<float>> spectra, fstd::span<float3> rgb, const uint32_t integrationSteps)
+    {
+        checkArgument(spectra.size() == rgb.size(), "'spectra' and 'rgb' must have the same size.");
+
+        // Look up the weights up front. Spectra are usually sampled on the same grid, so we only look up the cache on grid changes.
+        std::vector<const std::vector<float3>*> weights(spectra.size());
+        for (size_t i = 0; i < spectra.size(); i++)
+        {
+            const auto& s = spectra[i];
+            if (i > 0 && s.size() == spectra[i - 1].size() && s.getWavelengthRange() == spectra[i - 1].getWavelengthRange())
+            {
+                weights[i] = weights[i - 1];
+                continue;
+            }
+            float2 range = s.getWavelengthRange();
+            weights[i] = &getIntegrationWeights(range.x, range.y, s.size(), true, integrationSteps);
+        }
+
+        auto range = NumericRange<size_t>(0, spectra.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            const auto& w = *weights[i];
+            const auto& s = spectra[i];
+            float3 XYZ = float3(0.f);
+            for (size_t j = 0; j < w.size(); j++) XYZ += w[j] * s.get(j);
+            rgb[i] = XYZtoRGB_Rec709(XYZ) * (1.0f / kY_D65);
+        });
+    }
+
+    void SpectrumUtils::toRGB_Rec709(fstd::span<const PiecewiseLinearSpectrum> spectra, fstd::span<float3> rgb)
+    {
+        checkArgument(spectra.size() == rgb.size(), "'spectra' and 'rgb' must have the same size.");
+
+        auto range = NumericRange<size_t>(0, spectra.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            rgb[i] = spectrumToRGB(spectra[i]);
+        });
+    }
 }
@@ -27,13 +27,16 @@
  **************************************************************************/
 #pragma once
 #include "SampledSpectrum.h"
+#include "Spectrum.h"
 #include "Core/Macros.h"
 #include "Core/Assert.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Color/ColorUtils.h"
+#include <fstd/span.h> // TODO C++20: Replace with <span>
 #include <algorithm>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 namespace Falcor
 {
@@ -68,13 +71,13 @@ namespace Falcor
         /** Integrate over entire spectrum and apply user-supplied function to each integration.
             \param[in] spectrum The spectrum to be converted.
             \param[in] interpolationType Which type of interpolation that should be used.
-            \param[in] func A "ReturnType func(float wavelength)"-function that is applied in each integration step.
+            \param[in] func A "ReturnType func(float wavelength)"-functor that is applied in each integration step.
             \param[in] componentIndex Which component to evaluate when T is a vector type.
             \param[in] integrationSteps Number of integration steps per sample.
             \return XYZ of the spectrum.
         */
-        template<typename T, typename ReturnType>
-        static ReturnType integrate(SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType, std::function<ReturnType(float)> func, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
+        template<typename T, typename ReturnType, typename Func>
+        static ReturnType integrate(const SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType, const Func& func, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
         {
             FALCOR_ASSERT(integrationSteps >= 1);
             float2 wavelengthRange = spectrum.getWavelengthRange();
@@ -101,6 +104,20 @@ namespace Falcor
             return sum;
         }
 
+        /** Returns precomputed weights for integrating spectra sampled on a uniform wavelength grid.
+            The weights fold the integration rule, the linear interpolation of the spectrum and the color matching
+            functions (optionally times D65) into one XYZ weight per sample, so that integrate() reduces to a weighted sum:
+            toXYZ(spectrum) == sum_i weights[i] * spectrum.get(i).
+            The weights are computed once per grid and cached.
+            \param[in] lambdaStart First sampled wavelength in nm.
+            \param[in] lambdaEnd Last sampled wavelength in nm.
+            \param[in] sampleCount Number of wavelength samples.
+            \param[in] multiplyD65 Multiply the color matching functions by the D65 illuminant.
+            \param[in] integrationSteps Number of integration steps per sample.
+            \return Weights, one per sample.
+        */
+        static const std::vector<float3>& getIntegrationWeights(float lambdaStart, float lambdaEnd, size_t sampleCount, bool multiplyD65, uint32_t integrationSteps = 1);
+
         /** Convert entire spectrum to XYZ.
             \param[in] spectrum The spectrum to be converted.
             \param[in] interpolationType Which type of interpolation that should be used.
@@ -109,11 +126,9 @@ namespace Falcor
             \return XYZ of the spectrum.
         */
         template<typename T>
-        static float3 toXYZ(SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType = SpectrumInterpolation::Linear, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
+        static float3 toXYZ(const SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType = SpectrumInterpolation::Linear, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
         {
-            return integrate<T, float3>(spectrum, interpolationType,
-                [](float wavelength) -> float3 { return SpectrumUtils::wavelengthToXYZ_CIE1931(wavelength); },
-                componentIndex, integrationSteps);
+            return integrateWeighted(spectrum, interpolationType, false, componentIndex, integrationSteps);
         }
 
         /** Convert entire spectrum to XYZ times D65.
@@ -124,11 +139,9 @@ namespace Falcor
             \return XYZ of the spectrum times D65.
         */
         template<typename T>
-        static float3 toXYZ_D65(SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType = SpectrumInterpolation::Linear, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
+        static float3 toXYZ_D65(const SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType = SpectrumInterpolation::Linear, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
         {
-            return integrate<T,float3>(spectrum, interpolationType,
-                [](float wavelength) -> float3 { return SpectrumUtils::wavelengthToXYZ_CIE1931(wavelength) * SpectrumUtils::wavelengthToD65(wavelength); },
-                componentIndex, integrationSteps);
+            return integrateWeighted(spectrum, interpolationType, true, componentIndex, integrationSteps);
         }
 
         /** Convert entire spectrum to RGB under the assumption of using the D65 illuminant.
@@ -139,14 +152,53 @@ namespace Falcor
             \return An RGB color.
         */
         template<typename T>
-        static float3 toRGB_D65(SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
+        static float3 toRGB_D65(const SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType, const uint32_t componentIndex = 0, const uint32_t integrationSteps = 1)
         {
             // Equation 8 from "An OpenEXR Layout for Spectral Images", JCGT.
             // https://jcgt.org/published/0010/03/01/
             float3 XYZ = toXYZ_D65(spectrum, interpolationType, componentIndex, integrationSteps);
             float3 RGB = XYZtoRGB_Rec709(XYZ);
-            const float Y_D65 = 10567.0762f;    // Computed as Y_D65 = SpectrumUtils::sD65_5nm.toXYZ(1.0f).y; See Equation 8 in the paper above.
-            return RGB * (1.0f / Y_D65);
+            return RGB * (1.0f / kY_D65);
+        }
+
+        /** Convert a batch of spectra to RGB under the assumption of using the D65 illuminant.
+            This gives the same result as calling toRGB_D65() with linear interpolation on each spectrum.
+            The spectra are processed in parallel and spectra sharing a wavelength grid share the integration weights.
+            \param[in] spectra The spectra to be converted.
+            \param[out] rgb RGB colors, one per spectrum.
+            \param[in] integrationSteps Number of integration steps per sample.
+        */
+        static void toRGB_D65(fstd::span<const SampledSpectrum<float>> spectra, fstd::span<float3> rgb, const uint32_t integrationSteps = 1);
+
+        /** Convert a batch of piecewise linear spectra to RGB Rec.709.
+            This gives the same result as calling spectrumToRGB() on each spectrum. The spectra are processed in parallel.
+            \param[in] spectra The spectra to be converted.
+            \param[out] rgb RGB colors, one per spectrum.
+        */
+        static void toRGB_Rec709(fstd::span<const PiecewiseLinearSpectrum> spectra, fstd::span<float3> rgb);
+
+    private:
+        static constexpr float kY_D65 = 10567.0762f;    ///< Computed as Y_D65 = SpectrumUtils::sD65_5nm.toXYZ(1.0f).y; See Equation 8 in "An OpenEXR Layout for Spectral Images".
+
+        template<typename T>
+        static float3 integrateWeighted(const SampledSpectrum<T>& spectrum, const SpectrumInterpolation interpolationType, const bool multiplyD65, const uint32_t componentIndex, const uint32_t integrationSteps)
+        {
+            checkArgument(interpolationType == SpectrumInterpolation::Linear, "Interpolation type must be 'Linear'");
+            float2 wavelengthRange = spectrum.getWavelengthRange();
+            const auto& weights = getIntegrationWeights(wavelengthRange.x, wavelengthRange.y, spectrum.size(), multiplyD65, integrationSteps);
+            float3 sum = float3(0.f);
+            for (size_t i = 0; i < weights.size(); i++)
+            {
+                if constexpr (std::is_same_v<T, float>)
+                {
+                    sum += weights[i] * spectrum.get(i);
+                }
+                else
+                {
+                    sum += weights[i] * spectrum.get(i)[componentIndex];
+                }
+            }
+            return sum;
         }
     };
 }
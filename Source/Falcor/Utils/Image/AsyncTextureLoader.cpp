@@ -48,10 +48,10 @@ namespace Falcor
         gpDevice->flushAndSync();
     }
 
-    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback)
+    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback, ImageIO::CompressionMode compression)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback });
+        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback, compression });
         mCondition.notify_one();
         return mLoadRequestQueue.back().promise.get_future();
     }
@@ -106,7 +106,9 @@ namespace Falcor
             lock.unlock();
 
             // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            Texture::SharedPtr pTexture = mpTextureCache
+                ? mpTextureCache->loadTexture(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.compression)
+                : Texture::createFromFile(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
             request.promise.set_value(pTexture);
 
             if (request.callback)
@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "ImageIO.h"
+#include "TextureCache.h"
 #include "Core/Macros.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
@@ -65,6 +67,7 @@ namespace Falcor
             \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
             \param[in] bindFlags The bind flags for the texture resource.
             \param[in] callback Function called after the texture load has finished.
+            \param[in] compression Block compression mode used if the texture is loaded through a texture cache.
             \return A future to a new texture, or nullptr if the texture failed to load.
         */
         std::future<Texture::SharedPtr> loadFromFile(
@@ -72,9 +75,15 @@ namespace Falcor
             bool generateMipLevels,
             bool loadAsSRGB,
             Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-            LoadCallback callback = {}
+            LoadCallback callback = {},
+            ImageIO::CompressionMode compression = ImageIO::CompressionMode::None
         );
 
+        /** Set a texture cache used for loading textures. Pass nullptr to load textures directly.
+            Must not be called while load requests are in progress.
+        */
+        void setTextureCache(const TextureCache::SharedPtr& pTextureCache) { mpTextureCache = pTextureCache; }
+
     private:
         void runWorkers(size_t threadCount);
         void runWorker();
@@ -87,6 +96,7 @@ namespace Falcor
             bool loadAsSRGB;
             Resource::BindFlags bindFlags;
             LoadCallback callback;
+            ImageIO::CompressionMode compression;
             std::promise<Texture::SharedPtr> promise;
         };
 
@@ -94,6 +104,7 @@ namespace Falcor
         std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
         std::shared_ptr<Barrier> mFlushBarrier;     ///< Barrier for flushing the GPU to upload textures.
         std::vector<std::thread> mThreads;          ///< Worker threads.
+        TextureCache::SharedPtr mpTextureCache;     ///< Optional texture cache.
 
         // Internal state. Do not access outside of critical section.
         std::queue<LoadRequest> mLoadRequestQueue;  ///< Texture loading request queue.
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "PixelConversion.h"
 #include "Core/API/Texture.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
@@ -49,91 +50,14 @@ namespace Falcor
         return isHalfFormat || isLargeIntFormat;
     }
 
-    /** Converts half float image to RGBA float image.
-    */
-    static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-    {
-        std::vector<float> newData(width * height * 4u, 0.f);
-        const glm::detail::hdata* pSrc = reinterpret_cast<const glm::detail::hdata*>(pData);
-        float* pDst = newData.data();
-
-        for (uint32_t i = 0; i < width * height; ++i)
-        {
-            for (uint32_t c = 0; c < channelCount; ++c)
-            {
-                *pDst++ = glm::detail::toFloat32(*pSrc++);
-            }
-            pDst += (4 - channelCount);
-        }
-
-        return newData;
-    }
-
-    /** Converts integer image to RGBA float image.
-        Unsigned integers are normalized to [0,1], signed integers to [-1,1].
-    */
-    template<typename SrcT>
-    static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-    {
-        std::vector<float> newData(width * height * 4u, 0.f);
-        const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-        float* pDst = newData.data();
-
-        for (uint32_t i = 0; i < width * height; ++i)
-        {
-            for (uint32_t c = 0; c < channelCount; ++c)
-            {
-                *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
-            }
-            pDst += (4 - channelCount);
-        }
-
-        return newData;
-    }
-
     /** Converts an image of the given format to an RGBA float image.
     */
     static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
     {
         FALCOR_ASSERT(isConvertibleToRGBA32Float(format));
 
-        FormatType type = getFormatType(format);
-        uint32_t channelCount = getFormatChannelCount(format);
-        uint32_t channelBits = getNumChannelBits(format, 0);
-
-        std::vector<float> floatData;
-
-        if (type == FormatType::Float && channelBits == 16)
-        {
-            floatData = convertHalfToRGBA32Float(width, height, channelCount, pData);
-        }
-        else if (type == FormatType::Uint && channelBits == 16)
-        {
-            floatData = convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData);
-        }
-        else if (type == FormatType::Uint && channelBits == 32)
-        {
-            floatData = convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData);
-        }
-        else if (type == FormatType::Sint && channelBits == 16)
-        {
-            floatData = convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData);
-        }
-        else if (type == FormatType::Sint && channelBits == 32)
-        {
-            floatData = convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData);
-        }
-        else
-        {
-            FALCOR_UNREACHABLE();
-        }
-
-        // Default alpha channel to 1.
-        if (channelCount < 4)
-        {
-            for (uint32_t i = 0; i < width * height; ++i) floatData[i * 4 + 3] = 1.f;
-        }
-
+        std::vector<float> floatData(size_t(width) * height * 4);
+        PixelConversion::convertToRGBA32Float(format, width, height, pData, getFormatRowPitch(format, width), floatData.data());
         return floatData;
     }
 
@@ -154,23 +78,13 @@ namespace Falcor
         const BYTE *src_bits = (BYTE*)FreeImage_GetBits(pDib);
         BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
-        for (unsigned y = 0; y < height; y++)
+        // Convert pixels directly, while adding a "dummy" alpha of 1.0
+        PixelConversion::forEachRow(height, dst_pitch, [&](uint32_t y)
         {
-            const FIRGBF *src_pixel = (FIRGBF*)src_bits;
-            FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
-
-            for (unsigned x = 0; x < width; x++)
-            {
-                // Convert pixels directly, while adding a "dummy" alpha of 1.0
-                dst_pixel[x].red = src_pixel[x].red;
-                dst_pixel[x].green = src_pixel[x].green;
-                dst_pixel[x].blue = src_pixel[x].blue;
-                dst_pixel[x].alpha = 1.0F;
-
-            }
-            src_bits += src_pitch;
-            dst_bits += dst_pitch;
-        }
+            const float* src_pixel = (const float*)(src_bits + size_t(y) * src_pitch);
+            float* dst_pixel = (float*)(dst_bits + size_t(y) * dst_pitch);
+            PixelConversion::expandToRGBA(src_pixel, 3, dst_pixel, width, 1.f);
+        });
         return pNew;
     }
 
@@ -472,17 +386,12 @@ namespace Falcor
         // TODO: Replace this code for swapping channels. Can't use FreeImage masks b/c they only care about 16 bpp images.
         if (resourceFormat == ResourceFormat::RGBA8Unorm || resourceFormat == ResourceFormat::RGBA8Snorm || resourceFormat == ResourceFormat::RGBA8UnormSrgb)
         {
-            for (uint32_t a = 0; a < width * height; a++)
+            const uint8_t opaque = 0xff;
+            const uint8_t* pAlpha = is_set(exportFlags, ExportFlags::ExportAlpha) ? nullptr : &opaque;
+            PixelConversion::forEachRow(height, width * 4, [&](uint32_t y)
             {
-                uint32_t* pPixel = (uint32_t*)pData;
-                pPixel += a;
-                uint8_t* ch = (uint8_t*)pPixel;
-                std::swap(ch[0], ch[2]);
-                if (is_set(exportFlags, ExportFlags::ExportAlpha) == false)
-                {
-                    ch[3] = 0xff;
-                }
-            }
+                PixelConversion::swapRedBlue((uint8_t*)pData + size_t(y) * width * 4, width, pAlpha);
+            });
         }
 
         if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -527,26 +436,21 @@ namespace Falcor
             bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
 
             pImage = FreeImage_AllocateT(exportAlpha ? FIT_RGBAF : FIT_RGBF, width, height);
-            BYTE* head = (BYTE*)pData;
-            for (unsigned y = 0; y < height; y++)
+            const BYTE* head = (const BYTE*)pData;
+            PixelConversion::forEachRow(height, bytesPerPixel * width, [&](uint32_t y)
             {
                 float* dstBits = (float*)FreeImage_GetScanLine(pImage, height - y - 1);
+                const BYTE* srcBits = head + size_t(y) * bytesPerPixel * width;
                 if (scanlineCopy)
                 {
-                    std::memcpy(dstBits, head, bytesPerPixel * width);
+                    std::memcpy(dstBits, srcBits, bytesPerPixel * width);
                 }
                 else
                 {
                     FALCOR_ASSERT(exportAlpha == false);
-                    for (unsigned x = 0; x < width; x++)
-                    {
-                        dstBits[x*3 + 0] = (((float*)head)[x*4 + 0]);
-                        dstBits[x*3 + 1] = (((float*)head)[x*4 + 1]);
-                        dstBits[x*3 + 2] = (((float*)head)[x*4 + 2]);
-                    }
+                    PixelConversion::rgbaToRGB((const float*)srcBits, dstBits, width);
                 }
-                head += bytesPerPixel * width;
-            }
+            });
 
             if (fileFormat == Bitmap::FileFormat::ExrFile)
             {
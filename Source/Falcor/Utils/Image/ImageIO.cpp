@@ -29,17 +29,30 @@
 #include "Core/Errors.h"
 #include "Core/API/CopyContext.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Image/PixelConversion.h"
 
 #include <dds_header/DDSHeader.h>
 #include <nvtt/nvtt.h>
 
+#include <algorithm>
+#include <atomic>
+#include <execution>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 namespace Falcor
 {
     namespace
     {
+        /// Height in pixels of the bands that are block compressed in parallel. Must be a multiple of the block size.
+        const uint32_t kCompressionBandHeight = 64;
+
+        /// Number of bands compressed in parallel per worker thread before their output is written to the file.
+        const uint32_t kCompressionBandsPerThread = 4;
+
         struct ImportData
         {
             // Commonly used values converted or casted for cleaner access
@@ -262,41 +275,21 @@ namespace Falcor
 
             modified.resize(4 * pixelCount);
 
-            T* src = (T*)subresourceData;
+            const T* src = (const T*)subresourceData;
             T* dst = (T*)modified.data();
-            for (uint32_t h = 0; h < image.height; ++h)
+            PixelConversion::forEachRow(image.height, 4 * image.width * sizeof(T), [&](uint32_t h)
             {
-                for (uint32_t w = 0; w < image.width; ++w)
+                // Source rows are srcWidth pixels wide, destination rows may be narrower if clamping is involved.
+                const T* srcRow = src + size_t(h) * srcWidth * channelCount;
+                if (channelCount == 1)
                 {
-                    uint32_t i = h * srcWidth + w; // Source data index
-                    uint32_t j = h * image.width + w; // Destination data index - Same as source index if no clamping is involved
-                    if (channelCount == 1)
-                    {
-                        dst[j] = src[i];
-                    }
-                    else if (channelCount == 2)
-                    {
-                        dst[4 * j] = reverseRB ? 0 : src[2 * i];
-                        dst[4 * j + 1] = src[2 * i + 1];
-                        dst[4 * j + 2] = reverseRB ? src[2 * i] : 0;
-                        dst[4 * j + 3] = 0;
-                    }
-                    else if (channelCount == 3)
-                    {
-                        dst[4 * j] = reverseRB ? src[3 * i + 2] : src[3 * i];
-                        dst[4 * j + 1] = src[3 * i + 1];
-                        dst[4 * j + 2] = reverseRB ? src[3 * i] : src[3 * i + 2];
-                        dst[4 * j + 3] = 0;
-                    }
-                    else if (channelCount == 4)
-                    {
-                        dst[4 * j] = reverseRB ? src[4 * i + 2] : src[4 * i];
-                        dst[4 * j + 1] = src[4 * i + 1];
-                        dst[4 * j + 2] = reverseRB ? src[4 * i] : src[4 * i + 2];
-                        dst[4 * j + 3] = src[4 * i + 3];
-                    }
+                    std::memcpy(dst + size_t(h) * image.width, srcRow, image.width * sizeof(T));
                 }
-            }
+                else
+                {
+                    PixelConversion::expandToRGBA(srcRow, channelCount, dst + 4 * size_t(h) * image.width, image.width, alpha, reverseRB);
+                }
+            });
 
             if (isCompressedFormat(image.format))
             {
@@ -318,12 +311,140 @@ namespace Falcor
             if (fillAlpha) fillAlphaChannel(surface);
         }
 
+        // Returns the corresponding NVTT quality level for the provided quality preset.
+        nvtt::Quality convertQualityToNvttQuality(ImageIO::CompressionQuality quality)
+        {
+            switch (quality)
+            {
+            case ImageIO::CompressionQuality::Fast:
+                return nvtt::Quality::Quality_Fastest;
+            case ImageIO::CompressionQuality::Normal:
+                return nvtt::Quality::Quality_Normal;
+            case ImageIO::CompressionQuality::High:
+                return nvtt::Quality::Quality_Production;
+            default:
+                throw RuntimeError("Invalid compression quality.");
+            }
+        }
+
+        // Writes NVTT output to a stream.
+        class StreamOutputHandler : public nvtt::OutputHandler
+        {
+        public:
+            StreamOutputHandler(std::ostream& stream) : mStream(stream) {}
+
+            void beginImage(int size, int width, int height, int depth, int face, int miplevel) override {}
+            bool writeData(const void* data, int size) override
+            {
+                mStream.write(reinterpret_cast<const char*>(data), size);
+                return mStream.good();
+            }
+            void endImage() override {}
+
+        private:
+            std::ostream& mStream;
+        };
+
+        // Collects NVTT output in memory.
+        class MemoryOutputHandler : public nvtt::OutputHandler
+        {
+        public:
+            void beginImage(int size, int width, int height, int depth, int face, int miplevel) override { mData.reserve(mData.size() + size); }
+            bool writeData(const void* data, int size) override
+            {
+                const uint8_t* pData = reinterpret_cast<const uint8_t*>(data);
+                mData.insert(mData.end(), pData, pData + size);
+                return true;
+            }
+            void endImage() override {}
+
+            std::vector<uint8_t> takeData() { return std::move(mData); }
+
+        private:
+            std::vector<uint8_t> mData;
+        };
+
+        // Compresses all mip levels of a face and writes them to the stream.
+        // Block compressed images are stored as rows of blocks, so bands of whole block rows can be compressed
+        // independently and concatenated. On the CPU, the bands of all mip levels are compressed in parallel in
+        // batches, and each batch is written to the stream in file order before the next one starts. This keeps
+        // small mip levels from running single threaded and bounds the compressed data held in memory to one batch.
+        void compressSurfaces(nvtt::Context& context, const std::vector<nvtt::Surface>& mips, uint32_t face, const nvtt::CompressionOptions& compressionOptions, const nvtt::OutputOptions& outputOptions, bool tiled, std::ostream& stream)
+        {
+            if (!tiled || mips[0].depth() > 1)
+            {
+                for (uint32_t m = 0; m < (uint32_t)mips.size(); ++m)
+                {
+                    if (!context.compress(mips[m], face, m, compressionOptions, outputOptions))
+                    {
+                        throw RuntimeError("Failed to compress file.");
+                    }
+                }
+                return;
+            }
+
+            struct Band
+            {
+                uint32_t mip;
+                uint32_t y0;
+                uint32_t y1;
+            };
+
+            std::vector<Band> bands;
+            for (uint32_t m = 0; m < (uint32_t)mips.size(); ++m)
+            {
+                const uint32_t height = (uint32_t)mips[m].height();
+                for (uint32_t y0 = 0; y0 < height; y0 += kCompressionBandHeight)
+                {
+                    bands.push_back({ m, y0, std::min(y0 + kCompressionBandHeight, height) - 1 });
+                }
+            }
+
+            const uint32_t batchSize = std::max(1u, std::thread::hardware_concurrency()) * kCompressionBandsPerThread;
+            std::vector<std::vector<uint8_t>> bandData(std::min((uint32_t)bands.size(), batchSize));
+
+            for (uint32_t first = 0; first < (uint32_t)bands.size(); first += batchSize)
+            {
+                const uint32_t count = std::min(batchSize, (uint32_t)bands.size() - first);
+                std::atomic<bool> failed = false;
+                auto batch = NumericRange<uint32_t>(0, count);
+                std::for_each(std::execution::par, batch.begin(), batch.end(), [&](uint32_t i)
+                {
+                    const Band& band = bands[first + i];
+                    const nvtt::Surface& surface = mips[band.mip];
+                    nvtt::Surface bandSurface = surface.createSubImage(0, surface.width() - 1, (int)band.y0, (int)band.y1, 0, 0);
+
+                    MemoryOutputHandler handler;
+                    nvtt::OutputOptions bandOutputOptions;
+                    bandOutputOptions.setOutputHandler(&handler);
+
+                    nvtt::Context bandContext(false);
+                    if (!bandContext.compress(bandSurface, face, band.mip, compressionOptions, bandOutputOptions))
+                    {
+                        failed = true;
+                        return;
+                    }
+                    bandData[i] = handler.takeData();
+                });
+
+                if (failed) throw RuntimeError("Failed to compress file.");
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    stream.write(reinterpret_cast<const char*>(bandData[i].data()), bandData[i].size());
+                    bandData[i].clear();
+                }
+                if (!stream.good()) throw RuntimeError("Failed to write file.");
+            }
+        }
+
         // Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
-        void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips)
+        void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips, ImageIO::CompressionQuality quality)
         {
             nvtt::CompressionOptions compressionOptions;
             nvtt::Format format = convertModeToNvttFormat(mode);
             compressionOptions.setFormat(format);
+            compressionOptions.setQuality(convertQualityToNvttQuality(quality));
             if (format == nvtt::Format::Format_RGBA && !isCompressedFormat(image.format))
             {
                 if (getFormatType(image.format) == FormatType::Float)
@@ -345,9 +466,12 @@ namespace Falcor
                 compressionOptions.setPixelType(nvtt::PixelType::PixelType_Float);
             }
 
+            std::ofstream stream(path, std::ios::binary);
+            if (!stream) throw RuntimeError("Failed to open file for writing.");
+
+            StreamOutputHandler outputHandler(stream);
             nvtt::OutputOptions outputOptions;
-            std::string pathStr = path.string();
-            outputOptions.setFileName(pathStr.c_str());
+            outputOptions.setOutputHandler(&outputHandler);
             if (format == nvtt::Format::Format_BC6S || format == nvtt::Format::Format_BC7)
             {
                 outputOptions.setContainer(nvtt::Container::Container_DDS10);
@@ -360,30 +484,30 @@ namespace Falcor
                 throw RuntimeError("Failed to output file header.");
             }
 
+            // Split block compression into parallel bands when encoding on the CPU.
+            // With CUDA acceleration the whole image is handed to the GPU encoder instead.
+            const bool tiled = format != nvtt::Format::Format_RGBA && !context.isCudaAccelerationEnabled();
+
+            // The mip chain of a face is built up front so that all levels can be compressed in parallel.
+            std::vector<nvtt::Surface> mips(image.mipLevels);
             for (uint32_t f = 0; f < image.faceCount; ++f)
             {
                 size_t faceIndex = f * image.mipLevels;
-                nvtt::Surface tmp = image.images[faceIndex];
-                if (!context.compress(tmp, f, 0, compressionOptions, outputOptions))
-                {
-                    throw RuntimeError("Failed to compress file.");
-                }
+                mips[0] = image.images[faceIndex];
                 for (uint32_t m = 1; m < image.mipLevels; ++m)
                 {
                     if (generateMips)
                     {
-                        tmp.buildNextMipmap(nvtt::MipmapFilter::MipmapFilter_Box);
+                        mips[m] = mips[m - 1];
+                        mips[m].buildNextMipmap(nvtt::MipmapFilter::MipmapFilter_Box);
                     }
                     else
                     {
-                        tmp = image.images[faceIndex + m];
-                    }
-
-                    if (!context.compress(tmp, f, m, compressionOptions, outputOptions))
-                    {
-                        throw RuntimeError("Failed to compress file.");
+                        mips[m] = image.images[faceIndex + m];
                     }
                 }
+
+                compressSurfaces(context, mips, f, compressionOptions, outputOptions, tiled, stream);
             }
         }
 
@@ -637,7 +761,7 @@ namespace Falcor
         return pTex;
     }
 
-    void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
+    void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips, CompressionQuality quality)
     {
         if (!hasExtension(path, "dds"))
         {
@@ -705,7 +829,7 @@ namespace Falcor
                 mode = convertFormatToMode(image.format);
             }
 
-            exportDDS(path, image, mode, generateMips);
+            exportDDS(path, image, mode, generateMips, quality);
         }
         catch (const RuntimeError& e)
         {
@@ -713,7 +837,7 @@ namespace Falcor
         }
     }
 
-    void ImageIO::saveToDDS(CopyContext* pContext, const std::filesystem::path& path, const Texture::SharedPtr& pTexture, CompressionMode mode, bool generateMips)
+    void ImageIO::saveToDDS(CopyContext* pContext, const std::filesystem::path& path, const Texture::SharedPtr& pTexture, CompressionMode mode, bool generateMips, CompressionQuality quality)
     {
         if (!hasExtension(path, "dds"))
         {
@@ -810,7 +934,7 @@ namespace Falcor
                 mode = convertFormatToMode(image.format);
             }
 
-            exportDDS(path, image, mode, generateMips);
+            exportDDS(path, image, mode, generateMips, quality);
         }
         catch (const RuntimeError& e)
         {
@@ -80,6 +80,13 @@ namespace Falcor
             None
         };
 
+        enum class CompressionQuality
+        {
+            Fast,       ///< Fastest encoding with reduced quality, for iteration.
+            Normal,     ///< Balanced encoding speed and quality.
+            High,       ///< Slow encoding with the highest quality, for final bakes.
+        };
+
         /** Load a DDS file to a Bitmap. If the file contains an image array and/or mips, only the first image will be loaded.
             Throws an exception if the DDS file is malformed.
             \param[in] path Path of file to load.
@@ -96,13 +103,16 @@ namespace Falcor
         static Texture::SharedPtr loadTextureFromDDS(const std::filesystem::path& path, bool loadAsSrgb);
 
         /** Saves a bitmap to a DDS file.
+            Block compression on the CPU splits each mip level into bands of block rows. The bands of all mip levels of a face
+            are encoded in parallel in batches, which are written to the file as soon as they are done.
             Throws an exception if path is invalid or the image cannot be saved.
             \param[in] path Path to save to.
             \param[in] bitmap Bitmap object to save.
             \param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
             \param[in] if true, generate and save full mipmap chain; requires the caller to have initialized COM.
+            \param[in] quality Encoder quality preset, only used for block compression.
         */
-        static void saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode = CompressionMode::None, bool generateMips = false);
+        static void saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode = CompressionMode::None, bool generateMips = false, CompressionQuality quality = CompressionQuality::Normal);
 
         /** Saves a Texture to a DDS file. All mips and array images are saved.
             Throws an exception if the path is invalid or the image cannot be saved.
@@ -114,7 +124,8 @@ namespace Falcor
             \param[in] pBitmap Bitmap object to save.
             \param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
             \param[in] if true, generate and save full mipmap chain; requires the caller to have initialized COM.
+            \param[in] quality Encoder quality preset, only used for block compression.
         */
-        static void saveToDDS(CopyContext* pContext, const std::filesystem::path& path, const Texture::SharedPtr& pTexture, CompressionMode mode = CompressionMode::None, bool generateMips = false);
+        static void saveToDDS(CopyContext* pContext, const std::filesystem::path& path, const Texture::SharedPtr& pTexture, CompressionMode mode = CompressionMode::None, bool generateMips = false, CompressionQuality quality = CompressionQuality::Normal);
     };
 }
@@ -0,0 +1,255 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PixelConversion.h"
+#include "Utils/NumericRange.h"
+#include <fstd/bit.h> // TODO C++20: Replace with <bit>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Images with less data than this are converted on the calling thread.
+        const size_t kParallelThresholdInBytes = 1 << 20;
+
+        float halfBitsToFloat(uint16_t h)
+        {
+            // Shift exponent and mantissa into place and rebias the exponent.
+            // Infinities/NaNs need an additional exponent adjustment, denormals are renormalized by a float subtraction.
+            const uint32_t kShiftedExp = 0x7c00u << 13;
+            uint32_t bits = uint32_t(h & 0x7fff) << 13;
+            uint32_t exp = bits & kShiftedExp;
+            bits += (127 - 15) << 23;
+            if (exp == kShiftedExp) bits += (128 - 16) << 23;
+            float f = fstd::bit_cast<float>(bits);
+            if (exp == 0) f = fstd::bit_cast<float>(bits + (1u << 23)) - fstd::bit_cast<float>(113u << 23);
+            return fstd::bit_cast<float>(fstd::bit_cast<uint32_t>(f) | (uint32_t(h & 0x8000) << 16));
+        }
+
+        uint16_t floatToHalfBits(float f)
+        {
+            const uint32_t kInf = 255u << 23;
+            const uint32_t kHalfMax = (127u + 16u) << 23;
+            const uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+            uint32_t bits = fstd::bit_cast<uint32_t>(f);
+            uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+
+            uint16_t h;
+            if (bits >= kHalfMax)
+            {
+                // Out of range or Inf/NaN.
+                h = bits > kInf ? 0x7e00 : 0x7c00;
+            }
+            else if (bits < (113u << 23))
+            {
+                // Denormal result, let the FPU do the rounding by adding a magic value.
+                float v = fstd::bit_cast<float>(bits) + fstd::bit_cast<float>(kDenormMagic);
+                h = uint16_t(fstd::bit_cast<uint32_t>(v) - kDenormMagic);
+            }
+            else
+            {
+                // Normal result, rebias the exponent and round to nearest even.
+                uint32_t mantissaOdd = (bits >> 13) & 1;
+                bits += ((15u - 127u) << 23) + 0xfff;
+                bits += mantissaOdd;
+                h = uint16_t(bits >> 13);
+            }
+            return h | uint16_t(sign >> 16);
+        }
+
+        float srgbToLinearValue(float v)
+        {
+            return v <= 0.04045f ? v * (1.f / 12.92f) : std::pow((v + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgbValue(float v)
+        {
+            return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+        }
+
+        const std::array<float, 256>& getSrgbToLinearTable()
+        {
+            static const std::array<float, 256> table = []()
+            {
+                std::array<float, 256> t;
+                for (uint32_t i = 0; i < 256; ++i) t[i] = srgbToLinearValue(float(i) / 255.f);
+                return t;
+            }();
+            return table;
+        }
+
+        bool isBGRFormat(ResourceFormat format)
+        {
+            switch (format)
+            {
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRA8UnormSrgb:
+            case ResourceFormat::BGRX8Unorm:
+            case ResourceFormat::BGRX8UnormSrgb:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        /** Convert a row of channel values of the given format to floats.
+        */
+        void convertRowToFloat(FormatType type, uint32_t channelBits, const void* pSrc, float* pDst, size_t count)
+        {
+            switch (type)
+            {
+            case FormatType::Float:
+                if (channelBits == 16) PixelConversion::halfToFloat(reinterpret_cast<const uint16_t*>(pSrc), pDst, count);
+                else std::memcpy(pDst, pSrc, count * sizeof(float));
+                break;
+            case FormatType::Unorm:
+            case FormatType::UnormSrgb:
+            case FormatType::Uint:
+                if (channelBits == 8) PixelConversion::normalizedToFloat(reinterpret_cast<const uint8_t*>(pSrc), pDst, count);
+                else if (channelBits == 16) PixelConversion::normalizedToFloat(reinterpret_cast<const uint16_t*>(pSrc), pDst, count);
+                else PixelConversion::normalizedToFloat(reinterpret_cast<const uint32_t*>(pSrc), pDst, count);
+                break;
+            case FormatType::Snorm:
+            case FormatType::Sint:
+                if (channelBits == 8) PixelConversion::normalizedToFloat(reinterpret_cast<const int8_t*>(pSrc), pDst, count);
+                else if (channelBits == 16) PixelConversion::normalizedToFloat(reinterpret_cast<const int16_t*>(pSrc), pDst, count);
+                else PixelConversion::normalizedToFloat(reinterpret_cast<const int32_t*>(pSrc), pDst, count);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+            }
+        }
+    }
+
+    void PixelConversion::halfToFloat(const uint16_t* pSrc, float* pDst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) pDst[i] = halfBitsToFloat(pSrc[i]);
+    }
+
+    void PixelConversion::floatToHalf(const float* pSrc, uint16_t* pDst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) pDst[i] = floatToHalfBits(pSrc[i]);
+    }
+
+    void PixelConversion::srgbToLinear(const uint8_t* pSrc, float* pDst, size_t count)
+    {
+        const auto& table = getSrgbToLinearTable();
+        for (size_t i = 0; i < count; ++i) pDst[i] = table[pSrc[i]];
+    }
+
+    void PixelConversion::linearToSrgb(const float* pSrc, uint8_t* pDst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float v = linearToSrgbValue(std::clamp(pSrc[i], 0.f, 1.f));
+            pDst[i] = uint8_t(v * 255.f + 0.5f);
+        }
+    }
+
+    void PixelConversion::forEachRow(uint32_t rowCount, size_t bytesPerRow, const std::function<void(uint32_t)>& func)
+    {
+        if (rowCount * bytesPerRow < kParallelThresholdInBytes)
+        {
+            for (uint32_t row = 0; row < rowCount; ++row) func(row);
+        }
+        else
+        {
+            auto rows = NumericRange<uint32_t>(0, rowCount);
+            std::for_each(std::execution::par, rows.begin(), rows.end(), func);
+        }
+    }
+
+    bool PixelConversion::isConvertibleToRGBA32Float(ResourceFormat format)
+    {
+        if (format == ResourceFormat::Unknown || isCompressedFormat(format) || isDepthStencilFormat(format)) return false;
+
+        uint32_t channelCount = getFormatChannelCount(format);
+        if (channelCount == 1 && doesFormatHaveAlpha(format)) return false;
+
+        uint32_t channelBits = getNumChannelBits(format, 0);
+        if (channelBits != 8 && channelBits != 16 && channelBits != 32) return false;
+        for (uint32_t c = 1; c < channelCount; ++c)
+        {
+            if (getNumChannelBits(format, c) != channelBits) return false;
+        }
+
+        FormatType type = getFormatType(format);
+        if (type == FormatType::Float) return channelBits != 8;
+        if (type == FormatType::Unorm || type == FormatType::Snorm) return channelBits != 32;
+        if (type == FormatType::UnormSrgb) return channelBits == 8;
+        return type == FormatType::Uint || type == FormatType::Sint;
+    }
+
+    void PixelConversion::convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc, size_t srcRowPitch, float* pDst)
+    {
+        FALCOR_ASSERT(isConvertibleToRGBA32Float(format));
+
+        const FormatType type = getFormatType(format);
+        const uint32_t channelCount = getFormatChannelCount(format);
+        const uint32_t channelBits = getNumChannelBits(format, 0);
+        const bool swapRB = isBGRFormat(format);
+        const bool hasAlpha = doesFormatHaveAlpha(format);
+
+        forEachRow(height, size_t(width) * 4 * sizeof(float), [&](uint32_t y)
+        {
+            const uint8_t* pSrcRow = reinterpret_cast<const uint8_t*>(pSrc) + y * srcRowPitch;
+            float* pDstRow = pDst + size_t(y) * width * 4;
+
+            if (type == FormatType::UnormSrgb)
+            {
+                // Decode color channels with a lookup table, alpha is linear.
+                srgbToLinear(pSrcRow, pDstRow, size_t(width) * 4);
+                for (uint32_t x = 0; x < width; ++x) pDstRow[4 * x + 3] = hasAlpha ? float(pSrcRow[4 * x + 3]) / 255.f : 1.f;
+                if (swapRB) swapRedBlue(pDstRow, width);
+                return;
+            }
+
+            if (channelCount == 4 && !swapRB)
+            {
+                convertRowToFloat(type, channelBits, pSrcRow, pDstRow, size_t(width) * 4);
+            }
+            else
+            {
+                std::vector<float> row(size_t(width) * channelCount);
+                convertRowToFloat(type, channelBits, pSrcRow, row.data(), row.size());
+                expandToRGBA(row.data(), channelCount, pDstRow, width, 1.f, swapRB);
+            }
+
+            if (channelCount == 4 && !hasAlpha)
+            {
+                for (uint32_t x = 0; x < width; ++x) pDstRow[4 * x + 3] = 1.f;
+            }
+        });
+    }
+}
@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Assert.h"
+#include "Core/API/Formats.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+namespace Falcor
+{
+    /** Pixel format conversion routines used when loading, saving and uploading images.
+
+        The element and channel kernels operate on contiguous spans without per-pixel dispatch so that the
+        compiler can vectorize them. The image level functions process rows in parallel for large images.
+    */
+    class FALCOR_API PixelConversion
+    {
+    public:
+        /** Convert half-precision floats to single-precision floats. Denormals, infinities and NaNs are preserved.
+        */
+        static void halfToFloat(const uint16_t* pSrc, float* pDst, size_t count);
+
+        /** Convert single-precision floats to half-precision floats with round-to-nearest-even.
+            Values out of range are converted to infinity, NaNs are converted to a quiet NaN.
+        */
+        static void floatToHalf(const float* pSrc, uint16_t* pDst, size_t count);
+
+        /** Convert sRGB encoded 8-bit values to linear floats.
+        */
+        static void srgbToLinear(const uint8_t* pSrc, float* pDst, size_t count);
+
+        /** Convert linear floats to sRGB encoded 8-bit values. Values are clamped to [0,1].
+        */
+        static void linearToSrgb(const float* pSrc, uint8_t* pDst, size_t count);
+
+        /** Convert normalized integers to floats.
+            Unsigned integers are normalized to [0,1], signed integers to [-1,1].
+        */
+        template<typename T>
+        static void normalizedToFloat(const T* pSrc, float* pDst, size_t count)
+        {
+            static_assert(std::is_integral_v<T>);
+            const float maxValue = float(std::numeric_limits<T>::max());
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v = float(pSrc[i]) / maxValue;
+                if constexpr (std::is_signed_v<T>) v = std::max(v, -1.f);
+                pDst[i] = v;
+            }
+        }
+
+        /** Convert floats to normalized integers with rounding to nearest.
+            Values are clamped to [0,1] for unsigned integers and to [-1,1] for signed integers.
+        */
+        template<typename T>
+        static void floatToNormalized(const float* pSrc, T* pDst, size_t count)
+        {
+            static_assert(std::is_integral_v<T> && sizeof(T) <= 2);
+            const float maxValue = float(std::numeric_limits<T>::max());
+            const float minValue = std::is_signed_v<T> ? -1.f : 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v = std::clamp(pSrc[i], minValue, 1.f) * maxValue;
+                pDst[i] = T(v < 0.f ? v - 0.5f : v + 0.5f);
+            }
+        }
+
+        /** Expand pixels with 1-4 channels to 4 channels.
+            Missing color channels are set to zero and a missing alpha channel is set to the given value.
+            \param[in] pSrc Source pixels.
+            \param[in] srcChannelCount Number of channels per source pixel.
+            \param[out] pDst Destination pixels, 4 channels each. Must not overlap the source.
+            \param[in] pixelCount Number of pixels.
+            \param[in] alpha Value written to the alpha channel if the source has less than 4 channels.
+            \param[in] swapRedBlue Swap the red and blue channels of the destination.
+        */
+        template<typename T>
+        static void expandToRGBA(const T* pSrc, uint32_t srcChannelCount, T* pDst, size_t pixelCount, T alpha, bool swapRedBlue = false)
+        {
+            const uint32_t r = swapRedBlue ? 2 : 0;
+            const uint32_t b = swapRedBlue ? 0 : 2;
+            switch (srcChannelCount)
+            {
+            case 1:
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    pDst[4 * i + r] = pSrc[i];
+                    pDst[4 * i + 1] = T(0);
+                    pDst[4 * i + b] = T(0);
+                    pDst[4 * i + 3] = alpha;
+                }
+                break;
+            case 2:
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    pDst[4 * i + r] = pSrc[2 * i];
+                    pDst[4 * i + 1] = pSrc[2 * i + 1];
+                    pDst[4 * i + b] = T(0);
+                    pDst[4 * i + 3] = alpha;
+                }
+                break;
+            case 3:
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    pDst[4 * i + r] = pSrc[3 * i];
+                    pDst[4 * i + 1] = pSrc[3 * i + 1];
+                    pDst[4 * i + b] = pSrc[3 * i + 2];
+                    pDst[4 * i + 3] = alpha;
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < pixelCount; ++i)
+                {
+                    pDst[4 * i + r] = pSrc[4 * i];
+                    pDst[4 * i + 1] = pSrc[4 * i + 1];
+                    pDst[4 * i + b] = pSrc[4 * i + 2];
+                    pDst[4 * i + 3] = pSrc[4 * i + 3];
+                }
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+            }
+        }
+
+        /** Drop the alpha channel of 4 channel pixels.
+        */
+        template<typename T>
+        static void rgbaToRGB(const T* pSrc, T* pDst, size_t pixelCount)
+        {
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                pDst[3 * i] = pSrc[4 * i];
+                pDst[3 * i + 1] = pSrc[4 * i + 1];
+                pDst[3 * i + 2] = pSrc[4 * i + 2];
+            }
+        }
+
+        /** Swap the red and blue channels of 4 channel pixels in place, optionally overwriting alpha.
+            \param[in,out] pData Pixels to modify.
+            \param[in] pixelCount Number of pixels.
+            \param[in] pAlpha If non-null, the alpha channel is set to this value.
+        */
+        template<typename T>
+        static void swapRedBlue(T* pData, size_t pixelCount, const T* pAlpha = nullptr)
+        {
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                std::swap(pData[4 * i], pData[4 * i + 2]);
+            }
+            if (pAlpha)
+            {
+                for (size_t i = 0; i < pixelCount; ++i) pData[4 * i + 3] = *pAlpha;
+            }
+        }
+
+        /** Execute a function for all rows of an image. Rows are processed in parallel if the image is large enough.
+            \param[in] rowCount Number of rows.
+            \param[in] bytesPerRow Approximate amount of data processed per row, used to decide whether to go parallel.
+            \param[in] func Function called with the row index. Must be safe to call concurrently for different rows.
+        */
+        static void forEachRow(uint32_t rowCount, size_t bytesPerRow, const std::function<void(uint32_t)>& func);
+
+        /** Check if an image format can be converted with convertToRGBA32Float().
+            Supported are uncompressed formats with 8, 16 or 32 bits per channel and equal channel sizes.
+        */
+        static bool isConvertibleToRGBA32Float(ResourceFormat format);
+
+        /** Convert an image to RGBA32Float.
+            Integer formats are normalized, sRGB formats are converted to linear, BGR channel order is swapped to RGB.
+            Missing color channels are set to 0 and a missing alpha channel is set to 1.
+            \param[in] format Format of the source image. Must be supported by isConvertibleToRGBA32Float().
+            \param[in] width Image width in pixels.
+            \param[in] height Image height in pixels.
+            \param[in] pSrc Source image data.
+            \param[in] srcRowPitch Source row pitch in bytes.
+            \param[out] pDst Destination image, width * height * 4 floats.
+        */
+        static void convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc, size_t srcRowPitch, float* pDst);
+    };
+}
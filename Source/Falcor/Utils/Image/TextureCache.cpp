@@ -0,0 +1,351 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "Bitmap.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+        const uint32_t kCacheVersion = 1; ///< Increment when the preprocessing changes to invalidate existing cache entries.
+
+        /** Check if a bitmap can be processed on the CPU, i.e., all channels are 8-bit unorm or 32-bit float.
+        */
+        bool isSupportedForDownsampling(ResourceFormat format)
+        {
+            if (isCompressedFormat(format)) return false;
+            FormatType type = getFormatType(format);
+            uint32_t bits = getNumChannelBits(format, 0);
+            for (uint32_t i = 1; i < getFormatChannelCount(format); i++)
+            {
+                if (getNumChannelBits(format, (int)i) != bits) return false;
+            }
+            return ((type == FormatType::Unorm || type == FormatType::UnormSrgb) && bits == 8) || (type == FormatType::Float && bits == 32);
+        }
+
+        /** Downsample a bitmap by a factor of two using a 2x2 box filter. Odd trailing rows/columns are clamped.
+        */
+        Bitmap::UniqueConstPtr downsample(const Bitmap& src)
+        {
+            ResourceFormat format = src.getFormat();
+            FALCOR_ASSERT(isSupportedForDownsampling(format));
+
+            const uint32_t srcWidth = src.getWidth();
+            const uint32_t srcHeight = src.getHeight();
+            const uint32_t dstWidth = std::max(1u, srcWidth / 2);
+            const uint32_t dstHeight = std::max(1u, srcHeight / 2);
+            const uint32_t channelCount = getFormatChannelCount(format);
+            const bool isFloat = getFormatType(format) == FormatType::Float;
+
+            std::vector<uint8_t> dst(getFormatRowPitch(format, dstWidth) * dstHeight);
+
+            auto fetch = [&](uint32_t x, uint32_t y, uint32_t c)
+            {
+                x = std::min(x, srcWidth - 1);
+                y = std::min(y, srcHeight - 1);
+                const uint8_t* pRow = src.getData() + (size_t)y * src.getRowPitch();
+                if (isFloat) return reinterpret_cast<const float*>(pRow)[x * channelCount + c];
+                return (float)pRow[x * channelCount + c];
+            };
+
+            for (uint32_t y = 0; y < dstHeight; y++)
+            {
+                uint8_t* pDstRow = dst.data() + (size_t)y * getFormatRowPitch(format, dstWidth);
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        float sum = fetch(2 * x, 2 * y, c) + fetch(2 * x + 1, 2 * y, c) + fetch(2 * x, 2 * y + 1, c) + fetch(2 * x + 1, 2 * y + 1, c);
+                        if (isFloat) reinterpret_cast<float*>(pDstRow)[x * channelCount + c] = 0.25f * sum;
+                        else pDstRow[x * channelCount + c] = (uint8_t)std::min(255.f, 0.25f * sum + 0.5f);
+                    }
+                }
+            }
+
+            return Bitmap::create(dstWidth, dstHeight, format, dst.data());
+        }
+
+        /** Check if all alpha values of an 8-bit 4-channel bitmap are one.
+        */
+        bool isOpaque(const Bitmap& bitmap)
+        {
+            ResourceFormat format = bitmap.getFormat();
+            if (getFormatChannelCount(format) != 4 || getNumChannelBits(format, 3) != 8) return false;
+            for (uint32_t y = 0; y < bitmap.getHeight(); y++)
+            {
+                const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+                for (uint32_t x = 0; x < bitmap.getWidth(); x++)
+                {
+                    if (pRow[x * 4 + 3] != 255) return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    TextureCache::SharedPtr TextureCache::create(const Options& options)
+    {
+        return SharedPtr(new TextureCache(options));
+    }
+
+    TextureCache::TextureCache(const Options& options)
+        : mOptions(options)
+        , mFiles(options.directory.empty() ? getAppDataDirectory() / kDirectory : options.directory, ".dds")
+    {
+        mOptions.directory = mFiles.getDirectory();
+    }
+
+    Texture::SharedPtr TextureCache::loadTexture(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, ImageIO::CompressionMode compression)
+    {
+        // DDS files are already preprocessed and textures with other bind flags can't be block compressed.
+        if (hasExtension(fullPath, "dds") || bindFlags != Resource::BindFlags::ShaderResource)
+        {
+            return Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+        }
+
+        if (!mOptions.enableCompression) compression = ImageIO::CompressionMode::None;
+
+        try
+        {
+            auto key = getCacheKey(fullPath, generateMipLevels, compression);
+            auto cachePath = mFiles.getPath(key);
+
+            if (std::filesystem::exists(cachePath))
+            {
+                // Mark the entry as recently used.
+                std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now());
+
+                if (auto pTexture = ImageIO::loadTextureFromDDS(cachePath, loadAsSRGB))
+                {
+                    pTexture->setSourcePath(fullPath);
+                    pTexture->setSourceKey(cachePath.stem().string());
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mStats.hits++;
+                    return pTexture;
+                }
+
+                // The cache file is corrupt, recreate it.
+                logWarning("TextureCache: Failed to load cached texture '{}', recreating it.", cachePath);
+                std::filesystem::remove(cachePath);
+            }
+
+            if (writeCacheFile(fullPath, key, generateMipLevels, compression))
+            {
+                if (auto pTexture = ImageIO::loadTextureFromDDS(cachePath, loadAsSRGB))
+                {
+                    pTexture->setSourcePath(fullPath);
+                    pTexture->setSourceKey(cachePath.stem().string());
+                    return pTexture;
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("TextureCache: Failed to cache texture '{}': {}", fullPath, e.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.failures++;
+        }
+
+        return Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+    }
+
+    ImageIO::CompressionMode TextureCache::selectCompressionMode(ResourceFormat format, ImageIO::CompressionMode requested)
+    {
+        if (requested == ImageIO::CompressionMode::None) return requested;
+
+        // Only 8-bit unorm images are block compressed, HDR images are stored uncompressed.
+        FormatType type = getFormatType(format);
+        if (isCompressedFormat(format) || getNumChannelBits(format, 0) != 8 || (type != FormatType::Unorm && type != FormatType::UnormSrgb))
+        {
+            return ImageIO::CompressionMode::None;
+        }
+
+        switch (getFormatChannelCount(format))
+        {
+        case 1:
+            return ImageIO::CompressionMode::None;
+        case 2:
+            return ImageIO::CompressionMode::BC5;
+        default:
+            return requested;
+        }
+    }
+
+    void TextureCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(mOptions.directory, ec))
+        {
+            if (mFiles.isEntry(entry.path())) std::filesystem::remove(entry.path(), ec);
+        }
+        mCacheSizeValid = false;
+    }
+
+    TextureCache::Stats TextureCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    bool TextureCache::computeSourceHash(const Texture& texture, SHA1::MD& hash)
+    {
+        const auto& path = texture.getSourcePath();
+        if (path.empty()) return false;
+
+        SHA1 sha1;
+        if (!PersistentCache::hashFile(path, sha1)) return false;
+
+        // Textures loaded through the cache are keyed by their cache entry, which covers all preprocessing options.
+        // Lossy compression settings such as the encoder quality change the content without changing the format.
+        const std::string& sourceKey = texture.getSourceKey();
+        ResourceFormat format = texture.getFormat();
+        uint32_t dim[2] = { texture.getWidth(0), texture.getHeight(0) };
+        sha1.update(sourceKey.data(), sourceKey.size());
+        sha1.update(&format, sizeof(format));
+        sha1.update(dim, sizeof(dim));
+        hash = sha1.finalize();
+        return true;
+    }
+
+    SHA1::MD TextureCache::getCacheKey(const std::filesystem::path& fullPath, bool generateMipLevels, ImageIO::CompressionMode compression) const
+    {
+        SHA1 sha1;
+        if (!PersistentCache::hashFile(fullPath, sha1)) throw RuntimeError("Failed to open '{}'.", fullPath);
+
+        sha1.update(&kCacheVersion, sizeof(kCacheVersion));
+        sha1.update(&generateMipLevels, sizeof(generateMipLevels));
+        sha1.update(&compression, sizeof(compression));
+        sha1.update(&mOptions.maxResolution, sizeof(mOptions.maxResolution));
+        sha1.update(&mOptions.preferSmallerFormats, sizeof(mOptions.preferSmallerFormats));
+        sha1.update(&mOptions.compressionQuality, sizeof(mOptions.compressionQuality));
+        return sha1.finalize();
+    }
+
+    bool TextureCache::writeCacheFile(const std::filesystem::path& fullPath, const SHA1::MD& key, bool generateMipLevels, ImageIO::CompressionMode compression)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullPath, true);
+        if (!pBitmap) return false;
+
+        // Apply the resolution budget.
+        if (mOptions.maxResolution > 0 && isSupportedForDownsampling(pBitmap->getFormat()))
+        {
+            while (std::max(pBitmap->getWidth(), pBitmap->getHeight()) > mOptions.maxResolution)
+            {
+                pBitmap = downsample(*pBitmap);
+            }
+        }
+
+        compression = selectCompressionMode(pBitmap->getFormat(), compression);
+
+        // Block compressed textures need base dimensions that are a multiple of the block size. Lower mip levels are
+        // padded to whole blocks by the encoder. Unaligned images are stored uncompressed, as the DDS exporter would crop them.
+        if (pBitmap->getWidth() % 4 != 0 || pBitmap->getHeight() % 4 != 0)
+        {
+            compression = ImageIO::CompressionMode::None;
+        }
+
+        if (mOptions.preferSmallerFormats && compression == ImageIO::CompressionMode::BC7 && isOpaque(*pBitmap))
+        {
+            compression = ImageIO::CompressionMode::BC1;
+        }
+
+        // Uncompressed two channel images can't be written as DDS.
+        if (compression != ImageIO::CompressionMode::BC5 && getFormatChannelCount(pBitmap->getFormat()) == 2) return false;
+
+        bool stored = mFiles.store(key, [&](const std::filesystem::path& path)
+        {
+            ImageIO::saveToDDS(path, *pBitmap, compression, generateMipLevels, mOptions.compressionQuality);
+            return true;
+        });
+        if (!stored) return false;
+
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(mFiles.getPath(key), ec);
+        logInfo("TextureCache: Cached '{}' ({}x{}) in {:.1f} ms.", fullPath, pBitmap->getWidth(), pBitmap->getHeight(), CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.misses++;
+            mStats.bytesWritten += fileSize;
+
+            // The directory is scanned on the first store and whenever the tracked size exceeds the budget.
+            // Entries written by other processes are accounted for by the scan.
+            mCacheSize += fileSize;
+            if (!mCacheSizeValid || mCacheSize > mOptions.maxSizeInBytes) evict();
+        }
+
+        return true;
+    }
+
+    void TextureCache::evict()
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            uint64_t size;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(mOptions.directory, ec))
+        {
+            if (!entry.is_regular_file(ec) || !mFiles.isEntry(entry.path())) continue;
+            Entry e = { entry.path(), entry.last_write_time(ec), entry.file_size(ec) };
+            totalSize += e.size;
+            entries.push_back(std::move(e));
+        }
+
+        // Remove least recently used entries first.
+        if (totalSize > mOptions.maxSizeInBytes)
+        {
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+            for (const auto& e : entries)
+            {
+                if (totalSize <= mOptions.maxSizeInBytes) break;
+                if (std::filesystem::remove(e.path, ec)) totalSize -= e.size;
+            }
+        }
+
+        mCacheSize = totalSize;
+        mCacheSizeValid = true;
+    }
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/API/Resource.h"
+#include "Core/API/Texture.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/PersistentCache.h"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of preprocessed textures.
+
+        Source images (png, jpg, exr, etc.) are decoded, optionally downsampled, mip-mapped and
+        block compressed once, and stored as DDS files in the cache directory. Subsequent loads of the
+        same source image read the DDS file directly, avoiding decoding, mip generation and the upload
+        of uncompressed texel data.
+
+        Cache entries are keyed by the SHA-1 hash of the source file content and the preprocessing
+        settings, so modified source files are never served stale data. The cache size is bounded by
+        evicting the least recently used entries.
+
+        All operations are thread-safe.
+    */
+    class FALCOR_API TextureCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureCache>;
+
+        struct Options
+        {
+            std::filesystem::path directory;        ///< Cache directory. If empty, a directory in the application data directory is used.
+            uint64_t maxSizeInBytes = 4ull << 30;   ///< Maximum total size of cached files. Least recently used files are evicted beyond this size.
+            uint32_t maxResolution = 0;             ///< Maximum width/height of cached textures. Larger images are downsampled by factors of two. Zero means unlimited.
+            bool enableCompression = true;          ///< Enable block compression of cached textures.
+            bool preferSmallerFormats = false;      ///< Use BC1 instead of BC7 for opaque color textures, trading quality for half the memory.
+            ImageIO::CompressionQuality compressionQuality = ImageIO::CompressionQuality::Normal; ///< Encoder quality preset for block compression.
+        };
+
+        struct Stats
+        {
+            uint64_t hits = 0;                      ///< Number of textures loaded from the cache.
+            uint64_t misses = 0;                    ///< Number of textures preprocessed and added to the cache.
+            uint64_t failures = 0;                  ///< Number of textures that could not be cached and were loaded directly.
+            uint64_t bytesWritten = 0;              ///< Total size of files written to the cache.
+        };
+
+        /** Create a texture cache.
+            \param[in] options Cache options.
+            \return A new object.
+        */
+        static SharedPtr create(const Options& options = Options());
+
+        /** Load a texture through the cache.
+            The cache is bypassed for DDS source files and textures with bind flags other than shader resource,
+            in which case the texture is loaded with Texture::createFromFile().
+            \param[in] fullPath Full path of the source image.
+            \param[in] generateMipLevels Whether the full mip-chain should be generated.
+            \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
+            \param[in] bindFlags The bind flags for the texture resource.
+            \param[in] compression Requested block compression mode. The mode is adjusted to what the source format supports, see selectCompressionMode().
+            \return A new texture, or nullptr if the texture failed to load.
+        */
+        Texture::SharedPtr loadTexture(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, ImageIO::CompressionMode compression);
+
+        /** Select the compression mode to use for a source image format.
+            High dynamic range and single channel images are stored uncompressed, two channel images use BC5.
+            Requesting BC5 for images with more channels stores only the red and green channels (e.g. for normal maps).
+            \param[in] format Format of the decoded source image.
+            \param[in] requested Requested compression mode.
+            \return Compression mode to use.
+        */
+        static ImageIO::CompressionMode selectCompressionMode(ResourceFormat format, ImageIO::CompressionMode requested);
+
+        /** Hash the content of a texture from its source file, which avoids reading back the texture.
+            Textures loaded through the cache keep the path of their source image and the key of their cache entry,
+            which identifies the preprocessing options. The key, texture format and dimensions are included in the hash
+            as the texture content may differ from the source image.
+            \param[in] texture Texture.
+            \param[out] hash Hash of the texture content.
+            \return True if the texture has a source file that was hashed.
+        */
+        static bool computeSourceHash(const Texture& texture, SHA1::MD& hash);
+
+        /** Remove all files from the cache.
+        */
+        void clear();
+
+        /** Get the cache directory.
+        */
+        const std::filesystem::path& getDirectory() const { return mOptions.directory; }
+
+        /** Get cache statistics.
+        */
+        Stats getStats() const;
+
+    private:
+        TextureCache(const Options& options);
+
+        SHA1::MD getCacheKey(const std::filesystem::path& fullPath, bool generateMipLevels, ImageIO::CompressionMode compression) const;
+        bool writeCacheFile(const std::filesystem::path& fullPath, const SHA1::MD& key, bool generateMipLevels, ImageIO::CompressionMode compression);
+
+        /** Evict least recently used entries until the cache is within budget and update the tracked cache size.
+            Must be called with the mutex held.
+        */
+        void evict();
+
+        Options mOptions;
+        PersistentCache mFiles;
+        mutable std::mutex mMutex;                  ///< Mutex protecting the stats and eviction.
+        Stats mStats;
+        uint64_t mCacheSize = 0;                    ///< Total size of the cache entries. Updated as entries are stored, the directory is only scanned when it exceeds the budget.
+        bool mCacheSizeValid = false;               ///< True if mCacheSize has been computed by a directory scan.
+    };
+}
@@ -103,7 +103,7 @@ namespace Falcor
         return handle;
     }
 
-    TextureManager::TextureHandle TextureManager::loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, bool async)
+    TextureManager::TextureHandle TextureManager::loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, bool async, ImageIO::CompressionMode compression)
     {
         TextureHandle handle;
 
@@ -116,7 +116,10 @@ namespace Falcor
         }
 
         std::unique_lock<std::mutex> lock(mMutex);
-        const TextureKey textureKey(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+
+        // The compression mode only affects the loaded texture when going through the texture cache.
+        if (!mpTextureCache) compression = ImageIO::CompressionMode::None;
+        const TextureKey textureKey(fullPath, generateMipLevels, loadAsSRGB, bindFlags, compression);
 
         if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
         {
@@ -145,6 +148,7 @@ namespace Falcor
                 auto& desc = getDesc(handle);
                 desc.state = TextureState::Loaded;
                 desc.pTexture = pTexture;
+                markDescChanged(handle);
 
                 // Add to texture-to-handle map.
                 if (pTexture) mTextureToHandle[pTexture.get()] = handle;
@@ -154,10 +158,12 @@ namespace Falcor
             };
 
             // Issue load request to texture loader.
-            mAsyncTextureLoader.loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags, callback);
+            mAsyncTextureLoader.loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags, callback, compression);
 #else
             // Load texture from main thread.
-            Texture::SharedPtr pTexture = Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+            Texture::SharedPtr pTexture = mpTextureCache
+                ? mpTextureCache->loadTexture(fullPath, generateMipLevels, loadAsSRGB, bindFlags, compression)
+                : Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
 
             // Add new texture desc.
             TextureDesc desc = { TextureState::Loaded, pTexture };
@@ -183,6 +189,15 @@ namespace Falcor
         return handle;
     }
 
+    void TextureManager::setTextureCache(const TextureCache::SharedPtr& pTextureCache)
+    {
+        waitForAllTexturesLoading();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mpTextureCache = pTextureCache;
+        mAsyncTextureLoader.setTextureCache(pTextureCache);
+    }
+
     void TextureManager::waitForTextureLoading(const TextureHandle& handle)
     {
         if (!handle) return;
@@ -228,6 +243,7 @@ namespace Falcor
 
         // Clear texture desc.
         desc = {};
+        markDescChanged(handle);
 
         // Return handle to the free list.
         mFreeList.push_back(handle);
@@ -248,9 +264,10 @@ namespace Falcor
         return mTextureDescs.size();
     }
 
-    void TextureManager::setShaderData(const ShaderVar& var, const size_t descCount) const
+    void TextureManager::setShaderData(const ShaderVar& var, const size_t descCount)
     {
         std::lock_guard<std::mutex> lock(mMutex);
+        mChangedDescs.clear();
 
         if (mTextureDescs.size() > descCount)
         {
@@ -268,6 +285,26 @@ namespace Falcor
         }
     }
 
+    void TextureManager::updateShaderData(const ShaderVar& var, const size_t descCount)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mTextureDescs.size() > descCount)
+        {
+            throw RuntimeError("Descriptor array is too small");
+        }
+
+        std::sort(mChangedDescs.begin(), mChangedDescs.end());
+        mChangedDescs.erase(std::unique(mChangedDescs.begin(), mChangedDescs.end()), mChangedDescs.end());
+
+        for (uint32_t id : mChangedDescs)
+        {
+            FALCOR_ASSERT(id < mTextureDescs.size());
+            var[id] = mTextureDescs[id].pTexture;
+        }
+        mChangedDescs.clear();
+    }
+
     TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
     {
         TextureHandle handle;
@@ -289,6 +326,8 @@ namespace Falcor
             mTextureDescs.emplace_back(desc);
         }
 
+        markDescChanged(handle);
+
         return handle;
     }
 
@@ -27,6 +27,8 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "ImageIO.h"
+#include "TextureCache.h"
 #include "Core/Macros.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
@@ -111,9 +113,20 @@ namespace Falcor
             \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
             \param[in] bindFlags The bind flags for the texture resource.
             \param[in] async Load asynchronously, otherwise the function blocks until the texture data is loaded.
+            \param[in] compression Block compression mode. Only used if a texture cache is set, see setTextureCache().
             \return Unique handle to the texture, or an invalid handle if the texture can't be found.
         */
-        TextureHandle loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource, bool async = true);
+        TextureHandle loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource, bool async = true, ImageIO::CompressionMode compression = ImageIO::CompressionMode::None);
+
+        /** Set a persistent texture cache. Textures loaded from file after this call are preprocessed (mips, block compression)
+            once and loaded from the cache afterwards. Pass nullptr to disable caching.
+            \param[in] pTextureCache Texture cache.
+        */
+        void setTextureCache(const TextureCache::SharedPtr& pTextureCache);
+
+        /** Get the texture cache, or nullptr if none is set.
+        */
+        const TextureCache::SharedPtr& getTextureCache() const { return mpTextureCache; }
 
         /** Wait for a requested texture to load.
             If the handle is valid, the call blocks until the texture is loaded (or failed to load).
@@ -154,7 +167,15 @@ namespace Falcor
             \param[in] var Shader var for descriptor array.
             \param[in] descCount Size of descriptor array.
         */
-        void setShaderData(const ShaderVar& var, const size_t descCount) const;
+        void setShaderData(const ShaderVar& var, const size_t descCount);
+
+        /** Bind the textures that changed since the last call to setShaderData() or updateShaderData().
+            Textures are considered changed when they are added, finish loading or are removed.
+            The same shader var as in the last call to setShaderData() must be used.
+            \param[in] var Shader var for descriptor array.
+            \param[in] descCount Size of descriptor array.
+        */
+        void updateShaderData(const ShaderVar& var, const size_t descCount);
 
     private:
         TextureManager(size_t maxTextureCount, size_t threadCount);
@@ -167,9 +188,10 @@ namespace Falcor
             bool generateMipLevels;
             bool loadAsSRGB;
             Resource::BindFlags bindFlags;
+            ImageIO::CompressionMode compression;
 
-            TextureKey(const std::filesystem::path& path, bool mips, bool srgb, Resource::BindFlags flags)
-                : fullPath(path), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags)
+            TextureKey(const std::filesystem::path& path, bool mips, bool srgb, Resource::BindFlags flags, ImageIO::CompressionMode mode = ImageIO::CompressionMode::None)
+                : fullPath(path), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags), compression(mode)
             {}
 
             bool operator<(const TextureKey& rhs) const
@@ -177,12 +199,14 @@ namespace Falcor
                 if (fullPath != rhs.fullPath) return fullPath < rhs.fullPath;
                 else if (generateMipLevels != rhs.generateMipLevels) return generateMipLevels < rhs.generateMipLevels;
                 else if (loadAsSRGB != rhs.loadAsSRGB) return loadAsSRGB < rhs.loadAsSRGB;
-                else return bindFlags < rhs.bindFlags;
+                else if (bindFlags != rhs.bindFlags) return bindFlags < rhs.bindFlags;
+                else return compression < rhs.compression;
             }
         };
 
         TextureHandle addDesc(const TextureDesc& desc);
         TextureDesc& getDesc(const TextureHandle& handle);
+        void markDescChanged(const TextureHandle& handle) { mChangedDescs.push_back(handle.getID()); }
 
         mutable std::mutex mMutex;                                  ///< Mutex for synchronizing access to shared resources.
         std::condition_variable mCondition;                         ///< Condition variable to wait on for loading to finish.
@@ -192,8 +216,10 @@ namespace Falcor
         std::vector<TextureHandle> mFreeList;                       ///< List of unused handles.
         std::map<TextureKey, TextureHandle> mKeyToHandle;           ///< Map from texture key to handle.
         std::map<const Texture*, TextureHandle> mTextureToHandle;   ///< Map from texture ptr to handle.
+        std::vector<uint32_t> mChangedDescs;                        ///< IDs of texture descs that changed since the descriptors were last bound.
 
         AsyncTextureLoader mAsyncTextureLoader;                     ///< Utility for asynchronous texture loading.
+        TextureCache::SharedPtr mpTextureCache;                     ///< Optional persistent texture cache.
         size_t mLoadRequestsInProgress = 0;                         ///< Number of load requests currently in progress.
 
         const size_t mMaxTextureCount;                              ///< Maximum number of textures that can be simultaneously managed.
@@ -0,0 +1,110 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+
+namespace Falcor
+{
+    /** View frustum stored as six planes, used for conservative culling of bounding boxes on the CPU.
+        The planes are extracted from a view-projection matrix with a clip space z range of [0, w].
+        See: https://fgiesen.wordpress.com/2012/08/31/frustum-planes-from-the-projection-matrix/
+    */
+    struct Frustum
+    {
+        static constexpr uint32_t kPlaneCount = 6;
+        static constexpr uint32_t kAllPlanesMask = (1u << kPlaneCount) - 1;
+
+        enum class Result
+        {
+            Outside,        ///< The box is entirely outside of the frustum.
+            Intersecting,   ///< The box potentially intersects the frustum boundary.
+            Inside,         ///< The box is entirely inside the frustum.
+        };
+
+        float4 planes[kPlaneCount]; ///< Planes (n, d) with normals pointing to the inside, i.e., dot(n, p) + d >= 0 for points inside.
+
+        /** Construct a frustum that contains everything.
+        */
+        Frustum()
+        {
+            for (auto& plane : planes) plane = float4(0.f, 0.f, 0.f, 1.f);
+        }
+
+        /** Construct a frustum from a view-projection matrix.
+        */
+        explicit Frustum(const rmcv::mat4& viewProjMat)
+        {
+            const float4& x = viewProjMat[0];
+            const float4& y = viewProjMat[1];
+            const float4& z = viewProjMat[2];
+            const float4& w = viewProjMat[3];
+            planes[0] = w + x;  // Left
+            planes[1] = w - x;  // Right
+            planes[2] = w + y;  // Bottom
+            planes[3] = w - y;  // Top
+            planes[4] = z;      // Near
+            planes[5] = w - z;  // Far
+        }
+
+        /** Classify a box against the planes selected by a mask.
+            The box must be valid and finite, otherwise its center is undefined and so is the result.
+            \param[in] box Bounding box.
+            \param[in,out] planeMask Bit mask of planes to test. Planes the box is entirely inside of are removed from the mask,
+                           which allows skipping them for boxes contained in this box.
+            \return Outside if the box is outside any plane, Inside if it's inside all selected planes, Intersecting otherwise.
+        */
+        Result classify(const AABB& box, uint32_t& planeMask) const
+        {
+            const float3 c = box.center();
+            const float3 e = 0.5f * box.extent();
+
+            for (uint32_t i = 0; i < kPlaneCount; i++)
+            {
+                if ((planeMask & (1u << i)) == 0) continue;
+
+                const float3 n = float3(planes[i]);
+                const float dist = glm::dot(n, c) + planes[i].w;
+                const float radius = glm::dot(glm::abs(n), e);
+
+                if (dist + radius < 0.f) return Result::Outside;
+                if (dist - radius >= 0.f) planeMask &= ~(1u << i);
+            }
+            return planeMask == 0 ? Result::Inside : Result::Intersecting;
+        }
+
+        /** Check if a box potentially intersects the frustum. Boxes may be conservatively reported as intersecting.
+        */
+        bool intersects(const AABB& box) const
+        {
+            uint32_t planeMask = kAllPlanesMask;
+            return classify(box, planeMask) != Result::Outside;
+        }
+    };
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PersistentCache.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kReadChunkSize = 1 << 20;
+
+        // Returns a random suffix for temporary file names. The thread ID alone is not unique across processes sharing the cache.
+        uint64_t getTempSuffix()
+        {
+            thread_local std::mt19937_64 rng(((uint64_t)std::random_device()() << 32) ^ std::random_device()());
+            return rng();
+        }
+    }
+
+    PersistentCache::PersistentCache(const std::filesystem::path& directory, const std::string& extension)
+        : mDirectory(directory)
+        , mExtension(extension)
+    {
+    }
+
+    std::filesystem::path PersistentCache::getPath(const SHA1::MD& key) const
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (auto c : key) ss << std::setw(2) << (int)c;
+        return mDirectory / (ss.str() + mExtension);
+    }
+
+    bool PersistentCache::isEntry(const std::filesystem::path& path) const
+    {
+        if (path.extension().string() != mExtension) return false;
+        const std::string stem = path.stem().string();
+        return stem.size() == 2 * sizeof(SHA1::MD) && std::all_of(stem.begin(), stem.end(), [](char c) { return std::isxdigit((unsigned char)c) != 0; });
+    }
+
+    bool PersistentCache::store(const SHA1::MD& key, const WriteFunc& write) const
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(mDirectory, ec);
+
+        // Write to a temporary file first so that concurrent readers never see partially written files.
+        // The temporary file keeps the extension as some writers derive the file format from it.
+        const auto path = getPath(key);
+        std::stringstream tmpName;
+        tmpName << path.stem().string() << "." << std::hex << std::setfill('0') << std::setw(16) << getTempSuffix() << ".tmp" << mExtension;
+        const auto tmpPath = mDirectory / tmpName.str();
+
+        bool written = false;
+        try
+        {
+            written = write(tmpPath);
+        }
+        catch (...)
+        {
+            std::filesystem::remove(tmpPath, ec);
+            throw;
+        }
+
+        if (!written)
+        {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            // Another writer may have stored the same entry in the meantime.
+            std::filesystem::remove(tmpPath, ec);
+            return std::filesystem::exists(path, ec);
+        }
+        return true;
+    }
+
+    bool PersistentCache::hashFile(const std::filesystem::path& path, SHA1& sha1)
+    {
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs) return false;
+
+        std::vector<char> buffer(kReadChunkSize);
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            sha1.update(buffer.data(), (size_t)fs.gcount());
+        }
+        return true;
+    }
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "CryptoUtils.h"
+#include "Core/Macros.h"
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace Falcor
+{
+    /** Helper for persistent on-disk caches with entries keyed by a SHA-1 hash.
+
+        Each entry is a file in the cache directory named by the hex string of its key. Entries are written
+        to a temporary file first and renamed when complete, so that concurrent readers never see partially
+        written files. The cache does not evict entries, this is left to the user.
+    */
+    class FALCOR_API PersistentCache
+    {
+    public:
+        /** Function writing a cache entry to the given file. Returns false if writing failed.
+        */
+        using WriteFunc = std::function<bool(const std::filesystem::path& path)>;
+
+        /** Create a cache.
+            \param[in] directory Cache directory. It is created when the first entry is stored.
+            \param[in] extension File extension of the entries including the dot, e.g. ".bin".
+        */
+        PersistentCache(const std::filesystem::path& directory, const std::string& extension);
+
+        /** Get the path of a cache entry. The file may not exist.
+            \param[in] key Cache key.
+            \return Path of the entry.
+        */
+        std::filesystem::path getPath(const SHA1::MD& key) const;
+
+        /** Check if a file is a complete cache entry. Temporary files of writers in progress are not entries.
+            \param[in] path File path.
+            \return True if the file name is a key followed by the cache extension.
+        */
+        bool isEntry(const std::filesystem::path& path) const;
+
+        /** Store a cache entry. Failures to write the entry are not reported as errors, as caches are an optimization only.
+            \param[in] key Cache key.
+            \param[in] write Function writing the entry to a temporary file.
+            \return True if the entry exists after the call. It may have been stored concurrently by another writer.
+        */
+        bool store(const SHA1::MD& key, const WriteFunc& write) const;
+
+        const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+        /** Update a hash with the content of a file. The file is read in chunks.
+            \param[in] path File path.
+            \param[in,out] sha1 Hash to update.
+            \return True if the file was read, false if it could not be opened.
+        */
+        static bool hashFile(const std::filesystem::path& path, SHA1& sha1);
+
+    private:
+        std::filesystem::path mDirectory;
+        std::string mExtension;
+    };
+}
@@ -35,6 +35,7 @@
 namespace Falcor
 {
     /** Implements the alias method for sampling from a discrete probability distribution.
+        The table is built on the CPU with AliasTableBuilder and uploaded to the GPU.
     */
     class FALCOR_API AliasTable
     {
@@ -44,7 +45,7 @@ namespace Falcor
         /** Create an alias table.
             The weights don't need to be normalized to sum up to 1.
             \param[in] weights The weights we'd like to sample each entry proportional to.
-            \param[in] rng The random number generator to use when creating the table.
+            \param[in] rng Unused, the table is built deterministically by AliasTableBuilder.
             \returns The alias table.
         */
         static SharedPtr create(std::vector<float> weights, std::mt19937& rng);
@@ -0,0 +1,267 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AliasTableBuilder.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMinItemsPerTask = 1 << 14;
+        const uint32_t kMaxTasksPerThread = 4;
+
+        uint32_t getTaskCount(uint32_t itemCount)
+        {
+            uint32_t maxTasks = std::max(1u, std::thread::hardware_concurrency()) * kMaxTasksPerThread;
+            return std::clamp(itemCount / kMinItemsPerTask, 1u, maxTasks);
+        }
+
+        /** Returns the first item of the given task, items are split evenly between tasks.
+        */
+        uint32_t getTaskBegin(uint32_t task, uint32_t taskCount, uint32_t itemCount)
+        {
+            return (uint32_t)((uint64_t)itemCount * task / taskCount);
+        }
+    }
+
+    void AliasTableBuilder::build(std::vector<float> weights)
+    {
+        checkArgument(weights.size() < std::numeric_limits<uint32_t>::max(), "Too many entries for alias table.");
+
+        mWeights = std::move(weights);
+        rebuild();
+    }
+
+    bool AliasTableBuilder::updateWeights(const std::vector<uint32_t>& indices, const std::vector<float>& weights)
+    {
+        checkArgument(indices.size() == weights.size(), "'indices' and 'weights' need to contain the same number of elements.");
+
+        bool changed = false;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            checkArgument(indices[i] < mWeights.size(), "Weight index {} is out of range.", indices[i]);
+            if (mWeights[indices[i]] != weights[i])
+            {
+                mWeights[indices[i]] = weights[i];
+                changed = true;
+            }
+        }
+
+        if (changed) rebuild();
+        return changed;
+    }
+
+    bool AliasTableBuilder::updateWeights(const std::vector<float>& weights)
+    {
+        if (weights.size() != mWeights.size())
+        {
+            build(weights);
+            return true;
+        }
+
+        if (weights == mWeights) return false;
+
+        mWeights = weights;
+        rebuild();
+        return true;
+    }
+
+    // Sweeping construction of the alias table (Hübschle-Schneider and Sanders 2019).
+    //
+    // With weights normalized to an average of 1, lights have a deficit (1 - w) and heavies an excess (w - 1).
+    // The sequential sweep keeps one current heavy item j and fills the buckets of lights i in order with the excess
+    // of j, until j itself drops below 1. Then the bucket of j is filled with the excess of the next heavy item.
+    // After consuming lights [0, i) and completing heavies [0, j), the residual weight of the current heavy is
+    //
+    //     r = 1 + H[j + 1] - L[i]
+    //
+    // where L and H are the exclusive prefix sums of the light deficits and heavy excesses. The next step consumes a
+    // light if r >= 1, i.e., if L[i] <= H[j + 1]. The sweep is thus equivalent to merging the sorted sequences L[i]
+    // and H[j + 1], and the state after any number of steps can be found by a binary search on the merge path.
+    void AliasTableBuilder::rebuild()
+    {
+        const uint32_t count = (uint32_t)mWeights.size();
+        mEntries.resize(count);
+
+        // Sum element weights, use double to minimize precision issues.
+        mWeightSum = 0.0;
+        for (float w : mWeights)
+        {
+            checkArgument(std::isfinite(w) && w >= 0.f, "Alias table weights must be non-negative and finite.");
+            mWeightSum += w;
+        }
+
+        // Sample uniformly if there is no valid distribution.
+        if (mWeightSum <= 0.0)
+        {
+            for (uint32_t i = 0; i < count; i++) mEntries[i] = { 1.f, i };
+            return;
+        }
+
+        const double scale = double(count) / mWeightSum;
+        const uint32_t taskCount = getTaskCount(count);
+        auto tasks = NumericRange<uint32_t>(0, taskCount);
+
+        // Count lights and heavies and sum their deficits and excesses per task.
+        struct TaskSums
+        {
+            uint32_t lightCount = 0;
+            uint32_t heavyCount = 0;
+            double lightSum = 0.0;
+            double heavySum = 0.0;
+        };
+        std::vector<TaskSums> taskSums(taskCount + 1);
+
+        std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](uint32_t task)
+        {
+            TaskSums sums;
+            for (uint32_t i = getTaskBegin(task, taskCount, count); i < getTaskBegin(task + 1, taskCount, count); i++)
+            {
+                double w = mWeights[i] * scale;
+                if (w < 1.0)
+                {
+                    sums.lightCount++;
+                    sums.lightSum += 1.0 - w;
+                }
+                else
+                {
+                    sums.heavyCount++;
+                    sums.heavySum += w - 1.0;
+                }
+            }
+            taskSums[task + 1] = sums;
+        });
+
+        // Compute task offsets. The per task sums are accumulated in the same order below, which keeps the prefix sums monotonic.
+        for (uint32_t task = 0; task < taskCount; task++)
+        {
+            TaskSums& next = taskSums[task + 1];
+            const TaskSums& prev = taskSums[task];
+            next.lightCount += prev.lightCount;
+            next.heavyCount += prev.heavyCount;
+            next.lightSum += prev.lightSum;
+            next.heavySum += prev.heavySum;
+        }
+
+        const uint32_t lightCount = taskSums[taskCount].lightCount;
+        const uint32_t heavyCount = taskSums[taskCount].heavyCount;
+        // Note that heavyCount may be zero if all weights are equal up to numerical precision, which is handled by the sweep.
+
+        mLight.resize(lightCount);
+        mHeavy.resize(heavyCount);
+        mLightPrefix.resize(lightCount + 1);
+        mHeavyPrefix.resize(heavyCount + 1);
+        mLightPrefix[0] = 0.0;
+        mHeavyPrefix[0] = 0.0;
+
+        // Partition items into light and heavy lists (stable) and compute prefix sums.
+        std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](uint32_t task)
+        {
+            const TaskSums& offsets = taskSums[task];
+            uint32_t lightIndex = offsets.lightCount;
+            uint32_t heavyIndex = offsets.heavyCount;
+            double lightSum = 0.0;
+            double heavySum = 0.0;
+            for (uint32_t i = getTaskBegin(task, taskCount, count); i < getTaskBegin(task + 1, taskCount, count); i++)
+            {
+                double w = mWeights[i] * scale;
+                if (w < 1.0)
+                {
+                    lightSum += 1.0 - w;
+                    mLight[lightIndex] = i;
+                    mLightPrefix[++lightIndex] = offsets.lightSum + lightSum;
+                }
+                else
+                {
+                    heavySum += w - 1.0;
+                    mHeavy[heavyIndex] = i;
+                    mHeavyPrefix[++heavyIndex] = offsets.heavySum + heavySum;
+                }
+            }
+        });
+
+        // Returns true if the merge consumes light i before completing heavy j.
+        auto takeLight = [&](uint32_t i, uint32_t j)
+        {
+            if (i >= lightCount) return false;
+            if (j >= heavyCount) return true;
+            return mLightPrefix[i] <= mHeavyPrefix[j + 1];
+        };
+
+        // Sweep over independent ranges of the merge path in parallel.
+        std::for_each(std::execution::par, tasks.begin(), tasks.end(), [&](uint32_t task)
+        {
+            const uint32_t stepBegin = getTaskBegin(task, taskCount, count);
+            const uint32_t stepEnd = getTaskBegin(task + 1, taskCount, count);
+
+            // Find the number of lights consumed in the first stepBegin steps.
+            uint32_t lo = stepBegin > heavyCount ? stepBegin - heavyCount : 0;
+            uint32_t hi = std::min(stepBegin, lightCount);
+            while (lo < hi)
+            {
+                uint32_t mid = (lo + hi + 1) / 2;
+                if (takeLight(mid - 1, stepBegin - mid)) lo = mid;
+                else hi = mid - 1;
+            }
+
+            uint32_t i = lo;
+            uint32_t j = stepBegin - lo;
+            for (uint32_t step = stepBegin; step < stepEnd; step++)
+            {
+                if (takeLight(i, j))
+                {
+                    // Fill the bucket of the light with the excess of the current heavy.
+                    uint32_t light = mLight[i];
+                    mEntries[light] = j < heavyCount ? Entry{ float(mWeights[light] * scale), mHeavy[j] } : Entry{ 1.f, light };
+                    i++;
+                }
+                else
+                {
+                    // The current heavy dropped below 1, fill its bucket with the excess of the next heavy.
+                    // The last heavy only remains when all weight has been distributed, up to numerical precision.
+                    uint32_t heavy = mHeavy[j];
+                    if (j + 1 < heavyCount)
+                    {
+                        double residual = 1.0 + mHeavyPrefix[j + 1] - mLightPrefix[i];
+                        mEntries[heavy] = { (float)std::clamp(residual, 0.0, 1.0), mHeavy[j + 1] };
+                    }
+                    else
+                    {
+                        mEntries[heavy] = { 1.f, heavy };
+                    }
+                    j++;
+                }
+            }
+        });
+    }
+}
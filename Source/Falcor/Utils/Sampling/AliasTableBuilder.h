@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU builder for alias tables, used for sampling from a discrete probability distribution in O(1).
+
+        The builder is independent of any GPU resources. Users such as AliasTable and EmissivePowerSampler
+        pack the resulting entries into their own GPU representation.
+
+        Each table entry i holds a threshold and an alias. Sampling picks a uniform entry i and a uniform
+        number u, and returns i if u < threshold, otherwise the alias.
+
+        Construction uses the sweeping formulation of Vose's algorithm from Hübschle-Schneider and Sanders 2019,
+        "Parallel Weighted Random Sampling". Items are split into light (below average weight) and heavy (above
+        average weight) lists, and the sweep over both lists is equivalent to merging the prefix sums of the light
+        deficits and heavy excesses. This allows the sweep to be split into independent ranges with a binary search
+        per range (merge path), which are then processed in parallel. The result is deterministic and independent
+        of the number of threads.
+    */
+    class FALCOR_API AliasTableBuilder
+    {
+    public:
+        struct Entry
+        {
+            float threshold = 1.f;          ///< Probability of picking the entry itself.
+            uint32_t alias = 0;             ///< Index picked with probability (1 - threshold).
+        };
+
+        AliasTableBuilder() = default;
+
+        /** Create a builder and build the table for the given weights.
+            \param[in] weights The weights we'd like to sample each entry proportional to.
+        */
+        explicit AliasTableBuilder(std::vector<float> weights) { build(std::move(weights)); }
+
+        /** Build the table.
+            The weights don't need to be normalized to sum up to 1. If all weights are zero, entries are sampled uniformly.
+            \param[in] weights The weights we'd like to sample each entry proportional to. Must be non-negative and finite.
+        */
+        void build(std::vector<float> weights);
+
+        /** Update a subset of the weights and rebuild the table if any weight changed.
+            Storage from the previous build is reused.
+            \param[in] indices Indices of the weights to update.
+            \param[in] weights New weights, one per index.
+            \return True if any weight changed and the table was rebuilt.
+        */
+        bool updateWeights(const std::vector<uint32_t>& indices, const std::vector<float>& weights);
+
+        /** Update all weights and rebuild the table if any weight changed.
+            The number of weights has to match the current table, otherwise the table is built from scratch.
+            \param[in] weights New weights.
+            \return True if any weight changed and the table was rebuilt.
+        */
+        bool updateWeights(const std::vector<float>& weights);
+
+        /** Sample from the table.
+            \param[in] index Uniform random index in [0..count).
+            \param[in] u Uniform random number in [0..1).
+            \return Returns the sampled index.
+        */
+        uint32_t sample(uint32_t index, float u) const
+        {
+            const Entry& entry = mEntries[index];
+            return u < entry.threshold ? index : entry.alias;
+        }
+
+        /** Sample from the table.
+            \param[in] u Two uniform random numbers in [0..1).
+            \return Returns the sampled index.
+        */
+        uint32_t sample(float2 u) const
+        {
+            uint32_t index = std::min(getCount() - 1, (uint32_t)(u.x * getCount()));
+            return sample(index, u.y);
+        }
+
+        /** Get the probability of sampling the given index.
+        */
+        double getPdf(uint32_t index) const { return mWeightSum > 0.0 ? mWeights[index] / mWeightSum : 1.0 / getCount(); }
+
+        /** Get the number of entries in the table.
+        */
+        uint32_t getCount() const { return (uint32_t)mEntries.size(); }
+
+        /** Get the total sum of all weights in the table.
+        */
+        double getWeightSum() const { return mWeightSum; }
+
+        const std::vector<float>& getWeights() const { return mWeights; }
+        const std::vector<Entry>& getEntries() const { return mEntries; }
+
+    private:
+        void rebuild();
+
+        std::vector<float> mWeights;
+        double mWeightSum = 0.0;
+        std::vector<Entry> mEntries;
+
+        // Scratch data, kept to avoid reallocation on updates.
+        std::vector<uint32_t> mLight;       ///< Indices of items with below average weight.
+        std::vector<uint32_t> mHeavy;       ///< Indices of items with average or above average weight.
+        std::vector<double> mLightPrefix;   ///< Exclusive prefix sum of normalized light deficits (1 - w), with the total at the end.
+        std::vector<double> mHeavyPrefix;   ///< Exclusive prefix sum of normalized heavy excesses (w - 1), with the total at the end.
+    };
+}
@@ -611,7 +611,11 @@ void CSM::renderScene(RenderContext* pCtx)
 
     pCB->setBlob(&mCsmData, 0, sizeof(mCsmData));
     mpLightCamera->setProjectionMatrix(mCsmData.globalMat);
-    mpScene->rasterize(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get());
+    // All cascades are rendered in a single layered pass, so cull shadow casters against the global light frustum.
+    // The near plane is disabled as casters between the light and the shadow volume still occlude it.
+    Frustum casterFrustum(mCsmData.globalMat);
+    casterFrustum.planes[4] = float4(0.f, 0.f, 0.f, 1.f);
+    mpScene->rasterize(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get(), casterFrustum);
     //        mpCsmSceneRenderer->renderScene(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get(), mpLightCamera.get());
 }
 
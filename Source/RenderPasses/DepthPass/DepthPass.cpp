@@ -121,7 +121,8 @@ void DepthPass::execute(RenderContext* pRenderContext, const RenderData& renderD
     if (mpScene)
     {
         mpState->getProgram()->addDefine("USE_ALPHA_TEST", mUseAlphaTest ? "1" : "0");
-        mpScene->rasterize(pRenderContext, mpState.get(), mpVars.get(), mCullMode);
+        Frustum frustum(mpScene->getCamera()->getViewProjMatrix());
+        mpScene->rasterize(pRenderContext, mpState.get(), mpVars.get(), frustum, mCullMode);
     }
 }
 
@@ -221,7 +221,8 @@ void ForwardLightingPass::execute(RenderContext* pRenderContext, const RenderDat
     mpVars->setTexture(kVisBuffer, renderData.getTexture(kVisBuffer));
 
     mpState->setFbo(mpFbo);
-    mpScene->rasterize(pRenderContext, mpState.get(), mpVars.get());
+    Frustum frustum(mpScene->getCamera()->getViewProjMatrix());
+    mpScene->rasterize(pRenderContext, mpState.get(), mpVars.get(), frustum);
 
     mFrameCount++;
 }
@@ -312,23 +312,20 @@ Program::DefineList GBufferRT::getShaderDefines(const RenderData& renderData) co
 
 void GBufferRT::setShaderData(const ShaderVar& var, const RenderData& renderData)
 {
-    var["gGBufferRT"]["frameDim"] = mFrameDim;
-    var["gGBufferRT"]["invFrameDim"] = mInvFrameDim;
-    var["gGBufferRT"]["frameCount"] = mFrameCount;
-    var["gGBufferRT"]["screenSpacePixelSpreadAngle"] = mpScene->getCamera()->computeScreenSpacePixelSpreadAngle(mFrameDim.y);
+    mFrameDimPath.get(var) = mFrameDim;
+    mInvFrameDimPath.get(var) = mInvFrameDim;
+    mFrameCountPath.get(var) = mFrameCount;
+    mSpreadAnglePath.get(var) = mpScene->getCamera()->computeScreenSpacePixelSpreadAngle(mFrameDim.y);
 
     // Bind output channels as UAV buffers.
-    auto bind = [&](const ChannelDesc& channel)
-    {
-        Texture::SharedPtr pTex = getOutput(renderData, channel.name);
-        var[channel.texname] = pTex;
-    };
-    for (const auto& channel : kGBufferChannels) bind(channel);
-    for (const auto& channel : kGBufferExtraChannels) bind(channel);
+    bindChannels(var, renderData, kGBufferChannels, mChannelPaths);
+    bindChannels(var, renderData, kGBufferExtraChannels, mExtraChannelPaths);
 }
 
 GBufferRT::GBufferRT(const Dictionary& dict)
     : GBuffer(kInfo)
+    , mChannelPaths(createChannelPaths(kGBufferChannels))
+    , mExtraChannelPaths(createChannelPaths(kGBufferExtraChannels))
 {
     parseDictionary(dict);
 
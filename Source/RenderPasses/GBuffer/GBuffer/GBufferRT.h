@@ -78,4 +78,12 @@ private:
     } mRaytrace;
 
     ComputePass::SharedPtr mpComputePass;
+
+    // Precompiled paths to per-frame shader parameters.
+    ShaderVarPath mFrameDimPath = "gGBufferRT.frameDim";
+    ShaderVarPath mInvFrameDimPath = "gGBufferRT.invFrameDim";
+    ShaderVarPath mFrameCountPath = "gGBufferRT.frameCount";
+    ShaderVarPath mSpreadAnglePath = "gGBufferRT.screenSpacePixelSpreadAngle";
+    std::vector<ShaderVarPath> mChannelPaths;
+    std::vector<ShaderVarPath> mExtraChannelPaths;
 };
@@ -78,6 +78,7 @@ GBufferRaster::SharedPtr GBufferRaster::create(RenderContext* pRenderContext, co
 
 GBufferRaster::GBufferRaster(const Dictionary& dict)
     : GBuffer(kInfo)
+    , mExtraChannelPaths(createChannelPaths(kGBufferExtraChannels))
 {
     // Check for required features.
     if (!gpDevice->isFeatureSupported(Device::SupportedFeatures::Barycentrics))
@@ -199,17 +200,15 @@ void GBufferRaster::execute(RenderContext* pRenderContext, const RenderData& ren
     pRenderContext->copyResource(pDepth.get(), pPreDepth.get());
 
     // Bind extra channels as UAV buffers.
-    for (const auto& channel : kGBufferExtraChannels)
-    {
-        Texture::SharedPtr pTex = getOutput(renderData, channel.name);
-        mRaster.pVars[channel.texname] = pTex;
-    }
+    auto var = mRaster.pVars->getRootVar();
+    bindChannels(var, renderData, kGBufferExtraChannels, mExtraChannelPaths);
 
-    mRaster.pVars["PerFrameCB"]["gFrameDim"] = mFrameDim;
+    mFrameDimPath.get(var) = mFrameDim;
     mRaster.pState->setFbo(mpFbo); // Sets the viewport
 
-    // Rasterize the scene.
-    mpScene->rasterize(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), cullMode);
+    // Rasterize the scene, culling instances outside the camera frustum.
+    Frustum frustum(mpScene->getCamera()->getViewProjMatrix());
+    mpScene->rasterize(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), frustum, cullMode);
 
     mFrameCount++;
 }
@@ -65,4 +65,8 @@ private:
         GraphicsProgram::SharedPtr pProgram;
         GraphicsVars::SharedPtr pVars;
     } mRaster;
+
+    // Precompiled paths to per-frame shader parameters.
+    ShaderVarPath mFrameDimPath = "PerFrameCB.gFrameDim";
+    std::vector<ShaderVarPath> mExtraChannelPaths;
 };
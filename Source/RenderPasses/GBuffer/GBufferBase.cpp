@@ -252,3 +252,20 @@ Texture::SharedPtr GBufferBase::getOutput(const RenderData& renderData, const st
     }
     return pTex;
 }
+
+std::vector<ShaderVarPath> GBufferBase::createChannelPaths(const ChannelList& channels)
+{
+    std::vector<ShaderVarPath> paths;
+    paths.reserve(channels.size());
+    for (const auto& channel : channels) paths.emplace_back(channel.texname);
+    return paths;
+}
+
+void GBufferBase::bindChannels(const ShaderVar& var, const RenderData& renderData, const ChannelList& channels, const std::vector<ShaderVarPath>& paths) const
+{
+    FALCOR_ASSERT(channels.size() == paths.size());
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        paths[i].get(var) = getOutput(renderData, channels[i].name);
+    }
+}
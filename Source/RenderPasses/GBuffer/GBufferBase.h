@@ -29,6 +29,7 @@
 #include "Falcor.h"
 #include "RenderGraph/RenderPassLibrary.h"
 #include "RenderGraph/RenderPassHelpers.h"
+#include "Core/Program/ShaderVarPath.h"
 
 using namespace Falcor;
 
@@ -60,6 +61,20 @@ protected:
     void updateSamplePattern();
     Texture::SharedPtr getOutput(const RenderData& renderData, const std::string& name) const;
 
+    /** Create precompiled paths to the shader variables of a list of channels.
+        \param[in] channels List of channels.
+        \return List of paths, one per channel.
+    */
+    static std::vector<ShaderVarPath> createChannelPaths(const ChannelList& channels);
+
+    /** Bind the outputs of a list of channels to their shader variables.
+        \param[in] var Shader variable the channel paths start at.
+        \param[in] renderData Render data holding the outputs.
+        \param[in] channels List of channels.
+        \param[in] paths Precompiled paths to the shader variables of the channels, see createChannelPaths().
+    */
+    void bindChannels(const ShaderVar& var, const RenderData& renderData, const ChannelList& channels, const std::vector<ShaderVarPath>& paths) const;
+
     // Internal state
     Scene::SharedPtr                mpScene;
     CPUSampleGenerator::SharedPtr   mpSampleGenerator;                              ///< Sample generator for camera jitter.
@@ -267,23 +267,19 @@ Program::DefineList VBufferRT::getShaderDefines(const RenderData& renderData) co
 
 void VBufferRT::setShaderData(const ShaderVar& var, const RenderData& renderData)
 {
-    var["gVBufferRT"]["frameDim"] = mFrameDim;
-    var["gVBufferRT"]["frameCount"] = mFrameCount;
+    mFrameDimPath.get(var) = mFrameDim;
+    mFrameCountPath.get(var) = mFrameCount;
 
     // Bind resources.
-    var["gVBuffer"] = getOutput(renderData, kVBufferName);
+    mVBufferPath.get(var) = getOutput(renderData, kVBufferName);
 
     // Bind output channels as UAV buffers.
-    auto bind = [&](const ChannelDesc& channel)
-    {
-        Texture::SharedPtr pTex = getOutput(renderData, channel.name);
-        var[channel.texname] = pTex;
-    };
-    for (const auto& channel : kVBufferExtraChannels) bind(channel);
+    bindChannels(var, renderData, kVBufferExtraChannels, mExtraChannelPaths);
 }
 
 VBufferRT::VBufferRT(const Dictionary& dict)
     : GBufferBase(kInfo)
+    , mExtraChannelPaths(createChannelPaths(kVBufferExtraChannels))
 {
     parseDictionary(dict);
 
@@ -78,4 +78,10 @@ private:
     } mRaytrace;
 
     ComputePass::SharedPtr mpComputePass;
+
+    // Precompiled paths to per-frame shader parameters.
+    ShaderVarPath mFrameDimPath = "gVBufferRT.frameDim";
+    ShaderVarPath mFrameCountPath = "gVBufferRT.frameCount";
+    ShaderVarPath mVBufferPath = "gVBuffer";
+    std::vector<ShaderVarPath> mExtraChannelPaths;
 };
@@ -71,6 +71,7 @@ VBufferRaster::SharedPtr VBufferRaster::create(RenderContext* pRenderContext, co
 
 VBufferRaster::VBufferRaster(const Dictionary& dict)
     : GBufferBase(kInfo)
+    , mExtraChannelPaths(createChannelPaths(kVBufferExtraChannels))
 {
     // Check for required features.
     if (!gpDevice->isFeatureSupported(Device::SupportedFeatures::Barycentrics))
@@ -160,16 +161,14 @@ void VBufferRaster::execute(RenderContext* pRenderContext, const RenderData& ren
     mpFbo->attachColorTarget(pOutput, 0);
     mpFbo->attachDepthStencilTarget(pDepth);
     mRaster.pState->setFbo(mpFbo); // Sets the viewport
-    mRaster.pVars["PerFrameCB"]["gFrameDim"] = mFrameDim;
+    auto var = mRaster.pVars->getRootVar();
+    mFrameDimPath.get(var) = mFrameDim;
 
     // Bind extra channels as UAV buffers.
-    for (const auto& channel : kVBufferExtraChannels)
-    {
-        Texture::SharedPtr pTex = getOutput(renderData, channel.name);
-        mRaster.pVars[channel.texname] = pTex;
-    }
+    bindChannels(var, renderData, kVBufferExtraChannels, mExtraChannelPaths);
 
-    // Rasterize the scene.
+    // Rasterize the scene, culling instances outside the camera frustum.
     RasterizerState::CullMode cullMode = mForceCullMode ? mCullMode : kDefaultCullMode;
-    mpScene->rasterize(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), cullMode);
+    Frustum frustum(mpScene->getCamera()->getViewProjMatrix());
+    mpScene->rasterize(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), frustum, cullMode);
 }
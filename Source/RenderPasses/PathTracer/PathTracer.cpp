@@ -114,6 +114,40 @@ namespace
         { kOutputNRDResidualRadianceHitDist,                "",     "Output residual color (linear) and hit distance", true /* optional */, ResourceFormat::RGBA32Float },
     };
 
+    // Shader variables of the NRD output textures and the corresponding render pass outputs.
+    const std::vector<std::pair<std::string, std::string>> kNRDOutputVars =
+    {
+        { "primaryHitEmission",                     kOutputNRDEmission },
+        { "primaryHitDiffuseReflectance",           kOutputNRDDiffuseReflectance },
+        { "primaryHitSpecularReflectance",          kOutputNRDSpecularReflectance },
+        { "deltaReflectionReflectance",             kOutputNRDDeltaReflectionReflectance },
+        { "deltaReflectionEmission",                kOutputNRDDeltaReflectionEmission },
+        { "deltaReflectionNormWRoughMaterialID",    kOutputNRDDeltaReflectionNormWRoughMaterialID },
+        { "deltaReflectionPathLength",              kOutputNRDDeltaReflectionPathLength },
+        { "deltaReflectionHitDist",                 kOutputNRDDeltaReflectionHitDist },
+        { "deltaTransmissionReflectance",           kOutputNRDDeltaTransmissionReflectance },
+        { "deltaTransmissionEmission",              kOutputNRDDeltaTransmissionEmission },
+        { "deltaTransmissionNormWRoughMaterialID",  kOutputNRDDeltaTransmissionNormWRoughMaterialID },
+        { "deltaTransmissionPathLength",            kOutputNRDDeltaTransmissionPathLength },
+        { "deltaTransmissionPosW",                  kOutputNRDDeltaTransmissionPosW },
+    };
+
+    // Shader variables of the resolve pass output textures and the corresponding render pass outputs.
+    const std::vector<std::pair<std::string, std::string>> kResolvePassOutputVars =
+    {
+        { "outputColor",                                kOutputColor },
+        { "outputAlbedo",                               kOutputAlbedo },
+        { "outputSpecularAlbedo",                       kOutputSpecularAlbedo },
+        { "outputIndirectAlbedo",                       kOutputIndirectAlbedo },
+        { "outputNormal",                               kOutputNormal },
+        { "outputReflectionPosW",                       kOutputReflectionPosW },
+        { "outputNRDDiffuseRadianceHitDist",            kOutputNRDDiffuseRadianceHitDist },
+        { "outputNRDSpecularRadianceHitDist",           kOutputNRDSpecularRadianceHitDist },
+        { "outputNRDDeltaReflectionRadianceHitDist",    kOutputNRDDeltaReflectionRadianceHitDist },
+        { "outputNRDDeltaTransmissionRadianceHitDist",  kOutputNRDDeltaTransmissionRadianceHitDist },
+        { "outputNRDResidualRadianceHitDist",           kOutputNRDResidualRadianceHitDist },
+    };
+
     // UI variables.
     const Gui::DropdownList kColorFormatList =
     {
@@ -913,7 +947,7 @@ void PathTracer::preparePathTracer(const RenderData& renderData)
 
     // Bind resources.
     auto var = mpPathTracerBlock->getRootVar();
-    setShaderData(var, renderData);
+    setShaderData(var, renderData, mPathTracerPaths);
 }
 
 void PathTracer::resetLighting()
@@ -1058,28 +1092,26 @@ void PathTracer::prepareRTXDI(RenderContext* pRenderContext)
     }
 }
 
-void PathTracer::setNRDData(const ShaderVar& var, const RenderData& renderData) const
+PathTracer::ShaderDataPaths::ShaderDataPaths()
+{
+    for (const auto& [name, output] : kNRDOutputVars) nrdOutputs.emplace_back("outputNRD." + name, output);
+}
+
+PathTracer::ResolvePassPaths::ResolvePassPaths()
+{
+    for (const auto& [name, output] : kResolvePassOutputVars) outputs.emplace_back("CB.gResolvePass." + name, output);
+}
+
+void PathTracer::setNRDData(const ShaderVar& var, const RenderData& renderData, const ShaderDataPaths& paths) const
 {
-    var["sampleRadiance"] = mpSampleNRDRadiance;
-    var["sampleHitDist"] = mpSampleNRDHitDist;
-    var["sampleEmission"] = mpSampleNRDEmission;
-    var["sampleReflectance"] = mpSampleNRDReflectance;
-    var["primaryHitEmission"] = renderData.getTexture(kOutputNRDEmission);
-    var["primaryHitDiffuseReflectance"] = renderData.getTexture(kOutputNRDDiffuseReflectance);
-    var["primaryHitSpecularReflectance"] = renderData.getTexture(kOutputNRDSpecularReflectance);
-    var["deltaReflectionReflectance"] = renderData.getTexture(kOutputNRDDeltaReflectionReflectance);
-    var["deltaReflectionEmission"] = renderData.getTexture(kOutputNRDDeltaReflectionEmission);
-    var["deltaReflectionNormWRoughMaterialID"] = renderData.getTexture(kOutputNRDDeltaReflectionNormWRoughMaterialID);
-    var["deltaReflectionPathLength"] = renderData.getTexture(kOutputNRDDeltaReflectionPathLength);
-    var["deltaReflectionHitDist"] = renderData.getTexture(kOutputNRDDeltaReflectionHitDist);
-    var["deltaTransmissionReflectance"] = renderData.getTexture(kOutputNRDDeltaTransmissionReflectance);
-    var["deltaTransmissionEmission"] = renderData.getTexture(kOutputNRDDeltaTransmissionEmission);
-    var["deltaTransmissionNormWRoughMaterialID"] = renderData.getTexture(kOutputNRDDeltaTransmissionNormWRoughMaterialID);
-    var["deltaTransmissionPathLength"] = renderData.getTexture(kOutputNRDDeltaTransmissionPathLength);
-    var["deltaTransmissionPosW"] = renderData.getTexture(kOutputNRDDeltaTransmissionPosW);
+    paths.sampleNRDRadiance.get(var) = mpSampleNRDRadiance;
+    paths.sampleNRDHitDist.get(var) = mpSampleNRDHitDist;
+    paths.sampleNRDEmission.get(var) = mpSampleNRDEmission;
+    paths.sampleNRDReflectance.get(var) = mpSampleNRDReflectance;
+    for (const auto& [path, output] : paths.nrdOutputs) path.get(var) = renderData.getTexture(output);
 }
 
-void PathTracer::setShaderData(const ShaderVar& var, const RenderData& renderData, bool useLightSampling) const
+void PathTracer::setShaderData(const ShaderVar& var, const RenderData& renderData, const ShaderDataPaths& paths, bool useLightSampling) const
 {
     // Bind static resources that don't change per frame.
     if (mVarsChanged)
@@ -1092,7 +1124,7 @@ void PathTracer::setShaderData(const ShaderVar& var, const RenderData& renderDat
     }
 
     // Bind runtime data.
-    setNRDData(var["outputNRD"], renderData);
+    setNRDData(var, renderData, paths);
 
     Texture::SharedPtr pViewDir;
     if (mpScene->getCamera()->getApertureRadius() > 0.f)
@@ -1108,16 +1140,16 @@ void PathTracer::setShaderData(const ShaderVar& var, const RenderData& renderDat
         if (!pSampleCount) throw RuntimeError("PathTracer: Missing sample count input texture");
     }
 
-    var["params"].setBlob(mParams);
-    var["vbuffer"] = renderData.getTexture(kInputVBuffer);
-    var["viewDir"] = pViewDir; // Can be nullptr
-    var["sampleCount"] = pSampleCount; // Can be nullptr
-    var["outputColor"] = renderData.getTexture(kOutputColor);
+    paths.params.get(var).setBlob(mParams);
+    paths.vbuffer.get(var) = renderData.getTexture(kInputVBuffer);
+    paths.viewDir.get(var) = pViewDir; // Can be nullptr
+    paths.sampleCount.get(var) = pSampleCount; // Can be nullptr
+    paths.outputColor.get(var) = renderData.getTexture(kOutputColor);
 
     if (useLightSampling && mpEmissiveSampler)
     {
         // TODO: Do we have to bind this every frame?
-        mpEmissiveSampler->setShaderData(var["emissiveSampler"]);
+        mpEmissiveSampler->setShaderData(paths.emissiveSampler.get(var));
     }
 }
 
@@ -1292,8 +1324,8 @@ void PathTracer::generatePaths(RenderContext* pRenderContext, const RenderData&
     mpGeneratePaths->addDefine("OUTPUT_NRD_ADDITIONAL_DATA", mOutputNRDAdditionalData ? "1" : "0");
 
     // Bind resources.
-    auto var = mpGeneratePaths->getRootVar()["CB"]["gPathGenerator"];
-    setShaderData(var, renderData, false);
+    auto var = mPathGeneratorPath.get(mpGeneratePaths->getRootVar());
+    setShaderData(var, renderData, mGeneratePathsPaths, false);
 
     mpGeneratePaths["gScene"] = mpScene->getParameterBlock();
 
@@ -1350,23 +1382,14 @@ void PathTracer::resolvePass(RenderContext* pRenderContext, const RenderData& re
     mpResolvePass->addDefine("OUTPUT_NRD_DATA", mOutputNRDData ? "1" : "0");
 
     // Bind resources.
-    auto var = mpResolvePass->getRootVar()["CB"]["gResolvePass"];
-    var["params"].setBlob(mParams);
-    var["sampleCount"] = renderData.getTexture(kInputSampleCount); // Can be nullptr
-    var["outputColor"] = renderData.getTexture(kOutputColor);
-    var["outputAlbedo"] = renderData.getTexture(kOutputAlbedo);
-    var["outputSpecularAlbedo"] = renderData.getTexture(kOutputSpecularAlbedo);
-    var["outputIndirectAlbedo"] = renderData.getTexture(kOutputIndirectAlbedo);
-    var["outputNormal"] = renderData.getTexture(kOutputNormal);
-    var["outputReflectionPosW"] = renderData.getTexture(kOutputReflectionPosW);
-    var["outputNRDDiffuseRadianceHitDist"] = renderData.getTexture(kOutputNRDDiffuseRadianceHitDist);
-    var["outputNRDSpecularRadianceHitDist"] = renderData.getTexture(kOutputNRDSpecularRadianceHitDist);
-    var["outputNRDDeltaReflectionRadianceHitDist"] = renderData.getTexture(kOutputNRDDeltaReflectionRadianceHitDist);
-    var["outputNRDDeltaTransmissionRadianceHitDist"] = renderData.getTexture(kOutputNRDDeltaTransmissionRadianceHitDist);
-    var["outputNRDResidualRadianceHitDist"] = renderData.getTexture(kOutputNRDResidualRadianceHitDist);
+    auto rootVar = mpResolvePass->getRootVar();
+    mResolvePassPaths.params.get(rootVar).setBlob(mParams);
+    mResolvePassPaths.sampleCount.get(rootVar) = renderData.getTexture(kInputSampleCount); // Can be nullptr
+    for (const auto& [path, output] : mResolvePassPaths.outputs) path.get(rootVar) = renderData.getTexture(output);
 
     if (mVarsChanged)
     {
+        auto var = rootVar["CB"]["gResolvePass"];
         var["sampleOffset"] = mpSampleOffset; // Can be nullptr
         var["sampleColor"] = mpSampleColor;
         var["sampleGuideData"] = mpSampleGuideData;
@@ -28,6 +28,7 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderGraph/RenderPassHelpers.h"
+#include "Core/Program/ShaderVarPath.h"
 #include "Utils/Debug/PixelDebug.h"
 #include "Utils/Sampling/SampleGenerator.h"
 #include "Rendering/Lights/LightBVHSampler.h"
@@ -77,6 +78,37 @@ private:
         void prepareProgram(const Program::DefineList& defines);
     };
 
+    /** Precompiled paths to the path tracer parameters that are set per frame.
+        The paths cache offsets for the shader variable they are applied to, so a separate instance is used per binding target.
+    */
+    struct ShaderDataPaths
+    {
+        ShaderVarPath params = "params";
+        ShaderVarPath vbuffer = "vbuffer";
+        ShaderVarPath viewDir = "viewDir";
+        ShaderVarPath sampleCount = "sampleCount";
+        ShaderVarPath outputColor = "outputColor";
+        ShaderVarPath emissiveSampler = "emissiveSampler";
+        ShaderVarPath sampleNRDRadiance = "outputNRD.sampleRadiance";
+        ShaderVarPath sampleNRDHitDist = "outputNRD.sampleHitDist";
+        ShaderVarPath sampleNRDEmission = "outputNRD.sampleEmission";
+        ShaderVarPath sampleNRDReflectance = "outputNRD.sampleReflectance";
+        std::vector<std::pair<ShaderVarPath, std::string>> nrdOutputs;  ///< Paths to the NRD output textures and the names of the corresponding render pass outputs.
+
+        ShaderDataPaths();
+    };
+
+    /** Precompiled paths to the resolve pass parameters that are set per frame.
+    */
+    struct ResolvePassPaths
+    {
+        ShaderVarPath params = "CB.gResolvePass.params";
+        ShaderVarPath sampleCount = "CB.gResolvePass.sampleCount";
+        std::vector<std::pair<ShaderVarPath, std::string>> outputs;     ///< Paths to the output textures and the names of the corresponding render pass outputs.
+
+        ResolvePassPaths();
+    };
+
     PathTracer(const Dictionary& dict);
 
     void parseDictionary(const Dictionary& dict);
@@ -89,8 +121,8 @@ private:
     void prepareMaterials(RenderContext* pRenderContext);
     bool prepareLighting(RenderContext* pRenderContext);
     void prepareRTXDI(RenderContext* pRenderContext);
-    void setNRDData(const ShaderVar& var, const RenderData& renderData) const;
-    void setShaderData(const ShaderVar& var, const RenderData& renderData, bool useLightSampling = true) const;
+    void setNRDData(const ShaderVar& var, const RenderData& renderData, const ShaderDataPaths& paths) const;
+    void setShaderData(const ShaderVar& var, const RenderData& renderData, const ShaderDataPaths& paths, bool useLightSampling = true) const;
     bool renderRenderingUI(Gui::Widgets& widget);
     bool renderDebugUI(Gui::Widgets& widget);
     void renderStatsUI(Gui::Widgets& widget);
@@ -173,6 +205,11 @@ private:
     ComputePass::SharedPtr          mpResolvePass;              ///< Sample resolve pass.
     ComputePass::SharedPtr          mpReflectTypes;             ///< Helper for reflecting structured buffer types.
 
+    ShaderDataPaths                 mPathTracerPaths;           ///< Precompiled paths to the per-frame parameters in the path tracer parameter block.
+    ShaderDataPaths                 mGeneratePathsPaths;        ///< Precompiled paths to the per-frame parameters of the path generation pass.
+    ShaderVarPath                   mPathGeneratorPath = "CB.gPathGenerator"; ///< Precompiled path to the path generator in the path generation pass.
+    ResolvePassPaths                mResolvePassPaths;          ///< Precompiled paths to the per-frame parameters of the resolve pass.
+
     std::unique_ptr<TracePass>      mpTracePass;                ///< Main trace pass.
     std::unique_ptr<TracePass>      mpTraceDeltaReflectionPass; ///< Delta reflection trace pass (for NRD).
     std::unique_ptr<TracePass>      mpTraceDeltaTransmissionPass;   ///< Delta transmission trace pass (for NRD).
@@ -255,8 +255,8 @@ void TestRtProgram::renderUI(Gui::Widgets& widget)
 
     if (mMode == 0)
     {
-        auto primCount = mpScene->getCustomPrimitiveCount();
-        widget.text("Custom primitives: " + std::to_string(primCount));
+        auto primCount = mpScene->getCustomPrimitiveSlotCount();
+        widget.text("Custom primitives: " + std::to_string(mpScene->getCustomPrimitiveCount()) + " (" + std::to_string(primCount) + " slots)");
 
         mSelectedIdx = std::min(mSelectedIdx, primCount - 1);
         widget.text("\nSelected primitive:");
@@ -273,7 +273,7 @@ void TestRtProgram::renderUI(Gui::Widgets& widget)
             addCustomPrimitive();
         }
 
-        if (primCount > 0)
+        if (primCount > 0 && mpScene->isCustomPrimitiveActive(mSelectedIdx))
         {
             if (widget.button("Remove", true))
             {
@@ -319,13 +319,14 @@ void TestRtProgram::removeCustomPrimitive(uint32_t index)
         return;
     }
 
-    if (index >= mpScene->getCustomPrimitiveCount())
+    if (index >= mpScene->getCustomPrimitiveSlotCount())
     {
         logWarning("Custom primitive index is out of range. Ignoring call to removeCustomPrimitive()");
         return;
     }
 
     mpScene->removeCustomPrimitive(index);
+    mPrevSelectedIdx = -1; // Refresh the selected AABB.
 }
 
 void TestRtProgram::moveCustomPrimitive()
@@ -336,15 +337,17 @@ void TestRtProgram::moveCustomPrimitive()
         return;
     }
 
-    uint32_t primCount = mpScene->getCustomPrimitiveCount();
-    if (primCount == 0)
+    uint32_t primCount = mpScene->getCustomPrimitiveSlotCount();
+    if (mpScene->getCustomPrimitiveCount() == 0)
     {
         logWarning("Scene has no custom primitives. Ignoring call to moveCustomPrimitive()");
         return;
     }
 
+    // Pick a random primitive that has not been removed.
     std::uniform_real_distribution<float> u(0.f, 1.f);
     uint32_t index = std::min((uint32_t)(u(rng) * primCount), primCount - 1);
+    while (!mpScene->isCustomPrimitiveActive(index)) index = (index + 1) % primCount;
 
     AABB aabb = mpScene->getCustomPrimitiveAABB(index);
     float3 d = float3(u(rng), u(rng), u(rng)) * 2.f - 1.f;
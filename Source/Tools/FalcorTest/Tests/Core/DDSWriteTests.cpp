@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using CompressionMode = ImageIO::CompressionMode;
+        using CompressionQuality = ImageIO::CompressionQuality;
+
+        struct BCFormat
+        {
+            const char* name;
+            CompressionMode mode;
+            ResourceFormat srcFormat;
+        };
+
+        const BCFormat kBCFormats[] =
+        {
+            { "BC1", CompressionMode::BC1, ResourceFormat::RGBA8Unorm },
+            { "BC3", CompressionMode::BC3, ResourceFormat::RGBA8Unorm },
+            { "BC4", CompressionMode::BC4, ResourceFormat::RGBA8Unorm },
+            { "BC5", CompressionMode::BC5, ResourceFormat::RG8Unorm },
+            { "BC6", CompressionMode::BC6, ResourceFormat::RGBA32Float },
+            { "BC7", CompressionMode::BC7, ResourceFormat::RGBA8Unorm },
+        };
+
+        const uint32_t kBenchmarkSize = 2048;
+
+        /** Create a test image with smooth gradients and some noise.
+        */
+        Bitmap::UniqueConstPtr createTestImage(uint32_t width, uint32_t height, ResourceFormat format)
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+            uint32_t channelCount = getFormatChannelCount(format);
+            bool isFloat = getFormatType(format) == FormatType::Float;
+            std::vector<uint8_t> data(getFormatBytesPerBlock(format) * width * height);
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float4 c = float4(float(x) / width, float(y) / height, 0.5f + 0.5f * std::sin(0.05f * (x + y)), 1.f);
+                    for (uint32_t i = 0; i < channelCount; i++)
+                    {
+                        float v = std::clamp(c[i] + noise(rng), 0.f, 1.f);
+                        size_t index = size_t(y * width + x) * channelCount + i;
+                        if (isFloat) reinterpret_cast<float*>(data.data())[index] = 4.f * v;
+                        else data[index] = uint8_t(v * 255.f + 0.5f);
+                    }
+                }
+            }
+
+            return Bitmap::create(width, height, format, data.data());
+        }
+
+        std::filesystem::path getTempPath(const char* name)
+        {
+            return std::filesystem::temp_directory_path() / (std::string("FalcorDDSWriteTest_") + name + ".dds");
+        }
+    }
+
+    CPU_TEST(DDSWrite_BlockCompressed)
+    {
+        // Use a height that is not a multiple of the band height to test the last partial band.
+        const uint32_t width = 320;
+        const uint32_t height = 200;
+
+        for (const auto& bc : kBCFormats)
+        {
+            auto pSrc = createTestImage(width, height, bc.srcFormat);
+            auto path = getTempPath(bc.name);
+
+            for (auto quality : { CompressionQuality::Fast, CompressionQuality::High })
+            {
+                ImageIO::saveToDDS(path, *pSrc, bc.mode, false, quality);
+
+                auto pBitmap = ImageIO::loadBitmapFromDDS(path);
+                EXPECT(pBitmap != nullptr) << bc.name;
+                if (!pBitmap) continue;
+
+                EXPECT(isCompressedFormat(pBitmap->getFormat())) << bc.name;
+                EXPECT_EQ(pBitmap->getWidth(), width) << bc.name;
+                EXPECT_EQ(pBitmap->getHeight(), height) << bc.name;
+                EXPECT_EQ(pBitmap->getSize(), size_t(getFormatBytesPerBlock(pBitmap->getFormat())) * (width / 4) * (height / 4)) << bc.name;
+            }
+
+            std::filesystem::remove(path);
+        }
+    }
+
+    CPU_TEST(DDSWrite_Mips)
+    {
+        auto pSrc = createTestImage(256, 256, ResourceFormat::RGBA8Unorm);
+        auto path = getTempPath("Mips");
+
+        ImageIO::saveToDDS(path, *pSrc, CompressionMode::BC1, true, CompressionQuality::Fast);
+
+        // 9 mip levels of BC1, the smallest ones are padded to a single block.
+        size_t expectedSize = 0;
+        for (uint32_t size = 256; size > 0; size /= 2) expectedSize += size_t(8) * std::max(1u, size / 4) * std::max(1u, size / 4);
+        const size_t headerSize = 4 + 124;
+        EXPECT_EQ(std::filesystem::file_size(path), headerSize + expectedSize);
+
+        std::filesystem::remove(path);
+    }
+
+    CPU_TEST(DDSWrite_Benchmark, "Benchmark, run manually")
+    {
+        for (const auto& bc : kBCFormats)
+        {
+            auto pSrc = createTestImage(kBenchmarkSize, kBenchmarkSize, bc.srcFormat);
+            auto path = getTempPath(bc.name);
+
+            for (auto quality : { CompressionQuality::Fast, CompressionQuality::Normal })
+            {
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                ImageIO::saveToDDS(path, *pSrc, bc.mode, true, quality);
+                double timeInMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+                // Count all mip levels in the throughput.
+                double megaPixels = 4.0 / 3.0 * kBenchmarkSize * kBenchmarkSize * 1e-6;
+                logInfo("DDSWrite: {} {} {}x{} with mips: {:.1f} ms, {:.1f} MPixels/s.",
+                    bc.name, quality == CompressionQuality::Fast ? "fast" : "normal", kBenchmarkSize, kBenchmarkSize, timeInMs, megaPixels / (timeInMs * 1e-3));
+                EXPECT(std::filesystem::exists(path)) << bc.name;
+            }
+
+            std::filesystem::remove(path);
+        }
+    }
+}
@@ -0,0 +1,271 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/API/GpuMemoryHeap.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const size_t kPageSize = 1024;
+
+        /** Fence that is signaled from the test instead of a GPU queue.
+        */
+        struct MockFence
+        {
+            std::atomic<uint64_t> cpuValue = 1;
+            std::atomic<uint64_t> gpuValue = 0;
+
+            void signal() { gpuValue = cpuValue++; }
+        };
+
+        /** Pages backed by CPU memory.
+        */
+        struct MockPages
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<uint8_t[]>> storage;
+        };
+
+        GpuMemoryHeap::SharedPtr createHeap(MockFence& fence, MockPages& pages)
+        {
+            GpuMemoryHeap::Backend backend;
+            backend.getCpuFenceValue = [&fence]() { return fence.cpuValue.load(); };
+            backend.getGpuFenceValue = [&fence]() { return fence.gpuValue.load(); };
+            backend.createPage = [&pages](GpuMemoryHeap::BaseData& data, size_t size)
+            {
+                std::lock_guard<std::mutex> lock(pages.mutex);
+                pages.storage.push_back(std::make_unique<uint8_t[]>(size));
+                data.offset = 0;
+                data.pData = pages.storage.back().get();
+            };
+            return GpuMemoryHeap::create(GpuMemoryHeap::Type::Upload, kPageSize, backend);
+        }
+    }
+
+    CPU_TEST(GpuMemoryHeap_SizeClasses)
+    {
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(3), 3u);
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(1024), 1024u);
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(1025), 1280u);
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(1280), 1280u);
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(1281), 1536u);
+        EXPECT_EQ(GpuMemoryHeap::getLargePageSizeClass(2000), 2048u);
+
+        // Size classes waste at most 25%.
+        for (size_t size = 5; size < 100000; size += 37)
+        {
+            size_t sizeClass = GpuMemoryHeap::getLargePageSizeClass(size);
+            EXPECT_GE(sizeClass, size);
+            EXPECT_LE(sizeClass, size + size / 4);
+        }
+    }
+
+    CPU_TEST(GpuMemoryHeap_Pages)
+    {
+        MockFence fence;
+        MockPages pages;
+        auto pHeap = createHeap(fence, pages);
+
+        // Three allocations fit in the first page, the fourth starts a new page.
+        std::vector<GpuMemoryHeap::Allocation> allocations;
+        for (uint32_t i = 0; i < 4; i++) allocations.push_back(pHeap->allocate(300, 4));
+        EXPECT_EQ(pages.storage.size(), 2u);
+        EXPECT_EQ(allocations[0].pageID, allocations[2].pageID);
+        EXPECT_NE(allocations[2].pageID, allocations[3].pageID);
+        EXPECT_EQ(allocations[1].offset, 300u);
+        EXPECT(allocations[1].pData == allocations[0].pData + 300);
+        EXPECT_EQ(allocations[0].fenceValue, fence.cpuValue.load());
+
+        // Releases are deferred until the GPU has passed the fence.
+        for (auto& allocation : allocations) pHeap->release(allocation);
+        pHeap->executeDeferredReleases();
+        EXPECT_EQ(pHeap->getStats().availablePageCount, 0u);
+
+        // The retired page is recycled, the active page stays in use.
+        fence.signal();
+        pHeap->executeDeferredReleases();
+        auto stats = pHeap->getStats();
+        EXPECT_EQ(stats.pageCount, 2u);
+        EXPECT_EQ(stats.availablePageCount, 1u);
+
+        // An allocation not fitting the active page reuses the recycled page.
+        auto allocation = pHeap->allocate(800);
+        EXPECT_EQ(pages.storage.size(), 2u);
+        EXPECT(allocation.pData == allocations[0].pData);
+        EXPECT_EQ(pHeap->getStats().availablePageCount, 1u);
+    }
+
+    CPU_TEST(GpuMemoryHeap_LargePages)
+    {
+        MockFence fence;
+        MockPages pages;
+        auto pHeap = createHeap(fence, pages);
+
+        auto a = pHeap->allocate(5000);
+        EXPECT_EQ(a.pageID, GpuMemoryHeap::Allocation::kMegaPageId);
+        EXPECT_EQ(a.pageSize, 5120u);
+        EXPECT_EQ(pages.storage.size(), 1u);
+
+        // A large page in flight is not reused.
+        auto b = pHeap->allocate(4500);
+        EXPECT_EQ(pages.storage.size(), 2u);
+        EXPECT(a.pData != b.pData);
+
+        pHeap->release(a);
+        pHeap->executeDeferredReleases();
+        EXPECT_EQ(pHeap->getStats().pooledLargePageCount, 0u);
+
+        // Once the fence has passed, the page is pooled and reused by allocations of the same size class.
+        fence.signal();
+        pHeap->executeDeferredReleases();
+        EXPECT_EQ(pHeap->getStats().pooledLargePageCount, 1u);
+        EXPECT_EQ(pHeap->getStats().pooledLargePageBytes, 5120u);
+
+        auto c = pHeap->allocate(4200);
+        EXPECT_EQ(pages.storage.size(), 2u);
+        EXPECT(c.pData == a.pData);
+        EXPECT_EQ(c.fenceValue, fence.cpuValue.load());
+
+        // A different size class creates a new page.
+        auto d = pHeap->allocate(9000);
+        EXPECT_EQ(pages.storage.size(), 3u);
+
+        auto stats = pHeap->getStats();
+        EXPECT_EQ(stats.largePagesCreated, 3u);
+        EXPECT_EQ(stats.largePagesReused, 1u);
+        EXPECT_EQ(stats.largePageCount, 3u);
+
+        // Pages exceeding the pool budget are freed.
+        pHeap->setLargePagePoolBudget(6000);
+        pHeap->release(b);
+        pHeap->release(c);
+        pHeap->release(d);
+        fence.signal();
+        pHeap->executeDeferredReleases();
+        stats = pHeap->getStats();
+        EXPECT_EQ(stats.largePageCount, 0u);
+        EXPECT_EQ(stats.pooledLargePageCount, 1u);
+        EXPECT_LE(stats.pooledLargePageBytes, 6000u);
+
+        pHeap->trimLargePagePool();
+        EXPECT_EQ(pHeap->getStats().pooledLargePageCount, 0u);
+    }
+
+    CPU_TEST(GpuMemoryHeap_Threads)
+    {
+        const uint32_t kThreadCount = 8;
+        const uint32_t kAllocationsPerThread = 1000;
+
+        MockFence fence;
+        MockPages pages;
+        auto pHeap = createHeap(fence, pages);
+
+        // Each thread fills its allocations with its index.
+        std::vector<std::vector<GpuMemoryHeap::Allocation>> allocations(kThreadCount);
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kThreadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (uint32_t i = 0; i < kAllocationsPerThread; i++)
+                {
+                    size_t size = 16 + (i * 7 + t * 13) % 200;
+                    if (i % 100 == 0) size = 2000 + t;
+                    auto allocation = pHeap->allocate(size, 16);
+                    std::fill(allocation.pData, allocation.pData + size, uint8_t(t));
+                    allocations[t].push_back(allocation);
+
+                    // Release some allocations as we go to exercise recycling.
+                    if (i % 3 == 0)
+                    {
+                        pHeap->release(allocations[t][i / 3]);
+                        fence.signal();
+                        pHeap->executeDeferredReleases();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        // Allocations that were never released must still hold the data written by their thread.
+        for (uint32_t t = 0; t < kThreadCount; t++)
+        {
+            size_t releasedCount = (kAllocationsPerThread + 2) / 3;
+            for (size_t i = releasedCount; i < allocations[t].size(); i++)
+            {
+                const auto& allocation = allocations[t][i];
+                size_t size = allocation.pageID == GpuMemoryHeap::Allocation::kMegaPageId ? 2000 + t : 16 + (i * 7 + t * 13) % 200;
+                bool valid = std::all_of(allocation.pData, allocation.pData + size, [t](uint8_t v) { return v == t; });
+                EXPECT(valid) << "thread " << t << ", allocation " << i;
+            }
+
+            // Small allocations of different threads never share a page.
+            for (uint32_t u = t + 1; u < kThreadCount; u++)
+            {
+                if (allocations[t][1].pageID == allocations[u][1].pageID) EXPECT(false) << "threads " << t << " and " << u << " share a page";
+            }
+        }
+    }
+
+    CPU_TEST(GpuMemoryHeap_ExitedThreads)
+    {
+        MockFence fence;
+        MockPages pages;
+        auto pHeap = createHeap(fence, pages);
+
+        auto mainAllocation = pHeap->allocate(100);
+        EXPECT_EQ(pHeap->getStats().threadAllocatorCount, 1u);
+
+        // Short-lived threads allocate from their own pages.
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            std::thread thread([&]()
+            {
+                auto allocation = pHeap->allocate(100);
+                pHeap->release(allocation);
+            });
+            thread.join();
+        }
+
+        // Once the fence has passed, the pages of the exited threads are recycled and their allocators are dropped.
+        fence.signal();
+        pHeap->executeDeferredReleases();
+        auto stats = pHeap->getStats();
+        EXPECT_EQ(stats.threadAllocatorCount, 1u);
+        EXPECT_EQ(stats.pageCount, stats.availablePageCount + 1);
+
+        // The active page of the main thread stays in use.
+        auto allocation = pHeap->allocate(100);
+        EXPECT_EQ(allocation.pageID, mainAllocation.pageID);
+    }
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ShaderVarPath.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        bool isValidPath(const std::string& path)
+        {
+            try
+            {
+                ShaderVarPath p(path);
+                return true;
+            }
+            catch (const ArgumentError&)
+            {
+                return false;
+            }
+        }
+    }
+
+    CPU_TEST(ShaderVarPath_Parse)
+    {
+        EXPECT(isValidPath(""));
+        EXPECT(isValidPath("CB.items[2].value"));
+        EXPECT(isValidPath("[3][1].value"));
+        EXPECT(!isValidPath("CB..value"));
+        EXPECT(!isValidPath("CB.items[].value"));
+        EXPECT(!isValidPath("CB.items[x]"));
+        EXPECT(!isValidPath("CB.items[2"));
+        EXPECT(!isValidPath("CB."));
+    }
+
+    /** Test that paths are resolved correctly and re-resolved when the program layout changes.
+    */
+    GPU_TEST(ShaderVarPath)
+    {
+        ShaderVarPath countPath("CB.count");
+        ShaderVarPath itemPath("CB.items[2].value");
+        ShaderVarPath itemsPath("CB.items");
+        ShaderVarPath blockPath("gBlock.b");
+        ShaderVarPath invalidPath("CB.items[4].value");
+
+        for (bool usePadding : { false, true, false })
+        {
+            Program::DefineList defines = { { "USE_PADDING", usePadding ? "1" : "0" } };
+            ctx.createProgram("Tests/Core/ShaderVarPathTests.cs.slang", "main", defines);
+            ctx.allocateStructuredBuffer("result", 7);
+
+            auto pBlockReflection = ctx.getProgram()->getReflector()->getParameterBlock("gBlock");
+            auto pParamBlock = ParameterBlock::create(pBlockReflection);
+            ctx["gBlock"] = pParamBlock;
+
+            // Resolve twice to also exercise the cached offsets.
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                ShaderVar var = ctx.vars().getRootVar();
+                countPath.get(var) = 3u + i;
+                auto itemsVar = itemsPath.get(var);
+                for (uint32_t j = 0; j < 4; j++) itemsVar[j]["value"] = float(j);
+                itemPath.get(var) = 10.f + i;
+                ShaderVarPath("gBlock.a").get(var) = 0.5f;
+                blockPath.get(var) = float3(1.f, 2.f + i, 3.f);
+                EXPECT(!invalidPath.find(var).isValid());
+            }
+
+            ctx.runProgram(1, 1, 1);
+
+            const float* result = ctx.mapBuffer<const float>("result");
+            EXPECT_EQ(result[0], 4.f);
+            EXPECT_EQ(result[1], 0.f);
+            EXPECT_EQ(result[2], 1.f);
+            EXPECT_EQ(result[3], 11.f);
+            EXPECT_EQ(result[4], 3.f);
+            EXPECT_EQ(result[5], 0.5f);
+            EXPECT_EQ(result[6], 3.f);
+            ctx.unmapBuffer("result");
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraph.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const RenderPass::Info kMockPassInfo { "MockPass", "Pass counting reflect and compile calls." };
+        const uint32_t kTextureSize = 16;
+
+        /** Pass with an optional input, an output and a history texture, counting calls by the graph compiler.
+        */
+        class MockPass : public RenderPass
+        {
+        public:
+            using SharedPtr = std::shared_ptr<MockPass>;
+
+            static SharedPtr create(bool hasInput) { return SharedPtr(new MockPass(hasInput)); }
+
+            RenderPassReflection reflect(const CompileData& compileData) override
+            {
+                mReflectCount++;
+                RenderPassReflection reflector;
+                if (mHasInput) reflector.addInput("src", "Input").texture2D(kTextureSize, kTextureSize);
+                reflector.addOutput("dst", "Output").texture2D(kTextureSize, kTextureSize).format(mFormat);
+                reflector.addInternal("history", "History").texture2D(kTextureSize, kTextureSize).format(ResourceFormat::R32Float);
+                return reflector;
+            }
+
+            void compile(RenderContext* pRenderContext, const CompileData& compileData) override { mCompileCount++; }
+            void execute(RenderContext* pRenderContext, const RenderData& renderData) override {}
+
+            void setFormat(ResourceFormat format)
+            {
+                mFormat = format;
+                requestRecompile();
+            }
+
+            uint32_t getReflectCount() const { return mReflectCount; }
+            uint32_t getCompileCount() const { return mCompileCount; }
+
+        private:
+            MockPass(bool hasInput) : RenderPass(kMockPassInfo), mHasInput(hasInput) {}
+
+            bool mHasInput;
+            ResourceFormat mFormat = ResourceFormat::RGBA8Unorm;
+            uint32_t mReflectCount = 0;
+            uint32_t mCompileCount = 0;
+        };
+
+        /** Creates the graph A -> B -> C with the outputs of B and C marked as graph outputs.
+        */
+        RenderGraph::SharedPtr createChainGraph(std::vector<MockPass::SharedPtr>& passes, ResourceFormat formatC)
+        {
+            auto pGraph = RenderGraph::create("Chain");
+            passes = { MockPass::create(false), MockPass::create(true), MockPass::create(true) };
+            passes[2]->setFormat(formatC);
+            pGraph->addPass(passes[0], "A");
+            pGraph->addPass(passes[1], "B");
+            pGraph->addPass(passes[2], "C");
+            pGraph->addEdge("A.dst", "B.src");
+            pGraph->addEdge("B.dst", "C.src");
+            pGraph->markOutput("B.dst");
+            pGraph->markOutput("C.dst");
+            return pGraph;
+        }
+
+        bool isSameDesc(const Resource::SharedPtr& pA, const Resource::SharedPtr& pB)
+        {
+            if (!pA || !pB) return false;
+            auto pTexA = pA->asTexture();
+            auto pTexB = pB->asTexture();
+            return pTexA->getFormat() == pTexB->getFormat() && pTexA->getWidth() == pTexB->getWidth() && pTexA->getHeight() == pTexB->getHeight() && pTexA->getBindFlags() == pTexB->getBindFlags();
+        }
+    }
+
+    GPU_TEST(RenderGraphCompiler_Incremental)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        std::vector<MockPass::SharedPtr> passes;
+        auto pGraph = createChainGraph(passes, ResourceFormat::RGBA8Unorm);
+        EXPECT(pGraph->compile(pRenderContext));
+        for (const auto& pPass : passes)
+        {
+            EXPECT_EQ(pPass->getReflectCount(), 1u);
+            EXPECT_EQ(pPass->getCompileCount(), 1u);
+        }
+        Resource::SharedPtr pOutputB = pGraph->getOutput("B.dst");
+        Resource::SharedPtr pOutputC = pGraph->getOutput("C.dst");
+
+        // Changing the output format of C only reflects and compiles C again. B keeps its resources.
+        passes[2]->setFormat(ResourceFormat::RGBA16Float);
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(passes[0]->getReflectCount(), 1u);
+        EXPECT_EQ(passes[0]->getCompileCount(), 1u);
+        EXPECT_EQ(passes[1]->getReflectCount(), 1u);
+        EXPECT_EQ(passes[1]->getCompileCount(), 1u);
+        EXPECT_EQ(passes[2]->getReflectCount(), 2u);
+        EXPECT_EQ(passes[2]->getCompileCount(), 2u);
+        EXPECT(pGraph->getOutput("B.dst") == pOutputB);
+        EXPECT(pGraph->getOutput("C.dst") != pOutputC);
+
+        // The result matches a full compilation of the same graph.
+        std::vector<MockPass::SharedPtr> referencePasses;
+        auto pReferenceGraph = createChainGraph(referencePasses, ResourceFormat::RGBA16Float);
+        EXPECT(pReferenceGraph->compile(pRenderContext));
+        EXPECT(isSameDesc(pGraph->getOutput("B.dst"), pReferenceGraph->getOutput("B.dst")));
+        EXPECT(isSameDesc(pGraph->getOutput("C.dst"), pReferenceGraph->getOutput("C.dst")));
+
+        // Adding a pass compiles the new pass and the pass it connects to, but doesn't reflect existing passes.
+        auto pPassD = MockPass::create(true);
+        pGraph->addPass(pPassD, "D");
+        pGraph->addEdge("C.dst", "D.src");
+        pGraph->markOutput("D.dst");
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(passes[0]->getReflectCount(), 1u);
+        EXPECT_EQ(passes[1]->getReflectCount(), 1u);
+        EXPECT_EQ(passes[1]->getCompileCount(), 1u);
+        EXPECT_EQ(passes[2]->getReflectCount(), 2u);
+        EXPECT_EQ(passes[2]->getCompileCount(), 3u);
+        EXPECT_EQ(pPassD->getReflectCount(), 1u);
+        EXPECT_EQ(pPassD->getCompileCount(), 1u);
+        EXPECT(pGraph->getOutput("B.dst") == pOutputB);
+    }
+}
@@ -0,0 +1,257 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/EnvMapImportanceMap.h"
+#include "Rendering/Lights/EnvMapSampler.h"
+#include "Scene/Lights/EnvMap.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        EnvMapImportanceMap::EnvMapData createRandomEnvMap(std::mt19937& rng, uint32_t width, uint32_t height)
+        {
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            EnvMapImportanceMap::EnvMapData envMap;
+            envMap.width = width;
+            envMap.height = height;
+            envMap.texels.resize((size_t)width * height);
+            for (auto& texel : envMap.texels) texel = float3(u(rng), u(rng), u(rng));
+            return envMap;
+        }
+
+        EnvMapImportanceMap createRandomImportanceMap(std::mt19937& rng, uint32_t dimension)
+        {
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            std::vector<float> baseLevel((size_t)dimension * dimension);
+            for (auto& value : baseLevel) value = u(rng);
+            return EnvMapImportanceMap::createFromBaseLevel(dimension, std::move(baseLevel));
+        }
+    }
+
+    CPU_TEST(EnvMapImportanceMap_SampleEnvMap)
+    {
+        EnvMapImportanceMap::EnvMapData envMap;
+        envMap.width = 2;
+        envMap.height = 2;
+        envMap.texels = { float3(0.f), float3(1.f), float3(2.f), float3(3.f) };
+
+        // Texel centers.
+        EXPECT_EQ(envMap.sample(float2(0.25f, 0.25f)).x, 0.f);
+        EXPECT_EQ(envMap.sample(float2(0.75f, 0.75f)).x, 3.f);
+
+        // Bilinear interpolation between texel centers.
+        EXPECT_EQ(envMap.sample(float2(0.5f, 0.25f)).x, 0.5f);
+        EXPECT_EQ(envMap.sample(float2(0.5f, 0.5f)).x, 1.5f);
+
+        // Wrap in U, clamp in V.
+        EXPECT_EQ(envMap.sample(float2(0.f, 0.25f)).x, 0.5f);
+        EXPECT_EQ(envMap.sample(float2(0.25f, 0.f)).x, 0.f);
+        EXPECT_EQ(envMap.sample(float2(0.25f, 1.f)).x, 2.f);
+    }
+
+    CPU_TEST(EnvMapImportanceMap_BuildConstant)
+    {
+        EnvMapImportanceMap::EnvMapData envMap;
+        envMap.width = 16;
+        envMap.height = 8;
+        envMap.texels.assign(16 * 8, float3(0.5f, 1.f, 2.f));
+        const float L = luminance(float3(0.5f, 1.f, 2.f));
+
+        auto importanceMap = EnvMapImportanceMap::build(envMap, 32, 16);
+        EXPECT_EQ(importanceMap.getDimension(), 32u);
+        EXPECT_EQ(importanceMap.getMipCount(), 6u);
+
+        for (uint32_t mip = 0; mip < importanceMap.getMipCount(); mip++)
+        {
+            for (float value : importanceMap.getMip(mip)) EXPECT_LE(std::abs(value - L), 1e-5f * L) << "mip " << mip;
+        }
+    }
+
+    CPU_TEST(EnvMapImportanceMap_Hierarchy)
+    {
+        std::mt19937 rng(1);
+        auto importanceMap = createRandomImportanceMap(rng, 16);
+        EXPECT_EQ(importanceMap.getMipCount(), 5u);
+
+        double sum = 0.0;
+        for (float value : importanceMap.getMip(0)) sum += value;
+        EXPECT_LE(std::abs(importanceMap.getAverage() - (float)(sum / 256.0)), 1e-5f);
+
+        for (uint32_t mip = 1; mip < importanceMap.getMipCount(); mip++)
+        {
+            uint32_t dim = 16 >> mip;
+            EXPECT_EQ(importanceMap.getMip(mip).size(), (size_t)dim * dim);
+            for (uint32_t y = 0; y < dim; y++)
+            {
+                for (uint32_t x = 0; x < dim; x++)
+                {
+                    float expected = 0.25f * (importanceMap.getValue(mip - 1, 2 * x, 2 * y) + importanceMap.getValue(mip - 1, 2 * x + 1, 2 * y) +
+                        importanceMap.getValue(mip - 1, 2 * x, 2 * y + 1) + importanceMap.getValue(mip - 1, 2 * x + 1, 2 * y + 1));
+                    EXPECT_EQ(importanceMap.getValue(mip, x, y), expected);
+                }
+            }
+        }
+
+        auto packed = importanceMap.getPackedMips();
+        EXPECT_EQ(packed.size(), (size_t)(256 + 64 + 16 + 4 + 1));
+        EXPECT_EQ(packed.back(), importanceMap.getAverage());
+    }
+
+    CPU_TEST(EnvMapImportanceMap_Sample)
+    {
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        const uint32_t dim = 8;
+        auto importanceMap = createRandomImportanceMap(rng, dim);
+
+        // The sampled texel frequencies should follow the pdf, and the returned pdf should match evalPdf().
+        const uint32_t kSampleCount = 1 << 20;
+        std::vector<uint32_t> histogram(dim * dim, 0);
+        for (uint32_t i = 0; i < kSampleCount; i++)
+        {
+            float pdf = 0.f;
+            float2 uv = importanceMap.sample(float2(u(rng), u(rng)), pdf);
+            EXPECT(uv.x >= 0.f && uv.x <= 1.f && uv.y >= 0.f && uv.y <= 1.f);
+            EXPECT_LE(std::abs(pdf - importanceMap.evalPdf(uv)), 1e-5f * pdf);
+
+            uint32_t x = std::min((uint32_t)(uv.x * dim), dim - 1);
+            uint32_t y = std::min((uint32_t)(uv.y * dim), dim - 1);
+            histogram[y * dim + x]++;
+        }
+
+        for (uint32_t y = 0; y < dim; y++)
+        {
+            for (uint32_t x = 0; x < dim; x++)
+            {
+                float expected = importanceMap.evalPdf((float2(x, y) + 0.5f) / (float)dim) / (dim * dim);
+                float actual = histogram[y * dim + x] / (float)kSampleCount;
+                float sigma = std::sqrt(expected * (1.f - expected) / kSampleCount);
+                EXPECT_LE(std::abs(actual - expected), 5.f * sigma) << "texel (" << x << ", " << y << ")";
+            }
+        }
+    }
+
+    CPU_TEST(EnvMapImportanceMap_CDFTables)
+    {
+        std::mt19937 rng(3);
+        const uint32_t dim = 16;
+        auto importanceMap = createRandomImportanceMap(rng, dim);
+        auto tables = importanceMap.computeCDFTables();
+
+        EXPECT_EQ(tables.marginal.size(), (size_t)dim + 1);
+        EXPECT_EQ(tables.conditional.size(), (size_t)dim * (dim + 1));
+        EXPECT_EQ(tables.marginal.front(), 0.f);
+        EXPECT_EQ(tables.marginal.back(), 1.f);
+
+        // The density of the marginal/conditional distribution equals the density of the hierarchy.
+        for (uint32_t y = 0; y < dim; y++)
+        {
+            const float* pConditional = &tables.conditional[(size_t)y * (dim + 1)];
+            EXPECT_EQ(pConditional[0], 0.f);
+            EXPECT_EQ(pConditional[dim], 1.f);
+
+            float marginalPdf = tables.marginal[y + 1] - tables.marginal[y];
+            for (uint32_t x = 0; x < dim; x++)
+            {
+                EXPECT_LE(pConditional[x], pConditional[x + 1]);
+                float pdf = marginalPdf * (pConditional[x + 1] - pConditional[x]) * (dim * dim);
+                float expected = importanceMap.evalPdf((float2(x, y) + 0.5f) / (float)dim);
+                EXPECT_LE(std::abs(pdf - expected), 1e-3f * expected) << "texel (" << x << ", " << y << ")";
+            }
+        }
+    }
+
+    CPU_TEST(EnvMapImportanceMap_Cache)
+    {
+        auto directory = std::filesystem::temp_directory_path() / "FalcorEnvMapImportanceCacheTest";
+        std::filesystem::remove_all(directory);
+        EnvMapImportanceMap::Cache cache(directory);
+
+        std::mt19937 rng(4);
+        auto importanceMap = createRandomImportanceMap(rng, 16);
+
+        SHA1::MD envMapHash = SHA1::compute("envmap", 6);
+        auto key = EnvMapImportanceMap::computeKey(envMapHash, 16, 64);
+
+        EnvMapImportanceMap loaded;
+        EXPECT(!cache.load(key, 16, loaded));
+
+        cache.store(key, importanceMap);
+        EXPECT(cache.load(key, 16, loaded));
+        EXPECT(loaded.getPackedMips() == importanceMap.getPackedMips());
+
+        // Entries with a different dimension are rejected.
+        EXPECT(!cache.load(key, 32, loaded));
+
+        // The key depends on the env map content and the build parameters.
+        EXPECT(key != EnvMapImportanceMap::computeKey(SHA1::compute("other", 5), 16, 64));
+        EXPECT(key != EnvMapImportanceMap::computeKey(envMapHash, 32, 64));
+        EXPECT(key != EnvMapImportanceMap::computeKey(envMapHash, 16, 16));
+
+        std::filesystem::remove_all(directory);
+    }
+
+    GPU_TEST(EnvMapImportanceMap_ValidateAgainstShader)
+    {
+        std::mt19937 rng(5);
+        auto envMapData = createRandomEnvMap(rng, 64, 32);
+
+        std::vector<float4> texels;
+        for (const auto& texel : envMapData.texels) texels.push_back(float4(texel, 1.f));
+        auto pTexture = Texture::create2D(envMapData.width, envMapData.height, ResourceFormat::RGBA32Float, 1, 1, texels.data(), ResourceBindFlags::ShaderResource);
+        auto pEnvMap = EnvMap::create(pTexture);
+        auto pEnvMapSampler = EnvMapSampler::create(ctx.getRenderContext(), pEnvMap);
+
+        // Compare the CPU builder to the setup compute pass.
+        auto cpuMap = EnvMapImportanceMap::build(envMapData, 128, 16);
+        auto gpuMap = pEnvMapSampler->computeImportanceMapOnGPU(ctx.getRenderContext(), 128, 16);
+        EXPECT_EQ(gpuMap.getDimension(), cpuMap.getDimension());
+        for (uint32_t i = 0; i < 128 * 128; i++)
+        {
+            EXPECT_LE(std::abs(cpuMap.getMip(0)[i] - gpuMap.getMip(0)[i]), 1e-2f) << "texel " << i;
+        }
+        EXPECT_LE(std::abs(cpuMap.getAverage() - gpuMap.getAverage()), 1e-3f);
+
+        // The importance map texture holds the same data as the CPU representation.
+        const auto& importanceMap = pEnvMapSampler->getImportanceMapData();
+        auto pImportanceMap = pEnvMapSampler->getImportanceMap();
+        EXPECT_EQ(pImportanceMap->getMipCount(), importanceMap.getMipCount());
+        for (uint32_t mip = 0; mip < importanceMap.getMipCount(); mip++)
+        {
+            auto data = ctx.getRenderContext()->readTextureSubresource(pImportanceMap.get(), pImportanceMap->getSubresourceIndex(0, mip));
+            EXPECT_EQ(data.size(), importanceMap.getMip(mip).size() * sizeof(float));
+            if (data.size() != importanceMap.getMip(mip).size() * sizeof(float)) continue;
+            EXPECT(std::memcmp(data.data(), importanceMap.getMip(mip).data(), data.size()) == 0) << "mip " << mip;
+        }
+    }
+}
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Sampling/AliasTable.h"
+#include "Utils/Sampling/AliasTableBuilder.h"
 
 #include <hypothesis/hypothesis.h>
 
@@ -133,6 +134,73 @@ namespace Falcor
                 ctx.unmapBuffer("weightResult");
             }
         }
+
+        /** Verify that the probabilities implied by the table entries match the normalized weights.
+        */
+        void checkAliasTableBuilder(CPUUnitTestContext& ctx, const AliasTableBuilder& builder)
+        {
+            const uint32_t N = builder.getCount();
+            const auto& entries = builder.getEntries();
+
+            std::vector<double> pdf(N, 0.0);
+            for (uint32_t i = 0; i < N; ++i)
+            {
+                EXPECT_LT(entries[i].alias, N);
+                EXPECT(entries[i].threshold >= 0.f && entries[i].threshold <= 1.f);
+                pdf[i] += entries[i].threshold / N;
+                pdf[entries[i].alias] += (1.0 - entries[i].threshold) / N;
+            }
+
+            for (uint32_t i = 0; i < N; ++i)
+            {
+                EXPECT_LE(std::abs(pdf[i] - builder.getPdf(i)) * N, 1e-5) << "i = " << i;
+            }
+        }
+    }
+
+    CPU_TEST(AliasTableBuilder)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> uniform;
+
+        // Large enough to be split into multiple parallel tasks.
+        for (uint32_t N : { 1u, 2u, 1000u, 200000u })
+        {
+            std::vector<float> weights(N);
+            for (uint32_t i = 0; i < N; ++i) weights[i] = uniform(rng) * uniform(rng);
+            for (uint32_t i = 0; i < N / 100; ++i) weights[(size_t)(uniform(rng) * N)] = 0.f;
+
+            AliasTableBuilder builder(weights);
+            EXPECT_EQ(builder.getCount(), N);
+            checkAliasTableBuilder(ctx, builder);
+
+            // Update a subset of the weights.
+            std::vector<uint32_t> indices;
+            std::vector<float> newWeights;
+            for (uint32_t i = 0; i < std::min(N, 16u); ++i)
+            {
+                indices.push_back(i * (N / std::min(N, 16u)));
+                newWeights.push_back(10.f * uniform(rng));
+            }
+            EXPECT(builder.updateWeights(indices, newWeights));
+            checkAliasTableBuilder(ctx, builder);
+            EXPECT(!builder.updateWeights(indices, newWeights));
+
+            // Compare against a table built from scratch.
+            for (size_t i = 0; i < indices.size(); ++i) weights[indices[i]] = newWeights[i];
+            AliasTableBuilder reference(weights);
+            EXPECT_EQ(builder.getWeightSum(), reference.getWeightSum());
+            for (uint32_t i = 0; i < N; ++i)
+            {
+                EXPECT_EQ(builder.getEntries()[i].threshold, reference.getEntries()[i].threshold);
+                EXPECT_EQ(builder.getEntries()[i].alias, reference.getEntries()[i].alias);
+            }
+        }
+
+        // All weights zero samples uniformly.
+        AliasTableBuilder builder(std::vector<float>(10, 0.f));
+        checkAliasTableBuilder(ctx, builder);
+        EXPECT_EQ(builder.sample(float2(0.55f, 0.99f)), 5u);
     }
 
     GPU_TEST(AliasTable)
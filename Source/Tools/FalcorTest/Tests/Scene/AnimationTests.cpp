@@ -0,0 +1,450 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Utils/Math/Common.h"
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const double kDuration = 100.0;
+
+        Animation::SharedPtr createAnimation(uint32_t keyframeCount, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+            auto pAnimation = Animation::create("test", NodeID{ 0 }, kDuration);
+            // Add keyframes in reverse order to exercise sorted insertion.
+            for (uint32_t i = keyframeCount; i-- > 0;)
+            {
+                Animation::Keyframe keyframe;
+                keyframe.time = 1.0 + (kDuration - 1.0) * i / (keyframeCount - 1);
+                keyframe.translation = float3(u(rng), u(rng), u(rng)) * 10.f;
+                keyframe.scaling = float3(1.f) + float3(u(rng), u(rng), u(rng)) * 0.5f;
+                keyframe.rotation = glm::normalize(glm::quat(u(rng), u(rng), u(rng), u(rng)));
+                pAnimation->addKeyframe(keyframe);
+            }
+            return pAnimation;
+        }
+
+        bool isEqual(const rmcv::mat4& a, const rmcv::mat4& b)
+        {
+            return std::memcmp(&a, &b, sizeof(rmcv::mat4)) == 0;
+        }
+
+        /** Reference implementation storing the keyframes as an array of structures.
+            This is a verbatim copy of the implementation before keyframes were stored as channels.
+        */
+        class ReferenceAnimation
+        {
+        public:
+            using Keyframe = Animation::Keyframe;
+            using InterpolationMode = Animation::InterpolationMode;
+            using Behavior = Animation::Behavior;
+
+            ReferenceAnimation(double duration) : mDuration(duration) {}
+
+            void addKeyframe(const Keyframe& keyframe)
+            {
+                FALCOR_ASSERT(keyframe.time <= mDuration);
+
+                if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
+                {
+                    mKeyframes.insert(mKeyframes.begin(), keyframe);
+                }
+                else if (mKeyframes.back().time < keyframe.time)
+                {
+                    mKeyframes.push_back(keyframe);
+                }
+                else
+                {
+                    for (size_t i = 0; i < mKeyframes.size(); i++)
+                    {
+                        auto& current = mKeyframes[i];
+                        // If we already have a key-frame at the same time, replace it
+                        if (current.time == keyframe.time)
+                        {
+                            current = keyframe;
+                            return;
+                        }
+
+                        // If this is not the last frame, Check if we are in between frames
+                        if (i < mKeyframes.size() - 1)
+                        {
+                            auto& Next = mKeyframes[i + 1];
+                            if (current.time < keyframe.time && Next.time > keyframe.time)
+                            {
+                                mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
+                                return;
+                            }
+                        }
+                    }
+
+                    // If we got here, need to push it to the end of the list
+                    mKeyframes.push_back(keyframe);
+                }
+            }
+
+            rmcv::mat4 animate(double currentTime)
+            {
+                // Calculate the sample time.
+                double time = currentTime;
+                if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+                {
+                    time = calcSampleTime(currentTime);
+                }
+
+                // Determine if the animation behaves linearly outside of defined keyframes.
+                bool isLinearPostInfinity = time > mKeyframes.back().time && mPostInfinityBehavior == Behavior::Linear;
+                bool isLinearPreInfinity = time < mKeyframes.front().time && mPreInfinityBehavior == Behavior::Linear;
+
+                Keyframe interpolated;
+
+                if (isLinearPreInfinity && mKeyframes.size() > 1)
+                {
+                    const auto& k0 = mKeyframes.front();
+                    auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
+                    double segmentDuration = k1.time - k0.time;
+                    float t = (float)((time - k0.time) / segmentDuration);
+                    interpolated = interpolateLinear(k0, k1, t);
+                }
+                else if (isLinearPostInfinity && mKeyframes.size() > 1)
+                {
+                    const auto& k1 = mKeyframes.back();
+                    auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
+                    double segmentDuration = k1.time - k0.time;
+                    float t = (float)((time - k0.time) / segmentDuration);
+                    interpolated = interpolateLinear(k0, k1, t);
+                }
+                else
+                {
+                    interpolated = interpolate(mInterpolationMode, time);
+                }
+
+                rmcv::mat4 T = rmcv::translate(interpolated.translation);
+                rmcv::mat4 R = rmcv::mat4_cast(interpolated.rotation);
+                rmcv::mat4 S = rmcv::scale(interpolated.scaling);
+                rmcv::mat4 transform = T * R * S;
+
+                return transform;
+            }
+
+            Keyframe interpolate(InterpolationMode mode, double time) const
+            {
+                FALCOR_ASSERT(!mKeyframes.empty());
+
+                // Validate cached frame index.
+                size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
+                if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+
+                // Find frame index.
+                while (frameIndex < mKeyframes.size() - 1)
+                {
+                    if (mKeyframes[frameIndex + 1].time > time) break;
+                    frameIndex++;
+                }
+
+                // Cache frame index;
+                mCachedFrameIndex = frameIndex;
+
+                // Compute index of adjacent frame including optional warping.
+                auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
+                {
+                    size_t count = mKeyframes.size();
+                    return mEnableWarping ? (frame + count + offset) % count : clamp(frame + offset, (size_t)0, count - 1);
+                };
+
+                if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+                {
+                    size_t i0 = frameIndex;
+                    size_t i1 = adjacentFrame(i0);
+
+                    const Keyframe& k0 = mKeyframes[i0];
+                    const Keyframe& k1 = mKeyframes[i1];
+
+                    double segmentDuration = k1.time - k0.time;
+                    if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
+                    float t = (float)clamp((segmentDuration > 0.0 ? (time - k0.time) / segmentDuration : 1.0), 0.0, 1.0);
+
+                    return interpolateLinear(k0, k1, t);
+                }
+                else if (mode == InterpolationMode::Hermite)
+                {
+                    size_t i1 = frameIndex;
+                    size_t i0 = adjacentFrame(i1, -1);
+                    size_t i2 = adjacentFrame(i1, 1);
+                    size_t i3 = adjacentFrame(i1, 2);
+
+                    const Keyframe& k0 = mKeyframes[i0];
+                    const Keyframe& k1 = mKeyframes[i1];
+                    const Keyframe& k2 = mKeyframes[i2];
+                    const Keyframe& k3 = mKeyframes[i3];
+
+                    double segmentDuration = k2.time - k1.time;
+                    if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
+                    float t = (float)clamp(segmentDuration > 0.0 ? (time - k1.time) / segmentDuration : 1.0, 0.0, 1.0);
+
+                    return interpolateHermite(k0, k1, k2, k3, t);
+                }
+                else
+                {
+                    throw ArgumentError("'mode' is unknown interpolation mode");
+                }
+            }
+
+            double calcSampleTime(double currentTime)
+            {
+                double modifiedTime = currentTime;
+                double firstKeyframeTime = mKeyframes.front().time;
+                double lastKeyframeTime = mKeyframes.back().time;
+                double duration = lastKeyframeTime - firstKeyframeTime;
+
+                FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
+
+                Behavior behavior = (currentTime < firstKeyframeTime) ? mPreInfinityBehavior : mPostInfinityBehavior;
+                switch (behavior)
+                {
+                case Behavior::Constant:
+                    modifiedTime = clamp(currentTime, firstKeyframeTime, lastKeyframeTime);
+                    break;
+                case Behavior::Cycle:
+                    // Calculate the relative time
+                    modifiedTime = firstKeyframeTime + std::fmod(currentTime - firstKeyframeTime, duration);
+                    if (modifiedTime < firstKeyframeTime) modifiedTime += duration;
+                    break;
+                case Behavior::Oscillate:
+                    // Calculate the relative time
+                    double offset = std::fmod(currentTime - firstKeyframeTime, 2 * duration);
+                    if (offset < 0) offset += 2 * duration;
+                    if (offset > duration) offset = 2 * duration - offset;
+                    modifiedTime = firstKeyframeTime + offset;
+                }
+
+                return modifiedTime;
+            }
+
+            static float3 interpolateHermite(const float3& p0, const float3& p1, const float3& p2, const float3& p3, float t)
+            {
+                float3 b0 = p1;
+                float3 b1 = p1 + (p2 - p0) * 0.5f / 3.f;
+                float3 b2 = p2 - (p3 - p1) * 0.5f / 3.f;
+                float3 b3 = p2;
+
+                float3 q0 = lerp(b0, b1, t);
+                float3 q1 = lerp(b1, b2, t);
+                float3 q2 = lerp(b2, b3, t);
+
+                float3 qq0 = lerp(q0, q1, t);
+                float3 qq1 = lerp(q1, q2, t);
+
+                return lerp(qq0, qq1, t);
+            }
+
+            static glm::quat interpolateHermite(const glm::quat& r0, const glm::quat& r1, const glm::quat& r2, const glm::quat& r3, float t)
+            {
+                glm::quat b0 = r1;
+                glm::quat b1 = r1 + (r2 - r0) * 0.5f / 3.0f;
+                glm::quat b2 = r2 - (r3 - r1) * 0.5f / 3.0f;
+                glm::quat b3 = r2;
+
+                glm::quat q0 = slerp(b0, b1, t);
+                glm::quat q1 = slerp(b1, b2, t);
+                glm::quat q2 = slerp(b2, b3, t);
+
+                glm::quat qq0 = slerp(q0, q1, t);
+                glm::quat qq1 = slerp(q1, q2, t);
+
+                return slerp(qq0, qq1, t);
+            }
+
+            static Keyframe interpolateLinear(const Keyframe& k0, const Keyframe& k1, float t)
+            {
+                Keyframe result;
+                result.translation = lerp(k0.translation, k1.translation, t);
+                result.scaling = lerp(k0.scaling, k1.scaling, t);
+                result.rotation = slerp(k0.rotation, k1.rotation, t);
+                result.time = glm::lerp(k0.time, k1.time, (double)t);
+                return result;
+            }
+
+            static Keyframe interpolateHermite(const Keyframe& k0, const Keyframe& k1, const Keyframe& k2, const Keyframe& k3, float t)
+            {
+                FALCOR_ASSERT(t >= 0.f && t <= 1.f);
+                Keyframe result;
+                result.translation = interpolateHermite(k0.translation, k1.translation, k2.translation, k3.translation, t);
+                result.scaling = lerp(k1.scaling, k2.scaling, t);
+                result.rotation = interpolateHermite(k0.rotation, k1.rotation, k2.rotation, k3.rotation, t);
+                result.time = glm::lerp(k1.time, k2.time, (double)t);
+                return result;
+            }
+
+            static constexpr double kEpsilonTime = 1e-5f;
+
+            double mDuration;
+            Behavior mPreInfinityBehavior = Behavior::Constant;
+            Behavior mPostInfinityBehavior = Behavior::Constant;
+            InterpolationMode mInterpolationMode = InterpolationMode::Linear;
+            bool mEnableWarping = false;
+            std::vector<Keyframe> mKeyframes;
+            mutable size_t mCachedFrameIndex = 0;
+        };
+    }
+
+    CPU_TEST(Animation_Keyframes)
+    {
+        auto pAnimation = createAnimation(100, 1);
+        EXPECT_EQ(pAnimation->getKeyframeCount(), size_t(100));
+        EXPECT(pAnimation->doesKeyframeExists(1.0));
+        EXPECT(!pAnimation->doesKeyframeExists(1.5));
+
+        // Replacing a keyframe doesn't change the keyframe count.
+        Animation::Keyframe keyframe = pAnimation->getKeyframe(kDuration);
+        keyframe.translation = float3(1.f, 2.f, 3.f);
+        pAnimation->addKeyframe(keyframe);
+        EXPECT_EQ(pAnimation->getKeyframeCount(), size_t(100));
+        EXPECT(pAnimation->getKeyframe(kDuration).translation == float3(1.f, 2.f, 3.f));
+
+        // Animating at the last keyframe returns the keyframe transform.
+        Animation::Keyframe k = pAnimation->getKeyframe(kDuration);
+        rmcv::mat4 expected = rmcv::translate(k.translation) * rmcv::mat4_cast(k.rotation) * rmcv::scale(k.scaling);
+        EXPECT(isEqual(pAnimation->animate(kDuration), expected));
+    }
+
+    CPU_TEST(Animation_Scrubbing)
+    {
+        // The cached keyframe lookup must not affect the result, whatever the order in which time is sampled.
+        std::mt19937 rng;
+        std::uniform_real_distribution<double> u(-50.0, 250.0);
+
+        for (auto behavior : { Animation::Behavior::Constant, Animation::Behavior::Linear, Animation::Behavior::Cycle, Animation::Behavior::Oscillate })
+        {
+            for (auto mode : { Animation::InterpolationMode::Linear, Animation::InterpolationMode::Hermite })
+            {
+                auto pAnimation = createAnimation(1000, 2);
+                pAnimation->setPreInfinityBehavior(behavior);
+                pAnimation->setPostInfinityBehavior(behavior);
+                pAnimation->setInterpolationMode(mode);
+
+                auto pReference = createAnimation(1000, 2);
+                pReference->setPreInfinityBehavior(behavior);
+                pReference->setPostInfinityBehavior(behavior);
+                pReference->setInterpolationMode(mode);
+
+                for (uint32_t i = 0; i < 1000; i++)
+                {
+                    // Alternate between coherent playback and random jumps.
+                    double time = i % 10 == 0 ? u(rng) : 0.1 * i;
+                    rmcv::mat4 result = pAnimation->animate(time);
+
+                    // Move the reference lookup away from the sampled keyframe.
+                    pReference->animate(0.0);
+                    EXPECT(isEqual(result, pReference->animate(time))) << "time = " << time;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(Animation_Batch)
+    {
+        std::vector<Animation::SharedPtr> animations;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            animations.push_back(createAnimation(2 + i % 50, i));
+            animations.back()->setPostInfinityBehavior(i % 2 == 0 ? Animation::Behavior::Cycle : Animation::Behavior::Oscillate);
+        }
+
+        std::vector<rmcv::mat4> matrices;
+        for (double time : { 0.0, 50.0, 25.0, 175.0 })
+        {
+            Animation::animateBatch(animations, time, matrices);
+            EXPECT_EQ(matrices.size(), animations.size());
+            for (size_t i = 0; i < animations.size(); i++)
+            {
+                EXPECT(isEqual(matrices[i], animations[i]->animate(time))) << "animation " << i << ", time = " << time;
+            }
+        }
+    }
+
+    CPU_TEST(Animation_MatchesReference)
+    {
+        // Keyframes stored as channels must give bit-identical results to the previous array of keyframes.
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        std::uniform_real_distribution<double> keyframeTime(0.0, kDuration);
+        std::uniform_real_distribution<double> sampleTime(-50.0, 250.0);
+
+        for (auto behavior : { Animation::Behavior::Constant, Animation::Behavior::Linear, Animation::Behavior::Cycle, Animation::Behavior::Oscillate })
+        {
+            for (auto mode : { Animation::InterpolationMode::Linear, Animation::InterpolationMode::Hermite })
+            {
+                for (bool enableWarping : { false, true })
+                {
+                    auto pAnimation = Animation::create("test", NodeID{ 0 }, kDuration);
+                    ReferenceAnimation reference(kDuration);
+
+                    // Random keyframe times, with some keyframes replaced.
+                    std::vector<double> times;
+                    for (uint32_t i = 0; i < 200; i++)
+                    {
+                        Animation::Keyframe keyframe;
+                        keyframe.time = i % 10 == 9 ? times[i / 2] : keyframeTime(rng);
+                        keyframe.translation = float3(u(rng), u(rng), u(rng)) * 10.f;
+                        keyframe.scaling = float3(1.f) + float3(u(rng), u(rng), u(rng)) * 0.5f;
+                        keyframe.rotation = glm::normalize(glm::quat(u(rng), u(rng), u(rng), u(rng)));
+                        times.push_back(keyframe.time);
+                        pAnimation->addKeyframe(keyframe);
+                        reference.addKeyframe(keyframe);
+                    }
+                    EXPECT_EQ(pAnimation->getKeyframeCount(), reference.mKeyframes.size());
+
+                    pAnimation->setPreInfinityBehavior(behavior);
+                    pAnimation->setPostInfinityBehavior(behavior);
+                    pAnimation->setInterpolationMode(mode);
+                    pAnimation->setEnableWarping(enableWarping);
+                    reference.mPreInfinityBehavior = behavior;
+                    reference.mPostInfinityBehavior = behavior;
+                    reference.mInterpolationMode = mode;
+                    reference.mEnableWarping = enableWarping;
+
+                    for (uint32_t i = 0; i < 1000; i++)
+                    {
+                        // Alternate between coherent playback, random jumps and sampling exactly at keyframes.
+                        double time = i % 10 == 0 ? sampleTime(rng) : (i % 10 == 5 ? times[i % times.size()] : 0.1 * i);
+                        EXPECT(isEqual(pAnimation->animate(time), reference.animate(time))) << "time = " << time << ", mode = " << (int)mode << ", behavior = " << (int)behavior;
+                    }
+                }
+            }
+        }
+    }
+}
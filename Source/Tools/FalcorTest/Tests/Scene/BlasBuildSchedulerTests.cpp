@@ -0,0 +1,188 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasBuildScheduler.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint64_t kAlignment = 256;
+        const uint64_t kMB = 1ull << 20;
+
+        uint64_t alignSize(uint64_t size) { return (size + kAlignment - 1) / kAlignment * kAlignment; }
+
+        /** Generates BLAS sizes with a long-tailed distribution, similar to a scene with many small and a few huge meshes.
+        */
+        std::vector<BlasBuildScheduler::BlasSizes> createBlasSizes(std::mt19937& rng, uint32_t count)
+        {
+            std::lognormal_distribution<double> resultDist(std::log(2.0 * kMB), 1.5);
+            std::uniform_real_distribution<double> scratchDist(0.2, 1.2);
+            std::uniform_real_distribution<double> compactionDist(0.3, 0.7);
+
+            std::vector<BlasBuildScheduler::BlasSizes> blasSizes(count);
+            for (auto& sizes : blasSizes)
+            {
+                uint64_t resultByteSize = std::min((uint64_t)resultDist(rng), 256 * kMB);
+                sizes.resultByteSize = alignSize(std::max(resultByteSize, kAlignment));
+                sizes.scratchByteSize = alignSize((uint64_t)(sizes.resultByteSize * scratchDist(rng)) + 1);
+                sizes.finalByteSize = alignSize((uint64_t)(sizes.resultByteSize * compactionDist(rng)) + 1);
+            }
+            return blasSizes;
+        }
+
+        /** Groups BLASes greedily in index order without scratch aliasing, which is how BLAS groups used to be computed.
+        */
+        uint32_t countGreedyGroups(const std::vector<BlasBuildScheduler::BlasSizes>& blasSizes, uint64_t memoryBudget)
+        {
+            uint32_t groupCount = 0;
+            uint64_t groupSize = 0;
+            for (const auto& sizes : blasSizes)
+            {
+                uint64_t size = sizes.resultByteSize + sizes.scratchByteSize + sizes.finalByteSize;
+                if (groupSize == 0 || groupSize + size > memoryBudget)
+                {
+                    groupCount++;
+                    groupSize = 0;
+                }
+                groupSize += size;
+            }
+            return groupCount;
+        }
+
+        bool overlaps(uint64_t offsetA, uint64_t sizeA, uint64_t offsetB, uint64_t sizeB)
+        {
+            return offsetA < offsetB + sizeB && offsetB < offsetA + sizeA;
+        }
+
+        void validateSchedule(CPUUnitTestContext& ctx, const std::vector<BlasBuildScheduler::BlasSizes>& blasSizes, const BlasBuildScheduler::Options& options, const BlasBuildScheduler::Schedule& schedule)
+        {
+            EXPECT_EQ(schedule.placements.size(), blasSizes.size());
+
+            std::vector<uint32_t> scheduledCount(blasSizes.size(), 0);
+            for (uint32_t groupIndex = 0; groupIndex < (uint32_t)schedule.groups.size(); groupIndex++)
+            {
+                const auto& group = schedule.groups[groupIndex];
+                EXPECT(!group.blasIndices.empty());
+                EXPECT_LE(group.resultByteSize, schedule.resultByteSize);
+                EXPECT_LE(group.scratchByteSize, schedule.scratchByteSize);
+                EXPECT_LE(group.getBuildMemory(), schedule.peakBuildMemory);
+
+                // Groups may only exceed the budget if they hold a single BLAS.
+                if (group.blasIndices.size() > 1) EXPECT_LE(group.getBuildMemory(), options.memoryBudget);
+
+                for (size_t i = 0; i < group.blasIndices.size(); i++)
+                {
+                    uint32_t blasIndex = group.blasIndices[i];
+                    const auto& p = schedule.placements[blasIndex];
+                    const auto& sizes = blasSizes[blasIndex];
+                    scheduledCount[blasIndex]++;
+
+                    EXPECT_EQ(p.groupIndex, groupIndex);
+                    EXPECT_LT(p.batchIndex, group.batchCount);
+                    EXPECT_LE(p.resultByteOffset + sizes.resultByteSize, group.resultByteSize);
+                    EXPECT_LE(p.scratchByteOffset + sizes.scratchByteSize, group.scratchByteSize);
+                    EXPECT_EQ(p.resultByteOffset % kAlignment, 0ull);
+                    EXPECT_EQ(p.scratchByteOffset % kAlignment, 0ull);
+                    if (i > 0) EXPECT_GE(p.batchIndex, schedule.placements[group.blasIndices[i - 1]].batchIndex);
+
+                    // Result regions must be disjoint within a group. Scratch regions must be disjoint within a batch.
+                    for (size_t j = 0; j < i; j++)
+                    {
+                        uint32_t otherIndex = group.blasIndices[j];
+                        const auto& q = schedule.placements[otherIndex];
+                        const auto& otherSizes = blasSizes[otherIndex];
+                        EXPECT(!overlaps(p.resultByteOffset, sizes.resultByteSize, q.resultByteOffset, otherSizes.resultByteSize));
+                        if (p.batchIndex == q.batchIndex)
+                        {
+                            EXPECT(!overlaps(p.scratchByteOffset, sizes.scratchByteSize, q.scratchByteOffset, otherSizes.scratchByteSize));
+                        }
+                    }
+                }
+            }
+
+            for (uint32_t count : scheduledCount) EXPECT_EQ(count, 1u);
+        }
+    }
+
+    CPU_TEST(BlasBuildScheduler_Schedule)
+    {
+        std::mt19937 rng(5);
+
+        for (uint32_t blasCount : { 1u, 10u, 1000u })
+        {
+            auto blasSizes = createBlasSizes(rng, blasCount);
+
+            BlasBuildScheduler::Options options;
+            options.memoryBudget = 256 * kMB;
+            options.batchScratchBudget = 32 * kMB;
+            auto schedule = BlasBuildScheduler::createSchedule(blasSizes, options);
+            validateSchedule(ctx, blasSizes, options, schedule);
+
+            // Packing and scratch aliasing should never need more groups than the greedy grouping.
+            EXPECT_LE(schedule.groups.size(), (size_t)countGreedyGroups(blasSizes, options.memoryBudget));
+        }
+    }
+
+    CPU_TEST(BlasBuildScheduler_ScratchAliasing)
+    {
+        // Many equally sized BLASes. Each batch fits four scratch allocations, so the scratch is a quarter of the total.
+        std::vector<BlasBuildScheduler::BlasSizes> blasSizes(64);
+        for (auto& sizes : blasSizes)
+        {
+            sizes.resultByteSize = 4 * kMB;
+            sizes.scratchByteSize = 2 * kMB;
+            sizes.finalByteSize = 1 * kMB;
+        }
+
+        BlasBuildScheduler::Options options;
+        options.memoryBudget = 1024 * kMB;
+        options.batchScratchBudget = 8 * kMB;
+        auto schedule = BlasBuildScheduler::createSchedule(blasSizes, options);
+        validateSchedule(ctx, blasSizes, options, schedule);
+
+        EXPECT_EQ(schedule.groups.size(), (size_t)1);
+        EXPECT_EQ(schedule.groups[0].batchCount, 16u);
+        EXPECT_EQ(schedule.resultByteSize, 256 * kMB);
+        EXPECT_EQ(schedule.scratchByteSize, 8 * kMB);
+        EXPECT_EQ(schedule.peakBuildMemory, (256 + 8 + 64) * kMB);
+
+        // A BLAS larger than the budget is placed in a group of its own.
+        blasSizes.push_back({ 2048 * kMB, 512 * kMB, 0 });
+        schedule = BlasBuildScheduler::createSchedule(blasSizes, options);
+        validateSchedule(ctx, blasSizes, options, schedule);
+
+        EXPECT_EQ(schedule.groups.size(), (size_t)2);
+        EXPECT_EQ(schedule.placements.back().groupIndex, 0u);
+        EXPECT_EQ(schedule.groups[0].blasIndices.size(), (size_t)1);
+        EXPECT_EQ(schedule.groups[0].finalByteSize, 2048 * kMB);
+        EXPECT_EQ(schedule.scratchByteSize, 512 * kMB);
+    }
+}
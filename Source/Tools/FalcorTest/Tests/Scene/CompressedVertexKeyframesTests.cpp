@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/CompressedVertexKeyframes.h"
+#include <condition_variable>
+#include <mutex>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kVertexCount = 500;
+        const uint32_t kKeyframeCount = 20;
+
+        std::vector<double> createTimeSamples()
+        {
+            std::vector<double> timeSamples(kKeyframeCount);
+            for (uint32_t k = 0; k < kKeyframeCount; k++) timeSamples[k] = 0.5 * k;
+            return timeSamples;
+        }
+    }
+
+    CPU_TEST(CompressedVertexKeyframes_RoundTrip)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+        // Random motion, no keyframe can be interpolated from its neighbors.
+        std::vector<std::vector<DynamicCurveVertexData>> vertexData(kKeyframeCount, std::vector<DynamicCurveVertexData>(kVertexCount));
+        for (auto& keyframe : vertexData)
+        {
+            for (auto& v : keyframe) v.position = float3(u(rng), u(rng), u(rng)) * float3(10.f, 1.f, 0.1f);
+        }
+
+        CompressedVertexKeyframes keyframes(createTimeSamples(), vertexData, CompressedVertexKeyframes::Options());
+        EXPECT_EQ(keyframes.getKeyframeCount(), kKeyframeCount);
+        EXPECT_EQ(keyframes.getVertexCount(), kVertexCount);
+        EXPECT(!keyframes.hasNormals());
+        EXPECT_LT(keyframes.getMemoryUsageInBytes(), uint64_t(kKeyframeCount) * kVertexCount * sizeof(DynamicCurveVertexData) / 2 + kVertexCount * sizeof(float3) + 1024);
+
+        // Deltas to the first keyframe are quantized to 16 bits over their range in each keyframe.
+        std::vector<DynamicCurveVertexData> decoded(kVertexCount);
+        const float3 maxError = float3(40.f, 4.f, 0.4f) / 32767.f;
+        for (uint32_t k = 0; k < kKeyframeCount; k++)
+        {
+            keyframes.decode(k, decoded.data());
+            for (uint32_t v = 0; v < kVertexCount; v++)
+            {
+                float3 error = abs(decoded[v].position - vertexData[k][v].position);
+                EXPECT(glm::all(glm::lessThanEqual(error, maxError))) << "keyframe " << k << ", vertex " << v;
+            }
+        }
+    }
+
+    CPU_TEST(CompressedVertexKeyframes_Decimation)
+    {
+        // Linear motion up to the middle keyframe, then static.
+        std::vector<std::vector<PackedStaticVertexData>> vertexData(kKeyframeCount, std::vector<PackedStaticVertexData>(kVertexCount));
+        for (uint32_t k = 0; k < kKeyframeCount; k++)
+        {
+            for (uint32_t v = 0; v < kVertexCount; v++)
+            {
+                StaticVertexData s = {};
+                s.position = float3(float(v), 0.f, 0.f) + float3(0.f, 1.f, 0.f) * float(std::min(k, kKeyframeCount / 2));
+                s.normal = float3(0.f, 0.f, 1.f);
+                s.tangent = float4(1.f, 0.f, 0.f, 1.f);
+                s.texCrd = float2(float(v) / kVertexCount, 0.f);
+                vertexData[k][v].pack(s);
+            }
+        }
+
+        const auto timeSamples = createTimeSamples();
+
+        CompressedVertexKeyframes::Options options;
+        options.maxDecimationError = 1e-3f;
+        CompressedVertexKeyframes keyframes(timeSamples, vertexData, options);
+        EXPECT(keyframes.hasNormals());
+        EXPECT_LT(keyframes.getKeyframeCount(), kKeyframeCount);
+        EXPECT_EQ(keyframes.getTimeSamples().front(), timeSamples.front());
+        EXPECT_EQ(keyframes.getTimeSamples().back(), timeSamples.back());
+
+        // The keyframe where the motion stops must be retained.
+        const auto& retained = keyframes.getTimeSamples();
+        EXPECT(std::find(retained.begin(), retained.end(), timeSamples[kKeyframeCount / 2]) != retained.end());
+
+        std::vector<PackedStaticVertexData> decoded(kVertexCount);
+        keyframes.decode(keyframes.getKeyframeCount() - 1, decoded.data());
+        for (uint32_t v = 0; v < kVertexCount; v++)
+        {
+            StaticVertexData s = decoded[v].unpack();
+            StaticVertexData r = vertexData.back()[v].unpack();
+            EXPECT_LE(glm::length(s.position - r.position), 1e-3f);
+            EXPECT_GT(dot(s.normal, r.normal), 0.999f);
+            EXPECT_EQ(s.tangent.w, r.tangent.w);
+            EXPECT(s.texCrd == r.texCrd);
+        }
+
+        // Decimation disabled retains all keyframes.
+        options.maxDecimationError = -1.f;
+        EXPECT_EQ(CompressedVertexKeyframes(timeSamples, vertexData, options).getKeyframeCount(), kKeyframeCount);
+    }
+
+    CPU_TEST(CompressedVertexKeyframes_AddKeyframes)
+    {
+        // Linear motion, all keyframes but the first and last can be dropped.
+        CompressedVertexKeyframes::Options options;
+        options.maxDecimationError = 1e-3f;
+        CompressedVertexKeyframes keyframes(options);
+        const auto timeSamples = createTimeSamples();
+        std::vector<DynamicCurveVertexData> vertices(kVertexCount);
+        for (uint32_t k = 0; k < kKeyframeCount; k++)
+        {
+            for (uint32_t v = 0; v < kVertexCount; v++) vertices[v].position = float3(float(v), float(k), 0.f);
+            keyframes.addKeyframe(timeSamples[k], vertices);
+        }
+        keyframes.finalize();
+
+        // At most 8 consecutive keyframes are dropped, keyframes 0, 9, 18 and 19 are retained.
+        EXPECT_EQ(keyframes.getKeyframeCount(), 4u);
+        EXPECT_EQ(keyframes.getTimeSamples()[1], timeSamples[9]);
+        EXPECT_EQ(keyframes.getTimeSamples().back(), timeSamples.back());
+
+        std::vector<DynamicCurveVertexData> decoded(kVertexCount);
+        keyframes.decode(keyframes.getKeyframeCount() - 1, decoded.data());
+        for (uint32_t v = 0; v < kVertexCount; v++) EXPECT_LE(glm::length(decoded[v].position - vertices[v].position), 1e-3f);
+    }
+
+    CPU_TEST(VertexKeyframeWindow_Update)
+    {
+        const uint32_t keyframeCount = 8;
+        KeyframeDecodeQueue queue(2);
+        VertexKeyframeWindow<uint32_t> window(keyframeCount, 2, [](uint32_t keyframe, std::vector<uint32_t>& values) { values.assign(4, keyframe); }, &queue);
+
+        EXPECT_EQ(window.get(3).size(), size_t(4));
+        EXPECT_EQ(window.get(3)[0], 3u);
+
+        // Window covers keyframes 6, 7 and two prefetched keyframes wrapping around to 0 and 1.
+        window.update(6, 7);
+        for (uint32_t k : { 6u, 7u, 0u, 1u }) EXPECT_EQ(window.get(k)[0], k);
+        EXPECT_EQ(window.getMemoryUsageInBytes(), 4 * 4 * sizeof(uint32_t));
+    }
+
+    CPU_TEST(VertexKeyframeWindow_CancelInFlight)
+    {
+        KeyframeDecodeQueue queue(1);
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool started = false;
+        bool released = false;
+
+        // Decoding keyframe 0 blocks the only worker until it is released.
+        VertexKeyframeWindow<uint32_t> window(16, 0, [&](uint32_t keyframe, std::vector<uint32_t>& values)
+        {
+            if (keyframe == 0)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                started = true;
+                cv.notify_all();
+                cv.wait(lock, [&]() { return released; });
+            }
+            values.assign(4, keyframe);
+        }, &queue);
+
+        window.update(0, 0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return started; });
+        }
+
+        // Moving the window away from the in-flight keyframe does not wait for it.
+        // The queued keyframes are decoded on the calling thread while the worker is busy.
+        window.update(8, 9);
+        EXPECT_EQ(window.get(8)[0], 8u);
+        EXPECT_EQ(window.get(9)[0], 9u);
+        EXPECT_EQ(window.getMemoryUsageInBytes(), 2 * 4 * sizeof(uint32_t));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            released = true;
+        }
+        cv.notify_all();
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneTypes.slang"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        float3 randomDirection(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> u(-1.f, 1.f);
+            float3 d;
+            do d = float3(u(rng), u(rng), u(rng)); while (dot(d, d) > 1.f || dot(d, d) < 1e-4f);
+            return glm::normalize(d);
+        }
+
+        VertexQuantization createQuantization(bool useHalfTexCrd)
+        {
+            VertexQuantization q = {};
+            q.positionOffset = float3(10.f, -2.f, 0.5f);
+            q.positionScale = float3(4.f, 1.f, 0.25f);
+            q.useHalfTexCrd = useHalfTexCrd ? 1 : 0;
+            q.texCrdOffset = float2(-1.f, 0.f);
+            q.texCrdScale = float2(3.f, 2.f);
+            return q;
+        }
+    }
+
+    CPU_TEST(CompressedStaticVertexData_RoundTrip)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        for (bool useHalfTexCrd : { false, true })
+        {
+            const VertexQuantization q = createQuantization(useHalfTexCrd);
+
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                StaticVertexData v = {};
+                v.position = q.positionOffset + (float3(u(rng), u(rng), u(rng)) * 2.f - 1.f) * q.positionScale;
+                v.normal = randomDirection(rng);
+                v.tangent = float4(randomDirection(rng), i % 3 == 0 ? 0.f : (i % 3 == 1 ? 1.f : -1.f));
+                v.texCrd = q.texCrdOffset + float2(u(rng), u(rng)) * q.texCrdScale;
+
+                CompressedStaticVertexData c;
+                c.pack(v, q);
+                StaticVertexData r = c.unpack(q);
+
+                // Positions are quantized to snorm16 relative to the bounds.
+                float3 positionError = abs(r.position - v.position) / q.positionScale;
+                EXPECT_LE(std::max(positionError.x, std::max(positionError.y, positionError.z)), 0.51f / 32767.f);
+                EXPECT(r.position == c.unpackPosition(q));
+
+                // Normals use 2x12 bits and tangents 2x10 bits in octahedral encoding.
+                EXPECT_LT(1.f - dot(r.normal, v.normal), 1e-4f);
+                EXPECT_EQ(r.tangent.w, v.tangent.w);
+                if (v.tangent.w != 0.f) EXPECT_LT(1.f - dot(r.tangent.xyz(), v.tangent.xyz()), 1e-3f);
+
+                if (useHalfTexCrd)
+                {
+                    EXPECT(r.texCrd == f16tof32(f32tof16(v.texCrd)));
+                }
+                else
+                {
+                    float2 texCrdError = abs(r.texCrd - v.texCrd) / q.texCrdScale;
+                    EXPECT_LE(std::max(texCrdError.x, texCrdError.y), 0.51f / 65535.f);
+                }
+                EXPECT_EQ(r.curveRadius, 0.f);
+            }
+        }
+    }
+
+    CPU_TEST(CompressedStaticVertexData_Bounds)
+    {
+        // The corners of the bounds are represented exactly.
+        const VertexQuantization q = createQuantization(false);
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            StaticVertexData v = {};
+            float3 corner = float3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f);
+            v.position = q.positionOffset + corner * q.positionScale;
+            v.normal = float3(0.f, 0.f, 1.f);
+            v.texCrd = q.texCrdOffset + float2(i & 1 ? 1.f : 0.f, i & 2 ? 1.f : 0.f) * q.texCrdScale;
+
+            CompressedStaticVertexData c;
+            c.pack(v, q);
+            EXPECT(c.unpackPosition(q) == v.position);
+            EXPECT(c.unpack(q).texCrd == v.texCrd);
+            EXPECT_EQ(c.unpack(q).tangent.w, 0.f);
+        }
+    }
+}
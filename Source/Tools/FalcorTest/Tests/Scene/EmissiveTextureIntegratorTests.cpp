@@ -0,0 +1,243 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/EmissiveTextureIntegrator.h"
+#include "Scene/Lights/LightCollection.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/SceneBuilder.h"
+#include <filesystem>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        EmissiveTextureIntegrator::TextureData createRandomTexture(std::mt19937& rng, uint32_t width, uint32_t height)
+        {
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            EmissiveTextureIntegrator::TextureData texture;
+            texture.width = width;
+            texture.height = height;
+            texture.texels.resize((size_t)width * height);
+            for (auto& texel : texture.texels) texel = float3(u(rng), u(rng), u(rng));
+            return texture;
+        }
+
+        /** Reference integration by point sampling the triangle on a dense grid in texel space.
+        */
+        float3 integrateReference(const EmissiveTextureIntegrator::TextureData& texture, const float2 texCoords[3])
+        {
+            const uint32_t kGridSize = 1024;
+            const float2 dim = float2(texture.width, texture.height);
+            float2 p[3];
+            for (uint32_t i = 0; i < 3; i++) p[i] = texCoords[i] * dim;
+
+            const float2 pMin = min(min(p[0], p[1]), p[2]);
+            const float2 pMax = max(max(p[0], p[1]), p[2]);
+            auto edge = [](float2 a, float2 b, float2 c) { return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x); };
+            const float area = edge(p[0], p[1], p[2]);
+
+            glm::dvec3 sum(0.0);
+            uint64_t count = 0;
+            for (uint32_t y = 0; y < kGridSize; y++)
+            {
+                for (uint32_t x = 0; x < kGridSize; x++)
+                {
+                    float2 q = pMin + (float2(x, y) + 0.5f) / float(kGridSize) * (pMax - pMin);
+                    float w0 = edge(p[1], p[2], q) / area;
+                    float w1 = edge(p[2], p[0], q) / area;
+                    float w2 = edge(p[0], p[1], q) / area;
+                    if (w0 < 0.f || w1 < 0.f || w2 < 0.f) continue;
+                    sum += glm::dvec3(texture.fetch((int64_t)std::floor(q.x), (int64_t)std::floor(q.y)));
+                    count++;
+                }
+            }
+            return float3(sum / (double)count);
+        }
+    }
+
+    CPU_TEST(EmissiveTextureIntegrator_Constant)
+    {
+        EmissiveTextureIntegrator::TextureData texture;
+        texture.width = 7;
+        texture.height = 5;
+        texture.texels.assign(35, float3(0.25f, 0.5f, 2.f));
+
+        // Triangles inside a texel, spanning many texels and tiles, and with negative coordinates.
+        const float2 triangles[][3] =
+        {
+            { float2(0.01f, 0.01f), float2(0.02f, 0.01f), float2(0.01f, 0.03f) },
+            { float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f) },
+            { float2(-2.3f, 0.7f), float2(3.1f, -1.2f), float2(0.4f, 4.9f) },
+        };
+        for (const auto& tri : triangles)
+        {
+            float3 average = EmissiveTextureIntegrator::integrateTriangle(texture, tri);
+            EXPECT_LE(glm::length(average - float3(0.25f, 0.5f, 2.f)), 1e-5f);
+        }
+    }
+
+    CPU_TEST(EmissiveTextureIntegrator_Reference)
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> u(-1.f, 2.f);
+
+        for (auto addressMode : { Sampler::AddressMode::Wrap, Sampler::AddressMode::Mirror, Sampler::AddressMode::Clamp })
+        {
+            auto texture = createRandomTexture(rng, 16, 8);
+            texture.addressModeU = addressMode;
+            texture.addressModeV = addressMode;
+
+            std::vector<float2> texCoords;
+            for (uint32_t i = 0; i < 3 * 32; i++) texCoords.push_back(float2(u(rng), u(rng)));
+            auto averages = EmissiveTextureIntegrator::integrateTriangles(texture, texCoords);
+            EXPECT_EQ(averages.size(), (size_t)32);
+
+            for (uint32_t triIdx = 0; triIdx < 32; triIdx++)
+            {
+                float3 ref = integrateReference(texture, &texCoords[3 * triIdx]);
+                float3 diff = abs(averages[triIdx] - ref);
+                EXPECT_LE(std::max(std::max(diff.x, diff.y), diff.z), 1e-2f) << "triangle " << triIdx;
+            }
+        }
+    }
+
+    CPU_TEST(EmissiveTextureIntegrator_Degenerate)
+    {
+        std::mt19937 rng(2);
+        auto texture = createRandomTexture(rng, 8, 8);
+
+        // All vertices on a line. The result is the average of the texels at the vertices.
+        const float2 tri[3] = { float2(0.1f, 0.5f), float2(0.5f, 0.5f), float2(0.9f, 0.5f) };
+        float3 expected = (texture.fetch(0, 4) + texture.fetch(4, 4) + texture.fetch(7, 4)) / 3.f;
+        float3 average = EmissiveTextureIntegrator::integrateTriangle(texture, tri);
+        EXPECT_LE(glm::length(average - expected), 1e-5f);
+    }
+
+    CPU_TEST(EmissiveTextureIntegrator_AddressModes)
+    {
+        EmissiveTextureIntegrator::TextureData texture;
+        texture.width = 4;
+        texture.height = 1;
+        for (uint32_t i = 0; i < 4; i++) texture.texels.push_back(float3(float(i)));
+        texture.borderColor = float3(-1.f);
+
+        auto fetch = [&](Sampler::AddressMode mode, int64_t x) { texture.addressModeU = mode; return texture.fetch(x, 0).x; };
+
+        EXPECT_EQ(fetch(Sampler::AddressMode::Wrap, -1), 3.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Wrap, 9), 1.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Mirror, -1), 0.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Mirror, 5), 2.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Mirror, 9), 1.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::MirrorOnce, -2), 1.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::MirrorOnce, 9), 3.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Clamp, -5), 0.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Clamp, 7), 3.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Border, 4), -1.f);
+        EXPECT_EQ(fetch(Sampler::AddressMode::Border, 2), 2.f);
+    }
+
+    CPU_TEST(EmissiveTextureIntegrator_Cache)
+    {
+        auto directory = std::filesystem::temp_directory_path() / "FalcorEmissiveIntegrationCacheTest";
+        std::filesystem::remove_all(directory);
+        EmissiveTextureIntegrator::Cache cache(directory);
+
+        SHA1::MD textureHash = SHA1::compute("texture", 7);
+        std::vector<float2> texCoords = { float2(0.f), float2(1.f, 0.f), float2(0.f, 1.f) };
+        auto key = EmissiveTextureIntegrator::computeKey(textureHash, Sampler::AddressMode::Wrap, Sampler::AddressMode::Wrap, texCoords);
+
+        std::vector<float3> averages;
+        EXPECT(!cache.load(key, 1, averages));
+
+        cache.store(key, { float3(1.f, 2.f, 3.f) });
+        EXPECT(cache.load(key, 1, averages));
+        EXPECT_EQ(averages.size(), (size_t)1);
+        EXPECT(averages[0] == float3(1.f, 2.f, 3.f));
+
+        // Entries with a different triangle count are rejected.
+        EXPECT(!cache.load(key, 2, averages));
+
+        // The key depends on the texture coordinates, texture content and addressing.
+        texCoords[2].y = 0.5f;
+        EXPECT(key != EmissiveTextureIntegrator::computeKey(textureHash, Sampler::AddressMode::Wrap, Sampler::AddressMode::Wrap, texCoords));
+        EXPECT(key != EmissiveTextureIntegrator::computeKey(SHA1::compute("other", 5), Sampler::AddressMode::Wrap, Sampler::AddressMode::Wrap, texCoords));
+        EXPECT(key != EmissiveTextureIntegrator::computeKey(textureHash, Sampler::AddressMode::Clamp, Sampler::AddressMode::Wrap, texCoords));
+
+        std::filesystem::remove_all(directory);
+    }
+
+    GPU_TEST(EmissiveTextureIntegrator_ValidateAgainstShader)
+    {
+        const uint32_t triangleCount = 32;
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        // Random emissive texture, sampled with wrap addressing by the default material sampler.
+        auto textureData = createRandomTexture(rng, 16, 8);
+        std::vector<float4> texels;
+        for (const auto& texel : textureData.texels) texels.push_back(float4(texel, 1.f));
+        auto pTexture = Texture::create2D(textureData.width, textureData.height, ResourceFormat::RGBA32Float, 1, 1, texels.data(), ResourceBindFlags::ShaderResource);
+
+        // Triangles of random size spanning several texels and tiles of the texture.
+        TriangleMesh::VertexList vertices;
+        TriangleMesh::IndexList indices;
+        for (uint32_t i = 0; i < 3 * triangleCount; i++)
+        {
+            vertices.push_back({ float3(u(rng), u(rng), u(rng)), float3(0.f, 0.f, 1.f), float2(u(rng), u(rng)) * 2.f - 0.5f });
+            indices.push_back(i);
+        }
+
+        auto pMaterial = StandardMaterial::create("Emissive");
+        pMaterial->setEmissiveTexture(pTexture);
+        pMaterial->setEmissiveFactor(2.f);
+
+        auto pBuilder = SceneBuilder::create();
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::create(vertices, indices), pMaterial);
+        pBuilder->addMeshInstance(pBuilder->addNode(SceneBuilder::Node{ "Emissive", rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() }), meshID);
+        auto pScene = pBuilder->getScene();
+        EXPECT(pScene != nullptr);
+        if (!pScene) return;
+
+        // Compare the CPU integrator to the rasterization pass.
+        auto pCPULights = LightCollection::create(ctx.getRenderContext(), pScene, false);
+        auto pGPULights = LightCollection::create(ctx.getRenderContext(), pScene, true);
+        const auto& cpuTriangles = pCPULights->getMeshLightTriangles();
+        const auto& gpuTriangles = pGPULights->getMeshLightTriangles();
+        EXPECT_EQ(cpuTriangles.size(), (size_t)triangleCount);
+        EXPECT_EQ(gpuTriangles.size(), cpuTriangles.size());
+        if (gpuTriangles.size() != cpuTriangles.size()) return;
+
+        for (size_t i = 0; i < cpuTriangles.size(); i++)
+        {
+            float3 diff = abs(cpuTriangles[i].averageRadiance - gpuTriangles[i].averageRadiance);
+            EXPECT_LE(std::max(std::max(diff.x, diff.y), diff.z), 1e-3f) << "triangle " << i;
+            EXPECT_LE(std::abs(cpuTriangles[i].flux - gpuTriangles[i].flux), 1e-3f * std::max(1.f, gpuTriangles[i].flux)) << "triangle " << i;
+        }
+    }
+}
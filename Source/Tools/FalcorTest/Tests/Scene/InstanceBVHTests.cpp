@@ -0,0 +1,251 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/InstanceBVH.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFieldSize = 64;
+        const uint32_t kMeshCount = 16;
+
+        /** Generates a field of kFieldSize^2 unit boxes on the xz-plane with some random jitter.
+        */
+        std::vector<AABB> createInstanceField(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            std::vector<AABB> bounds;
+            for (uint32_t z = 0; z < kFieldSize; z++)
+            {
+                for (uint32_t x = 0; x < kFieldSize; x++)
+                {
+                    float3 p = float3(2.f * x + u(rng), u(rng), 2.f * z + u(rng)) - float3(float(kFieldSize), 0.f, float(kFieldSize));
+                    bounds.push_back(AABB(p, p + float3(0.5f + u(rng))));
+                }
+            }
+            return bounds;
+        }
+
+        bool isBounded(const AABB& box)
+        {
+            return box.valid() && !glm::any(glm::isinf(box.minPoint)) && !glm::any(glm::isinf(box.maxPoint));
+        }
+
+        std::vector<uint32_t> cullBruteForce(const Frustum& frustum, const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs)
+        {
+            std::vector<uint32_t> visible;
+            for (uint32_t itemID : itemIDs)
+            {
+                if (!isBounded(bounds[itemID]) || frustum.intersects(bounds[itemID])) visible.push_back(itemID);
+            }
+            return visible;
+        }
+
+        Frustum createFrustum(const float3& eye, const float3& target)
+        {
+            rmcv::mat4 view = rmcv::lookAt(eye, target, float3(0.f, 1.f, 0.f));
+            rmcv::mat4 proj = rmcv::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 40.f);
+            return Frustum(proj * view);
+        }
+
+        void testCulling(CPUUnitTestContext& ctx, const InstanceBVH& bvh, const std::vector<AABB>& bounds, const std::vector<uint32_t>& itemIDs, const Frustum& frustum)
+        {
+            std::vector<uint32_t> visible;
+            bvh.cull(frustum, visible);
+            std::vector<uint32_t> expected = cullBruteForce(frustum, bounds, itemIDs);
+
+            std::sort(visible.begin(), visible.end());
+            EXPECT_EQ(visible.size(), expected.size());
+            EXPECT(visible == expected);
+        }
+    }
+
+    CPU_TEST(InstanceBVH_Culling)
+    {
+        std::mt19937 rng(1234);
+        std::vector<AABB> bounds = createInstanceField(rng);
+
+        // Leave out some items to test sparse item IDs.
+        std::vector<uint32_t> itemIDs;
+        for (uint32_t i = 0; i < (uint32_t)bounds.size(); i++)
+        {
+            if (i % 7 != 3) itemIDs.push_back(i);
+        }
+
+        InstanceBVH bvh;
+        bvh.build(bounds, itemIDs);
+        EXPECT_EQ(bvh.getItemCount(), (uint32_t)itemIDs.size());
+
+        const Frustum frustums[] =
+        {
+            createFrustum(float3(0.f, 5.f, 0.f), float3(10.f, 0.f, 10.f)),
+            createFrustum(float3(-kFieldSize, 2.f, 0.f), float3(0.f, 0.f, 0.f)),
+            createFrustum(float3(0.f, 50.f, 0.f), float3(0.f, 0.f, 0.1f)),
+            createFrustum(float3(0.f, 5.f, 0.f), float3(1.f, 10.f, 0.f)),
+            Frustum(),
+        };
+
+        for (const auto& frustum : frustums) testCulling(ctx, bvh, bounds, itemIDs, frustum);
+
+        // Everything is visible with the default frustum.
+        std::vector<uint32_t> visible;
+        bvh.cull(Frustum(), visible);
+        EXPECT_EQ(visible.size(), itemIDs.size());
+
+        // A view into a corner of the field sees only a fraction of the instances.
+        bvh.cull(frustums[0], visible);
+        EXPECT_GT(visible.size(), (size_t)0);
+        EXPECT_LT(visible.size(), itemIDs.size() / 2);
+
+        // Move a few instances and refit.
+        std::uniform_int_distribution<uint32_t> pick(0, (uint32_t)bounds.size() - 1);
+        std::vector<uint32_t> changed;
+        for (uint32_t i = 0; i < 50; i++)
+        {
+            uint32_t itemID = pick(rng);
+            bounds[itemID].minPoint += float3(0.f, 0.f, 20.f);
+            bounds[itemID].maxPoint += float3(0.f, 0.f, 20.f);
+            changed.push_back(itemID);
+        }
+        bvh.refit(bounds, changed);
+        for (const auto& frustum : frustums) testCulling(ctx, bvh, bounds, itemIDs, frustum);
+
+        // Move all instances and refit.
+        for (auto& box : bounds)
+        {
+            box.minPoint -= float3(5.f, 0.f, 0.f);
+            box.maxPoint -= float3(5.f, 0.f, 0.f);
+        }
+        bvh.refit(bounds);
+        for (const auto& frustum : frustums) testCulling(ctx, bvh, bounds, itemIDs, frustum);
+
+    }
+
+    CPU_TEST(InstanceBVH_UnboundedItems)
+    {
+        std::mt19937 rng(4321);
+        std::vector<AABB> bounds = createInstanceField(rng);
+        std::vector<uint32_t> itemIDs(bounds.size());
+        for (uint32_t i = 0; i < (uint32_t)bounds.size(); i++) itemIDs[i] = i;
+
+        // Items with invalid or infinite bounds.
+        const float inf = std::numeric_limits<float>::infinity();
+        bounds[10] = AABB();
+        bounds[20] = AABB(float3(-inf), float3(inf));
+        bounds[30] = AABB(float3(0.f), float3(1.f, inf, 1.f));
+
+        InstanceBVH bvh;
+        bvh.build(bounds, itemIDs);
+        EXPECT_EQ(bvh.getItemCount(), (uint32_t)itemIDs.size());
+
+        // A view into the sky sees only the unbounded items.
+        const Frustum skyFrustum = createFrustum(float3(0.f, 50.f, 0.f), float3(0.f, 100.f, 0.1f));
+        const Frustum fieldFrustum = createFrustum(float3(0.f, 5.f, 0.f), float3(10.f, 0.f, 10.f));
+        std::vector<uint32_t> visible;
+        bvh.cull(skyFrustum, visible);
+        std::sort(visible.begin(), visible.end());
+        EXPECT(visible == std::vector<uint32_t>({ 10, 20, 30 }));
+        testCulling(ctx, bvh, bounds, itemIDs, fieldFrustum);
+
+        // Bounded items becoming unbounded and vice versa.
+        bounds[10] = AABB(float3(0.f, 70.f, 0.f), float3(1.f, 71.f, 1.f));
+        bounds[40] = AABB();
+        bvh.refit(bounds, { 10, 40 });
+        bvh.cull(skyFrustum, visible);
+        std::sort(visible.begin(), visible.end());
+        EXPECT(visible == std::vector<uint32_t>({ 10, 20, 30, 40 }));
+        testCulling(ctx, bvh, bounds, itemIDs, fieldFrustum);
+
+        bounds[20] = AABB(float3(0.f), float3(1.f));
+        bvh.refit(bounds);
+        bvh.cull(skyFrustum, visible);
+        std::sort(visible.begin(), visible.end());
+        EXPECT(visible == std::vector<uint32_t>({ 10, 30, 40 }));
+        testCulling(ctx, bvh, bounds, itemIDs, fieldFrustum);
+    }
+
+    CPU_TEST(InstanceBVH_Batching)
+    {
+        std::mt19937 rng(5678);
+        std::vector<AABB> bounds = createInstanceField(rng);
+        const uint32_t instanceCount = (uint32_t)bounds.size();
+
+        // Assign each instance a random mesh and winding. The key is meshID * 2 + winding.
+        std::uniform_int_distribution<uint32_t> pick(0, 2 * kMeshCount - 1);
+        std::vector<uint32_t> keys(instanceCount);
+        for (auto& key : keys) key = pick(rng);
+
+        InstanceBatcher batcher;
+        batcher.setKeys(keys, 2 * kMeshCount);
+
+        std::vector<uint32_t> itemIDs(instanceCount);
+        for (uint32_t i = 0; i < instanceCount; i++) itemIDs[i] = i;
+
+        InstanceBVH bvh;
+        bvh.build(bounds, itemIDs);
+
+        std::vector<uint32_t> visible, sorted;
+        std::vector<InstanceBatcher::Batch> batches;
+        bvh.cull(createFrustum(float3(0.f, 5.f, 0.f), float3(10.f, 0.f, 10.f)), visible);
+        batcher.createBatches(visible, sorted, batches);
+
+        // One draw per distinct key instead of one per instance.
+        EXPECT_EQ(sorted.size(), visible.size());
+        EXPECT_LE(batches.size(), (size_t)(2 * kMeshCount));
+        EXPECT_LT(batches.size(), visible.size());
+
+        uint32_t next = 0;
+        for (size_t i = 0; i < batches.size(); i++)
+        {
+            const auto& batch = batches[i];
+            if (i > 0) EXPECT_LT(batches[i - 1].key, batch.key);
+            EXPECT_EQ(batch.firstItem, next);
+            EXPECT_GT(batch.itemCount, 0u);
+            for (uint32_t j = batch.firstItem; j < batch.firstItem + batch.itemCount; j++) EXPECT_EQ(keys[sorted[j]], batch.key);
+            next += batch.itemCount;
+        }
+        EXPECT_EQ(next, (uint32_t)visible.size());
+
+        std::vector<uint32_t> sortedVisible = visible;
+        std::sort(sortedVisible.begin(), sortedVisible.end());
+        std::sort(sorted.begin(), sorted.end());
+        EXPECT(sorted == sortedVisible);
+
+        // Changing a key moves the item to another batch.
+        uint32_t itemID = visible[0];
+        uint32_t newKey = (keys[itemID] + 1) % (2 * kMeshCount);
+        batcher.setKey(itemID, newKey);
+        batcher.createBatches({ itemID }, sorted, batches);
+        EXPECT_EQ(batches.size(), (size_t)1);
+        EXPECT_EQ(batches[0].key, newKey);
+    }
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/PBRTImporter/LoopSubdivide.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBenchmarkLevels[] = { 3, 4, 5 };
+
+        void createIcosahedron(std::vector<float3>& positions, std::vector<uint32_t>& indices)
+        {
+            const float t = 1.618034f;
+            positions =
+            {
+                { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 }, { 0, -1, t }, { 0, 1, t },
+                { 0, -1, -t }, { 0, 1, -t }, { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+            };
+            indices =
+            {
+                0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+            };
+        }
+
+        void createGrid(uint32_t size, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+        {
+            for (uint32_t y = 0; y <= size; y++)
+            {
+                for (uint32_t x = 0; x <= size; x++) positions.push_back(float3(float(x), float(y), 0.f));
+            }
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    uint32_t i = y * (size + 1) + x;
+                    indices.insert(indices.end(), { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 });
+                }
+            }
+        }
+    }
+
+    CPU_TEST(LoopSubdivide_Closed)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createIcosahedron(positions, indices);
+
+        for (uint32_t levels = 0; levels <= 3; levels++)
+        {
+            auto result = pbrt::loopSubdivide(levels, positions, indices);
+
+            // Each level splits every triangle in four and adds a vertex per edge.
+            uint32_t faceCount = 20u << (2 * levels);
+            EXPECT_EQ(result.indices.size(), size_t(faceCount) * 3);
+            EXPECT_EQ(result.positions.size(), size_t(faceCount / 2 + 2));
+            EXPECT_EQ(result.normals.size(), result.positions.size());
+
+            // The limit surface of the origin centered icosahedron is convex, so all normals face the same side.
+            float side = dot(result.normals[0], result.positions[0]);
+            for (size_t i = 0; i < result.positions.size(); i++)
+            {
+                EXPECT_GT(side * dot(result.normals[i], result.positions[i]), 0.f) << "levels = " << levels << ", vertex " << i;
+            }
+            for (uint32_t index : result.indices) EXPECT_LT(index, result.positions.size());
+        }
+    }
+
+    CPU_TEST(LoopSubdivide_Boundary)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createGrid(4, positions, indices);
+
+        auto result = pbrt::loopSubdivide(2, positions, indices);
+        EXPECT_EQ(result.indices.size(), indices.size() * 16);
+
+        // A planar mesh stays planar and inside its bounds. Boundary rules only use boundary vertices.
+        for (size_t i = 0; i < result.positions.size(); i++)
+        {
+            const float3& p = result.positions[i];
+            const float3& n = result.normals[i];
+            EXPECT_EQ(p.z, 0.f);
+            EXPECT(p.x >= 0.f && p.x <= 4.f && p.y >= 0.f && p.y <= 4.f) << "vertex " << i;
+            EXPECT(n.x == 0.f && n.y == 0.f && n.z != 0.f) << "vertex " << i;
+        }
+    }
+
+    CPU_TEST(LoopSubdivide_Benchmark, "Benchmark, run manually")
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createGrid(64, positions, indices);
+
+        for (uint32_t levels : kBenchmarkLevels)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            auto result = pbrt::loopSubdivide(levels, positions, indices);
+            double timeInMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+            EXPECT_EQ(result.indices.size(), indices.size() << (2 * levels));
+
+            logInfo("LoopSubdivide: {} triangles at level {}: {} vertices, {} triangles in {:.2f} ms.",
+                indices.size() / 3, levels, result.positions.size(), result.indices.size() / 3, timeInMs);
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaterialCount = 64;
+
+        void checkMaterialData(GPUUnitTestContext& ctx, const MaterialSystem::SharedPtr& pMaterials)
+        {
+            auto pBuffer = pMaterials->getParameterBlock()->getBuffer("materialData");
+            EXPECT(pBuffer != nullptr);
+            if (!pBuffer) return;
+
+            const size_t size = pMaterials->getMaterialCount() * sizeof(MaterialDataBlob);
+            auto pReadback = Buffer::create(size, ResourceBindFlags::None, Buffer::CpuAccess::Read, nullptr);
+            ctx.getRenderContext()->copyBufferRegion(pReadback.get(), 0ull, pBuffer.get(), 0ull, size);
+            ctx.getRenderContext()->flush(true);
+
+            const MaterialDataBlob* pData = static_cast<const MaterialDataBlob*>(pReadback->map(Buffer::MapType::Read));
+            for (uint32_t i = 0; i < pMaterials->getMaterialCount(); i++)
+            {
+                MaterialDataBlob expected = pMaterials->getMaterial(MaterialID{ i })->getDataBlob();
+                EXPECT(std::memcmp(&pData[i], &expected, sizeof(MaterialDataBlob)) == 0) << "materialID = " << i;
+            }
+            pReadback->unmap();
+        }
+    }
+
+    GPU_TEST(MaterialSystem_DirtyUpdates)
+    {
+        auto pMaterials = MaterialSystem::create();
+        std::vector<StandardMaterial::SharedPtr> materials;
+        for (uint32_t i = 0; i < kMaterialCount; i++)
+        {
+            auto pMaterial = StandardMaterial::create("Material" + std::to_string(i));
+            pMaterial->setBaseColor(float4(0.5f, 0.5f, 0.5f, 1.f));
+            pMaterials->addMaterial(pMaterial);
+            materials.push_back(pMaterial);
+        }
+        pMaterials->finalize();
+
+        // Initial update uploads all materials.
+        pMaterials->update(false);
+        checkMaterialData(ctx, pMaterials);
+
+        // Nothing changed.
+        EXPECT(pMaterials->update(false) == Material::UpdateFlags::None);
+
+        // Change a few materials, including a contiguous run.
+        for (uint32_t i : { 3u, 4u, 5u, 17u, 63u })
+        {
+            materials[i]->setBaseColor(float4(float(i) / kMaterialCount, 0.25f, 0.75f, 1.f));
+        }
+        EXPECT(is_set(pMaterials->update(false), Material::UpdateFlags::DataChanged));
+        checkMaterialData(ctx, pMaterials);
+
+        // Dirty list is cleared after the update.
+        EXPECT(pMaterials->update(false) == Material::UpdateFlags::None);
+    }
+
+    GPU_TEST(MaterialSystem_DirtyUpdatesAfterRemovingDuplicates)
+    {
+        auto pMaterials = MaterialSystem::create();
+        std::vector<StandardMaterial::SharedPtr> materials;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            // Every other material is a duplicate of the previous one.
+            auto pMaterial = StandardMaterial::create("Material" + std::to_string(i));
+            pMaterial->setBaseColor(float4(float(i / 2) / 8, 0.5f, 0.5f, 1.f));
+            pMaterials->addMaterial(pMaterial);
+            materials.push_back(pMaterial);
+        }
+
+        // Mark materials dirty before removing duplicates, the dirty list must not keep stale IDs.
+        materials[7]->setRoughness(0.5f);
+        materials[6]->setRoughness(0.5f);
+
+        std::vector<MaterialID> idMap;
+        EXPECT_EQ(pMaterials->removeDuplicateMaterials(idMap), 4u);
+        EXPECT_EQ(pMaterials->getMaterialCount(), 4u);
+        pMaterials->finalize();
+        pMaterials->update(false);
+        checkMaterialData(ctx, pMaterials);
+
+        // Changing a removed material must not affect the material system.
+        materials[1]->setBaseColor(float4(1.f, 0.f, 0.f, 1.f));
+        EXPECT(pMaterials->update(false) == Material::UpdateFlags::None);
+
+        // Changing a remapped material updates the material at its new ID.
+        materials[6]->setBaseColor(float4(0.f, 1.f, 0.f, 1.f));
+        EXPECT_EQ(idMap[6].get(), 3u);
+        EXPECT(is_set(pMaterials->update(false), Material::UpdateFlags::DataChanged));
+        checkMaterialData(ctx, pMaterials);
+    }
+}
@@ -0,0 +1,115 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshOptimizer.h"
+#include "Scene/TriangleMesh.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Returns the triangles of an index list as sorted keys, with each triangle rotated to start at its smallest index.
+            Rotation preserves the winding, so two lists have equal keys iff they contain the same triangles with the same winding.
+        */
+        std::vector<uint64_t> getTriangleKeys(const std::vector<uint32_t>& indices)
+        {
+            std::vector<uint64_t> keys;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const uint32_t* t = &indices[i];
+                uint32_t s = t[0] <= t[1] && t[0] <= t[2] ? 0 : (t[1] <= t[2] ? 1 : 2);
+                keys.push_back(((uint64_t)t[s] << 42) | ((uint64_t)t[(s + 1) % 3] << 21) | (uint64_t)t[(s + 2) % 3]);
+            }
+            std::sort(keys.begin(), keys.end());
+            return keys;
+        }
+    }
+
+    CPU_TEST(MeshOptimizer_AnalyzeVertexCache)
+    {
+        // Two triangles sharing an edge, the shared vertices hit in the cache.
+        auto stats = MeshOptimizer::analyzeVertexCache({ 0, 1, 2, 2, 1, 3 }, 4);
+        EXPECT_EQ(stats.triangleCount, 2);
+        EXPECT_EQ(stats.vertexCount, 4);
+        EXPECT_EQ(stats.cacheMissCount, 4);
+
+        // With a cache of size 1, every index except repeated ones misses.
+        stats = MeshOptimizer::analyzeVertexCache({ 0, 1, 2, 2, 1, 3 }, 4, 1);
+        EXPECT_EQ(stats.cacheMissCount, 5);
+    }
+
+    CPU_TEST(MeshOptimizer_Sphere)
+    {
+        TriangleMesh::SharedPtr pMesh = TriangleMesh::createSphere(1.f, 64, 32);
+        std::vector<float3> positions;
+        for (const auto& v : pMesh->getVertices()) positions.push_back(v.position);
+        const uint32_t vertexCount = (uint32_t)positions.size();
+
+        // Shuffle the triangles to start from a cache unfriendly order.
+        std::vector<uint32_t> indices;
+        {
+            const auto& meshIndices = pMesh->getIndices();
+            std::vector<uint32_t> order(meshIndices.size() / 3);
+            for (uint32_t i = 0; i < (uint32_t)order.size(); i++) order[i] = i;
+            std::shuffle(order.begin(), order.end(), std::mt19937());
+            for (uint32_t t : order) indices.insert(indices.end(), meshIndices.begin() + t * 3, meshIndices.begin() + t * 3 + 3);
+        }
+        const auto inputKeys = getTriangleKeys(indices);
+        const auto statsBefore = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+
+        MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+        EXPECT(getTriangleKeys(indices) == inputKeys);
+        const auto statsOptimized = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+        EXPECT_LT(statsOptimized.getACMR(), 0.5 * statsBefore.getACMR());
+        EXPECT_LT(statsOptimized.getACMR(), 1.0);
+
+        // Spatial sorting only moves whole clusters, so the cache efficiency is mostly preserved.
+        MeshOptimizer::sortClustersSpatially(indices, positions);
+        EXPECT(getTriangleKeys(indices) == inputKeys);
+        const auto statsSorted = MeshOptimizer::analyzeVertexCache(indices, vertexCount);
+        EXPECT_LT(statsSorted.getACMR(), 1.25 * statsOptimized.getACMR());
+
+        // Vertex remapping must not change the geometry or the cache behavior.
+        std::vector<uint32_t> remappedIndices = indices;
+        auto remap = MeshOptimizer::optimizeVertexFetch(remappedIndices, vertexCount);
+        std::vector<float3> remappedPositions = positions;
+        MeshOptimizer::remapVertices(remappedPositions, remap);
+
+        uint32_t nextVertex = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            EXPECT(remappedPositions[remappedIndices[i]] == positions[indices[i]]);
+            // Vertices are numbered in order of first use.
+            EXPECT_LE(remappedIndices[i], nextVertex);
+            if (remappedIndices[i] == nextVertex) nextVertex++;
+        }
+        EXPECT_EQ(MeshOptimizer::analyzeVertexCache(remappedIndices, vertexCount).cacheMissCount, statsSorted.cacheMissCount);
+    }
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFMeshVoxelizer.h"
+#include "Scene/SDFs/SDFSparseGridFile.h"
+#include "Utils/Logger.h"
+#include <sstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        // These files are located in the Data/Framework/Models directory.
+        const char* kBenchmarkMeshes[] = { "Framework/Models/LightBulb.obj", "Framework/Models/Camera.obj" };
+        const uint32_t kBenchmarkGridWidths[] = { 64, 128 };
+    }
+
+    CPU_TEST(SDFMeshVoxelizer_Sphere)
+    {
+        const float kRadius = 0.5f;
+        TriangleMesh::SharedPtr pMesh = TriangleMesh::createSphere(kRadius, 128, 64);
+
+        SDFMeshVoxelizer::Options options;
+        options.gridWidth = 64;
+        SDFMeshVoxelizer voxelizer(*pMesh);
+        voxelizer.prepare(options);
+
+        // The sphere is scaled to fit the grid minus the padding.
+        float gridRadius = float4(voxelizer.getMeshToGridTransform(options) * float4(kRadius, 0.f, 0.f, 1.f)).x;
+        EXPECT_LE(std::abs(gridRadius - 0.5f * (1.f - 2.f * options.paddingVoxels / options.gridWidth)), 1e-5f);
+
+        const float3 kPoints[] = { float3(0.f), float3(0.1f, 0.f, 0.f), float3(0.2f, -0.1f, 0.15f), float3(0.45f, 0.45f, 0.f), float3(-0.5f, 0.5f, 0.5f), float3(0.f, 0.f, -0.35f) };
+        for (const float3& p : kPoints)
+        {
+            float expected = glm::length(p) - gridRadius;
+            EXPECT_LE(std::abs(voxelizer.evalSignedDistance(p) - expected), 2e-3f) << "p = " << to_string(p);
+
+            float windingNumber = voxelizer.evalWindingNumber(p);
+            EXPECT_LE(std::abs(windingNumber - (expected < 0.f ? 1.f : 0.f)), 0.05f) << "p = " << to_string(p);
+        }
+    }
+
+    CPU_TEST(SDFMeshVoxelizer_SparseOutput)
+    {
+        TriangleMesh::SharedPtr pMesh = TriangleMesh::createCube(float3(1.f));
+
+        SDFMeshVoxelizer::Options options;
+        options.gridWidth = 32;
+        options.brickWidth = 4;
+        options.narrowBandThickness = 1.f;
+        options.paddingVoxels = 8.f;
+
+        auto pStream = std::make_unique<std::stringstream>(std::ios::in | std::ios::out | std::ios::binary);
+        SDFMeshVoxelizer voxelizer(*pMesh);
+        SDFMeshVoxelizer::Stats stats;
+        EXPECT(voxelizer.write(*pStream, options, &stats));
+        EXPECT_EQ(stats.triangleCount, 12u);
+        EXPECT_EQ(stats.totalBrickCount, 8u * 8u * 8u);
+        EXPECT_GT(stats.narrowBandBrickCount, 0u);
+        EXPECT_LE(stats.narrowBandBrickCount, stats.evaluatedBrickCount);
+        EXPECT_LT(stats.evaluatedBrickCount, stats.totalBrickCount);
+
+        pStream->seekg(0);
+        SDFSparseGridFile::Reader reader;
+        EXPECT(reader.open(std::move(pStream)));
+        EXPECT_EQ(reader.getHeader().gridWidth, options.gridWidth);
+        EXPECT_EQ(reader.getHeader().narrowBandBrickCount, stats.narrowBandBrickCount);
+
+        // The grid center is deep inside the cube and the grid corners are outside.
+        auto getState = [&](uint32_t x, uint32_t y, uint32_t z) { return reader.getBrickState(x + 8 * (y + 8 * z)); };
+        EXPECT(getState(3, 3, 3) == SDFSparseGridFile::BrickState::Inside);
+        EXPECT(getState(4, 4, 4) == SDFSparseGridFile::BrickState::Inside);
+        EXPECT(getState(0, 0, 0) == SDFSparseGridFile::BrickState::Outside);
+        EXPECT(getState(7, 7, 7) == SDFSparseGridFile::BrickState::Outside);
+
+        // All stored values must lie within the grid and straddle the surface within the narrow band.
+        SDFSparseGridFile::BrickHeader brickHeader;
+        std::vector<float> values;
+        uint32_t brickCount = 0;
+        while (reader.readNextBrick(brickHeader, values))
+        {
+            EXPECT(reader.getBrickState(brickHeader.virtualBrickID) == SDFSparseGridFile::BrickState::NarrowBand);
+            EXPECT_LE(brickHeader.minValue, reader.getHeader().narrowBandDistance);
+            EXPECT_GE(brickHeader.maxValue, -reader.getHeader().narrowBandDistance);
+            brickCount++;
+        }
+        EXPECT_EQ(brickCount, stats.narrowBandBrickCount);
+    }
+
+    CPU_TEST(SDFMeshVoxelizer_Benchmark, "Benchmark, run manually")
+    {
+        for (const char* meshPath : kBenchmarkMeshes)
+        {
+            TriangleMesh::SharedPtr pMesh = TriangleMesh::createFromFile(meshPath);
+            EXPECT_NE(pMesh, nullptr);
+            if (!pMesh) continue;
+
+            SDFMeshVoxelizer voxelizer(*pMesh);
+            for (uint32_t gridWidth : kBenchmarkGridWidths)
+            {
+                SDFMeshVoxelizer::Options options;
+                options.gridWidth = gridWidth;
+
+                std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+                SDFMeshVoxelizer::Stats stats;
+                EXPECT(voxelizer.write(stream, options, &stats));
+                EXPECT_GT(stats.narrowBandBrickCount, 0u);
+
+                logInfo("SDFMeshVoxelizer: '{}' ({} triangles) at {}^3: BVH {:.2f} ms, voxelization {:.2f} ms, {}/{} bricks in narrow band, {} bytes.",
+                    meshPath, stats.triangleCount, gridWidth, stats.bvhBuildTimeInMs, stats.voxelizeTimeInMs, stats.narrowBandBrickCount, stats.totalBrickCount, stream.str().size());
+            }
+        }
+    }
+}
@@ -0,0 +1,310 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Item = SceneBuilder::MeshGroupPartitionItem;
+        using Groups = std::vector<std::vector<uint32_t>>;
+
+        Item createItem(const float3& center, float size, size_t triangleCount)
+        {
+            Item item;
+            item.bounds = AABB(center - 0.5f * size, center + 0.5f * size);
+            item.triangleCount = triangleCount;
+            item.byteSize = triangleCount * 3 * sizeof(uint32_t);
+            return item;
+        }
+
+        /** Returns the sum of the group surface areas weighted by their triangle counts.
+        */
+        float calcSAHCost(const std::vector<Item>& items, const Groups& groups)
+        {
+            float cost = 0.f;
+            for (const auto& group : groups)
+            {
+                AABB bounds;
+                size_t triangleCount = 0;
+                for (uint32_t i : group)
+                {
+                    bounds.include(items[i].bounds);
+                    triangleCount += items[i].triangleCount;
+                }
+                cost += bounds.area() * (float)triangleCount;
+            }
+            return cost;
+        }
+
+        /** Reference partition splitting groups at the median in terms of triangle count along the largest axis.
+            This is the whole-mesh partition used by SceneBuilder::splitMeshGroupMedian().
+        */
+        void partitionMedian(const std::vector<Item>& items, std::vector<uint32_t> indices, size_t maxTriangleCount, Groups& groups)
+        {
+            AABB bounds;
+            size_t triangleCount = 0;
+            for (uint32_t i : indices)
+            {
+                bounds.include(items[i].bounds);
+                triangleCount += items[i].triangleCount;
+            }
+            if (indices.size() <= 1 || triangleCount <= maxTriangleCount)
+            {
+                groups.push_back(std::move(indices));
+                return;
+            }
+
+            float3 extent = bounds.extent();
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            std::sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) { return items[a].bounds.center()[axis] < items[b].bounds.center()[axis]; });
+
+            size_t triangles = 0;
+            auto splitIter = std::find_if(indices.begin(), indices.end(), [&](uint32_t i) { triangles += items[i].triangleCount; return triangles > triangleCount / 2; });
+            if (splitIter == indices.begin() || splitIter == indices.end()) splitIter = indices.begin() + indices.size() / 2;
+
+            partitionMedian(items, std::vector<uint32_t>(indices.begin(), splitIter), maxTriangleCount, groups);
+            partitionMedian(items, std::vector<uint32_t>(splitIter, indices.end()), maxTriangleCount, groups);
+        }
+
+        /** Cut function splitting the bounds of the meshes by the plane, distributing the triangles by extent.
+            This mimics SceneBuilder::splitMesh(). Meshes with a single triangle are placed by their centroid.
+            \param[in,out] items List of meshes. Halves of cut meshes are appended to the list.
+            \param[in,out] cutItems Per mesh flag, set to true for meshes that have been cut.
+        */
+        SceneBuilder::MeshGroupCutFunc createCutFunc(std::vector<Item>& items, std::vector<bool>& cutItems)
+        {
+            cutItems.assign(items.size(), false);
+            return [&items, &cutItems](const std::vector<uint32_t>& indices, int axis, float pos, std::vector<uint32_t>& left, std::vector<uint32_t>& right)
+            {
+                for (uint32_t i : indices)
+                {
+                    const Item item = items[i];
+                    if (item.bounds.maxPoint[axis] < pos) left.push_back(i);
+                    else if (item.bounds.minPoint[axis] >= pos) right.push_back(i);
+                    else if (item.triangleCount < 2)
+                    {
+                        if (item.bounds.center()[axis] < pos) left.push_back(i);
+                        else right.push_back(i);
+                    }
+                    else
+                    {
+                        float t = (pos - item.bounds.minPoint[axis]) / (item.bounds.maxPoint[axis] - item.bounds.minPoint[axis]);
+                        size_t leftTriangleCount = std::clamp((size_t)(t * item.triangleCount), (size_t)1, item.triangleCount - 1);
+
+                        Item leftItem = item;
+                        leftItem.bounds.maxPoint[axis] = pos;
+                        leftItem.triangleCount = leftTriangleCount;
+                        leftItem.byteSize = leftTriangleCount * 3 * sizeof(uint32_t);
+                        Item rightItem = item;
+                        rightItem.bounds.minPoint[axis] = pos;
+                        rightItem.triangleCount = item.triangleCount - leftTriangleCount;
+                        rightItem.byteSize = rightItem.triangleCount * 3 * sizeof(uint32_t);
+
+                        cutItems[i] = true;
+                        items.push_back(leftItem);
+                        cutItems.push_back(false);
+                        left.push_back((uint32_t)items.size() - 1);
+                        items.push_back(rightItem);
+                        cutItems.push_back(false);
+                        right.push_back((uint32_t)items.size() - 1);
+                    }
+                }
+            };
+        }
+
+        size_t countTriangles(const std::vector<Item>& items, const Groups& groups)
+        {
+            size_t triangleCount = 0;
+            for (const auto& group : groups)
+            {
+                for (uint32_t i : group) triangleCount += items[i].triangleCount;
+            }
+            return triangleCount;
+        }
+
+        void checkPartition(CPUUnitTestContext& ctx, const std::vector<Item>& items, const Groups& groups, const SceneBuilder::MeshGroupBudget& budget, const std::vector<bool>& cutItems = {})
+        {
+            // Every mesh lands in exactly one group, except for meshes that have been cut.
+            std::vector<uint32_t> counts(items.size(), 0);
+            for (const auto& group : groups)
+            {
+                EXPECT(!group.empty());
+                for (uint32_t i : group)
+                {
+                    EXPECT_LT(i, items.size());
+                    if (i < items.size()) counts[i]++;
+                }
+            }
+            for (size_t i = 0; i < items.size(); i++) EXPECT_EQ(counts[i], i < cutItems.size() && cutItems[i] ? 0u : 1u) << "mesh " << i;
+
+            // Only groups holding a single mesh may exceed the budget.
+            for (const auto& group : groups)
+            {
+                if (group.size() == 1) continue;
+                size_t triangleCount = 0;
+                size_t byteSize = 0;
+                for (uint32_t i : group)
+                {
+                    triangleCount += items[i].triangleCount;
+                    byteSize += items[i].byteSize;
+                }
+                EXPECT_LE(triangleCount, budget.maxTriangleCount);
+                if (budget.maxMemoryInBytes > 0) EXPECT_LE(byteSize, budget.maxMemoryInBytes);
+            }
+        }
+    }
+
+    CPU_TEST(SceneBuilder_PartitionMeshesSAH)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(0.f, 100.f);
+        std::uniform_real_distribution<float> size(0.5f, 5.f);
+        std::uniform_int_distribution<size_t> triangles(10, 1000);
+
+        std::vector<Item> items;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            items.push_back(createItem(float3(position(rng), position(rng), position(rng)), size(rng), triangles(rng)));
+        }
+        // A single mesh exceeding the budget.
+        items.push_back(createItem(float3(50.f), 10.f, 20000));
+
+        SceneBuilder::MeshGroupBudget budget;
+        budget.maxTriangleCount = 10000;
+        Groups groups = SceneBuilder::partitionMeshesSAH(items, budget);
+        EXPECT_GT(groups.size(), 50u);
+        checkPartition(ctx, items, groups, budget);
+
+        // Memory budget.
+        budget.maxTriangleCount = 1ull << 24;
+        budget.maxMemoryInBytes = 50000;
+        groups = SceneBuilder::partitionMeshesSAH(items, budget);
+        checkPartition(ctx, items, groups, budget);
+
+        // Groups within budget are not split.
+        budget.maxMemoryInBytes = 0;
+        groups = SceneBuilder::partitionMeshesSAH(items, budget);
+        EXPECT_EQ(groups.size(), 1u);
+        checkPartition(ctx, items, groups, budget);
+    }
+
+    CPU_TEST(SceneBuilder_PartitionMeshesSAHCoincident)
+    {
+        // Meshes with coinciding centroids cannot be binned and are split by list order.
+        std::vector<Item> items;
+        for (uint32_t i = 0; i < 16; i++) items.push_back(createItem(float3(0.f), 1.f + i, 100));
+
+        SceneBuilder::MeshGroupBudget budget;
+        budget.maxTriangleCount = 400;
+        Groups groups = SceneBuilder::partitionMeshesSAH(items, budget);
+        EXPECT_EQ(groups.size(), 4u);
+        checkPartition(ctx, items, groups, budget);
+    }
+
+    CPU_TEST(SceneBuilder_PartitionMeshesSAHCost)
+    {
+        // Two clusters of meshes far apart, with a triangle count median inside the larger cluster.
+        std::vector<Item> items;
+        for (uint32_t i = 0; i < 30; i++) items.push_back(createItem(float3((float)i, 0.f, 0.f), 1.f, 100));
+        for (uint32_t i = 0; i < 10; i++) items.push_back(createItem(float3(1000.f + i, 0.f, 0.f), 1.f, 100));
+
+        SceneBuilder::MeshGroupBudget budget;
+        budget.maxTriangleCount = 3000;
+        Groups sahGroups = SceneBuilder::partitionMeshesSAH(items, budget);
+        checkPartition(ctx, items, sahGroups, budget);
+        EXPECT_EQ(sahGroups.size(), 2u);
+
+        std::vector<uint32_t> indices(items.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        Groups medianGroups;
+        partitionMedian(items, indices, budget.maxTriangleCount, medianGroups);
+        checkPartition(ctx, items, medianGroups, budget);
+
+        // The SAH partition separates the clusters, the median split spans both.
+        float sahCost = calcSAHCost(items, sahGroups);
+        float medianCost = calcSAHCost(items, medianGroups);
+        EXPECT_LE(sahCost, medianCost);
+        EXPECT_LT(sahCost, 0.5f * medianCost);
+    }
+
+    CPU_TEST(SceneBuilder_PartitionMeshesSAHCut)
+    {
+        SceneBuilder::MeshGroupBudget budget;
+        budget.maxTriangleCount = 5000;
+        std::vector<bool> cutItems;
+
+        // A single mesh exceeding the budget is cut until the halves fit.
+        std::vector<Item> items = { createItem(float3(0.f), 100.f, 20000) };
+        Groups groups = SceneBuilder::partitionMeshesSAH(items, budget, createCutFunc(items, cutItems));
+        checkPartition(ctx, items, groups, budget, cutItems);
+        EXPECT_GE(groups.size(), 4u);
+        EXPECT(cutItems[0]);
+        EXPECT_EQ(countTriangles(items, groups), 20000u);
+        for (const auto& group : groups)
+        {
+            EXPECT_EQ(group.size(), 1u);
+            EXPECT_LE(items[group[0]].triangleCount, budget.maxTriangleCount);
+        }
+
+        // Long meshes stacked along y. All whole-mesh partitions overlap heavily, so the meshes are cut along x.
+        items.clear();
+        for (uint32_t i = 0; i < 4; i++) items.push_back(Item{ AABB(float3(0.f, 0.1f * i, 0.f), float3(100.f, 0.1f * i + 1.f, 1.f)), 2000, 2000 * 3 * sizeof(uint32_t) });
+        budget.maxTriangleCount = 4000;
+        groups = SceneBuilder::partitionMeshesSAH(items, budget, createCutFunc(items, cutItems));
+        checkPartition(ctx, items, groups, budget, cutItems);
+        EXPECT_EQ(groups.size(), 2u);
+        EXPECT_EQ(countTriangles(items, groups), 8000u);
+        for (uint32_t i = 0; i < 4; i++) EXPECT(cutItems[i]) << "mesh " << i;
+        for (const auto& group : groups)
+        {
+            AABB bounds;
+            for (uint32_t i : group) bounds.include(items[i].bounds);
+            EXPECT_LE(bounds.extent().x, 50.f);
+        }
+
+        // The same meshes are partitioned whole without a cut function.
+        items.resize(4);
+        groups = SceneBuilder::partitionMeshesSAH(items, budget);
+        checkPartition(ctx, items, groups, budget);
+        EXPECT_EQ(items.size(), 4u);
+
+        // Overlapping meshes that cannot be cut fall back on the whole-mesh partition.
+        items.clear();
+        for (uint32_t i = 0; i < 8; i++) items.push_back(createItem(float3(50.f, 0.1f * i, 0.f), 100.f, 1));
+        budget.maxTriangleCount = 2;
+        groups = SceneBuilder::partitionMeshesSAH(items, budget, createCutFunc(items, cutItems));
+        checkPartition(ctx, items, groups, budget, cutItems);
+        EXPECT_EQ(groups.size(), 4u);
+        EXPECT_EQ(items.size(), 8u);
+    }
+}
@@ -0,0 +1,269 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <tuple>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kChainLength = 20;
+        const uint32_t kAnimatedNode = 10;
+        const uint32_t kNodesPerInstance = 5; // Root, mesh node 5, animated node and its parent, mesh node at the end of the chain.
+
+        SceneBuilder::Node createNode(const std::string& name, NodeID parent, float3 translation = float3(0.f))
+        {
+            return SceneBuilder::Node{ name, rmcv::translate(translation), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), parent };
+        }
+
+        Animation::SharedPtr createAnimation(NodeID nodeID)
+        {
+            auto pAnimation = Animation::create("Move", nodeID, 1.0);
+            Animation::Keyframe keyframe;
+            pAnimation->addKeyframe(keyframe);
+            keyframe.time = 1.0;
+            keyframe.translation = float3(0.f, 1.f, 0.f);
+            pAnimation->addKeyframe(keyframe);
+            return pAnimation;
+        }
+
+        float3 getChainTranslation(uint32_t i)
+        {
+            return float3(1.f, 0.f, 0.1f * i);
+        }
+
+        /** Creates a prototype with a chain of static nodes, an animated node in the middle and meshes at two nodes.
+            Per instance, only the nodes holding meshes, the animated node and its parent need to be created.
+        */
+        SceneBuilder::Prototype createChainPrototype(MeshID meshID)
+        {
+            SceneBuilder::Prototype prototype;
+            prototype.name = "Chain";
+            for (uint32_t i = 0; i < kChainLength; i++)
+            {
+                prototype.nodes.push_back(createNode("Node" + std::to_string(i), i > 0 ? NodeID{ i - 1 } : NodeID::Invalid(), getChainTranslation(i)));
+            }
+            prototype.meshInstances.push_back({ NodeID{ 5 }, meshID });
+            prototype.meshInstances.push_back({ NodeID{ kChainLength - 1 }, meshID });
+            prototype.animations.push_back(createAnimation(NodeID{ kAnimatedNode }));
+            return prototype;
+        }
+
+        SceneBuilder::Node createInstanceRoot(uint32_t i)
+        {
+            return createNode("Instance" + std::to_string(i), NodeID::Invalid(), float3(0.f, 0.f, 10.f * i));
+        }
+
+        /** Adds the chain of createChainPrototype() to the builder without prototypes, replicating the subgraph and the animation per instance.
+        */
+        void addReplicatedChain(SceneBuilder& builder, MeshID meshID, uint32_t i)
+        {
+            NodeID parent = builder.addNode(createInstanceRoot(i));
+            std::vector<NodeID> nodeIDs;
+            for (uint32_t j = 0; j < kChainLength; j++)
+            {
+                nodeIDs.push_back(builder.addNode(createNode("Node" + std::to_string(j), j > 0 ? nodeIDs[j - 1] : parent, getChainTranslation(j))));
+            }
+            builder.addMeshInstance(nodeIDs[5], meshID);
+            builder.addMeshInstance(nodeIDs[kChainLength - 1], meshID);
+            builder.addAnimation(createAnimation(nodeIDs[kAnimatedNode]));
+        }
+
+        /** Returns the world matrices of all geometry instances at the given time, sorted by translation.
+        */
+        std::vector<rmcv::mat4> getInstanceWorldMatrices(GPUUnitTestContext& ctx, const Scene::SharedPtr& pScene, double time)
+        {
+            pScene->update(ctx.getRenderContext(), time);
+            const auto& globalMatrices = pScene->getAnimationController()->getGlobalMatrices();
+
+            std::vector<rmcv::mat4> matrices;
+            for (uint32_t i = 0; i < pScene->getGeometryInstanceCount(); i++)
+            {
+                matrices.push_back(globalMatrices[pScene->getGeometryInstance(i).globalMatrixID]);
+            }
+            std::sort(matrices.begin(), matrices.end(), [](const rmcv::mat4& a, const rmcv::mat4& b)
+            {
+                return std::make_tuple(a[0][3], a[1][3], a[2][3]) < std::make_tuple(b[0][3], b[1][3], b[2][3]);
+            });
+            return matrices;
+        }
+    }
+
+    GPU_TEST(SceneBuilder_PrototypeInstances)
+    {
+        const uint32_t instanceCount = 100;
+
+        auto pBuilder = SceneBuilder::create(SceneBuilder::Flags::DontOptimizeGraph);
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+        PrototypeID prototypeID = pBuilder->addPrototype(createChainPrototype(meshID));
+        for (uint32_t i = 0; i < instanceCount; i++) pBuilder->addPrototypeInstance(prototypeID, createInstanceRoot(i));
+
+        // Only the instance roots exist until the scene is created.
+        EXPECT_EQ(pBuilder->getNodeCount(), instanceCount);
+
+        auto pScene = pBuilder->getScene();
+        EXPECT(pScene != nullptr);
+        if (!pScene) return;
+
+        // The replicated subgraph would have created kChainLength + 1 nodes per instance.
+        // Scene creation adds one identity node for pretransformed meshes.
+        EXPECT_GE(pBuilder->getNodeCount(), instanceCount * kNodesPerInstance);
+        EXPECT_LE(pBuilder->getNodeCount(), instanceCount * kNodesPerInstance + 1);
+        EXPECT_EQ(pScene->getGeometryInstanceCount(), instanceCount * 2);
+
+        // Node names are prefixed with the instance name.
+        uint32_t prefixedNodeCount = 0;
+        for (uint32_t i = 0; i < pBuilder->getNodeCount(); i++)
+        {
+            if (pBuilder->getNode(NodeID{ i }).name == "Instance7/Node" + std::to_string(kChainLength - 1)) prefixedNodeCount++;
+        }
+        EXPECT_EQ(prefixedNodeCount, 1u);
+
+        // The prototype animation is shared by all instances.
+        const auto& animations = pScene->getAnimations();
+        EXPECT_EQ(animations.size(), size_t(1));
+        if (animations.size() == 1) EXPECT_EQ(animations[0]->getInstanceNodeIDs().size(), size_t(instanceCount - 1));
+    }
+
+    GPU_TEST(SceneBuilder_PrototypeInstanceTransforms)
+    {
+        const uint32_t instanceCount = 4;
+
+        // Scene with prototype instances, static nodes are folded.
+        auto pBuilder = SceneBuilder::create();
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+        PrototypeID prototypeID = pBuilder->addPrototype(createChainPrototype(meshID));
+        for (uint32_t i = 0; i < instanceCount; i++) pBuilder->addPrototypeInstance(prototypeID, createInstanceRoot(i));
+        auto pScene = pBuilder->getScene();
+
+        // Same scene with the subgraph and the animation replicated per instance.
+        auto pReferenceBuilder = SceneBuilder::create();
+        MeshID referenceMeshID = pReferenceBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+        for (uint32_t i = 0; i < instanceCount; i++) addReplicatedChain(*pReferenceBuilder, referenceMeshID, i);
+        auto pReferenceScene = pReferenceBuilder->getScene();
+
+        EXPECT(pScene != nullptr && pReferenceScene != nullptr);
+        if (!pScene || !pReferenceScene) return;
+
+        // World transforms match at several times, including the geometry below the animated node.
+        for (double time : { 0.0, 0.25, 0.5 })
+        {
+            auto matrices = getInstanceWorldMatrices(ctx, pScene, time);
+            auto referenceMatrices = getInstanceWorldMatrices(ctx, pReferenceScene, time);
+            EXPECT_EQ(matrices.size(), size_t(instanceCount * 2));
+            EXPECT_EQ(matrices.size(), referenceMatrices.size());
+            if (matrices.size() != referenceMatrices.size()) continue;
+
+            for (size_t i = 0; i < matrices.size(); i++)
+            {
+                for (int r = 0; r < 4; r++)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        EXPECT_LE(std::abs(matrices[i][r][c] - referenceMatrices[i][r][c]), 1e-4f) << "time " << time << ", instance " << i << ", element " << r << "," << c;
+                    }
+                }
+            }
+        }
+    }
+
+    GPU_TEST(SceneBuilder_PrototypeInstancesBenchmark, "Benchmark, run manually")
+    {
+        const uint32_t instanceCount = 10000;
+
+        auto pBuilder = SceneBuilder::create();
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+        PrototypeID prototypeID = pBuilder->addPrototype(createChainPrototype(meshID));
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < instanceCount; i++) pBuilder->addPrototypeInstance(prototypeID, createInstanceRoot(i));
+        auto addTime = CpuTimer::getCurrentTimePoint();
+        auto pScene = pBuilder->getScene();
+        auto endTime = CpuTimer::getCurrentTimePoint();
+        EXPECT(pScene != nullptr);
+
+        logInfo("SceneBuilder_PrototypeInstancesBenchmark: {} instances, {} nodes ({} without prototypes), add {:.2f} ms, getScene {:.2f} ms",
+            instanceCount, pBuilder->getNodeCount(), instanceCount * (kChainLength + 1),
+            CpuTimer::calcDuration(startTime, addTime), CpuTimer::calcDuration(addTime, endTime));
+    }
+
+    GPU_TEST(SceneBuilder_NestedPrototypeInstances)
+    {
+        const uint32_t instanceCount = 100;
+
+        auto pBuilder = SceneBuilder::create();
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+
+        // Leaf prototype with a single mesh at its root.
+        SceneBuilder::Prototype leaf;
+        leaf.name = "Leaf";
+        leaf.nodes.push_back(createNode("LeafRoot", NodeID::Invalid()));
+        leaf.meshInstances.push_back({ NodeID{ 0 }, meshID });
+        PrototypeID leafID = pBuilder->addPrototype(leaf);
+
+        // Branch prototype with three leaves, one of them animated.
+        SceneBuilder::Prototype branch;
+        branch.name = "Branch";
+        branch.nodes.push_back(createNode("BranchRoot", NodeID::Invalid(), float3(0.f, 1.f, 0.f)));
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            SceneBuilder::Prototype::PrototypeInstance instance;
+            instance.name = "Leaf" + std::to_string(i);
+            instance.prototypeID = leafID;
+            instance.parent = NodeID{ 0 };
+            instance.transform = rmcv::translate(float3(float(i), 0.f, 0.f));
+            if (i == 0)
+            {
+                instance.pAnimation = Animation::create("Sway", NodeID::Invalid(), 1.0);
+                instance.pAnimation->addKeyframe(Animation::Keyframe{});
+            }
+            branch.prototypeInstances.push_back(instance);
+        }
+        PrototypeID branchID = pBuilder->addPrototype(branch);
+
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            pBuilder->addPrototypeInstance(branchID, createNode("Tree" + std::to_string(i), NodeID::Invalid(), float3(float(i), 0.f, 0.f)));
+        }
+
+        auto pScene = pBuilder->getScene();
+        EXPECT(pScene != nullptr);
+        EXPECT_EQ(pScene->getGeometryInstanceCount(), instanceCount * 3);
+
+        // Per tree: the root, the branch node and three leaf roots.
+        EXPECT_LE(pBuilder->getNodeCount(), instanceCount * 5 + 1);
+
+        const auto& animations = pScene->getAnimations();
+        EXPECT_EQ(animations.size(), size_t(1));
+        if (animations.size() == 1) EXPECT_EQ(animations[0]->getInstanceNodeIDs().size(), size_t(instanceCount - 1));
+    }
+}
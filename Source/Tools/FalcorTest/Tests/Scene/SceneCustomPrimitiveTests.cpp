@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        AABB createBox(float x)
+        {
+            return AABB(float3(x, 0.f, 0.f), float3(x + 1.f, 1.f, 1.f));
+        }
+    }
+
+    GPU_TEST(Scene_CustomPrimitiveHandles)
+    {
+        const uint32_t primCount = 8;
+
+        auto pBuilder = SceneBuilder::create();
+        MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), StandardMaterial::create("Cube"));
+        pBuilder->addMeshInstance(pBuilder->addNode(SceneBuilder::Node{ "Cube", rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() }), meshID);
+        for (uint32_t i = 0; i < primCount; i++) pBuilder->addCustomPrimitive(i, createBox(float(i)));
+
+        auto pScene = pBuilder->getScene();
+        pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), primCount);
+
+        // Removing primitives keeps the indices of all other primitives.
+        pScene->removeCustomPrimitives(2, 4);
+        pScene->removeCustomPrimitive(2); // Already removed, ignored.
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), primCount - 2);
+        EXPECT(!pScene->isCustomPrimitiveActive(2));
+        EXPECT(!pScene->isCustomPrimitiveActive(3));
+        EXPECT(pScene->isCustomPrimitiveActive(4));
+        EXPECT_EQ(pScene->getCustomPrimitive(4).userID, 4u);
+        EXPECT(pScene->getCustomPrimitiveAABB(4) == createBox(4.f));
+        EXPECT_EQ(pScene->getCustomPrimitiveAABB(2).volume(), 0.f);
+        EXPECT_EQ(pScene->getCustomPrimitive(2).userID, CustomPrimitiveDesc::kInvalidUserID);
+        EXPECT_EQ(pScene->getCustomPrimitive(3).userID, CustomPrimitiveDesc::kInvalidUserID);
+
+        // Removed primitives can't be updated.
+        bool updateThrew = false;
+        try
+        {
+            pScene->updateCustomPrimitive(3, createBox(0.f));
+        }
+        catch (const ArgumentError&)
+        {
+            updateThrew = true;
+        }
+        EXPECT(updateThrew);
+
+        // Removing only refits the acceleration structure.
+        auto updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::CustomPrimitivesMoved));
+        EXPECT(!is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // Adding primitives reuses the free slots before appending new ones, lowest index first.
+        uint32_t a = pScene->addCustomPrimitive(100, createBox(10.f));
+        uint32_t b = pScene->addCustomPrimitive(101, createBox(11.f));
+        EXPECT_EQ(a, 2u);
+        EXPECT_EQ(b, 3u);
+        EXPECT_EQ(pScene->getCustomPrimitive(a).userID, 100u);
+        EXPECT(pScene->getCustomPrimitiveAABB(b) == createBox(11.f));
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount);
+
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::CustomPrimitivesMoved));
+        EXPECT(!is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        uint32_t c = pScene->addCustomPrimitive(102, createBox(12.f));
+        EXPECT_EQ(c, primCount);
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount + 1);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), primCount + 1);
+
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // Updating a primitive only marks it as moved.
+        pScene->updateCustomPrimitive(0, createBox(20.f));
+        EXPECT(pScene->getCustomPrimitiveAABB(0) == createBox(20.f));
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::CustomPrimitivesMoved));
+        EXPECT(!is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // No changes, no updates.
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(!is_set(updates, Scene::UpdateFlags::CustomPrimitivesMoved));
+
+        // A few removed slots at the end are kept.
+        pScene->removeCustomPrimitive(primCount);
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount + 1);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), primCount);
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(!is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // Removed slots at the end are released once they make up a quarter of all slots, which rebuilds the acceleration structure.
+        pScene->removeCustomPrimitives(primCount - 2, primCount);
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), primCount - 2);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), primCount - 2);
+        EXPECT(pScene->isCustomPrimitiveActive(primCount - 3));
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // Released slots are appended again.
+        uint32_t d = pScene->addCustomPrimitive(103, createBox(13.f));
+        EXPECT_EQ(d, primCount - 2);
+        EXPECT_EQ(pScene->getCustomPrimitive(d).userID, 103u);
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // Removing all primitives releases all slots.
+        pScene->removeCustomPrimitives(0, pScene->getCustomPrimitiveSlotCount());
+        EXPECT_EQ(pScene->getCustomPrimitiveSlotCount(), 0u);
+        EXPECT_EQ(pScene->getCustomPrimitiveCount(), 0u);
+        pScene->update(ctx.getRenderContext(), 0.0);
+    }
+
+    GPU_TEST(Scene_CurveUpdates)
+    {
+        const float3 positions[] = { float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(2.f, 0.f, 0.f) };
+        const float radius[] = { 0.1f, 0.1f, 0.1f };
+        const uint32_t indices[] = { 0, 1 };
+
+        SceneBuilder::Curve curve;
+        curve.name = "Curve";
+        curve.vertexCount = 3;
+        curve.indexCount = 2;
+        curve.pIndices = indices;
+        curve.pMaterial = StandardMaterial::create("Curve");
+        curve.positions.pData = positions;
+        curve.radius.pData = radius;
+
+        auto pBuilder = SceneBuilder::create();
+        CurveID curveID = pBuilder->addCurve(curve);
+        pBuilder->addCurveInstance(pBuilder->addNode(SceneBuilder::Node{ "Curve", rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() }), curveID);
+
+        auto pScene = pBuilder->getScene();
+        pScene->update(ctx.getRenderContext(), 0.0);
+
+        // Updating the vertices of a curve only marks the curve as moved.
+        std::vector<StaticCurveVertexData> vertices(pScene->getCurve(curveID).vertexCount);
+        for (uint32_t i = 0; i < (uint32_t)vertices.size(); i++)
+        {
+            vertices[i].position = float3((float)i, 1.f, 0.f);
+            vertices[i].radius = 0.2f;
+        }
+        pScene->updateCurveVertices(curveID, vertices);
+        auto updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(is_set(updates, Scene::UpdateFlags::CurvesMoved));
+        EXPECT(!is_set(updates, Scene::UpdateFlags::GeometryChanged));
+
+        // No changes, no updates.
+        updates = pScene->update(ctx.getRenderContext(), 0.0);
+        EXPECT(!is_set(updates, Scene::UpdateFlags::CurvesMoved));
+
+        // The vertex count must match.
+        bool threw = false;
+        try
+        {
+            vertices.pop_back();
+            pScene->updateCurveVertices(curveID, vertices);
+        }
+        catch (const ArgumentError&)
+        {
+            threw = true;
+        }
+        EXPECT(threw);
+    }
+}
@@ -35,6 +35,91 @@ namespace Falcor
     {
         const float kTestMinWavelength = 300.f;
         const float kTestMaxWavelength = 900.f;
+
+        SampledSpectrum<float> createRandomSpectrum(std::mt19937& rng, float lambdaStart, float lambdaEnd, size_t sampleCount)
+        {
+            auto dist = std::uniform_real_distribution<float>();
+            std::vector<float> samples(sampleCount);
+            for (auto& v : samples) v = dist(rng);
+            return SampledSpectrum<float>(lambdaStart, lambdaEnd, sampleCount, samples.data());
+        }
+
+        float maxRelativeError(const float3& ref, const float3& res)
+        {
+            float3 e = glm::abs(ref - res) / glm::max(glm::abs(ref), float3(1e-6f));
+            return std::max(e.x, std::max(e.y, e.z));
+        }
+    }
+
+    CPU_TEST(SpectrumUtils_IntegrationWeights)
+    {
+        std::mt19937 rng;
+
+        for (uint32_t integrationSteps : { 1u, 4u })
+        {
+            for (uint32_t i = 0; i < 100; i++)
+            {
+                auto spectrum = createRandomSpectrum(rng, 380.f, 780.f, 5 + i);
+
+                float3 ref = SpectrumUtils::integrate<float, float3>(spectrum, SpectrumInterpolation::Linear,
+                    [](float wavelength) { return SpectrumUtils::wavelengthToXYZ_CIE1931(wavelength); }, 0, integrationSteps);
+                float3 res = SpectrumUtils::toXYZ(spectrum, SpectrumInterpolation::Linear, 0, integrationSteps);
+                EXPECT_LE(maxRelativeError(ref, res), 1e-4f);
+
+                ref = SpectrumUtils::integrate<float, float3>(spectrum, SpectrumInterpolation::Linear,
+                    [](float wavelength) { return SpectrumUtils::wavelengthToXYZ_CIE1931(wavelength) * SpectrumUtils::wavelengthToD65(wavelength); }, 0, integrationSteps);
+                res = SpectrumUtils::toXYZ_D65(spectrum, SpectrumInterpolation::Linear, 0, integrationSteps);
+                EXPECT_LE(maxRelativeError(ref, res), 1e-4f);
+            }
+        }
+    }
+
+    CPU_TEST(SpectrumUtils_BatchToRGB)
+    {
+        std::mt19937 rng;
+
+        // Sampled spectra on a mix of grids.
+        std::vector<SampledSpectrum<float>> spectra;
+        for (uint32_t i = 0; i < 1000; i++) spectra.push_back(createRandomSpectrum(rng, i < 500 ? 400.f : 360.f, 700.f, i % 3 == 0 ? 31 : 61));
+
+        std::vector<float3> rgb(spectra.size());
+        SpectrumUtils::toRGB_D65(spectra, rgb);
+        for (size_t i = 0; i < spectra.size(); i++)
+        {
+            EXPECT(rgb[i] == SpectrumUtils::toRGB_D65(spectra[i], SpectrumInterpolation::Linear));
+        }
+
+        // Piecewise linear spectra with integer and non-integer start wavelengths.
+        auto dist = std::uniform_real_distribution<float>();
+        std::vector<PiecewiseLinearSpectrum> piecewiseSpectra;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            std::vector<float> wavelengths;
+            std::vector<float> values;
+            float wavelength = i % 2 == 0 ? 300.f + (float)(i % 100) : 350.f + 100.f * dist(rng);
+            while (wavelength < 850.f)
+            {
+                wavelengths.push_back(wavelength);
+                values.push_back(dist(rng));
+                wavelength += 1.f + 20.f * dist(rng);
+            }
+            piecewiseSpectra.emplace_back(wavelengths, values);
+        }
+
+        rgb.resize(piecewiseSpectra.size());
+        SpectrumUtils::toRGB_Rec709(piecewiseSpectra, rgb);
+        for (size_t i = 0; i < piecewiseSpectra.size(); i++)
+        {
+            // Compare the single pass conversion against the generic one.
+            const auto& s = piecewiseSpectra[i];
+            float3 ref = float3(
+                innerProduct(s, Spectra::kCIE_X),
+                innerProduct(s, Spectra::kCIE_Y),
+                innerProduct(s, Spectra::kCIE_Z)
+            ) / Spectra::kCIE_Y_Integral;
+            EXPECT_LE(maxRelativeError(ref, spectrumToXYZ(s)), 1e-5f);
+            EXPECT(rgb[i] == spectrumToRGB(s));
+        }
     }
 
     GPU_TEST(WavelengthToXYZ)
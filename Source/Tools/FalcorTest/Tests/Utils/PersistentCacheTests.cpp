@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/PersistentCache.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace Falcor
+{
+    CPU_TEST(PersistentCache_Store)
+    {
+        auto directory = std::filesystem::temp_directory_path() / "FalcorPersistentCacheTest";
+        std::filesystem::remove_all(directory);
+        PersistentCache cache(directory, ".bin");
+
+        // Entries are named by the hex string of the key.
+        SHA1::MD key = SHA1::compute("key", 3);
+        auto path = cache.getPath(key);
+        EXPECT(path.parent_path() == directory);
+        EXPECT_EQ(path.filename().string(), "a62f2225bf70bfaccbc7f1ef2a397836717377de.bin");
+
+        // Entries are written to a temporary file that is renamed when complete.
+        std::filesystem::path tmpPath;
+        bool stored = cache.store(key, [&](const std::filesystem::path& p)
+        {
+            tmpPath = p;
+            EXPECT(!std::filesystem::exists(path));
+            std::ofstream fs(p, std::ios_base::binary);
+            fs << "data";
+            return (bool)fs;
+        });
+        EXPECT(stored);
+        EXPECT(tmpPath != path);
+        EXPECT_EQ(tmpPath.extension().string(), ".bin");
+        EXPECT(std::filesystem::exists(path));
+        EXPECT(!std::filesystem::exists(tmpPath));
+
+        // Only completed files are entries.
+        EXPECT(cache.isEntry(path));
+        EXPECT(!cache.isEntry(tmpPath));
+        EXPECT(!cache.isEntry(path.parent_path() / (path.stem().string() + ".dds")));
+        EXPECT(!cache.isEntry(directory / "other.bin"));
+
+        // Failed and throwing writes leave no files behind.
+        SHA1::MD otherKey = SHA1::compute("other", 5);
+        EXPECT(!cache.store(otherKey, [&](const std::filesystem::path& p) { tmpPath = p; std::ofstream fs(p); return false; }));
+        EXPECT(!std::filesystem::exists(tmpPath));
+        EXPECT(!std::filesystem::exists(cache.getPath(otherKey)));
+
+        bool threw = false;
+        try
+        {
+            cache.store(otherKey, [&](const std::filesystem::path& p) -> bool { tmpPath = p; std::ofstream fs(p); throw std::runtime_error("write"); });
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        EXPECT(threw);
+        EXPECT(!std::filesystem::exists(tmpPath));
+
+        // Temporary files are unique per store, so writers in other threads or processes never share them.
+        std::filesystem::path otherTmpPath;
+        cache.store(otherKey, [&](const std::filesystem::path& p) { otherTmpPath = p; return false; });
+        EXPECT(otherTmpPath != tmpPath);
+
+        // Hashing a file is the same as hashing its content.
+        SHA1 sha1;
+        EXPECT(PersistentCache::hashFile(path, sha1));
+        EXPECT(sha1.finalize() == SHA1::compute("data", 4));
+        EXPECT(!PersistentCache::hashFile(directory / "missing.bin", sha1));
+
+        std::filesystem::remove_all(directory);
+    }
+}
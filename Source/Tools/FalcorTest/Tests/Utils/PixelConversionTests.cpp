@@ -0,0 +1,192 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/HostDeviceShared.slangh"
+#include <cmath>
+#include <vector>
+
+namespace Falcor
+{
+    CPU_TEST(PixelConversion_Half)
+    {
+        // Test all half values against the reference conversion and make sure they round trip.
+        std::vector<uint16_t> halfs(65536);
+        for (uint32_t i = 0; i < 65536; i++) halfs[i] = (uint16_t)i;
+
+        std::vector<float> floats(halfs.size());
+        PixelConversion::halfToFloat(halfs.data(), floats.data(), halfs.size());
+
+        std::vector<uint16_t> result(halfs.size());
+        PixelConversion::floatToHalf(floats.data(), result.data(), floats.size());
+
+        for (uint32_t i = 0; i < 65536; i++)
+        {
+            bool isNaN = (i & 0x7c00) == 0x7c00 && (i & 0x03ff) != 0;
+            if (isNaN)
+            {
+                EXPECT(std::isnan(floats[i])) << "i = " << i;
+                EXPECT(std::isnan(f16tof32(result[i]))) << "i = " << i;
+            }
+            else
+            {
+                EXPECT_EQ(floats[i], f16tof32(i)) << "i = " << i;
+                EXPECT_EQ(result[i], i) << "i = " << i;
+            }
+        }
+
+        // Test rounding to nearest even and overflow.
+        const float values[] = { 1.f + 1.f / 2048.f, 1.f + 3.f / 2048.f, 65504.f, 65520.f, -1e6f, 1e-8f };
+        const uint16_t expected[] = { 0x3c00, 0x3c02, 0x7bff, 0x7c00, 0xfc00, 0x0000 };
+        uint16_t halfValues[std::size(values)];
+        PixelConversion::floatToHalf(values, halfValues, std::size(values));
+        for (size_t i = 0; i < std::size(values); i++) EXPECT_EQ(halfValues[i], expected[i]) << "i = " << i;
+    }
+
+    CPU_TEST(PixelConversion_Normalized)
+    {
+        const uint8_t u8[] = { 0, 1, 128, 255 };
+        const int16_t s16[] = { -32768, -32767, 0, 32767 };
+        float f[4];
+
+        PixelConversion::normalizedToFloat(u8, f, 4);
+        for (size_t i = 0; i < 4; i++) EXPECT_EQ(f[i], u8[i] / 255.f);
+
+        uint8_t u8Result[4];
+        PixelConversion::floatToNormalized(f, u8Result, 4);
+        for (size_t i = 0; i < 4; i++) EXPECT_EQ(u8Result[i], u8[i]);
+
+        PixelConversion::normalizedToFloat(s16, f, 4);
+        EXPECT_EQ(f[0], -1.f);
+        EXPECT_EQ(f[1], -1.f);
+        EXPECT_EQ(f[2], 0.f);
+        EXPECT_EQ(f[3], 1.f);
+
+        int16_t s16Result[4];
+        PixelConversion::floatToNormalized(f, s16Result, 4);
+        EXPECT_EQ(s16Result[0], -32767);
+        EXPECT_EQ(s16Result[1], -32767);
+        EXPECT_EQ(s16Result[2], 0);
+        EXPECT_EQ(s16Result[3], 32767);
+    }
+
+    CPU_TEST(PixelConversion_Srgb)
+    {
+        std::vector<uint8_t> srgb(256);
+        for (uint32_t i = 0; i < 256; i++) srgb[i] = (uint8_t)i;
+
+        std::vector<float> linear(256);
+        PixelConversion::srgbToLinear(srgb.data(), linear.data(), srgb.size());
+        EXPECT_EQ(linear[0], 0.f);
+        EXPECT_EQ(linear[255], 1.f);
+        for (uint32_t i = 1; i < 256; i++) EXPECT_GT(linear[i], linear[i - 1]);
+
+        std::vector<uint8_t> result(256);
+        PixelConversion::linearToSrgb(linear.data(), result.data(), linear.size());
+        for (uint32_t i = 0; i < 256; i++) EXPECT_EQ(result[i], srgb[i]) << "i = " << i;
+    }
+
+    CPU_TEST(PixelConversion_ConvertToRGBA32Float)
+    {
+        EXPECT(PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::BGRA8Unorm));
+        EXPECT(PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::RGB16Float));
+        EXPECT(PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::R32Uint));
+        EXPECT(!PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::RGB10A2Unorm));
+        EXPECT(!PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::BC1Unorm));
+        EXPECT(!PixelConversion::isConvertibleToRGBA32Float(ResourceFormat::D32Float));
+
+        // 3x2 image with padded rows.
+        const uint32_t width = 3;
+        const uint32_t height = 2;
+        std::vector<float> dst(width * height * 4);
+
+        {
+            const size_t rowPitch = 16;
+            std::vector<uint8_t> src(rowPitch * height, 0xcd);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint8_t* p = &src[y * rowPitch + x * 4];
+                    p[0] = 10; p[1] = 20; p[2] = 30; p[3] = 40; // BGRX
+                }
+            }
+            PixelConversion::convertToRGBA32Float(ResourceFormat::BGRX8Unorm, width, height, src.data(), rowPitch, dst.data());
+            for (uint32_t i = 0; i < width * height; i++)
+            {
+                EXPECT_EQ(dst[i * 4 + 0], 30.f / 255.f);
+                EXPECT_EQ(dst[i * 4 + 1], 20.f / 255.f);
+                EXPECT_EQ(dst[i * 4 + 2], 10.f / 255.f);
+                EXPECT_EQ(dst[i * 4 + 3], 1.f);
+            }
+        }
+
+        {
+            std::vector<uint16_t> src(width * height * 3);
+            for (size_t i = 0; i < src.size(); i++) src[i] = (uint16_t)f32tof16(float(i));
+            PixelConversion::convertToRGBA32Float(ResourceFormat::RGB16Float, width, height, src.data(), width * 6, dst.data());
+            for (uint32_t i = 0; i < width * height; i++)
+            {
+                EXPECT_EQ(dst[i * 4 + 0], float(i * 3 + 0));
+                EXPECT_EQ(dst[i * 4 + 1], float(i * 3 + 1));
+                EXPECT_EQ(dst[i * 4 + 2], float(i * 3 + 2));
+                EXPECT_EQ(dst[i * 4 + 3], 1.f);
+            }
+        }
+
+        {
+            std::vector<uint16_t> src(width * height * 2);
+            for (size_t i = 0; i < src.size(); i++) src[i] = (uint16_t)(i * 1000);
+            PixelConversion::convertToRGBA32Float(ResourceFormat::RG16Unorm, width, height, src.data(), width * 4, dst.data());
+            for (uint32_t i = 0; i < width * height; i++)
+            {
+                EXPECT_EQ(dst[i * 4 + 0], float(src[i * 2 + 0]) / 65535.f);
+                EXPECT_EQ(dst[i * 4 + 1], float(src[i * 2 + 1]) / 65535.f);
+                EXPECT_EQ(dst[i * 4 + 2], 0.f);
+                EXPECT_EQ(dst[i * 4 + 3], 1.f);
+            }
+        }
+    }
+
+    CPU_TEST(PixelConversion_Channels)
+    {
+        const uint8_t rgb[] = { 1, 2, 3, 4, 5, 6 };
+        uint8_t rgba[8];
+        PixelConversion::expandToRGBA(rgb, 3, rgba, 2, (uint8_t)255, true);
+        const uint8_t expected[] = { 3, 2, 1, 255, 6, 5, 4, 255 };
+        for (size_t i = 0; i < 8; i++) EXPECT_EQ(rgba[i], expected[i]);
+
+        PixelConversion::swapRedBlue(rgba, 2);
+        const uint8_t swapped[] = { 1, 2, 3, 255, 4, 5, 6, 255 };
+        for (size_t i = 0; i < 8; i++) EXPECT_EQ(rgba[i], swapped[i]);
+
+        uint8_t result[6];
+        PixelConversion::rgbaToRGB(rgba, result, 2);
+        for (size_t i = 0; i < 6; i++) EXPECT_EQ(result[i], rgb[i]);
+    }
+}
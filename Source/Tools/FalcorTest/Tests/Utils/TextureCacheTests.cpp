@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        using CompressionMode = ImageIO::CompressionMode;
+    }
+
+    CPU_TEST(TextureCache_SelectCompressionMode)
+    {
+        // 8-bit color images use the requested mode.
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::BGRA8Unorm, CompressionMode::BC7) == CompressionMode::BC7);
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, CompressionMode::BC1) == CompressionMode::BC1);
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RGBA8UnormSrgb, CompressionMode::BC5) == CompressionMode::BC5);
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, CompressionMode::None) == CompressionMode::None);
+
+        // Two channel images always use BC5.
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RG8Unorm, CompressionMode::BC7) == CompressionMode::BC5);
+
+        // Single channel and HDR images are stored uncompressed.
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::R8Unorm, CompressionMode::BC7) == CompressionMode::None);
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RGBA16Float, CompressionMode::BC7) == CompressionMode::None);
+        EXPECT(TextureCache::selectCompressionMode(ResourceFormat::RGBA32Float, CompressionMode::BC7) == CompressionMode::None);
+    }
+
+    GPU_TEST(TextureCache_LoadTexture)
+    {
+        TextureCache::Options options;
+        options.directory = std::filesystem::temp_directory_path() / "FalcorTextureCacheTest";
+        options.maxResolution = 16;
+        auto pCache = TextureCache::create(options);
+        pCache->clear();
+
+        std::filesystem::path fullPath;
+        EXPECT(findFileInDataDirectories("texture4.png", fullPath));
+
+        // First load creates the cache entry.
+        auto pTexture = pCache->loadTexture(fullPath, true, false, Resource::BindFlags::ShaderResource, CompressionMode::BC7);
+        EXPECT(pTexture != nullptr);
+        EXPECT_EQ(pCache->getStats().misses, 1u);
+        EXPECT_EQ(pCache->getStats().hits, 0u);
+
+        // Second load is served from the cache.
+        auto pCachedTexture = pCache->loadTexture(fullPath, true, false, Resource::BindFlags::ShaderResource, CompressionMode::BC7);
+        EXPECT(pCachedTexture != nullptr);
+        EXPECT_EQ(pCache->getStats().misses, 1u);
+        EXPECT_EQ(pCache->getStats().hits, 1u);
+        EXPECT_EQ(pCache->getStats().failures, 0u);
+
+        EXPECT(pCachedTexture->getFormat() == ResourceFormat::BC7Unorm);
+        EXPECT_LE(std::max(pCachedTexture->getWidth(), pCachedTexture->getHeight()), options.maxResolution);
+        EXPECT(pCachedTexture->getSourcePath() == fullPath);
+
+        pCache->clear();
+    }
+
+    GPU_TEST(TextureCache_UnalignedDimensions)
+    {
+        TextureCache::Options options;
+        options.directory = std::filesystem::temp_directory_path() / "FalcorTextureCacheTest";
+        auto pCache = TextureCache::create(options);
+        pCache->clear();
+        std::filesystem::create_directories(options.directory);
+
+        auto createImage = [&](uint32_t width, uint32_t height)
+        {
+            std::vector<uint8_t> data(width * height * 4);
+            for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)(i * 7);
+            auto path = options.directory / ("unaligned" + std::to_string(width) + "x" + std::to_string(height) + ".png");
+            Bitmap::saveImage(path, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::Uncompressed | Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, data.data());
+            return path;
+        };
+
+        // Block aligned base level with mip levels of 6x3, 3x1 and 1x1 pixels. The lower levels are padded to whole blocks.
+        auto alignedPath = createImage(24, 12);
+        auto pAligned = pCache->loadTexture(alignedPath, true, false, Resource::BindFlags::ShaderResource, CompressionMode::BC7);
+        EXPECT(pAligned != nullptr);
+        EXPECT(pAligned->getFormat() == ResourceFormat::BC7Unorm);
+        EXPECT_EQ(pAligned->getWidth(), 24u);
+        EXPECT_EQ(pAligned->getHeight(), 12u);
+        EXPECT_EQ(pAligned->getMipCount(), 5u);
+
+        // Unaligned base levels are stored uncompressed and not cropped, with or without mips.
+        auto unalignedPath = createImage(10, 6);
+        for (bool generateMips : { true, false })
+        {
+            auto pUnaligned = pCache->loadTexture(unalignedPath, generateMips, false, Resource::BindFlags::ShaderResource, CompressionMode::BC7);
+            EXPECT(pUnaligned != nullptr);
+            EXPECT(!isCompressedFormat(pUnaligned->getFormat()));
+            EXPECT_EQ(pUnaligned->getWidth(), 10u);
+            EXPECT_EQ(pUnaligned->getHeight(), 6u);
+            EXPECT_EQ(pUnaligned->getMipCount(), generateMips ? 4u : 1u);
+        }
+        EXPECT_EQ(pCache->getStats().failures, 0u);
+
+        pCache->clear();
+        std::filesystem::remove(alignedPath);
+        std::filesystem::remove(unalignedPath);
+    }
+
+    GPU_TEST(TextureCache_SourceHash)
+    {
+        std::filesystem::path fullPath;
+        EXPECT(findFileInDataDirectories("texture4.png", fullPath));
+        const auto directory = std::filesystem::temp_directory_path() / "FalcorTextureCacheTest";
+
+        auto computeHash = [&](const Texture::SharedPtr& pTexture)
+        {
+            SHA1::MD hash = {};
+            EXPECT(pTexture != nullptr);
+            if (pTexture) EXPECT(TextureCache::computeSourceHash(*pTexture, hash));
+            return hash;
+        };
+
+        auto loadCached = [&](ImageIO::CompressionQuality quality)
+        {
+            TextureCache::Options options;
+            options.directory = directory;
+            options.compressionQuality = quality;
+            auto pCache = TextureCache::create(options);
+            return pCache->loadTexture(fullPath, true, false, Resource::BindFlags::ShaderResource, CompressionMode::BC7);
+        };
+
+        // Loading the same texture with the same options gives the same hash.
+        auto pFast = loadCached(ImageIO::CompressionQuality::Fast);
+        EXPECT(computeHash(pFast) == computeHash(loadCached(ImageIO::CompressionQuality::Fast)));
+
+        // The encoder quality changes the content but not the format, so it must change the hash.
+        auto pHigh = loadCached(ImageIO::CompressionQuality::High);
+        EXPECT(pFast->getFormat() == pHigh->getFormat());
+        EXPECT(computeHash(pFast) != computeHash(pHigh));
+
+        // Textures loaded directly are not keyed by a cache entry.
+        auto pDirect = Texture::createFromFile(fullPath, true, false);
+        EXPECT(pDirect->getSourceKey().empty());
+        EXPECT(computeHash(pDirect) != computeHash(pFast));
+
+        std::filesystem::remove_all(directory);
+    }
+}